@@ -0,0 +1,204 @@
+// AccessControl.cpp - 写入权限：访问组编号和按用户预先计算的权限位
+#include "accesscontrol.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace Industrial {
+
+// ==================== Checker 实现 ====================
+WriteAccessControl::Decision WriteAccessControl::Checker::check(const VariableDefinition *var) const
+{
+    if (!var || !var->writable()) {
+        if (m_owner) {
+            m_owner->recordDenied(DENIED_NOT_WRITABLE, -1);
+        }
+        return DENIED_NOT_WRITABLE;
+    }
+
+    const StringPool::Id groupId = var->accessGroupId();
+    if (groupId == StringPool::EMPTY_ID) {
+        return ALLOWED;
+    }
+
+    int group = -1;
+    if (m_groupOfString && groupId < static_cast<StringPool::Id>(m_groupOfString->size())) {
+        group = m_groupOfString->at(static_cast<int>(groupId));
+    }
+    if (group >= 0 && (m_mask & (Q_UINT64_C(1) << group))) {
+        return ALLOWED;
+    }
+
+    if (m_owner) {
+        m_owner->recordDenied(DENIED_GROUP, group);
+    }
+    return DENIED_GROUP;
+}
+
+// ==================== WriteAccessControl 实现 ====================
+const int WriteAccessControl::MAX_GROUPS;
+
+WriteAccessControl::WriteAccessControl()
+    : m_groupOfString(std::make_shared<const QVector<qint8>>())
+{
+    for (auto &count : m_deniedPerGroup) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+int WriteAccessControl::registerGroup(const QString &group)
+{
+    if (group.isEmpty()) {
+        return -1;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const StringPool::Id id = StringPool::global()->intern(group);
+    auto it = m_groupIds.constFind(id);
+    if (it != m_groupIds.constEnd()) {
+        return it.value();
+    }
+    if (m_groups.size() >= MAX_GROUPS) {
+        qWarning() << "Access group limit reached, cannot register" << group;
+        return -1;
+    }
+
+    const int index = m_groups.size();
+    m_groups.append(group);
+    m_groupIds.insert(id, index);
+    publishTable();
+    return index;
+}
+
+int WriteAccessControl::groupIndex(const QString &group) const
+{
+    const StringPool::Id id = StringPool::global()->find(group);
+    QMutexLocker locker(&m_mutex);
+    return m_groupIds.value(id, -1);
+}
+
+QStringList WriteAccessControl::groups() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_groups;
+}
+
+bool WriteAccessControl::setUserGroups(const QString &user, const QStringList &groups)
+{
+    quint64 mask = 0;
+    bool ok = true;
+    for (const QString &group : groups) {
+        const int index = registerGroup(group);
+        if (index < 0) {
+            ok = false;
+            continue;
+        }
+        mask |= Q_UINT64_C(1) << index;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_userMasks.insert(user, mask);
+    if (user == m_currentUser) {
+        m_currentMask = mask;
+    }
+    return ok;
+}
+
+void WriteAccessControl::removeUser(const QString &user)
+{
+    QMutexLocker locker(&m_mutex);
+    m_userMasks.remove(user);
+    if (user == m_currentUser) {
+        m_currentMask = 0;
+    }
+}
+
+quint64 WriteAccessControl::userMask(const QString &user) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_userMasks.value(user, 0);
+}
+
+QStringList WriteAccessControl::users() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_userMasks.keys();
+}
+
+void WriteAccessControl::setCurrentUser(const QString &user)
+{
+    QMutexLocker locker(&m_mutex);
+    m_currentUser = user;
+    m_currentMask = m_userMasks.value(user, 0);
+}
+
+QString WriteAccessControl::currentUser() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentUser;
+}
+
+WriteAccessControl::Checker WriteAccessControl::checker() const
+{
+    Checker result;
+    result.m_owner = this;
+    QMutexLocker locker(&m_mutex);
+    result.m_groupOfString = m_groupOfString;
+    result.m_mask = m_currentMask;
+    return result;
+}
+
+WriteAccessControl::Checker WriteAccessControl::checker(const QString &user) const
+{
+    Checker result;
+    result.m_owner = this;
+    QMutexLocker locker(&m_mutex);
+    result.m_groupOfString = m_groupOfString;
+    result.m_mask = m_userMasks.value(user, 0);
+    return result;
+}
+
+quint64 WriteAccessControl::deniedCount(int group) const
+{
+    if (group < 0 || group >= MAX_GROUPS) {
+        return 0;
+    }
+    return m_deniedPerGroup[group].load(std::memory_order_relaxed);
+}
+
+void WriteAccessControl::resetStatistics()
+{
+    m_deniedNotWritable.store(0, std::memory_order_relaxed);
+    m_deniedByGroup.store(0, std::memory_order_relaxed);
+    for (auto &count : m_deniedPerGroup) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void WriteAccessControl::recordDenied(Decision decision, int group) const
+{
+    if (decision == DENIED_NOT_WRITABLE) {
+        m_deniedNotWritable.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_deniedByGroup.fetch_add(1, std::memory_order_relaxed);
+    if (group >= 0 && group < MAX_GROUPS) {
+        m_deniedPerGroup[group].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void WriteAccessControl::publishTable()
+{
+    // 按字符串池编号直接下标，表长为已登记组中最大的编号加1
+    StringPool::Id maxId = 0;
+    for (auto it = m_groupIds.constBegin(); it != m_groupIds.constEnd(); ++it) {
+        maxId = qMax(maxId, it.key());
+    }
+
+    auto table = std::make_shared<QVector<qint8>>(static_cast<int>(maxId) + 1, static_cast<qint8>(-1));
+    for (auto it = m_groupIds.constBegin(); it != m_groupIds.constEnd(); ++it) {
+        (*table)[static_cast<int>(it.key())] = static_cast<qint8>(it.value());
+    }
+    m_groupOfString = std::move(table);
+}
+
+} // namespace Industrial
@@ -0,0 +1,96 @@
+// AccessControl.h - 写入权限：访问组编号和按用户预先计算的权限位
+#ifndef ACCESSCONTROL_H
+#define ACCESSCONTROL_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <memory>
+#include <atomic>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 写入权限 ====================
+// 访问组（VariableDefinition::accessGroup）登记为0..MAX_GROUPS-1的组号，每个用户可写的组预先算成64位掩码。
+// 检查时按变量访问组的字符串池编号查表得到组号，再测掩码的一位，不比较字符串。
+// 访问组为空的变量对所有用户开放（只看writable）；访问组未登记的变量拒绝写入。
+// 配置修改时发布新的只读表，写入方先取一个Checker（加锁一次），之后逐变量检查不加锁；
+// 批量写入整批共用一个Checker。拒绝次数按原因和组号计数
+class WriteAccessControl {
+public:
+    static const int MAX_GROUPS = 64;
+
+    enum Decision {
+        ALLOWED = 0,
+        DENIED_NOT_WRITABLE,        // 变量本身不可写
+        DENIED_GROUP                // 当前用户没有该访问组的写权限
+    };
+
+    // ==================== 检查器 ====================
+    // 持有取得时的权限表和用户掩码，之后的配置修改不影响它；可在任意线程使用
+    class Checker {
+    public:
+        Decision check(const VariableDefinition *var) const;   // 拒绝时计数
+        bool canWrite(const VariableDefinition *var) const { return check(var) == ALLOWED; }
+        quint64 mask() const { return m_mask; }
+
+    private:
+        friend class WriteAccessControl;
+
+        const WriteAccessControl *m_owner = nullptr;
+        std::shared_ptr<const QVector<qint8>> m_groupOfString;  // 字符串池编号 -> 组号，-1为未登记
+        quint64 m_mask = 0;
+    };
+
+    WriteAccessControl();
+
+    // ==================== 访问组 ====================
+    int registerGroup(const QString &group);        // 返回组号，已登记时返回原组号，超出MAX_GROUPS返回-1
+    int groupIndex(const QString &group) const;     // 未登记返回-1
+    QStringList groups() const;                     // 按组号顺序
+
+    // ==================== 用户 ====================
+    bool setUserGroups(const QString &user, const QStringList &groups);   // 未登记的组自动登记，组数超限时返回false
+    void removeUser(const QString &user);
+    quint64 userMask(const QString &user) const;
+    QStringList users() const;
+
+    void setCurrentUser(const QString &user);       // 之后的写入按该用户检查；空或未知用户只能写无访问组的变量
+    QString currentUser() const;
+
+    Checker checker() const;                        // 当前用户
+    Checker checker(const QString &user) const;
+
+    // ==================== 统计 ====================
+    quint64 deniedNotWritable() const { return m_deniedNotWritable.load(std::memory_order_relaxed); }
+    quint64 deniedByGroup() const { return m_deniedByGroup.load(std::memory_order_relaxed); }
+    quint64 deniedCount(int group) const;           // 某个访问组被拒绝的次数
+    void resetStatistics();
+
+private:
+    WriteAccessControl(const WriteAccessControl&) = delete;
+    WriteAccessControl& operator=(const WriteAccessControl&) = delete;
+
+    void recordDenied(Decision decision, int group) const;
+    void publishTable();                            // 调用者持有m_mutex
+
+    mutable QMutex m_mutex;
+    QStringList m_groups;                           // 组号 -> 组名
+    QHash<StringPool::Id, int> m_groupIds;          // 字符串池编号 -> 组号
+    QHash<QString, quint64> m_userMasks;
+    QString m_currentUser;
+    quint64 m_currentMask = 0;
+    std::shared_ptr<const QVector<qint8>> m_groupOfString;
+
+    mutable std::atomic<quint64> m_deniedNotWritable{0};
+    mutable std::atomic<quint64> m_deniedByGroup{0};
+    mutable std::atomic<quint64> m_deniedPerGroup[MAX_GROUPS];
+};
+
+} // namespace Industrial
+
+#endif // ACCESSCONTROL_H
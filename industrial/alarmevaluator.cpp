@@ -0,0 +1,385 @@
+// AlarmEvaluator.cpp - 按列存放的批量报警限值计算
+#include "alarmevaluator.h"
+#include <QDebug>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ALARM_EVALUATOR_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ALARM_EVALUATOR_SSE2
+#endif
+
+namespace Industrial {
+
+AlarmEvaluator::AlarmEvaluator(const std::shared_ptr<ValueCellStore> &store)
+    : m_store(store ? store : ValueCellStore::global())
+{
+}
+
+void AlarmEvaluator::ensurePlan()
+{
+    if (!m_planValid || m_store->configVersion() != m_planVersion) {
+        rebuild();
+    }
+}
+
+void AlarmEvaluator::rebuild()//按编号展开报警限值
+{
+    // 先取版本：重建期间的修改会让下一批再次重建
+    m_planVersion = m_store->configVersion();
+
+    const double unused = std::numeric_limits<double>::quiet_NaN();
+    int capacity = m_store->capacity();
+    m_loLo.fill(unused, capacity);
+    m_lo.fill(unused, capacity);
+    m_hi.fill(unused, capacity);
+    m_hiHi.fill(unused, capacity);
+    m_loLoClear.fill(unused, capacity);
+    m_loClear.fill(unused, capacity);
+    m_hiClear.fill(unused, capacity);
+    m_hiHiClear.fill(unused, capacity);
+    m_bandLevel.fill(ALARM_NONE, capacity);
+    m_onDelay.fill(0, capacity);
+    m_offDelay.fill(0, capacity);
+    m_level.resize(capacity);       // 保留已有编号的当前级别，新编号为ALARM_NONE
+    m_owner.resize(capacity);
+    m_filter.resize(capacity);
+    m_pendingFlag.resize(capacity);
+    m_enabledCount = 0;
+
+    for (int id = 0; id < capacity; id++) {
+        VariableDefinition *variable = m_store->owner(static_cast<quint32>(id));
+        if (variable != m_owner[id]) {  // 编号释放后分给了别的变量
+            m_owner[id] = variable;
+            m_level[id] = ALARM_NONE;
+            m_filter[id].reset();
+        }
+        if (!variable) {
+            continue;
+        }
+
+        AlarmThresholds thresholds = variable->alarmThresholds();
+        if (!thresholds.enabled) {
+            m_level[id] = ALARM_NONE;
+            m_filter[id].reset();
+            continue;
+        }
+
+        double hysteresis = qMax(0.0, thresholds.hysteresis);
+        m_loLo[id] = thresholds.loLo;
+        m_lo[id] = thresholds.lo;
+        m_hi[id] = thresholds.hi;
+        m_hiHi[id] = thresholds.hiHi;
+        m_loLoClear[id] = thresholds.loLo + hysteresis;    // NaN加减后仍为NaN
+        m_loClear[id] = thresholds.lo + hysteresis;
+        m_hiClear[id] = thresholds.hi - hysteresis;
+        m_hiHiClear[id] = thresholds.hiHi - hysteresis;
+        m_bandLevel[id] = thresholds.bandLevel;
+        m_onDelay[id] = static_cast<qint64>(variable->alarmOnDelay()) * UaTime::TICKS_PER_MSEC;
+        m_offDelay[id] = static_cast<qint64>(variable->alarmOffDelay()) * UaTime::TICKS_PER_MSEC;
+        m_enabledCount++;
+    }
+
+    m_planValid = true;
+}
+
+AlarmEvaluator::Columns AlarmEvaluator::planColumns() const
+{
+    Columns columns;
+    columns.loLo = m_loLo.constData();
+    columns.lo = m_lo.constData();
+    columns.hi = m_hi.constData();
+    columns.hiHi = m_hiHi.constData();
+    columns.loLoClear = m_loLoClear.constData();
+    columns.loClear = m_loClear.constData();
+    columns.hiClear = m_hiClear.constData();
+    columns.hiHiClear = m_hiHiClear.constData();
+    columns.bandLevel = m_bandLevel.constData();
+    return columns;
+}
+
+AlarmEvaluator::Columns AlarmEvaluator::batchColumns() const
+{
+    Columns columns;
+    columns.loLo = m_batchLimits[0].constData();
+    columns.lo = m_batchLimits[1].constData();
+    columns.hi = m_batchLimits[2].constData();
+    columns.hiHi = m_batchLimits[3].constData();
+    columns.loLoClear = m_batchLimits[4].constData();
+    columns.loClear = m_batchLimits[5].constData();
+    columns.hiClear = m_batchLimits[6].constData();
+    columns.hiHiClear = m_batchLimits[7].constData();
+    columns.bandLevel = m_batchLimits[8].constData();
+    return columns;
+}
+
+int AlarmEvaluator::evaluate(const quint32 *tagIds, const double *values, int count,
+                             QVector<AlarmTransition> &transitions, UaTimestamp now)
+{
+    if (count <= 0) {
+        return 0;
+    }
+    ensurePlan();
+
+    // 1. 按编号取出限值和当前级别，未分配的编号按不启用处理
+    const double unused = std::numeric_limits<double>::quiet_NaN();
+    const QVector<double> *planLimits[9] = {
+        &m_loLo, &m_lo, &m_hi, &m_hiHi, &m_loLoClear, &m_loClear, &m_hiClear, &m_hiHiClear, &m_bandLevel
+    };
+    const quint32 planSize = static_cast<quint32>(m_level.size());
+
+    for (int column = 0; column < 9; column++) {
+        m_batchLimits[column].resize(count);
+        double *dst = m_batchLimits[column].data();
+        const double *src = planLimits[column]->constData();
+        double fallback = (column == 8) ? 0.0 : unused;
+        for (int i = 0; i < count; i++) {
+            dst[i] = tagIds[i] < planSize ? src[tagIds[i]] : fallback;
+        }
+    }
+    m_batchLevel.resize(count);
+    double *level = m_batchLevel.data();
+    for (int i = 0; i < count; i++) {
+        level[i] = tagIds[i] < planSize ? m_level[tagIds[i]] : 0.0;
+    }
+
+    // 2. 向量化计算新级别
+    m_changed.resize(count);
+    int changedCount = evaluateLevels(values, batchColumns(), level, count, m_changed.data());
+
+    // 3. 只写回变化的级别
+    for (int k = 0; k < changedCount; k++) {
+        int i = m_changed[k];
+        m_level[tagIds[i]] = level[i];
+    }
+
+    return confirmTransitions(tagIds, values, level, changedCount, now, transitions);
+}
+
+int AlarmEvaluator::evaluate(const QVector<quint32> &tagIds, const QVector<double> &values,
+                             QVector<AlarmTransition> &transitions, UaTimestamp now)
+{
+    int count = qMin(tagIds.size(), values.size());
+    if (tagIds.size() != values.size()) {
+        qWarning() << "AlarmEvaluator: tagIds/values size mismatch" << tagIds.size() << values.size();
+    }
+    return evaluate(tagIds.constData(), values.constData(), count, transitions, now);
+}
+
+int AlarmEvaluator::evaluateAll(const double *values, int count, QVector<AlarmTransition> &transitions,
+                                UaTimestamp now)
+{
+    ensurePlan();
+    count = qMin(count, m_level.size());
+    if (count <= 0) {
+        return 0;
+    }
+
+    // 限值表本身就是按编号排列的连续数组，直接在上面计算，级别原地更新
+    m_changed.resize(count);
+    double *level = m_level.data();
+    int changedCount = evaluateLevels(values, planColumns(), level, count, m_changed.data());
+
+    return confirmTransitions(nullptr, values, level, changedCount, now, transitions);
+}
+
+int AlarmEvaluator::confirmTransitions(const quint32 *tagIds, const double *values,
+                                       const double *levels, int changedCount, UaTimestamp now,
+                                       QVector<AlarmTransition> &transitions)
+{
+    if (changedCount == 0) {
+        return 0;
+    }
+    if (now == UaTime::NOW) {
+        now = UaTime::now();
+    }
+
+    int appended = 0;
+    for (int k = 0; k < changedCount; k++) {
+        int i = m_changed[k];
+        quint32 id = tagIds ? tagIds[i] : static_cast<quint32>(i);
+        AlarmFilter &filter = m_filter[id];
+        AlarmLevel oldLevel = filter.confirmed;
+
+        if (filter.update(static_cast<AlarmLevel>(static_cast<int>(levels[i])), now,
+                          m_onDelay[id], m_offDelay[id])) {
+            AlarmTransition transition;
+            transition.tagId = id;
+            transition.oldLevel = oldLevel;
+            transition.newLevel = filter.confirmed;
+            transition.value = values[i];
+            transitions.append(transition);
+            appended++;
+        } else if (filter.hasPending() && !m_pendingFlag[id]) {
+            m_pendingFlag[id] = true;
+            m_pendingIds.append(id);
+        }
+    }
+    return appended;
+}
+
+int AlarmEvaluator::poll(QVector<AlarmTransition> &transitions, UaTimestamp now)
+{
+    if (m_pendingIds.isEmpty()) {
+        return 0;
+    }
+    if (now == UaTime::NOW) {
+        now = UaTime::now();
+    }
+
+    int appended = 0;
+    int k = 0;
+    while (k < m_pendingIds.size()) {
+        quint32 id = m_pendingIds[k];
+        AlarmFilter &filter = m_filter[id];
+        AlarmLevel oldLevel = filter.confirmed;
+
+        bool done = !filter.hasPending();   // 已被后续批次确认或作废
+        if (!done && filter.update(filter.pending, now, m_onDelay[id], m_offDelay[id])) {
+            AlarmTransition transition;
+            transition.tagId = id;
+            transition.oldLevel = oldLevel;
+            transition.newLevel = filter.confirmed;
+            transition.value = std::numeric_limits<double>::quiet_NaN(); // 到期确认，不对应某个新值
+            transitions.append(transition);
+            appended++;
+            done = true;
+        }
+
+        if (done) {
+            m_pendingFlag[id] = false;
+            m_pendingIds[k] = m_pendingIds.last();
+            m_pendingIds.removeLast();
+        } else {
+            k++;
+        }
+    }
+    return appended;
+}
+
+quint64 AlarmEvaluator::suppressedByDelay() const
+{
+    quint64 total = 0;
+    for (const AlarmFilter &filter : m_filter) {
+        total += filter.suppressed;
+    }
+    return total;
+}
+
+AlarmLevel AlarmEvaluator::state(quint32 tagId) const
+{
+    if (tagId >= static_cast<quint32>(m_level.size())) {
+        return ALARM_NONE;
+    }
+    return m_filter[tagId].confirmed;
+}
+
+void AlarmEvaluator::resetState(quint32 tagId)
+{
+    if (tagId < static_cast<quint32>(m_level.size())) {
+        m_level[tagId] = ALARM_NONE;
+        m_filter[tagId].reset();
+    }
+}
+
+void AlarmEvaluator::resetAll()
+{
+    m_level.fill(ALARM_NONE);
+    for (AlarmFilter &filter : m_filter) {
+        filter.reset();
+    }
+}
+
+// ==================== 计算核心 ====================
+// raise：按越限限值算出的级别；hold：按复位限值算出的级别。
+// 新级别 = max(raise, min(hold, 当前级别))，即升级立即生效，降级要越过滞环
+int AlarmEvaluator::evaluateLevels(const double *values, const Columns &columns, double *levels, int count,
+                                   int *changed)
+{
+    int changedCount = 0;
+    int i = 0;
+
+#if defined(ALARM_EVALUATOR_AVX)
+    const __m256d critical = _mm256_set1_pd(ALARM_CRITICAL);
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(values + i);
+        __m256d band = _mm256_loadu_pd(columns.bandLevel + i);
+
+        __m256d over = _mm256_or_pd(_mm256_cmp_pd(v, _mm256_loadu_pd(columns.loLo + i), _CMP_LE_OQ),
+                                    _mm256_cmp_pd(v, _mm256_loadu_pd(columns.hiHi + i), _CMP_GE_OQ));
+        __m256d outside = _mm256_or_pd(_mm256_cmp_pd(v, _mm256_loadu_pd(columns.lo + i), _CMP_LE_OQ),
+                                       _mm256_cmp_pd(v, _mm256_loadu_pd(columns.hi + i), _CMP_GE_OQ));
+        __m256d raise = _mm256_max_pd(_mm256_and_pd(over, critical), _mm256_and_pd(outside, band));
+
+        over = _mm256_or_pd(_mm256_cmp_pd(v, _mm256_loadu_pd(columns.loLoClear + i), _CMP_LE_OQ),
+                            _mm256_cmp_pd(v, _mm256_loadu_pd(columns.hiHiClear + i), _CMP_GE_OQ));
+        outside = _mm256_or_pd(_mm256_cmp_pd(v, _mm256_loadu_pd(columns.loClear + i), _CMP_LE_OQ),
+                               _mm256_cmp_pd(v, _mm256_loadu_pd(columns.hiClear + i), _CMP_GE_OQ));
+        __m256d hold = _mm256_max_pd(_mm256_and_pd(over, critical), _mm256_and_pd(outside, band));
+
+        __m256d cur = _mm256_loadu_pd(levels + i);
+        __m256d next = _mm256_max_pd(raise, _mm256_min_pd(hold, cur));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(next, cur, _CMP_NEQ_OQ));
+        if (mask) {  // 绝大多数批次没有变化，只在有变化时写回
+            _mm256_storeu_pd(levels + i, next);
+            for (int lane = 0; lane < 4; lane++) {
+                if (mask & (1 << lane)) {
+                    changed[changedCount++] = i + lane;
+                }
+            }
+        }
+    }
+#elif defined(ALARM_EVALUATOR_SSE2)
+    const __m128d critical = _mm_set1_pd(ALARM_CRITICAL);
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_loadu_pd(values + i);
+        __m128d band = _mm_loadu_pd(columns.bandLevel + i);
+
+        __m128d over = _mm_or_pd(_mm_cmple_pd(v, _mm_loadu_pd(columns.loLo + i)),
+                                 _mm_cmpge_pd(v, _mm_loadu_pd(columns.hiHi + i)));
+        __m128d outside = _mm_or_pd(_mm_cmple_pd(v, _mm_loadu_pd(columns.lo + i)),
+                                    _mm_cmpge_pd(v, _mm_loadu_pd(columns.hi + i)));
+        __m128d raise = _mm_max_pd(_mm_and_pd(over, critical), _mm_and_pd(outside, band));
+
+        over = _mm_or_pd(_mm_cmple_pd(v, _mm_loadu_pd(columns.loLoClear + i)),
+                         _mm_cmpge_pd(v, _mm_loadu_pd(columns.hiHiClear + i)));
+        outside = _mm_or_pd(_mm_cmple_pd(v, _mm_loadu_pd(columns.loClear + i)),
+                            _mm_cmpge_pd(v, _mm_loadu_pd(columns.hiClear + i)));
+        __m128d hold = _mm_max_pd(_mm_and_pd(over, critical), _mm_and_pd(outside, band));
+
+        __m128d cur = _mm_loadu_pd(levels + i);
+        __m128d next = _mm_max_pd(raise, _mm_min_pd(hold, cur));
+        int mask = _mm_movemask_pd(_mm_cmpneq_pd(next, cur));
+        if (mask) {
+            _mm_storeu_pd(levels + i, next);
+            for (int lane = 0; lane < 2; lane++) {
+                if (mask & (1 << lane)) {
+                    changed[changedCount++] = i + lane;
+                }
+            }
+        }
+    }
+#endif
+
+    // 剩余部分（或无SIMD时全部）用标量，比较规则与向量部分一致（NaN不越限）
+    for (; i < count; i++) {
+        double v = values[i];
+        double band = columns.bandLevel[i];
+        double raise = (v <= columns.loLo[i] || v >= columns.hiHi[i]) ? ALARM_CRITICAL
+                       : ((v <= columns.lo[i] || v >= columns.hi[i]) ? band : 0.0);
+        double hold = (v <= columns.loLoClear[i] || v >= columns.hiHiClear[i]) ? ALARM_CRITICAL
+                      : ((v <= columns.loClear[i] || v >= columns.hiClear[i]) ? band : 0.0);
+        double cur = levels[i];
+        double next = qMax(raise, qMin(hold, cur));
+        if (next != cur) {
+            levels[i] = next;
+            changed[changedCount++] = i;
+        }
+    }
+
+    return changedCount;
+}
+
+} // namespace Industrial
@@ -0,0 +1,113 @@
+// AlarmEvaluator.h - 按列存放的批量报警限值计算
+#ifndef ALARMEVALUATOR_H
+#define ALARMEVALUATOR_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <memory>
+#include "valuecellstore.h"
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 报警变化 ====================
+struct AlarmTransition {
+    quint32 tagId = ValueCellStore::INVALID_ID;
+    AlarmLevel oldLevel = ALARM_NONE;
+    AlarmLevel newLevel = ALARM_NONE;
+    double value = 0.0;         // 触发变化的值
+};
+
+// ==================== 批量报警计算 ====================
+// 按值单元编号（tagId）把所有变量的LoLo/Lo/Hi/HiHi限值、复位限值（扣除滞环）和当前报警级别
+// 展开成连续数组（SoA），一批新值用SIMD一次算出新级别，只输出级别发生变化的编号。
+// 判断规则与VariableDefinition::checkAlarmFast一致，另外支持复位滞环：
+// 新级别 = max(按越限限值算出的级别, min(按复位限值算出的级别, 当前级别))。
+// 设置了确认延时的变量，级别变化先进入等待，持续到延时后才输出（由后续批次或poll()确认）。
+// 存储的配置版本变化（变量增删、限值或报警设置修改）时自动重建限值表，已有编号保留当前级别。
+// NaN值按不越限处理，质量不好的值应由调用者剔除。
+// 非线程安全：每个处理线程使用自己的计算器
+class AlarmEvaluator {
+public:
+    explicit AlarmEvaluator(const std::shared_ptr<ValueCellStore> &store);
+
+    // tagIds[i]对应values[i]，同一批内编号不重复；确认的级别变化追加到transitions，返回追加个数
+    int evaluate(const quint32 *tagIds, const double *values, int count,
+                 QVector<AlarmTransition> &transitions, UaTimestamp now = UaTime::NOW);
+    int evaluate(const QVector<quint32> &tagIds, const QVector<double> &values,
+                 QVector<AlarmTransition> &transitions, UaTimestamp now = UaTime::NOW);
+    // values按编号排列（values[tagId]），计算编号0..count-1，不需要按编号取限值
+    int evaluateAll(const double *values, int count, QVector<AlarmTransition> &transitions,
+                    UaTimestamp now = UaTime::NOW);
+    // 确认已到期的等待变化（值不再刷新时由定时器调用）
+    int poll(QVector<AlarmTransition> &transitions, UaTimestamp now = UaTime::NOW);
+
+    AlarmLevel state(quint32 tagId) const;      // 确认后的级别
+    void resetState(quint32 tagId);             // 复位为ALARM_NONE，不产生变化记录
+    void resetAll();
+
+    void rebuild();                             // 立即重建限值表
+    int enabledCount() const { return m_enabledCount; }  // 参与客户端限值判断的变量数
+    int pendingCount() const { return m_pendingIds.size(); }
+    quint64 suppressedByDelay() const;          // 被确认延时吸收的变化次数
+
+    // ==================== 计算核心 ====================
+    struct Columns {
+        const double *loLo;
+        const double *lo;
+        const double *hi;
+        const double *hiHi;
+        const double *loLoClear;    // 复位限值：loLo + 滞环
+        const double *loClear;
+        const double *hiClear;      // 复位限值：hi - 滞环
+        const double *hiHiClear;
+        const double *bandLevel;    // 越Lo/Hi时的级别
+    };
+
+    // levels为当前级别（入）/新级别（出）；变化的下标写入changed，返回变化个数
+    static int evaluateLevels(const double *values, const Columns &columns, double *levels, int count,
+                              int *changed);
+
+private:
+    void ensurePlan();
+    Columns planColumns() const;
+    Columns batchColumns() const;
+    int confirmTransitions(const quint32 *tagIds, const double *values,
+                           const double *levels, int changedCount, UaTimestamp now,
+                           QVector<AlarmTransition> &transitions);
+
+    std::shared_ptr<ValueCellStore> m_store;
+    quint32 m_planVersion = 0;
+    bool m_planValid = false;
+
+    // 按tagId展开的限值表（SoA），未启用的编号限值为NaN
+    QVector<double> m_loLo;
+    QVector<double> m_lo;
+    QVector<double> m_hi;
+    QVector<double> m_hiHi;
+    QVector<double> m_loLoClear;
+    QVector<double> m_loClear;
+    QVector<double> m_hiClear;
+    QVector<double> m_hiHiClear;
+    QVector<double> m_bandLevel;
+    QVector<double> m_level;                    // 限值+滞环判断的级别，按double存放便于直接参与向量计算
+    QVector<VariableDefinition*> m_owner;       // 重建时判断编号是否换了变量
+
+    // 确认延时（UaTimestamp刻度），只在级别变化时访问
+    QVector<qint64> m_onDelay;
+    QVector<qint64> m_offDelay;
+    QVector<AlarmFilter> m_filter;
+    QVector<quint32> m_pendingIds;              // 有等待确认变化的编号
+    QVector<bool> m_pendingFlag;
+
+    // 每批的临时数组，复用容量避免分配
+    QVector<double> m_batchLimits[9];
+    QVector<double> m_batchLevel;
+    QVector<int> m_changed;
+
+    int m_enabledCount = 0;
+};
+
+} // namespace Industrial
+
+#endif // ALARMEVALUATOR_H
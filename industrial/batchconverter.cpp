@@ -0,0 +1,187 @@
+// BatchConverter.cpp - 原始值到工程值的批量转换
+#include "batchconverter.h"
+#include "variablesystem.h"
+#include <QDebug>
+#include <QHash>
+#include <QJsonDocument>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_CONVERTER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATCH_CONVERTER_SSE2
+#endif
+
+namespace Industrial {
+
+BatchConverter::BatchConverter(const std::shared_ptr<ValueCellStore> &store)
+    : m_store(store ? store : ValueCellStore::global())
+{
+}
+
+void BatchConverter::ensurePlan()
+{
+    if (!m_planValid || m_store->configVersion() != m_planVersion) {
+        rebuild();
+    }
+}
+
+void BatchConverter::rebuild()//按编号展开转换系数
+{
+    // 先取版本：重建期间的修改会让下一批再次重建
+    m_planVersion = m_store->configVersion();
+
+    int capacity = m_store->capacity();
+    m_scale.fill(1.0, capacity);
+    m_offset.fill(0.0, capacity);
+    m_kind.fill(ENTRY_UNUSED, capacity);
+    m_customGroup.fill(-1, capacity);
+    m_groupFunctions.clear();
+    m_linearCount = 0;
+    m_customCount = 0;
+
+    QHash<const ConversionFunction*, int> groupOfFunction;
+    QHash<QString, int> groupOfParameters;     // 类型名+参数 -> 组号
+
+    for (int id = 0; id < capacity; id++) {
+        VariableDefinition *variable = m_store->owner(static_cast<quint32>(id));
+        if (!variable) {
+            continue;
+        }
+        double scale = 1.0;
+        double offset = 0.0;
+        if (variable->linearCoefficients(scale, offset)) {
+            m_scale[id] = scale;
+            m_offset[id] = offset;
+            m_kind[id] = ENTRY_LINEAR;
+            m_linearCount++;
+        } else {
+            const ConversionFunction *func = variable->conversionFunction();
+            if (!func) {
+                continue;
+            }
+            int group = groupOfFunction.value(func, -1);
+            if (group < 0) {
+                // 每个变量持有自己的转换对象，参数相同的内置转换（同一分度表的热电偶等）按参数合为一组
+                QString key;
+                if (!func->typeName().isEmpty()) {
+                    key = func->typeName() + QString::fromUtf8(
+                              QJsonDocument(func->parameters()).toJson(QJsonDocument::Compact));
+                    group = groupOfParameters.value(key, -1);
+                }
+                if (group < 0) {
+                    group = m_groupFunctions.size();
+                    m_groupFunctions.append(func);
+                    if (!key.isEmpty()) {
+                        groupOfParameters.insert(key, group);
+                    }
+                }
+                groupOfFunction.insert(func, group);
+            }
+            m_kind[id] = ENTRY_CUSTOM;
+            m_customGroup[id] = group;
+            m_customCount++;
+        }
+    }
+
+    m_planValid = true;
+}
+
+void BatchConverter::rawToEngineering(const quint32 *tagIds, const double *raw, double *eng, int count)
+{
+    if (count <= 0) {
+        return;
+    }
+    ensurePlan();
+
+    // 1. 按编号取出系数，自定义转换先按原样占位
+    m_batchScale.resize(count);
+    m_batchOffset.resize(count);
+    m_batchCustom.clear();
+    double *scale = m_batchScale.data();
+    double *offset = m_batchOffset.data();
+    const int planSize = m_kind.size();
+
+    for (int i = 0; i < count; i++) {
+        quint32 id = tagIds[i];
+        if (id < static_cast<quint32>(planSize) && m_kind[id] == ENTRY_LINEAR) {
+            scale[i] = m_scale[id];
+            offset[i] = m_offset[id];
+        } else {
+            scale[i] = 1.0;
+            offset[i] = 0.0;
+            if (id < static_cast<quint32>(planSize) && m_kind[id] == ENTRY_CUSTOM) {
+                m_batchCustom.append((static_cast<quint64>(m_customGroup[id]) << 32) | static_cast<quint32>(i));
+            }
+        }
+    }
+
+    // 2. 向量化计算整批线性转换
+    applyLinear(raw, scale, offset, eng, count);
+
+    // 3. 非线性转换按组排序，每组收集原始值后调用一次批量接口再写回
+    const int customTotal = m_batchCustom.size();
+    if (customTotal == 0) {
+        return;
+    }
+    std::sort(m_batchCustom.begin(), m_batchCustom.end());
+    m_gatherRaw.resize(customTotal);
+    m_gatherEng.resize(customTotal);
+    const quint64 *items = m_batchCustom.constData();
+    double *gatherRaw = m_gatherRaw.data();
+    double *gatherEng = m_gatherEng.data();
+
+    int begin = 0;
+    while (begin < customTotal) {
+        const quint32 group = static_cast<quint32>(items[begin] >> 32);
+        int end = begin;
+        for (; end < customTotal && static_cast<quint32>(items[end] >> 32) == group; end++) {
+            gatherRaw[end - begin] = raw[static_cast<quint32>(items[end])];
+        }
+        m_groupFunctions[static_cast<int>(group)]->rawToEngineeringBatch(gatherRaw, gatherEng, end - begin);
+        for (int k = begin; k < end; k++) {
+            eng[static_cast<quint32>(items[k])] = gatherEng[k - begin];
+        }
+        begin = end;
+    }
+}
+
+void BatchConverter::rawToEngineering(const QVector<quint32> &tagIds, const QVector<double> &raw,
+                                      QVector<double> &eng)
+{
+    int count = qMin(tagIds.size(), raw.size());
+    if (tagIds.size() != raw.size()) {
+        qWarning() << "BatchConverter: tagIds/raw size mismatch" << tagIds.size() << raw.size();
+    }
+    eng.resize(count);
+    rawToEngineering(tagIds.constData(), raw.constData(), eng.data(), count);
+}
+
+void BatchConverter::applyLinear(const double *raw, const double *scale, const double *offset,
+                                 double *out, int count)
+{
+    int i = 0;
+#if defined(BATCH_CONVERTER_AVX)
+    for (; i + 4 <= count; i += 4) {
+        __m256d r = _mm256_loadu_pd(raw + i);
+        __m256d s = _mm256_loadu_pd(scale + i);
+        __m256d o = _mm256_loadu_pd(offset + i);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(r, s), o));
+    }
+#elif defined(BATCH_CONVERTER_SSE2)
+    for (; i + 2 <= count; i += 2) {
+        __m128d r = _mm_loadu_pd(raw + i);
+        __m128d s = _mm_loadu_pd(scale + i);
+        __m128d o = _mm_loadu_pd(offset + i);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(r, s), o));
+    }
+#endif
+    // 剩余部分（或无SIMD时全部）用标量，乘加顺序与单值rawToEngineering一致
+    for (; i < count; i++) {
+        out[i] = raw[i] * scale[i] + offset[i];
+    }
+}
+
+} // namespace Industrial
@@ -0,0 +1,72 @@
+// BatchConverter.h - 原始值到工程值的批量转换
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <memory>
+#include "valuecellstore.h"
+
+namespace Industrial {
+
+class ConversionFunction;
+
+// ==================== 批量转换 ====================
+// 按值单元编号（tagId）批量把原始寄存器值转换为工程值。
+// 线性转换（包括未设置转换函数时的量程换算）的系数按编号预先展开成scale/offset连续数组，
+// 一批数据先按编号取出系数，再用SIMD统一计算y = raw * scale + offset；
+// 非线性转换按转换对象分组（类型名和参数相同的内置转换合为一组），每组收集后调用一次rawToEngineeringBatch。
+// 存储的配置版本变化（变量增删、量程或转换函数修改）时自动重建系数表。
+// 非线程安全：每个采集线程使用自己的转换器
+class BatchConverter {
+public:
+    explicit BatchConverter(const std::shared_ptr<ValueCellStore> &store);
+
+    // tagIds[i]对应raw[i]，结果写入eng[i]；未分配的编号原样输出
+    void rawToEngineering(const quint32 *tagIds, const double *raw, double *eng, int count);
+    void rawToEngineering(const QVector<quint32> &tagIds, const QVector<double> &raw,
+                          QVector<double> &eng);
+
+    void rebuild();                             // 立即重建系数表
+    int linearCount() const { return m_linearCount; }   // 走向量化路径的变量数
+    int customCount() const { return m_customCount; }   // 走转换函数路径的变量数
+    int customGroupCount() const { return m_groupFunctions.size(); }  // 转换函数分组数
+
+    // 连续数组上的 out[i] = raw[i] * scale[i] + offset[i]
+    static void applyLinear(const double *raw, const double *scale, const double *offset,
+                            double *out, int count);
+
+private:
+    enum EntryKind : quint8 {
+        ENTRY_UNUSED = 0,   // 编号未分配，原样输出
+        ENTRY_LINEAR,       // 线性转换
+        ENTRY_CUSTOM        // 自定义转换函数
+    };
+
+    void ensurePlan();
+
+    std::shared_ptr<ValueCellStore> m_store;
+    quint32 m_planVersion = 0;
+    bool m_planValid = false;
+
+    // 按tagId展开的系数表（SoA）
+    QVector<double> m_scale;
+    QVector<double> m_offset;
+    QVector<quint8> m_kind;
+    QVector<int> m_customGroup;             // ENTRY_CUSTOM的编号所属的转换组，其余为-1
+    QVector<const ConversionFunction*> m_groupFunctions;    // 每组的代表转换函数
+
+    // 每批的临时数组，复用容量避免分配
+    QVector<double> m_batchScale;
+    QVector<double> m_batchOffset;
+    QVector<quint64> m_batchCustom;         // 组号 << 32 | 批内下标，排序后同组相邻
+    QVector<double> m_gatherRaw;
+    QVector<double> m_gatherEng;
+
+    int m_linearCount = 0;
+    int m_customCount = 0;
+};
+
+} // namespace Industrial
+
+#endif // BATCHCONVERTER_H
@@ -0,0 +1,1023 @@
+// CalculationEngine.cpp - 计算变量公式编译与增量求值
+#include "calculationengine.h"
+#include <QTimer>
+#include <QVarLengthArray>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+#include <QtMath>
+#include <cmath>
+
+namespace Industrial {
+
+// ==================== 公式解析 ====================
+// 递归下降，边解析边输出后缀字节码，同时记录栈深度
+class ExpressionParser {
+public:
+    ExpressionParser(const QString &source, CompiledExpression &out)
+        : m_source(source), m_out(out) {}
+
+    bool parse();
+
+private:
+    typedef CompiledExpression::OpCode OpCode;
+
+    enum TokenType {
+        T_END, T_NUMBER, T_NAME, T_TAG, T_OP, T_LPAREN, T_RPAREN, T_COMMA, T_QUESTION, T_COLON
+    };
+
+    struct Token {
+        TokenType type = T_END;
+        QString text;
+        double number = 0.0;
+        int pos = 0;
+    };
+
+    bool next();
+    bool peekIsCall() const;            // 名称后紧跟'('
+    bool isOp(const char *op) const;
+    bool isKeyword(const char *word) const;
+
+    bool parseTernary();
+    bool parseOr();
+    bool parseAnd();
+    bool parseEquality();
+    bool parseComparison();
+    bool parseAdditive();
+    bool parseMultiplicative();
+    bool parseUnary();
+    bool parsePower();
+    bool parsePrimary();
+    bool parseCall(const QString &name);
+    bool expect(TokenType type, const char *what);
+
+    void push(OpCode op, int stackDelta, int arg = 0, int aux = 0);
+    int inputIndex(const QString &tagName);
+    bool fail(const QString &message);
+
+    const QString &m_source;
+    CompiledExpression &m_out;
+    Token m_token;
+    int m_pos = 0;
+    int m_depth = 0;
+};
+
+bool ExpressionParser::parse()
+{
+    if (!next()) {
+        return false;
+    }
+    if (m_token.type == T_END) {
+        return fail("Empty expression");
+    }
+    if (!parseTernary()) {
+        return false;
+    }
+    if (m_token.type != T_END) {
+        return fail(QString("Unexpected '%1'").arg(m_token.text));
+    }
+    return true;
+}
+
+bool ExpressionParser::next()
+{
+    while (m_pos < m_source.size() && m_source[m_pos].isSpace()) {
+        m_pos++;
+    }
+
+    m_token = Token();
+    m_token.pos = m_pos;
+    if (m_pos >= m_source.size()) {
+        m_token.type = T_END;
+        return true;
+    }
+
+    QChar c = m_source[m_pos];
+
+    // 数字
+    if (c.isDigit() || (c == QLatin1Char('.') && m_pos + 1 < m_source.size() && m_source[m_pos + 1].isDigit())) {
+        int start = m_pos;
+        while (m_pos < m_source.size() && (m_source[m_pos].isDigit() || m_source[m_pos] == QLatin1Char('.'))) {
+            m_pos++;
+        }
+        if (m_pos < m_source.size() && (m_source[m_pos] == QLatin1Char('e') || m_source[m_pos] == QLatin1Char('E'))) {
+            int save = m_pos++;
+            if (m_pos < m_source.size() && (m_source[m_pos] == QLatin1Char('+') || m_source[m_pos] == QLatin1Char('-'))) {
+                m_pos++;
+            }
+            if (m_pos < m_source.size() && m_source[m_pos].isDigit()) {
+                while (m_pos < m_source.size() && m_source[m_pos].isDigit()) {
+                    m_pos++;
+                }
+            } else {
+                m_pos = save;
+            }
+        }
+        m_token.text = m_source.mid(start, m_pos - start);
+        bool ok = false;
+        m_token.number = m_token.text.toDouble(&ok);
+        if (!ok) {
+            return fail(QString("Invalid number '%1'").arg(m_token.text));
+        }
+        m_token.type = T_NUMBER;
+        return true;
+    }
+
+    // 名称：函数名、关键字或标签名（可含'.'）
+    if (c.isLetter() || c == QLatin1Char('_')) {
+        int start = m_pos;
+        while (m_pos < m_source.size() &&
+               (m_source[m_pos].isLetterOrNumber() || m_source[m_pos] == QLatin1Char('_') ||
+                m_source[m_pos] == QLatin1Char('.'))) {
+            m_pos++;
+        }
+        m_token.type = T_NAME;
+        m_token.text = m_source.mid(start, m_pos - start);
+        return true;
+    }
+
+    // [任意标签名]
+    if (c == QLatin1Char('[')) {
+        int end = m_source.indexOf(QLatin1Char(']'), m_pos + 1);
+        if (end < 0) {
+            return fail("Missing ']'");
+        }
+        m_token.type = T_TAG;
+        m_token.text = m_source.mid(m_pos + 1, end - m_pos - 1).trimmed();
+        m_pos = end + 1;
+        if (m_token.text.isEmpty()) {
+            return fail("Empty tag reference");
+        }
+        return true;
+    }
+
+    m_pos++;
+    m_token.text = QString(c);
+    switch (c.unicode()) {
+    case '(': m_token.type = T_LPAREN; return true;
+    case ')': m_token.type = T_RPAREN; return true;
+    case ',': m_token.type = T_COMMA; return true;
+    case '?': m_token.type = T_QUESTION; return true;
+    case ':': m_token.type = T_COLON; return true;
+    case '+': case '-': case '*': case '/': case '%': case '^':
+        m_token.type = T_OP;
+        return true;
+    case '<': case '>': case '=': case '!': case '&': case '|': {
+        QChar second = m_pos < m_source.size() ? m_source[m_pos] : QChar();
+        QString pair = m_token.text + second;
+        if (pair == "<=" || pair == ">=" || pair == "==" || pair == "!=" || pair == "&&" || pair == "||") {
+            m_pos++;
+            m_token.text = pair;
+        } else if (c == QLatin1Char('=') || c == QLatin1Char('&') || c == QLatin1Char('|')) {
+            return fail(QString("Unexpected '%1'").arg(c));
+        }
+        m_token.type = T_OP;
+        return true;
+    }
+    default:
+        return fail(QString("Unexpected '%1'").arg(c));
+    }
+}
+
+bool ExpressionParser::peekIsCall() const
+{
+    int pos = m_pos;
+    while (pos < m_source.size() && m_source[pos].isSpace()) {
+        pos++;
+    }
+    return pos < m_source.size() && m_source[pos] == QLatin1Char('(');
+}
+
+bool ExpressionParser::isOp(const char *op) const
+{
+    return m_token.type == T_OP && m_token.text == QLatin1String(op);
+}
+
+bool ExpressionParser::isKeyword(const char *word) const
+{
+    return m_token.type == T_NAME && m_token.text.compare(QLatin1String(word), Qt::CaseInsensitive) == 0;
+}
+
+bool ExpressionParser::parseTernary()
+{
+    if (!parseOr()) {
+        return false;
+    }
+    if (m_token.type != T_QUESTION) {
+        return true;
+    }
+    if (!next() || !parseTernary() || !expect(T_COLON, "':'") || !parseTernary()) {
+        return false;
+    }
+    push(CompiledExpression::OP_SELECT, -2);
+    return true;
+}
+
+bool ExpressionParser::parseOr()
+{
+    if (!parseAnd()) {
+        return false;
+    }
+    while (isOp("||") || isKeyword("or")) {
+        if (!next() || !parseAnd()) {
+            return false;
+        }
+        push(CompiledExpression::OP_OR, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseAnd()
+{
+    if (!parseEquality()) {
+        return false;
+    }
+    while (isOp("&&") || isKeyword("and")) {
+        if (!next() || !parseEquality()) {
+            return false;
+        }
+        push(CompiledExpression::OP_AND, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseEquality()
+{
+    if (!parseComparison()) {
+        return false;
+    }
+    while (isOp("==") || isOp("!=")) {
+        OpCode op = isOp("==") ? CompiledExpression::OP_EQ : CompiledExpression::OP_NE;
+        if (!next() || !parseComparison()) {
+            return false;
+        }
+        push(op, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseComparison()
+{
+    if (!parseAdditive()) {
+        return false;
+    }
+    while (isOp("<") || isOp("<=") || isOp(">") || isOp(">=")) {
+        OpCode op = isOp("<") ? CompiledExpression::OP_LT :
+                    isOp("<=") ? CompiledExpression::OP_LE :
+                    isOp(">") ? CompiledExpression::OP_GT : CompiledExpression::OP_GE;
+        if (!next() || !parseAdditive()) {
+            return false;
+        }
+        push(op, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseAdditive()
+{
+    if (!parseMultiplicative()) {
+        return false;
+    }
+    while (isOp("+") || isOp("-")) {
+        OpCode op = isOp("+") ? CompiledExpression::OP_ADD : CompiledExpression::OP_SUB;
+        if (!next() || !parseMultiplicative()) {
+            return false;
+        }
+        push(op, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseMultiplicative()
+{
+    if (!parseUnary()) {
+        return false;
+    }
+    while (isOp("*") || isOp("/") || isOp("%")) {
+        OpCode op = isOp("*") ? CompiledExpression::OP_MUL :
+                    isOp("/") ? CompiledExpression::OP_DIV : CompiledExpression::OP_MOD;
+        if (!next() || !parseUnary()) {
+            return false;
+        }
+        push(op, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parseUnary()
+{
+    if (isOp("-")) {
+        if (!next() || !parseUnary()) {
+            return false;
+        }
+        push(CompiledExpression::OP_NEG, 0);
+        return true;
+    }
+    if (isOp("+")) {
+        return next() && parseUnary();
+    }
+    if (isOp("!") || isKeyword("not")) {
+        if (!next() || !parseUnary()) {
+            return false;
+        }
+        push(CompiledExpression::OP_NOT, 0);
+        return true;
+    }
+    return parsePower();
+}
+
+bool ExpressionParser::parsePower()
+{
+    if (!parsePrimary()) {
+        return false;
+    }
+    if (isOp("^")) {
+        // 右结合，指数可带符号：2^-1
+        if (!next() || !parseUnary()) {
+            return false;
+        }
+        push(CompiledExpression::OP_POW, -1);
+    }
+    return true;
+}
+
+bool ExpressionParser::parsePrimary()
+{
+    switch (m_token.type) {
+    case T_NUMBER: {
+        m_out.m_constants.append(m_token.number);
+        push(CompiledExpression::OP_CONST, 1, m_out.m_constants.size() - 1);
+        return next();
+    }
+    case T_TAG:
+        push(CompiledExpression::OP_INPUT, 1, inputIndex(m_token.text));
+        return next();
+    case T_NAME: {
+        QString name = m_token.text;
+        if (peekIsCall()) {
+            return parseCall(name);
+        }
+        double constant = 0.0;
+        if (name.compare("true", Qt::CaseInsensitive) == 0) {
+            constant = 1.0;
+        } else if (name.compare("false", Qt::CaseInsensitive) == 0) {
+            constant = 0.0;
+        } else if (name.compare("pi", Qt::CaseInsensitive) == 0) {
+            constant = M_PI;
+        } else {
+            push(CompiledExpression::OP_INPUT, 1, inputIndex(name));
+            return next();
+        }
+        m_out.m_constants.append(constant);
+        push(CompiledExpression::OP_CONST, 1, m_out.m_constants.size() - 1);
+        return next();
+    }
+    case T_LPAREN:
+        return next() && parseTernary() && expect(T_RPAREN, "')'");
+    case T_END:
+        return fail("Unexpected end of expression");
+    default:
+        return fail(QString("Unexpected '%1'").arg(m_token.text));
+    }
+}
+
+bool ExpressionParser::parseCall(const QString &name)
+{
+    const QString function = name.toLower();
+    if (!next() || !expect(T_LPAREN, "'('")) {
+        return false;
+    }
+
+    // rate()的参数必须是标签，状态按标签保存
+    if (function == "rate") {
+        if (m_token.type != T_NAME && m_token.type != T_TAG) {
+            return fail("rate() expects a tag name");
+        }
+        int input = inputIndex(m_token.text);
+        m_out.m_rates.append(CompiledExpression::RateState());
+        push(CompiledExpression::OP_RATE, 1, input, m_out.m_rates.size() - 1);
+        return next() && expect(T_RPAREN, "')'");
+    }
+
+    int argc = 0;
+    if (m_token.type != T_RPAREN) {
+        while (true) {
+            if (!parseTernary()) {
+                return false;
+            }
+            argc++;
+            if (m_token.type != T_COMMA) {
+                break;
+            }
+            if (!next()) {
+                return false;
+            }
+        }
+    }
+    if (!expect(T_RPAREN, "')'")) {
+        return false;
+    }
+
+    struct Fixed {
+        const char *name;
+        OpCode op;
+        int argc;
+    };
+    static const Fixed fixed[] = {
+        {"abs", CompiledExpression::OP_ABS, 1},
+        {"sqrt", CompiledExpression::OP_SQRT, 1},
+        {"exp", CompiledExpression::OP_EXP, 1},
+        {"ln", CompiledExpression::OP_LN, 1},
+        {"log10", CompiledExpression::OP_LOG10, 1},
+        {"sin", CompiledExpression::OP_SIN, 1},
+        {"cos", CompiledExpression::OP_COS, 1},
+        {"tan", CompiledExpression::OP_TAN, 1},
+        {"floor", CompiledExpression::OP_FLOOR, 1},
+        {"ceil", CompiledExpression::OP_CEIL, 1},
+        {"round", CompiledExpression::OP_ROUND, 1},
+        {"pow", CompiledExpression::OP_POW, 2},
+        {"clamp", CompiledExpression::OP_CLAMP, 3},
+        {"if", CompiledExpression::OP_SELECT, 3}
+    };
+    for (const Fixed &f : fixed) {
+        if (function == QLatin1String(f.name)) {
+            if (argc != f.argc) {
+                return fail(QString("%1() expects %2 argument(s)").arg(name).arg(f.argc));
+            }
+            push(f.op, 1 - argc);
+            return true;
+        }
+    }
+
+    OpCode variadic;
+    if (function == "min") {
+        variadic = CompiledExpression::OP_MIN;
+    } else if (function == "max") {
+        variadic = CompiledExpression::OP_MAX;
+    } else if (function == "sum") {
+        variadic = CompiledExpression::OP_SUM;
+    } else if (function == "avg") {
+        variadic = CompiledExpression::OP_AVG;
+    } else {
+        return fail(QString("Unknown function '%1'").arg(name));
+    }
+    if (argc == 0) {
+        return fail(QString("%1() expects at least one argument").arg(name));
+    }
+    push(variadic, 1 - argc, argc);
+    return true;
+}
+
+bool ExpressionParser::expect(TokenType type, const char *what)
+{
+    if (m_token.type != type) {
+        return fail(QString("Expected %1").arg(QLatin1String(what)));
+    }
+    return next();
+}
+
+void ExpressionParser::push(OpCode op, int stackDelta, int arg, int aux)
+{
+    CompiledExpression::Instruction instruction;
+    instruction.op = op;
+    instruction.arg = arg;
+    instruction.aux = aux;
+    m_out.m_code.append(instruction);
+
+    m_depth += stackDelta;
+    m_out.m_maxStack = qMax(m_out.m_maxStack, m_depth);
+}
+
+int ExpressionParser::inputIndex(const QString &tagName)
+{
+    int index = m_out.m_inputs.indexOf(tagName);
+    if (index < 0) {
+        m_out.m_inputs.append(tagName);
+        index = m_out.m_inputs.size() - 1;
+    }
+    return index;
+}
+
+bool ExpressionParser::fail(const QString &message)
+{
+    if (m_out.m_error.isEmpty()) {
+        m_out.m_error = QString("%1 at position %2").arg(message).arg(m_token.pos);
+    }
+    return false;
+}
+
+// ==================== CompiledExpression 实现 ====================
+CompiledExpression CompiledExpression::compile(const QString &source)
+{
+    CompiledExpression expression;
+    expression.m_source = source;
+
+    ExpressionParser parser(source, expression);
+    expression.m_valid = parser.parse();
+    if (!expression.m_valid) {
+        expression.m_code.clear();
+        expression.m_rates.clear();
+    }
+    return expression;
+}
+
+double CompiledExpression::evaluate(const double *values, const UaTimestamp *timestamps)
+{
+    if (!m_valid) {
+        return qQNaN();
+    }
+
+    QVarLengthArray<double, 32> stack(m_maxStack);
+    double *sp = stack.data();      // 下一个空位
+
+    for (const Instruction &ins : m_code) {
+        switch (ins.op) {
+        case OP_CONST: *sp++ = m_constants[ins.arg]; break;
+        case OP_INPUT: *sp++ = values[ins.arg]; break;
+
+        case OP_ADD: sp--; sp[-1] += sp[0]; break;
+        case OP_SUB: sp--; sp[-1] -= sp[0]; break;
+        case OP_MUL: sp--; sp[-1] *= sp[0]; break;
+        case OP_DIV: sp--; sp[-1] /= sp[0]; break;
+        case OP_MOD: sp--; sp[-1] = std::fmod(sp[-1], sp[0]); break;
+        case OP_POW: sp--; sp[-1] = std::pow(sp[-1], sp[0]); break;
+        case OP_NEG: sp[-1] = -sp[-1]; break;
+
+        case OP_LT: sp--; sp[-1] = sp[-1] < sp[0] ? 1.0 : 0.0; break;
+        case OP_LE: sp--; sp[-1] = sp[-1] <= sp[0] ? 1.0 : 0.0; break;
+        case OP_GT: sp--; sp[-1] = sp[-1] > sp[0] ? 1.0 : 0.0; break;
+        case OP_GE: sp--; sp[-1] = sp[-1] >= sp[0] ? 1.0 : 0.0; break;
+        case OP_EQ: sp--; sp[-1] = sp[-1] == sp[0] ? 1.0 : 0.0; break;
+        case OP_NE: sp--; sp[-1] = sp[-1] != sp[0] ? 1.0 : 0.0; break;
+
+        case OP_AND: sp--; sp[-1] = (sp[-1] != 0.0 && sp[0] != 0.0) ? 1.0 : 0.0; break;
+        case OP_OR: sp--; sp[-1] = (sp[-1] != 0.0 || sp[0] != 0.0) ? 1.0 : 0.0; break;
+        case OP_NOT: sp[-1] = sp[-1] == 0.0 ? 1.0 : 0.0; break;
+
+        case OP_SELECT:
+            sp -= 2;
+            sp[-1] = sp[-1] != 0.0 ? sp[0] : sp[1];
+            break;
+
+        case OP_MIN:
+        case OP_MAX:
+        case OP_SUM:
+        case OP_AVG: {
+            double *base = sp - ins.arg;
+            double result = base[0];
+            for (int k = 1; k < ins.arg; k++) {
+                if (ins.op == OP_MIN) {
+                    result = qMin(result, base[k]);
+                } else if (ins.op == OP_MAX) {
+                    result = qMax(result, base[k]);
+                } else {
+                    result += base[k];
+                }
+            }
+            if (ins.op == OP_AVG) {
+                result /= ins.arg;
+            }
+            sp = base;
+            *sp++ = result;
+            break;
+        }
+
+        case OP_ABS: sp[-1] = std::fabs(sp[-1]); break;
+        case OP_SQRT: sp[-1] = std::sqrt(sp[-1]); break;
+        case OP_EXP: sp[-1] = std::exp(sp[-1]); break;
+        case OP_LN: sp[-1] = std::log(sp[-1]); break;
+        case OP_LOG10: sp[-1] = std::log10(sp[-1]); break;
+        case OP_SIN: sp[-1] = std::sin(sp[-1]); break;
+        case OP_COS: sp[-1] = std::cos(sp[-1]); break;
+        case OP_TAN: sp[-1] = std::tan(sp[-1]); break;
+        case OP_FLOOR: sp[-1] = std::floor(sp[-1]); break;
+        case OP_CEIL: sp[-1] = std::ceil(sp[-1]); break;
+        case OP_ROUND: sp[-1] = std::round(sp[-1]); break;
+
+        case OP_CLAMP:
+            sp -= 2;
+            sp[-1] = qBound(sp[0], sp[-1], sp[1]);
+            break;
+
+        case OP_RATE: {
+            // 同一时间戳重复求值（其他输入变化）时沿用上次的变化率
+            RateState &state = m_rates[ins.aux];
+            double value = values[ins.arg];
+            UaTimestamp time = timestamps[ins.arg];
+            if (state.lastTime != 0 && time > state.lastTime) {
+                state.rate = (value - state.lastValue) / UaTime::secondsBetween(state.lastTime, time);
+            }
+            if (time != state.lastTime) {
+                state.lastValue = value;
+                state.lastTime = time;
+            }
+            *sp++ = state.rate;
+            break;
+        }
+        }
+    }
+
+    return sp > stack.data() ? sp[-1] : qQNaN();
+}
+
+void CompiledExpression::resetState()
+{
+    for (RateState &state : m_rates) {
+        state = RateState();
+    }
+}
+}
+
+// ==================== CalculationEngine 实现 ====================
+namespace Industrial {
+
+CalculationEngine::CalculationEngine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+CalculationEngine::~CalculationEngine()
+{
+}
+
+bool CalculationEngine::isCalculated(const VariableDefinition *var) const
+{
+    return (var->type() == TYPE_CALC || var->type() == TYPE_DERIVED) && !var->expression().isEmpty();
+}
+
+void CalculationEngine::addVariable(VariableDefinition *var)
+{
+    if (!var || m_index.contains(var->tagName())) {
+        return;
+    }
+
+    const QString tagName = var->tagName();
+    Node node;
+    node.var = var;
+    m_nodes.append(node);
+    m_index.insert(tagName, m_nodes.size() - 1);
+    compileNode(m_nodes.size() - 1);
+
+    // 计算节点由引擎写入，它自己的信号在inputChanged中忽略
+    connect(var, &VariableDefinition::valueChanged, this, [this, var]() {
+        inputChanged(var);
+    });
+    connect(var, &VariableDefinition::qualityChanged, this, [this, var]() {
+        inputChanged(var);
+    });
+    connect(var, &VariableDefinition::expressionChanged, this, [this, tagName]() {
+        int index = nodeIndex(tagName);
+        if (index >= 0) {
+            compileNode(index);
+        }
+    });
+    connect(var, &QObject::destroyed, this, [this, tagName]() {
+        removeVariable(tagName);
+    });
+
+    m_graphDirty = true;
+    scheduleEvaluation();
+}
+
+void CalculationEngine::addVariables(const QList<VariableDefinition*> &variables)
+{
+    for (VariableDefinition *var : variables) {
+        addVariable(var);
+    }
+}
+
+void CalculationEngine::removeVariable(const QString &tagName)
+{
+    int index = nodeIndex(tagName);
+    if (index < 0) {
+        return;
+    }
+
+    disconnect(m_nodes[index].var, nullptr, this, nullptr);
+    m_nodes.remove(index);
+    m_index.clear();
+    for (int i = 0; i < m_nodes.size(); i++) {
+        m_index.insert(m_nodes[i].var->tagName(), i);
+    }
+
+    // 节点下标已变，等重建后再计算
+    m_orderedNodes.clear();
+    m_dirtyOrders.clear();
+    m_graphDirty = true;
+    scheduleEvaluation();
+}
+
+void CalculationEngine::clear()
+{
+    for (const Node &node : m_nodes) {
+        disconnect(node.var, nullptr, this, nullptr);
+    }
+    m_nodes.clear();
+    m_index.clear();
+    m_orderedNodes.clear();
+    m_dirtyOrders.clear();
+    m_graphDirty = false;
+}
+
+bool CalculationEngine::setFormula(VariableDefinition *target, const QString &expression)
+{
+    if (!target) {
+        return false;
+    }
+    if (target->type() != TYPE_CALC && target->type() != TYPE_DERIVED) {
+        qWarning() << "Formula target must be TYPE_CALC or TYPE_DERIVED:" << target->tagName();
+        return false;
+    }
+
+    addVariable(target);
+    target->setExpression(expression);
+    int index = nodeIndex(target->tagName());
+    compileNode(index);
+
+    const Node &node = m_nodes[index];
+    if (!node.expression.isValid()) {
+        qWarning() << "Invalid formula for" << target->tagName() << ":" << node.expression.errorString();
+        emit calculationError(target->tagName(), node.expression.errorString());
+        return false;
+    }
+    return true;
+}
+
+void CalculationEngine::compileNode(int index)
+{
+    Node &node = m_nodes[index];
+    if (!isCalculated(node.var)) {
+        if (node.expression.isValid() || !node.expression.source().isEmpty()) {
+            node.expression = CompiledExpression();
+            m_graphDirty = true;
+            scheduleEvaluation();
+        }
+        return;
+    }
+    if (node.expression.source() == node.var->expression()) {
+        return;     // 公式没变，保留已编译的字节码和rate状态
+    }
+
+    node.expression = CompiledExpression::compile(node.var->expression());
+    for (const QString &input : node.expression.inputs()) {
+        node.var->addRelatedVariable(input);
+    }
+    m_graphDirty = true;
+    scheduleEvaluation();
+}
+
+bool CalculationEngine::rebuild()
+{
+    m_graphDirty = false;
+    m_orderedNodes.clear();
+    m_dirtyOrders.clear();
+    for (Node &node : m_nodes) {
+        node.inputs.clear();
+        node.dependents.clear();
+        node.order = -1;
+        node.dirty = false;
+        node.error.clear();
+    }
+
+    // 1. 按标签名连边
+    QVector<bool> active(m_nodes.size(), false);
+    for (int i = 0; i < m_nodes.size(); i++) {
+        Node &node = m_nodes[i];
+        if (!isCalculated(node.var)) {
+            continue;
+        }
+        if (!node.expression.isValid()) {
+            node.error = node.expression.errorString();
+            continue;
+        }
+        for (const QString &input : node.expression.inputs()) {
+            int source = nodeIndex(input);
+            if (source < 0) {
+                node.error = QString("Unknown tag '%1'").arg(input);
+                break;
+            }
+            node.inputs.append(source);
+        }
+        if (!node.error.isEmpty()) {
+            node.inputs.clear();
+            continue;
+        }
+        for (int source : node.inputs) {
+            m_nodes[source].dependents.append(i);
+        }
+        active[i] = true;
+    }
+
+    // 2. 拓扑排序，只数计算节点之间的边；剩下入度不为0的在环上
+    QVector<int> pendingInputs(m_nodes.size(), 0);
+    QVector<int> ready;
+    for (int i = 0; i < m_nodes.size(); i++) {
+        if (!active[i]) {
+            continue;
+        }
+        for (int source : m_nodes[i].inputs) {
+            if (active[source]) {
+                pendingInputs[i]++;
+            }
+        }
+        if (pendingInputs[i] == 0) {
+            ready.append(i);
+        }
+    }
+    for (int head = 0; head < ready.size(); head++) {
+        int i = ready[head];
+        m_nodes[i].order = m_orderedNodes.size();
+        m_orderedNodes.append(i);
+        for (int dependent : m_nodes[i].dependents) {
+            if (active[dependent] && --pendingInputs[dependent] == 0) {
+                ready.append(dependent);
+            }
+        }
+    }
+
+    bool ok = true;
+    for (int i = 0; i < m_nodes.size(); i++) {
+        Node &node = m_nodes[i];
+        if (active[i] && node.order < 0) {
+            node.error = "Circular reference";
+        }
+        if (!node.error.isEmpty()) {
+            ok = false;
+            qWarning() << "Calculation disabled for" << node.var->tagName() << ":" << node.error;
+            emit calculationError(node.var->tagName(), node.error);
+        }
+    }
+
+    // 3. 结构变化后全部重新计算一次
+    for (int i : m_orderedNodes) {
+        m_nodes[i].dirty = true;
+        m_dirtyOrders.append(m_nodes[i].order);
+    }
+    std::make_heap(m_dirtyOrders.begin(), m_dirtyOrders.end(), std::greater<int>());
+    return ok;
+}
+
+void CalculationEngine::ensureGraph()
+{
+    if (m_graphDirty) {
+        rebuild();
+    }
+}
+
+// ==================== 求值 ====================
+void CalculationEngine::inputChanged(VariableDefinition *var)
+{
+    ensureGraph();
+    int index = nodeIndex(var->tagName());
+    if (index < 0 || m_nodes[index].var != var || m_nodes[index].order >= 0) {
+        return;
+    }
+    markDependents(index);
+}
+
+void CalculationEngine::inputsChanged(const QList<VariableDefinition*> &variables)
+{
+    for (VariableDefinition *var : variables) {
+        inputChanged(var);
+    }
+}
+
+void CalculationEngine::markDependents(int index)
+{
+    bool marked = false;
+    for (int dependent : m_nodes[index].dependents) {
+        Node &node = m_nodes[dependent];
+        if (node.order >= 0 && !node.dirty) {
+            node.dirty = true;
+            m_dirtyOrders.append(node.order);
+            std::push_heap(m_dirtyOrders.begin(), m_dirtyOrders.end(), std::greater<int>());
+            marked = true;
+        }
+    }
+    if (marked) {
+        scheduleEvaluation();
+    }
+}
+
+void CalculationEngine::scheduleEvaluation()
+{
+    // 同一轮事件中的多次变化合并成一次计算
+    if (!m_evaluationScheduled) {
+        m_evaluationScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            evaluatePending();
+        });
+    }
+}
+
+int CalculationEngine::evaluatePending()
+{
+    m_evaluationScheduled = false;
+    ensureGraph();
+
+    int count = 0;
+    while (!m_dirtyOrders.isEmpty()) {
+        std::pop_heap(m_dirtyOrders.begin(), m_dirtyOrders.end(), std::greater<int>());
+        int order = m_dirtyOrders.takeLast();
+        int index = m_orderedNodes[order];
+        m_nodes[index].dirty = false;
+        count++;
+        if (evaluateNode(index)) {
+            markDependents(index);
+        }
+    }
+
+    if (count > 0) {
+        emit evaluated(count);
+    }
+    return count;
+}
+
+int CalculationEngine::evaluateAll()
+{
+    ensureGraph();
+    for (int index : m_orderedNodes) {
+        Node &node = m_nodes[index];
+        if (!node.dirty) {
+            node.dirty = true;
+            m_dirtyOrders.append(node.order);
+            std::push_heap(m_dirtyOrders.begin(), m_dirtyOrders.end(), std::greater<int>());
+        }
+    }
+    return evaluatePending();
+}
+
+bool CalculationEngine::evaluateNode(int index)
+{
+    Node &node = m_nodes[index];
+    const int count = node.inputs.size();
+    m_inputValues.resize(count);
+    m_inputTimes.resize(count);
+
+    UaTimestamp latest = 0;
+    DataQuality quality = QUALITY_GOOD;
+    for (int k = 0; k < count; k++) {
+        ValueSample sample = m_nodes[node.inputs[k]].var->sample();
+        m_inputValues[k] = VariableDefinition::sampleToDouble(sample);
+        m_inputTimes[k] = sample.timestamp;
+        latest = qMax(latest, sample.timestamp);
+        if (quality == QUALITY_GOOD && sample.quality != QUALITY_GOOD) {
+            quality = static_cast<DataQuality>(sample.quality);
+        }
+    }
+
+    double result = node.expression.evaluate(m_inputValues.constData(), m_inputTimes.constData());
+    if (!std::isfinite(result)) {
+        quality = QUALITY_BAD;
+    }
+
+    ValueSample before = node.var->sample();
+    node.var->setDoubleValue(result, latest > 0 ? latest : UaTime::NOW, quality);
+    ValueSample after = node.var->sample();
+
+    // 按位比较，NaN也能判断
+    return after.value.asLong != before.value.asLong || after.quality != before.quality ||
+           after.storageType != before.storageType;
+}
+
+// ==================== 查询 ====================
+QStringList CalculationEngine::calculatedTags() const
+{
+    QStringList tags;
+    for (int index : m_orderedNodes) {
+        tags.append(m_nodes[index].var->tagName());
+    }
+    return tags;
+}
+
+QStringList CalculationEngine::dependencies(const QString &tagName) const
+{
+    QStringList tags;
+    int index = nodeIndex(tagName);
+    if (index >= 0) {
+        for (int source : m_nodes[index].inputs) {
+            tags.append(m_nodes[source].var->tagName());
+        }
+    }
+    return tags;
+}
+
+QStringList CalculationEngine::dependents(const QString &tagName) const
+{
+    QStringList tags;
+    int index = nodeIndex(tagName);
+    if (index >= 0) {
+        for (int dependent : m_nodes[index].dependents) {
+            tags.append(m_nodes[dependent].var->tagName());
+        }
+    }
+    return tags;
+}
+
+QString CalculationEngine::errorString(const QString &tagName) const
+{
+    int index = nodeIndex(tagName);
+    return index >= 0 ? m_nodes[index].error : QString();
+}
+
+} // namespace Industrial
@@ -0,0 +1,149 @@
+// CalculationEngine.h - 计算变量（TYPE_CALC/TYPE_DERIVED）公式编译与增量求值
+#ifndef CALCULATIONENGINE_H
+#define CALCULATIONENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 编译后的公式 ====================
+// 公式只在设置时解析一次，编译成后缀字节码，求值时在栈上顺序执行，不再解析文本。
+// 语法：
+//   数字、true/false、pi；标签名直接书写（AREA1.PUMP101.FLOW.PV），含其他字符的标签写成[TT-101.PV]
+//   算术 + - * / % ^，比较 < <= > >= == !=，逻辑 && || !（也可写and/or/not），条件 c ? a : b
+//   min/max/sum/avg(任意个参数)、abs/sqrt/exp/ln/log10/sin/cos/tan/floor/ceil/round、pow(x,y)、
+//   clamp(x,lo,hi)、if(c,a,b)、rate(标签)（每秒变化率，按输入时间戳计算）
+// 条件和逻辑运算两边都求值（没有副作用，rate的状态因此每次都更新），结果按真假选择
+class CompiledExpression {
+public:
+    enum OpCode : quint8 {
+        OP_CONST,       // arg：常量下标
+        OP_INPUT,       // arg：输入下标
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW, OP_NEG,
+        OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE,
+        OP_AND, OP_OR, OP_NOT,
+        OP_SELECT,      // 条件 ? a : b
+        OP_MIN, OP_MAX, OP_SUM, OP_AVG,     // arg：参数个数
+        OP_ABS, OP_SQRT, OP_EXP, OP_LN, OP_LOG10,
+        OP_SIN, OP_COS, OP_TAN, OP_FLOOR, OP_CEIL, OP_ROUND,
+        OP_CLAMP,
+        OP_RATE         // arg：输入下标，aux：状态下标
+    };
+
+    struct Instruction {
+        OpCode op;
+        qint32 arg;
+        qint32 aux;
+    };
+
+    CompiledExpression() = default;
+    static CompiledExpression compile(const QString &source);
+
+    bool isValid() const { return m_valid; }
+    QString source() const { return m_source; }
+    QString errorString() const { return m_error; }
+
+    const QStringList& inputs() const { return m_inputs; }  // 引用的标签名，下标即OP_INPUT的参数
+    const QVector<Instruction>& code() const { return m_code; }
+
+    // values/timestamps按inputs()的顺序；rate()的状态保存在本对象中
+    double evaluate(const double *values, const UaTimestamp *timestamps);
+    void resetState();
+
+private:
+    friend class ExpressionParser;
+
+    struct RateState {
+        double lastValue = 0.0;
+        UaTimestamp lastTime = 0;
+        double rate = 0.0;
+    };
+
+    QString m_source;
+    QString m_error;
+    bool m_valid = false;
+    QStringList m_inputs;
+    QVector<double> m_constants;
+    QVector<Instruction> m_code;
+    QVector<RateState> m_rates;
+    int m_maxStack = 0;
+};
+
+// ==================== 计算引擎 ====================
+// 登记的变量中，有公式的TYPE_CALC/TYPE_DERIVED变量成为计算节点，公式引用的标签为其输入，组成依赖图。
+// 图按拓扑序排好，循环引用和引用不到的标签在重建时报错并停用相关节点。
+// 输入变化只把下游节点标脏，在事件循环空闲时按拓扑序计算受影响的节点，结果写回目标变量：
+// 时间戳取输入中最新的，任一输入质量不好时结果沿用该质量，结果不是有限数时为QUALITY_BAD。
+// 结果与原值相同时不再向下游传递。
+// 输入关闭逐个信号（批量变化通知）时由消费者调用inputsChanged()。非线程安全，在引擎所在线程使用
+class CalculationEngine : public QObject {
+    Q_OBJECT
+public:
+    explicit CalculationEngine(QObject *parent = nullptr);
+    ~CalculationEngine();
+
+    // ==================== 变量登记 ====================
+    void addVariable(VariableDefinition *var);
+    void addVariables(const QList<VariableDefinition*> &variables);
+    void removeVariable(const QString &tagName);
+    void clear();
+
+    bool setFormula(VariableDefinition *target, const QString &expression);//设置公式并登记
+    bool rebuild();                     // 立即重建依赖图，全部节点可用时返回true
+
+    // ==================== 求值 ====================
+    void inputChanged(VariableDefinition *var);
+    void inputsChanged(const QList<VariableDefinition*> &variables);
+    int evaluatePending();              // 计算所有受影响的节点，返回计算的节点数
+    int evaluateAll();
+
+    // ==================== 查询 ====================
+    QStringList calculatedTags() const;             // 按计算顺序
+    QStringList dependencies(const QString &tagName) const;
+    QStringList dependents(const QString &tagName) const;
+    QString errorString(const QString &tagName) const;
+    int pendingCount() const { return m_dirtyOrders.size(); }
+
+signals:
+    void calculationError(const QString &tagName, const QString &error);
+    void evaluated(int count);
+
+private:
+    struct Node {
+        VariableDefinition *var = nullptr;
+        CompiledExpression expression;  // 无效时为输入节点
+        QVector<int> inputs;            // 与expression.inputs()对应的节点
+        QVector<int> dependents;
+        int order = -1;                 // 计算顺序，-1为不参与计算
+        bool dirty = false;
+        QString error;
+    };
+
+    bool isCalculated(const VariableDefinition *var) const;
+    int nodeIndex(const QString &tagName) const { return m_index.value(tagName, -1); }
+    void ensureGraph();
+    void compileNode(int node);         // 公式变化时重新编译
+    void markDependents(int node);
+    void scheduleEvaluation();
+    bool evaluateNode(int node);        // 结果变化时返回true
+
+    QVector<Node> m_nodes;
+    QHash<QString, int> m_index;        // 标签名 -> 节点
+    QVector<int> m_orderedNodes;        // 按计算顺序的计算节点
+    QVector<int> m_dirtyOrders;         // 脏节点的计算顺序（小顶堆），按顺序弹出保证每个节点只算一次
+    bool m_graphDirty = false;
+    bool m_evaluationScheduled = false;
+
+    // 每个节点求值时复用
+    QVector<double> m_inputValues;
+    QVector<UaTimestamp> m_inputTimes;
+};
+
+} // namespace Industrial
+
+#endif // CALCULATIONENGINE_H
@@ -0,0 +1,568 @@
+// ConversionFunctions.cpp - 内置非线性转换函数（分段线性、多项式、开方、查表）
+#include "conversionfunctions.h"
+#include <QJsonArray>
+#include <QDebug>
+#include <QtNumeric>
+#include <algorithm>
+#include <cmath>
+
+namespace Industrial {
+
+static QJsonArray toJsonArray(const QVector<double> &values)
+{
+    QJsonArray array;
+    for (double v : values) {
+        array.append(v);
+    }
+    return array;
+}
+
+static QVector<double> fromJsonArray(const QJsonValue &value)
+{
+    QVector<double> result;
+    const QJsonArray array = value.toArray();
+    result.reserve(array.size());
+    for (const QJsonValue &v : array) {
+        result.append(v.toDouble());
+    }
+    return result;
+}
+
+// 严格单调：1递增，-1递减，0非单调
+static int monotonicDirection(const QVector<double> &values)
+{
+    if (values.size() < 2) {
+        return 0;
+    }
+    bool increasing = true;
+    bool decreasing = true;
+    for (int i = 1; i < values.size(); i++) {
+        if (!(values[i] > values[i - 1])) increasing = false;
+        if (!(values[i] < values[i - 1])) decreasing = false;
+    }
+    return increasing ? 1 : (decreasing ? -1 : 0);
+}
+
+// ==================== SegmentTable 实现 ====================
+bool SegmentTable::build(const QVector<double> &xs, const QVector<double> &ys)
+{
+    x.clear();
+    slope.clear();
+    intercept.clear();
+    if (xs.size() < 2 || xs.size() != ys.size()) {
+        return false;
+    }
+
+    int segments = xs.size() - 1;
+    x = xs;
+    slope.resize(segments);
+    intercept.resize(segments);
+    for (int i = 0; i < segments; i++) {
+        double dx = xs[i + 1] - xs[i];
+        slope[i] = (ys[i + 1] - ys[i]) / dx;
+        intercept[i] = ys[i] - slope[i] * xs[i];
+    }
+    return true;
+}
+
+int SegmentTable::segment(double v) const
+{
+    // 第一个大于v的断点之前的一段，两端夹到首末段
+    int i = static_cast<int>(std::upper_bound(x.constBegin(), x.constEnd(), v) - x.constBegin()) - 1;
+    return qBound(0, i, slope.size() - 1);
+}
+
+// ==================== PiecewiseLinearConversion 实现 ====================
+PiecewiseLinearConversion::PiecewiseLinearConversion(const QVector<double> &rawPoints,
+                                                     const QVector<double> &engPoints)
+    : m_invertible(false)
+{
+    int count = qMin(rawPoints.size(), engPoints.size());
+    QVector<QPair<double, double>> points;
+    points.reserve(count);
+    for (int i = 0; i < count; i++) {
+        points.append(qMakePair(rawPoints[i], engPoints[i]));
+    }
+    std::sort(points.begin(), points.end());
+
+    // 去掉重复的原始值
+    for (const auto &point : points) {
+        if (!m_rawPoints.isEmpty() && point.first == m_rawPoints.last()) {
+            continue;
+        }
+        m_rawPoints.append(point.first);
+        m_engPoints.append(point.second);
+    }
+
+    if (!m_forward.build(m_rawPoints, m_engPoints)) {
+        qWarning() << "PiecewiseLinearConversion: at least 2 distinct points required, got"
+                   << m_rawPoints.size();
+        return;
+    }
+
+    int direction = monotonicDirection(m_engPoints);
+    if (direction != 0) {
+        QVector<double> engs = m_engPoints;
+        QVector<double> raws = m_rawPoints;
+        if (direction < 0) {
+            std::reverse(engs.begin(), engs.end());
+            std::reverse(raws.begin(), raws.end());
+        }
+        m_invertible = m_inverse.build(engs, raws);
+    }
+}
+
+double PiecewiseLinearConversion::rawToEngineering(double rawValue) const
+{
+    return m_forward.isEmpty() ? rawValue : m_forward.evaluate(rawValue);
+}
+
+double PiecewiseLinearConversion::engineeringToRaw(double engValue) const
+{
+    if (m_forward.isEmpty()) {
+        return engValue;
+    }
+    return m_invertible ? m_inverse.evaluate(engValue) : qQNaN();
+}
+
+void PiecewiseLinearConversion::rawToEngineeringBatch(const double *raw, double *eng, int count) const
+{
+    if (m_forward.isEmpty()) {
+        std::copy(raw, raw + count, eng);
+        return;
+    }
+    const double *slope = m_forward.slope.constData();
+    const double *intercept = m_forward.intercept.constData();
+    for (int i = 0; i < count; i++) {
+        int s = m_forward.segment(raw[i]);
+        eng[i] = slope[s] * raw[i] + intercept[s];
+    }
+}
+
+ConversionFunction* PiecewiseLinearConversion::clone() const
+{
+    return new PiecewiseLinearConversion(m_rawPoints, m_engPoints);
+}
+
+QJsonObject PiecewiseLinearConversion::parameters() const
+{
+    QJsonObject params;
+    params["raw"] = toJsonArray(m_rawPoints);
+    params["eng"] = toJsonArray(m_engPoints);
+    return params;
+}
+
+// ==================== PolynomialConversion 实现 ====================
+PolynomialConversion::PolynomialConversion(const QVector<double> &coefficients, double rawMin, double rawMax)
+    : m_order(0)
+    , m_rawMin(qMin(rawMin, rawMax))
+    , m_rawMax(qMax(rawMin, rawMax))
+    , m_invertible(false)
+    , m_valid(true)
+{
+    // 去掉高次的零系数
+    int n = coefficients.size();
+    while (n > 1 && coefficients[n - 1] == 0.0) {
+        n--;
+    }
+
+    std::fill(m_coeff, m_coeff + MAX_ORDER + 1, 0.0);
+    std::fill(m_deriv, m_deriv + MAX_ORDER, 0.0);
+
+    // 截掉高次项会悄悄改变标定曲线，超阶的配置不接受，按原样输出
+    if (n > MAX_ORDER + 1) {
+        qWarning() << "PolynomialConversion: order" << (n - 1) << "exceeds" << MAX_ORDER << ", rejected";
+        m_valid = false;
+        m_order = 1;
+        m_coeff[0] = 1.0;
+        m_deriv[0] = 1.0;
+        return;
+    }
+    if (n == 0) {
+        return;     // y = 0
+    }
+
+    m_order = n - 1;
+    for (int i = 0; i <= m_order; i++) {
+        m_coeff[i] = coefficients[m_order - i];
+    }
+    for (int i = 0; i < m_order; i++) {
+        m_deriv[i] = m_coeff[i] * (m_order - i);
+    }
+
+    // 求解区间内导数不变号才可逆
+    if (m_order >= 1 && m_rawMax > m_rawMin) {
+        const int samples = 128;
+        int sign = 0;
+        m_invertible = true;
+        for (int i = 0; i <= samples; i++) {
+            double x = m_rawMin + (m_rawMax - m_rawMin) * i / samples;
+            double d = derivative(x);
+            int s = d > 0.0 ? 1 : (d < 0.0 ? -1 : 0);
+            if (s == 0 || (sign != 0 && s != sign)) {
+                m_invertible = false;
+                break;
+            }
+            sign = s;
+        }
+    }
+}
+
+double PolynomialConversion::engineeringToRaw(double engValue) const
+{
+    if (!m_valid) {
+        return engValue;
+    }
+    if (!m_invertible) {
+        return qQNaN();
+    }
+
+    double lo = m_rawMin;
+    double hi = m_rawMax;
+    double fLo = evaluate(lo) - engValue;
+    double fHi = evaluate(hi) - engValue;
+    if (fLo == 0.0) return lo;
+    if (fHi == 0.0) return hi;
+
+    double x = (std::fabs(fLo) < std::fabs(fHi)) ? lo : hi;
+    bool bracketed = (fLo < 0.0) != (fHi < 0.0);
+    const double tolerance = 1e-12 * qMax(1.0, m_rawMax - m_rawMin);
+
+    for (int iter = 0; iter < 60; iter++) {
+        double f = evaluate(x) - engValue;
+        double d = derivative(x);
+        double next = (d != 0.0) ? x - f / d : x;
+
+        if (bracketed) {
+            // 牛顿步出界时退回二分
+            if (!(next > lo && next < hi)) {
+                next = 0.5 * (lo + hi);
+            }
+            double fNext = evaluate(next) - engValue;
+            if ((fNext < 0.0) == (fLo < 0.0)) {
+                lo = next;
+                fLo = fNext;
+            } else {
+                hi = next;
+            }
+        }
+
+        if (std::fabs(next - x) <= tolerance) {
+            return next;
+        }
+        x = next;
+    }
+    return x;
+}
+
+void PolynomialConversion::rawToEngineeringBatch(const double *raw, double *eng, int count) const
+{
+    // 系数拷到局部，内层按元素展开便于向量化
+    double c[MAX_ORDER + 1];
+    std::copy(m_coeff, m_coeff + MAX_ORDER + 1, c);
+    const int order = m_order;
+    for (int i = 0; i < count; i++) {
+        double x = raw[i];
+        double y = c[0];
+        for (int k = 1; k <= order; k++) {
+            y = y * x + c[k];
+        }
+        eng[i] = y;
+    }
+}
+
+ConversionFunction* PolynomialConversion::clone() const
+{
+    return new PolynomialConversion(coefficients(), m_rawMin, m_rawMax);
+}
+
+QVector<double> PolynomialConversion::coefficients() const
+{
+    QVector<double> result(m_order + 1);
+    for (int i = 0; i <= m_order; i++) {
+        result[i] = m_coeff[m_order - i];
+    }
+    return result;
+}
+
+QJsonObject PolynomialConversion::parameters() const
+{
+    QJsonObject params;
+    params["coefficients"] = toJsonArray(coefficients());
+    params["rawMin"] = m_rawMin;
+    params["rawMax"] = m_rawMax;
+    return params;
+}
+
+// ==================== SquareRootConversion 实现 ====================
+SquareRootConversion::SquareRootConversion(double rawMin, double rawMax, double engMin, double engMax,
+                                           double lowFlowCutoff)
+    : m_rawMin(rawMin)
+    , m_rawMax(rawMax)
+    , m_engMin(engMin)
+    , m_engMax(engMax)
+    , m_cutoff(qBound(0.0, lowFlowCutoff, 1.0))
+    , m_invRawSpan(qFuzzyCompare(rawMax - rawMin, 0.0) ? 0.0 : 1.0 / (rawMax - rawMin))
+    , m_engSpan(engMax - engMin)
+{
+    if (m_invRawSpan == 0.0) {
+        qWarning() << "SquareRootConversion: raw range is empty";
+    }
+}
+
+double SquareRootConversion::rawToEngineering(double rawValue) const
+{
+    double ratio = (rawValue - m_rawMin) * m_invRawSpan;
+    if (ratio < m_cutoff || ratio <= 0.0) {
+        return m_engMin;
+    }
+    return m_engMin + m_engSpan * std::sqrt(ratio);
+}
+
+double SquareRootConversion::engineeringToRaw(double engValue) const
+{
+    if (m_engSpan == 0.0) {
+        return m_rawMin;
+    }
+    double ratio = (engValue - m_engMin) / m_engSpan;
+    if (ratio <= 0.0) {
+        return m_rawMin;
+    }
+    return m_rawMin + (m_rawMax - m_rawMin) * ratio * ratio;
+}
+
+void SquareRootConversion::rawToEngineeringBatch(const double *raw, double *eng, int count) const
+{
+    const double rawMin = m_rawMin;
+    const double invSpan = m_invRawSpan;
+    const double cutoff = m_cutoff;
+    const double engMin = m_engMin;
+    const double engSpan = m_engSpan;
+    for (int i = 0; i < count; i++) {
+        double ratio = (raw[i] - rawMin) * invSpan;
+        double root = std::sqrt(ratio > 0.0 ? ratio : 0.0);
+        eng[i] = (ratio < cutoff) ? engMin : engMin + engSpan * root;
+    }
+}
+
+ConversionFunction* SquareRootConversion::clone() const
+{
+    return new SquareRootConversion(m_rawMin, m_rawMax, m_engMin, m_engMax, m_cutoff);
+}
+
+QJsonObject SquareRootConversion::parameters() const
+{
+    QJsonObject params;
+    params["rawMin"] = m_rawMin;
+    params["rawMax"] = m_rawMax;
+    params["engMin"] = m_engMin;
+    params["engMax"] = m_engMax;
+    params["lowFlowCutoff"] = m_cutoff;
+    return params;
+}
+
+// ==================== LookupTableConversion 实现 ====================
+LookupTableConversion::LookupTableConversion(double rawStart, double rawStep, const QVector<double> &table)
+    : m_rawStart(rawStart)
+    , m_rawStep(rawStep)
+    , m_table(table)
+    , m_invStep(0.0)
+    , m_lastIndex(0)
+    , m_invertible(false)
+    , m_ascending(true)
+{
+    compile();
+}
+
+LookupTableConversion* LookupTableConversion::fromPoints(const QVector<double> &rawPoints,
+                                                         const QVector<double> &engPoints,
+                                                         int resolution)
+{
+    // 先按断点建分段线性，再在首末断点之间等间距采样
+    PiecewiseLinearConversion piecewise(rawPoints, engPoints);
+    if (!piecewise.isValid()) {
+        return new LookupTableConversion(0.0, 1.0, QVector<double>());
+    }
+
+    QVector<double> raws = piecewise.rawPoints();
+    int size = qMax(2, resolution);
+    double start = raws.first();
+    double step = (raws.last() - start) / (size - 1);
+
+    QVector<double> table(size);
+    for (int i = 0; i < size; i++) {
+        table[i] = piecewise.rawToEngineering(start + step * i);
+    }
+    return new LookupTableConversion(start, step, table);
+}
+
+void LookupTableConversion::compile()
+{
+    m_delta.clear();
+    if (m_table.size() < 2 || m_rawStep <= 0.0) {
+        qWarning() << "LookupTableConversion: need at least 2 entries and a positive step";
+        m_lastIndex = 0;
+        m_invertible = false;
+        return;
+    }
+
+    m_invStep = 1.0 / m_rawStep;
+    m_lastIndex = m_table.size() - 1;
+    m_delta.resize(m_lastIndex);
+    for (int i = 0; i < m_lastIndex; i++) {
+        m_delta[i] = m_table[i + 1] - m_table[i];
+    }
+
+    int direction = monotonicDirection(m_table);
+    m_invertible = direction != 0;
+    m_ascending = direction >= 0;
+}
+
+double LookupTableConversion::rawToEngineering(double rawValue) const
+{
+    if (m_delta.isEmpty()) {
+        return m_table.isEmpty() ? rawValue : m_table.first();
+    }
+    if (std::isnan(rawValue)) {
+        return rawValue;    // 不参与比较，下标转换对NaN未定义
+    }
+    double pos = (rawValue - m_rawStart) * m_invStep;
+    if (pos <= 0.0) {
+        return m_table.first();
+    }
+    if (pos >= m_lastIndex) {
+        return m_table.last();
+    }
+    int i = static_cast<int>(pos);
+    return m_table[i] + m_delta[i] * (pos - i);
+}
+
+double LookupTableConversion::engineeringToRaw(double engValue) const
+{
+    if (m_delta.isEmpty()) {
+        return engValue;
+    }
+    if (!m_invertible) {
+        return qQNaN();
+    }
+
+    // 表单调，二分找到所在区间后反插值；超出表范围取端点
+    int lo = 0;
+    int hi = m_lastIndex;
+    bool beforeFirst = m_ascending ? engValue <= m_table.first() : engValue >= m_table.first();
+    bool afterLast = m_ascending ? engValue >= m_table.last() : engValue <= m_table.last();
+    if (beforeFirst) {
+        return m_rawStart;
+    }
+    if (afterLast) {
+        return m_rawStart + m_rawStep * m_lastIndex;
+    }
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        bool below = m_ascending ? m_table[mid] <= engValue : m_table[mid] >= engValue;
+        if (below) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    double frac = (engValue - m_table[lo]) / m_delta[lo];
+    return m_rawStart + m_rawStep * (lo + frac);
+}
+
+void LookupTableConversion::rawToEngineeringBatch(const double *raw, double *eng, int count) const
+{
+    if (m_delta.isEmpty()) {
+        for (int i = 0; i < count; i++) {
+            eng[i] = rawToEngineering(raw[i]);
+        }
+        return;
+    }
+
+    const double *table = m_table.constData();
+    const double *delta = m_delta.constData();
+    const double start = m_rawStart;
+    const double invStep = m_invStep;
+    const double maxPos = static_cast<double>(m_lastIndex);
+    const int lastSegment = m_lastIndex - 1;
+    for (int i = 0; i < count; i++) {
+        // NaN经qBound得到0，下标有效；结果再按输入改回NaN，与单值版本一致
+        double pos = qBound(0.0, (raw[i] - start) * invStep, maxPos);
+        int index = qMin(static_cast<int>(pos), lastSegment);
+        double value = table[index] + delta[index] * (pos - index);
+        eng[i] = std::isnan(raw[i]) ? raw[i] : value;
+    }
+}
+
+ConversionFunction* LookupTableConversion::clone() const
+{
+    return new LookupTableConversion(m_rawStart, m_rawStep, m_table);
+}
+
+QJsonObject LookupTableConversion::parameters() const
+{
+    QJsonObject params;
+    params["rawStart"] = m_rawStart;
+    params["rawStep"] = m_rawStep;
+    params["table"] = toJsonArray(m_table);
+    return params;
+}
+
+// ==================== 序列化 ====================
+QJsonObject conversionToJson(const ConversionFunction *func)
+{
+    QJsonObject json;
+    if (!func || func->typeName().isEmpty()) {
+        return json;
+    }
+    json["type"] = func->typeName();
+    json["parameters"] = func->parameters();
+    return json;
+}
+
+ConversionFunction* conversionFromJson(const QJsonObject &json)
+{
+    if (!json.contains("type")) {
+        return nullptr;
+    }
+    return createConversionFunction(json["type"].toString(), json["parameters"].toObject());
+}
+
+ConversionFunction* createConversionFunction(const QString &typeName, const QJsonObject &parameters)
+{
+    if (typeName == "linear") {
+        return new LinearConversion(parameters["scaleFactor"].toDouble(1.0),
+                                    parameters["offset"].toDouble(0.0));
+    }
+    if (typeName == "piecewise") {
+        return new PiecewiseLinearConversion(fromJsonArray(parameters["raw"]),
+                                             fromJsonArray(parameters["eng"]));
+    }
+    if (typeName == "polynomial") {
+        PolynomialConversion *polynomial = new PolynomialConversion(fromJsonArray(parameters["coefficients"]),
+                                                                    parameters["rawMin"].toDouble(),
+                                                                    parameters["rawMax"].toDouble());
+        if (!polynomial->isValid()) {
+            delete polynomial;
+            return nullptr;
+        }
+        return polynomial;
+    }
+    if (typeName == "sqrt") {
+        return new SquareRootConversion(parameters["rawMin"].toDouble(),
+                                        parameters["rawMax"].toDouble(),
+                                        parameters["engMin"].toDouble(),
+                                        parameters["engMax"].toDouble(),
+                                        parameters["lowFlowCutoff"].toDouble(0.01));
+    }
+    if (typeName == "lookup") {
+        return new LookupTableConversion(parameters["rawStart"].toDouble(),
+                                         parameters["rawStep"].toDouble(1.0),
+                                         fromJsonArray(parameters["table"]));
+    }
+
+    qWarning() << "Unknown conversion function type:" << typeName;
+    return nullptr;
+}
+
+} // namespace Industrial
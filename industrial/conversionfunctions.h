@@ -0,0 +1,176 @@
+// ConversionFunctions.h - 内置非线性转换函数（分段线性、多项式、开方、查表）
+#ifndef CONVERSIONFUNCTIONS_H
+#define CONVERSIONFUNCTIONS_H
+
+#include <QVector>
+#include <QString>
+#include <QJsonObject>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 分段线性表 ====================
+// 断点按x升序，预先算好每段的斜率和截距，求值时二分查段后一次乘加；两端按首末段外推
+struct SegmentTable {
+    QVector<double> x;          // 断点
+    QVector<double> slope;      // 第i段 y = slope[i] * v + intercept[i]
+    QVector<double> intercept;
+
+    bool build(const QVector<double> &xs, const QVector<double> &ys);//xs需严格升序
+    int segment(double v) const;
+    double evaluate(double v) const {
+        int i = segment(v);
+        return slope[i] * v + intercept[i];
+    }
+    bool isEmpty() const { return slope.isEmpty(); }
+};
+
+// ==================== 分段线性转换 ====================
+// 热电偶分度表、非线性传感器标定等：给定若干(原始值, 工程值)断点，断点间线性插值
+class PiecewiseLinearConversion : public ConversionFunction {
+public:
+    PiecewiseLinearConversion(const QVector<double> &rawPoints, const QVector<double> &engPoints);
+
+    double rawToEngineering(double rawValue) const override;
+    double engineeringToRaw(double engValue) const override;
+    void rawToEngineeringBatch(const double *raw, double *eng, int count) const override;
+    ConversionFunction* clone() const override;
+
+    bool isInvertible() const override { return m_invertible; }//工程值严格单调时可反算
+    QString typeName() const override { return "piecewise"; }
+    QJsonObject parameters() const override;
+
+    bool isValid() const { return !m_forward.isEmpty(); }
+    QVector<double> rawPoints() const { return m_rawPoints; }
+    QVector<double> engPoints() const { return m_engPoints; }
+
+private:
+    QVector<double> m_rawPoints;    // 按原始值排序后的断点
+    QVector<double> m_engPoints;
+    SegmentTable m_forward;
+    SegmentTable m_inverse;
+    bool m_invertible;
+};
+
+// ==================== 多项式转换 ====================
+// y = c0 + c1*x + ... + cn*x^n（n <= 9，超阶的系数不接受，isValid()为false），Horner求值。
+// 反算在[rawMin, rawMax]区间内用带二分保护的牛顿法，区间内单调时才可逆
+class PolynomialConversion : public ConversionFunction {
+public:
+    static const int MAX_ORDER = 9;
+
+    // coefficients[i]为x^i的系数
+    PolynomialConversion(const QVector<double> &coefficients, double rawMin = 0.0, double rawMax = 0.0);
+
+    double rawToEngineering(double rawValue) const override { return evaluate(rawValue); }
+    double engineeringToRaw(double engValue) const override;
+    void rawToEngineeringBatch(const double *raw, double *eng, int count) const override;
+    ConversionFunction* clone() const override;
+
+    bool isInvertible() const override { return m_invertible; }
+    QString typeName() const override { return "polynomial"; }
+    QJsonObject parameters() const override;
+
+    bool isValid() const { return m_valid; }
+    int order() const { return m_order; }
+    QVector<double> coefficients() const;
+
+private:
+    double evaluate(double x) const {
+        double y = m_coeff[0];
+        for (int i = 1; i <= m_order; i++) {
+            y = y * x + m_coeff[i];
+        }
+        return y;
+    }
+    double derivative(double x) const {
+        double y = m_deriv[0];
+        for (int i = 1; i < m_order; i++) {
+            y = y * x + m_deriv[i];
+        }
+        return m_order > 0 ? y : 0.0;
+    }
+
+    double m_coeff[MAX_ORDER + 1];  // 高次在前，Horner顺序读取
+    double m_deriv[MAX_ORDER];      // 导数系数，高次在前
+    int m_order;
+    double m_rawMin;
+    double m_rawMax;
+    bool m_invertible;
+    bool m_valid;
+};
+
+// ==================== 开方转换 ====================
+// 差压流量计：flow = engMin + (engMax - engMin) * sqrt((raw - rawMin) / (rawMax - rawMin))。
+// 相对输入低于lowFlowCutoff时输出engMin（小信号切除），反算对切除点以上的工程值成立
+class SquareRootConversion : public ConversionFunction {
+public:
+    SquareRootConversion(double rawMin, double rawMax, double engMin, double engMax,
+                         double lowFlowCutoff = 0.01);
+
+    double rawToEngineering(double rawValue) const override;
+    double engineeringToRaw(double engValue) const override;
+    void rawToEngineeringBatch(const double *raw, double *eng, int count) const override;
+    ConversionFunction* clone() const override;
+
+    QString typeName() const override { return "sqrt"; }
+    QJsonObject parameters() const override;
+
+private:
+    double m_rawMin;
+    double m_rawMax;
+    double m_engMin;
+    double m_engMax;
+    double m_cutoff;
+    // 预计算
+    double m_invRawSpan;
+    double m_engSpan;
+};
+
+// ==================== 查表转换 ====================
+// 等间距表：table[i]对应原始值 rawStart + i * rawStep，求值直接定位下标后线性插值，不查找。
+// 储罐容积表等不等间距数据用fromPoints()重采样
+class LookupTableConversion : public ConversionFunction {
+public:
+    LookupTableConversion(double rawStart, double rawStep, const QVector<double> &table);
+
+    static LookupTableConversion* fromPoints(const QVector<double> &rawPoints,
+                                             const QVector<double> &engPoints,
+                                             int resolution = 1024);
+
+    double rawToEngineering(double rawValue) const override;
+    double engineeringToRaw(double engValue) const override;
+    void rawToEngineeringBatch(const double *raw, double *eng, int count) const override;
+    ConversionFunction* clone() const override;
+
+    bool isInvertible() const override { return m_invertible; }//表严格单调时可反算
+    QString typeName() const override { return "lookup"; }
+    QJsonObject parameters() const override;
+
+    double rawStart() const { return m_rawStart; }
+    double rawStep() const { return m_rawStep; }
+    QVector<double> table() const { return m_table; }
+
+private:
+    void compile();
+
+    double m_rawStart;
+    double m_rawStep;
+    QVector<double> m_table;
+    // 预计算：相邻差值和步长倒数，超出表范围时取端点值
+    QVector<double> m_delta;
+    double m_invStep;
+    int m_lastIndex;
+    bool m_invertible;
+    bool m_ascending;
+};
+
+// ==================== 序列化 ====================
+// {"type": typeName(), "parameters": parameters()}；自定义转换（类型名为空）返回空对象
+QJsonObject conversionToJson(const ConversionFunction *func);
+ConversionFunction* conversionFromJson(const QJsonObject &json);
+ConversionFunction* createConversionFunction(const QString &typeName, const QJsonObject &parameters);
+
+} // namespace Industrial
+
+#endif // CONVERSIONFUNCTIONS_H
@@ -0,0 +1,229 @@
+// DataBlock.h - PLC数据块的编译期描述
+#ifndef DATABLOCK_H
+#define DATABLOCK_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QList>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <cmath>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 字段类型 ====================
+// C++类型对应的缺省变量类型和OPC UA数据类型名
+template <typename T> struct PlcFieldTraits;
+template <> struct PlcFieldTraits<double>  { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "Double"; } };
+template <> struct PlcFieldTraits<float>   { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "Float"; } };
+template <> struct PlcFieldTraits<bool>    { static constexpr VariableType TYPE = TYPE_DI; static const char* dataType() { return "Boolean"; } };
+template <> struct PlcFieldTraits<qint16>  { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "Int16"; } };
+template <> struct PlcFieldTraits<quint16> { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "UInt16"; } };
+template <> struct PlcFieldTraits<qint32>  { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "Int32"; } };
+template <> struct PlcFieldTraits<quint32> { static constexpr VariableType TYPE = TYPE_AI; static const char* dataType() { return "UInt32"; } };
+
+template <typename T>
+inline T plcValueFromSample(const ValueSample &sample)
+{
+    double value = VariableDefinition::sampleToDouble(sample);
+    if constexpr (std::is_same<T, bool>::value) {
+        return value != 0.0;
+    } else if constexpr (std::is_integral<T>::value) {
+        return std::isfinite(value) ? static_cast<T>(std::llround(value)) : T();
+    } else {
+        return static_cast<T>(value);
+    }
+}
+
+// ==================== 字段描述 ====================
+// 单个成员：变量名即字段名
+template <typename Block, typename T>
+struct PlcScalarField {
+    typedef T ValueType;
+    static constexpr int COUNT = 1;
+
+    T Block::*member;
+    const char *name;
+    VariableType type;
+
+    T& element(Block &block, int) const { return block.*member; }
+    QString elementName(int) const { return QString::fromLatin1(name); }
+};
+
+// 数组成员：变量名为字段名加序号，序号从firstIndex开始（PLC中常见的Temp1..Temp100）
+template <typename Block, typename T, std::size_t N>
+struct PlcArrayField {
+    typedef T ValueType;
+    static constexpr int COUNT = static_cast<int>(N);
+
+    T (Block::*member)[N];
+    const char *name;
+    int firstIndex;
+    VariableType type;
+
+    T& element(Block &block, int index) const { return (block.*member)[index]; }
+    QString elementName(int index) const { return QString::fromLatin1(name) + QString::number(firstIndex + index); }
+};
+
+template <typename Block, typename T, typename = typename std::enable_if<!std::is_array<T>::value>::type>
+constexpr PlcScalarField<Block, T> plcField(T Block::*member, const char *name,
+                                            VariableType type = PlcFieldTraits<T>::TYPE)
+{
+    return PlcScalarField<Block, T>{ member, name, type };
+}
+
+template <typename Block, typename T, std::size_t N>
+constexpr PlcArrayField<Block, T, N> plcField(T (Block::*member)[N], const char *name, int firstIndex = 1,
+                                              VariableType type = PlcFieldTraits<T>::TYPE)
+{
+    return PlcArrayField<Block, T, N>{ member, name, firstIndex, type };
+}
+
+namespace PlcBlockDetail {
+
+template <typename Tuple> struct FieldCount;
+template <typename... Fields>
+struct FieldCount<std::tuple<Fields...>> {
+    static constexpr int value = (0 + ... + Fields::COUNT);
+};
+
+template <typename Field, typename Member>
+constexpr bool sameMember(const Field &field, Member member)
+{
+    if constexpr (std::is_same<decltype(field.member), Member>::value) {
+        return field.member == member;
+    } else {
+        return false;
+    }
+}
+
+// 成员在变量数组中的起始下标，找不到时为-1
+template <typename Tuple, typename Member, std::size_t... I>
+constexpr int fieldOffset(const Tuple &fields, Member member, std::index_sequence<I...>)
+{
+    int offset = 0;
+    int result = -1;
+    ((result < 0 && sameMember(std::get<I>(fields), member) ? (void)(result = offset) : (void)0,
+      offset += std::tuple_element<I, Tuple>::type::COUNT), ...);
+    return result;
+}
+
+} // namespace PlcBlockDetail
+
+// ==================== 数据块 ====================
+// 数据块声明为普通结构体，成员即PLC中的字段，再由静态constexpr函数fields()列出各字段的名称和类型：
+//   struct TestDB {
+//       double temp[100];
+//       bool running;
+//       static constexpr auto fields() {
+//           return std::make_tuple(plcField(&TestDB::temp, "Temp"), plcField(&TestDB::running, "Running"));
+//       }
+//   };
+// DataBlock<TestDB>按声明顺序为每个元素生成一个VariableDefinition（地址为节点前缀加变量名），
+// 变量数、各字段的起始下标都在编译期确定。refresh()把各变量的当前值按字段类型读入values()，
+// 应用程序直接读成员（values().temp[3]），不再按标签名逐个查找。变量属于数据块，析构时删除
+template <typename Block>
+class DataBlock {
+public:
+    typedef decltype(Block::fields()) Fields;
+    static constexpr int VARIABLE_COUNT = PlcBlockDetail::FieldCount<Fields>::value;
+
+    explicit DataBlock(const QString &nodePrefix, const QString &tagPrefix = QString())
+        : m_values()
+    {
+        m_qualities.fill(static_cast<quint8>(QUALITY_BAD));
+        int next = 0;
+        std::apply([&](const auto&... field) {
+            (createVariables(field, nodePrefix, tagPrefix, next), ...);
+        }, Block::fields());
+    }
+
+    ~DataBlock()
+    {
+        for (VariableDefinition *var : m_variables) {
+            delete var;
+        }
+    }
+
+    const Block& values() const { return m_values; }
+
+    // 从值单元读入全部字段，返回值或质量变化的元素数
+    int refresh()
+    {
+        int next = 0;
+        int changed = 0;
+        std::apply([&](const auto&... field) {
+            (refreshField(field, next, changed), ...);
+        }, Block::fields());
+        return changed;
+    }
+
+    // ==================== 按成员访问变量 ====================
+    // 下标在编译期算出：variable<&TestDB::temp>(3)
+    template <auto Member>
+    static constexpr int offsetOf()
+    {
+        constexpr int offset = PlcBlockDetail::fieldOffset(Block::fields(), Member,
+                                                           std::make_index_sequence<std::tuple_size<Fields>::value>());
+        static_assert(offset >= 0, "Member is not listed in Block::fields()");
+        return offset;
+    }
+
+    template <auto Member>
+    VariableDefinition* variable(int index = 0) const { return m_variables[offsetOf<Member>() + index]; }
+
+    template <auto Member>
+    DataQuality quality(int index = 0) const { return static_cast<DataQuality>(m_qualities[offsetOf<Member>() + index]); }
+
+    QList<VariableDefinition*> variables() const
+    {
+        QList<VariableDefinition*> result;
+        result.reserve(VARIABLE_COUNT);
+        for (VariableDefinition *var : m_variables) {
+            result.append(var);
+        }
+        return result;
+    }
+
+private:
+    Q_DISABLE_COPY(DataBlock)
+
+    template <typename Field>
+    void createVariables(const Field &field, const QString &nodePrefix, const QString &tagPrefix, int &next)
+    {
+        for (int i = 0; i < Field::COUNT; i++) {
+            const QString name = field.elementName(i);
+            VariableDefinition *var = new VariableDefinition(tagPrefix + name, field.type);
+            var->setAddress(nodePrefix + name);
+            var->setDataType(PlcFieldTraits<typename Field::ValueType>::dataType());
+            m_variables[next++] = var;
+        }
+    }
+
+    template <typename Field>
+    void refreshField(const Field &field, int &next, int &changed)
+    {
+        typedef typename Field::ValueType T;
+        for (int i = 0; i < Field::COUNT; i++, next++) {
+            const ValueSample sample = m_variables[next]->sample();
+            const T value = plcValueFromSample<T>(sample);
+            T &slot = field.element(m_values, i);
+            if (!(slot == value) || m_qualities[next] != sample.quality) {
+                slot = value;
+                m_qualities[next] = sample.quality;
+                changed++;
+            }
+        }
+    }
+
+    Block m_values;                                             // 按字段类型连续存放
+    std::array<VariableDefinition*, VARIABLE_COUNT> m_variables;
+    std::array<quint8, VARIABLE_COUNT> m_qualities;             // DataQuality
+};
+
+} // namespace Industrial
+
+#endif // DATABLOCK_H
@@ -5,17 +5,45 @@ QMAKE_CFLAGS += -std=c99
 LIBS += -lpthread libwsock32 libws2_32
 
 HEADERS += \
+    $$PWD/accesscontrol.h \
+    $$PWD/alarmevaluator.h \
+    $$PWD/batchconverter.h \
+    $$PWD/calculationengine.h \
+    $$PWD/conversionfunctions.h \
+    $$PWD/datablock.h \
     $$PWD/opcuaclientmanager.h \
+    $$PWD/opcuasecuritybenchmark.h \
     $$PWD/open62541.h \
     $$PWD/realtimevariablemanager.h \
+    $$PWD/stalenessmonitor.h \
+    $$PWD/statisticsengine.h \
+    $$PWD/stringpool.h \
+    $$PWD/tagindex.h \
+    $$PWD/uatime.h \
+    $$PWD/valuecellstore.h \
+    $$PWD/valuepathbenchmark.h \
+    $$PWD/variablearena.h \
     $$PWD/variableconfigtool.h \
     $$PWD/variabledatabase.h \
     $$PWD/variablesystem.h
 
 SOURCES += \
+    $$PWD/accesscontrol.cpp \
+    $$PWD/alarmevaluator.cpp \
+    $$PWD/batchconverter.cpp \
+    $$PWD/calculationengine.cpp \
+    $$PWD/conversionfunctions.cpp \
     $$PWD/opcuaclientmanager.cpp \
+    $$PWD/opcuasecuritybenchmark.cpp \
     $$PWD/open62541.c \
     $$PWD/realtimevariablemanager.cpp \
+    $$PWD/stalenessmonitor.cpp \
+    $$PWD/statisticsengine.cpp \
+    $$PWD/stringpool.cpp \
+    $$PWD/tagindex.cpp \
+    $$PWD/valuecellstore.cpp \
+    $$PWD/valuepathbenchmark.cpp \
+    $$PWD/variablearena.cpp \
     $$PWD/variableconfigtool.cpp \
     $$PWD/variabledatabase.cpp \
     $$PWD/variablesystem.cpp
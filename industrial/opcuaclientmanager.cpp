@@ -4,6 +4,7 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QMetaMethod>
 #include <QMutexLocker>
 #include <QReadLocker>
 #include <QWriteLocker>
@@ -14,6 +15,10 @@
 #include <QMutex>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSysInfo>
 
 /* ------------------------------------open62541的回调机制-----------------------------------------
 您的 Qt 程序                          open62541 库                          OPC UA 服务器
@@ -60,6 +65,9 @@ OPC UA 服务器 → OPCUAVariableManager → VariableDefinition → 客户端
 // ==================== 辅助函数 ====================
 namespace Industrial {
 
+static_assert(UaTime::UNIX_EPOCH == UA_DATETIME_UNIX_EPOCH &&
+              UaTime::TICKS_PER_SEC == UA_DATETIME_SEC,
+              "UaTimestamp must stay binary compatible with UA_DateTime");
 
 // QString 到 UA_String
 static UA_String qStringToUAString(const QString &qStr) {
@@ -73,6 +81,22 @@ static UA_String qStringToUAString(const QString &qStr) {
     return uaStr;
 }
 
+// 解析节点地址，与parseNodeId相同但不输出调试信息，可在工作线程中调用（批量注册时并行解析）
+static bool parseNodeAddress(const QString &address, UA_NodeId &nodeId) {
+    UA_NodeId_init(&nodeId);
+    if (address.isEmpty()) {
+        return false;
+    }
+
+    // 只有字符串标识符时按namespace 2处理
+    const bool qualified = address.contains("ns=") || address.contains("i=") ||
+                           address.contains("s=") || address.contains("g=");
+    UA_String uaAddress = qStringToUAString(qualified ? address : QString("ns=2;s=%1").arg(address));
+    UA_StatusCode status = UA_NodeId_parse(&nodeId, uaAddress);
+    UA_String_clear(&uaAddress);
+    return status == UA_STATUSCODE_GOOD && !UA_NodeId_isNull(&nodeId);
+}
+
 // 生成随机客户端句柄
 static UA_UInt32 generateClientHandle() {
     static std::random_device rd;
@@ -442,6 +466,160 @@ UA_Variant publicQVariantToUAVariant(const QVariant &qtVariant,
 } // namespace Industrial
 
 
+// ==================== ConnectionTuning 实现 ====================
+namespace Industrial {
+
+ConnectionTuning ConnectionTuning::sizedFor(int tagCount) const//按变量数量计算传输配置
+{
+    ConnectionTuning tuned = *this;
+    if (!autoSize || tagCount <= 0) {
+        return tuned;
+    }
+
+    // 整批读取或一次发布全部变量时的响应大小，留一倍余量给状态码、时间戳和诊断信息
+    const quint64 perTag = static_cast<quint64>(qMax(16, bytesPerTag));
+    const quint64 payload = static_cast<quint64>(tagCount) * perTag * 2 + 64 * 1024;
+
+    // 分块大小：小批量保持默认，大批量加大单块，减少分块数量和每块的安全头开销
+    UA_UInt32 buffer = 65536;
+    if (payload > 16ULL * 1024 * 1024) {
+        buffer = 1024 * 1024;
+    } else if (payload > 1024 * 1024) {
+        buffer = 256 * 1024;
+    }
+    tuned.sendBufferSize = qMax(tuned.sendBufferSize, buffer);
+    tuned.recvBufferSize = qMax(tuned.recvBufferSize, buffer);
+
+    // 消息大小向上取整到2的幂，上限1GB；0（不限制）保持不变
+    if (tuned.maxMessageSize != 0) {
+        quint64 message = 1024 * 1024;
+        while (message < payload && message < (1ULL << 30)) {
+            message <<= 1;
+        }
+        tuned.maxMessageSize = qMax(tuned.maxMessageSize, static_cast<UA_UInt32>(message));
+    }
+
+    // 分块数要能装下最大消息
+    if (tuned.maxChunkCount != 0 && tuned.maxMessageSize != 0) {
+        const UA_UInt32 bufferSize = qMin(tuned.sendBufferSize, tuned.recvBufferSize);
+        const UA_UInt32 chunks = tuned.maxMessageSize / bufferSize + 1;
+        tuned.maxChunkCount = qMax(tuned.maxChunkCount, chunks);
+    }
+
+    // 一个发布响应能带上全部变量的变化，避免被拆成多个发布周期
+    if (tuned.maxNotificationsPerPublish != 0) {
+        tuned.maxNotificationsPerPublish = qMax(tuned.maxNotificationsPerPublish,
+                                                static_cast<UA_UInt32>(tagCount));
+    }
+
+    return tuned;
+}
+
+bool ConnectionTuning::coveredBy(const ConnectionTuning &negotiated) const//判断协商过的配置是否够用
+{
+    // 0表示不限制：协商值不限制时总够用，本配置要求不限制时只有协商值也不限制才够用
+    auto fits = [](UA_UInt32 wanted, UA_UInt32 limit) {
+        return limit == 0 || (wanted != 0 && wanted <= limit);
+    };
+    return sendBufferSize <= negotiated.sendBufferSize &&
+           recvBufferSize <= negotiated.recvBufferSize &&
+           fits(maxMessageSize, negotiated.maxMessageSize) &&
+           fits(maxChunkCount, negotiated.maxChunkCount);
+}
+
+} // namespace Industrial
+
+
+// ==================== ReconnectLimiter 实现 ====================
+namespace Industrial {
+
+ReconnectLimiter* ReconnectLimiter::instance()
+{
+    static ReconnectLimiter limiter;  // 进程内唯一，线程安全初始化
+    return &limiter;
+}
+
+void ReconnectLimiter::setMaxConcurrent(int count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxConcurrent = qMax(1, count);
+}
+
+int ReconnectLimiter::maxConcurrent() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxConcurrent;
+}
+
+void ReconnectLimiter::setMinInterval(int intervalMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_minInterval = qMax(0, intervalMs);
+}
+
+int ReconnectLimiter::minInterval() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_minInterval;
+}
+
+bool ReconnectLimiter::tryAcquire(int &retryAfterMs)//获取重连许可
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // 同时重连数已满
+    if (m_active >= m_maxConcurrent) {
+        retryAfterMs = qMax(m_minInterval, 500);
+        return false;
+    }
+
+    // 距离上一次重连开始太近
+    qint64 elapsed = now - m_lastStartTime;
+    if (elapsed < m_minInterval) {
+        retryAfterMs = static_cast<int>(m_minInterval - elapsed);
+        return false;
+    }
+
+    m_active++;
+    m_lastStartTime = now;
+    retryAfterMs = 0;
+    return true;
+}
+
+void ReconnectLimiter::release(bool success)//释放许可并记录结果
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_active > 0) {
+        m_active--;
+    }
+
+    // 成功时减半而不是清零，一个连接恢复不代表网关已完全恢复
+    if (success) {
+        m_sharedFailures /= 2;
+    } else if (m_sharedFailures < 16) {
+        m_sharedFailures++;
+    }
+}
+
+int ReconnectLimiter::sharedBackoff() const//共享退避附加延迟
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_sharedFailures == 0) {
+        return 0;
+    }
+    return qMin(30000, 100 << qMin(m_sharedFailures, 8));
+}
+
+int ReconnectLimiter::activeCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_active;
+}
+
+} // namespace Industrial
+
+
 // ==================== OPCUAConnectionManager 完整实现 ====================
 namespace Industrial {
 
@@ -606,16 +784,86 @@ void OPCUAConnectionManager::setReconnectPolicy(const ReconnectPolicy &policy)//
     logConnectionAttempt("Set the ReconnectPolicy");//连接日志
 }
 
+void OPCUAConnectionManager::setSecurityConfig(const SecurityConfig &config)//设定安全策略，下一次连接时生效
+{
+    QMutexLocker locker(&m_mutex);
+    m_security = config;
+    m_securityDirty = true;
+    logConnectionAttempt(QString("Set the SecurityConfig: %1 mode %2")
+                             .arg(securityPolicyUri(config.policy)).arg(config.mode));
+}
+
+SecurityConfig OPCUAConnectionManager::securityConfig() const//返回安全策略
+{
+    QMutexLocker locker(&m_mutex);
+    return m_security;
+}
+
+void OPCUAConnectionManager::setConnectionTuning(const ConnectionTuning &tuning)//设定传输配置，下一次建立安全通道时生效
+{
+    QMutexLocker locker(&m_mutex);
+    m_tuning = tuning;
+    logConnectionAttempt(QString("Set the ConnectionTuning: buffer %1/%2 message %3 chunks %4 auto %5")
+                             .arg(tuning.sendBufferSize).arg(tuning.recvBufferSize)
+                             .arg(tuning.maxMessageSize).arg(tuning.maxChunkCount)
+                             .arg(tuning.autoSize));
+}
+
+ConnectionTuning OPCUAConnectionManager::connectionTuning() const//返回传输配置
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tuning;
+}
+
+ConnectionTuning OPCUAConnectionManager::effectiveConnectionTuning() const//返回按变量数量计算后的实际传输配置
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tuning.sizedFor(m_expectedTagCount.load());
+}
+
+ConnectionTuning OPCUAConnectionManager::appliedConnectionTuning() const//返回当前安全通道使用的传输配置
+{
+    QMutexLocker locker(&m_appliedTuningMutex);
+    return m_appliedTuning;
+}
+
+bool OPCUAConnectionManager::connectionTuningOutdated() const//当前通道的缓冲区是否已小于变量数量需要的大小
+{
+    if (m_state.load() != STATE_CONNECTED) {
+        return false;  // 下一次连接时按当前数量计算
+    }
+    QMutexLocker locker(&m_mutex);
+    const ConnectionTuning wanted = m_tuning.sizedFor(m_expectedTagCount.load());
+    QMutexLocker appliedLocker(&m_appliedTuningMutex);
+    return !wanted.coveredBy(m_appliedTuning);
+}
+
+QString OPCUAConnectionManager::securityPolicyUri(SecurityPolicyType policy)//安全策略URI
+{
+    switch (policy) {
+    case SECURITY_POLICY_BASIC256SHA256:
+        return "http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256";
+    case SECURITY_POLICY_AES128_SHA256_RSAOAEP:
+        return "http://opcfoundation.org/UA/SecurityPolicy#Aes128_Sha256_RsaOaep";
+    case SECURITY_POLICY_NONE:
+    default:
+        return "http://opcfoundation.org/UA/SecurityPolicy#None";
+    }
+}
+
 SessionStatistics OPCUAConnectionManager::statistics() const//获得统计信息
 {
     QMutexLocker locker(&m_mutex);
-    return m_stats;
+    SessionStatistics stats = m_stats;
+    stats.keepalivesInferred = m_keepalivesInferred.load();
+    return stats;
 }
 
 void OPCUAConnectionManager::resetStatistics()//重置连接统计信息
 {
     QMutexLocker locker(&m_mutex);
     m_stats = SessionStatistics();
+    m_keepalivesInferred.store(0);
     logConnectionAttempt("reset the ReconnectPolicy");//连接日志
 }
 
@@ -679,18 +927,54 @@ QString OPCUAConnectionManager::connectionStateName() const//将输出状态转
 
 void OPCUAConnectionManager::onKeepaliveTimer()// onKeepaliveTimer 使用读锁
 {
+    if (m_state.load() != STATE_CONNECTED) {//当检测到状态不是链接状态时，心跳退出，保证不会影响迟滞链接
+        return;
+    }
+
+    // 订阅通知即心跳：静默时间未超过阈值且客户端没有报告订阅超时，不发显式读取，也不取锁
+    bool inactive = m_subscriptionInactive.exchange(false);
+    qint64 silence = QDateTime::currentMSecsSinceEpoch() - m_lastActivityTime.load(std::memory_order_relaxed);
+    if (!inactive && silence < keepaliveSilenceThreshold()) {
+        m_keepalivesInferred.fetch_add(1, std::memory_order_relaxed);
+        emit keepaliveReceived();//连接好着
+        return;
+    }
+
     QReadLocker locker(&m_rwLock);  // 读锁，多个读可以并发
 
-    if (m_state.load() != STATE_CONNECTED) {//当检测到状态不是链接状态时，心跳退出，保证不会影响迟滞链接
+    if (m_state.load() != STATE_CONNECTED) {
         return;
     }
     //isKeepaliveExpired()以前调用检查心跳是否超时，但是起始就是按超时时间链接发送心跳，无意义，故取消
     sendKeepalive();  // sendKeepalive 内部使用写锁
 }
 
+int OPCUAConnectionManager::keepaliveSilenceThreshold() const//需要显式心跳读取的静默时间
+{
+    if (m_policy.keepaliveSilenceThreshold > 0) {
+        return m_policy.keepaliveSilenceThreshold;
+    }
+
+    // 有订阅时服务器在保活周期内至少发送一次发布响应，超过保活周期加一个心跳间隔仍无通知再显式读取
+    int window = m_subscriptionKeepaliveWindow.load();
+    if (window > 0) {
+        return window + m_policy.keepaliveInterval;
+    }
+    return m_policy.keepaliveInterval;
+}
+
 void OPCUAConnectionManager::onReconnectTimer()//从新连接
 {
-    reconnect();//重新连接
+    // 全局限流：其他连接正在重连时稍后再试（不计入重试次数）
+    int retryAfter = 0;
+    if (!ReconnectLimiter::instance()->tryAcquire(retryAfter)) {
+        int jitter = QRandomGenerator::global()->bounded(retryAfter / 2 + 1);
+        m_reconnectTimer->start(retryAfter + jitter);
+        return;
+    }
+
+    bool success = reconnect();//重新连接
+    ReconnectLimiter::instance()->release(success);
 }
 
 bool OPCUAConnectionManager::sendKeepalive()//心跳发送
@@ -711,6 +995,7 @@ bool OPCUAConnectionManager::sendKeepalive()//心跳发送
         if (success) {
             m_lastKeepaliveTime.store(currentTime);// 最后心跳时间
             m_lastActivityTime.store(currentTime);// 最后活动时间timer.elapsed()
+            m_stats.keepaliveReads++;
             QString message =QString("Keepalive successful in%1ms")
                                     .arg(timer.elapsed());
             emit keepaliveReceived();//连接好着
@@ -779,25 +1064,28 @@ int OPCUAConnectionManager::calculateReconnectDelay()//智能重连延迟计算
         delay *= m_policy.delayMultiplier;
     }
 
+    // 叠加共享退避：同一进程内其他连接也在失败时整体放慢
+    delay += ReconnectLimiter::instance()->sharedBackoff();
+
     // 限制最大延迟
     if (delay > m_policy.maxDelay) {
         delay = m_policy.maxDelay;
     }
 
-    // 添加随机抖动（±10%）避免多个客户端同时重连
-    if (delay > 0) {
-        int jitter = delay / 10;  // 10% 抖动
-        if (jitter > 0) {
-            delay +=  QRandomGenerator::global()->bounded(2 * jitter) - jitter;
-        }
-    }
-
-    // 确保最小延迟
+    // 确保最小延迟；在抖动之前限制，否则首次重连的负向抖动都会落回initialDelay，客户端仍同时重连
     if (delay < m_policy.initialDelay) {
         delay = m_policy.initialDelay;
     }
 
-    return delay;
+    // 添加随机抖动（±jitterPercent）避免多个客户端同时重连；先乘后除，小延迟也有抖动
+    if (delay > 0 && m_policy.jitterPercent > 0) {
+        int jitter = static_cast<int>(static_cast<qint64>(delay) * qMin(m_policy.jitterPercent, 100) / 100);
+        if (jitter > 0) {
+            delay += QRandomGenerator::global()->bounded(2 * jitter + 1) - jitter;
+        }
+    }
+
+    return qMax(0, delay);
 }
 
 bool OPCUAConnectionManager::reconnect()//从新连接
@@ -817,9 +1105,26 @@ bool OPCUAConnectionManager::reconnect()//从新连接
     updateState(STATE_RECONNECTING);//安全的更新链接状态
     emit reconnecting(m_reconnectAttempt.load() + 1, calculateReconnectDelay());//发送重连信号
 
+    // 关闭旧的安全通道。复用会话时保留会话，UA_Client_connect只重建安全通道并用
+    // ActivateSession激活原会话，服务器端订阅保持不变；安全配置变化时必须重建会话
+    UA_SessionState sessionState = UA_SESSIONSTATE_CLOSED;
+    if (m_client) {
+        if (m_security.reuseSession && !m_securityDirty) {
+            UA_Client_disconnectSecureChannel(m_client);
+        } else {
+            UA_Client_disconnect(m_client);
+        }
+        UA_Client_getState(m_client, nullptr, &sessionState, nullptr);
+    }
+    bool reactivating = (sessionState == UA_SESSIONSTATE_CREATED);
+
     bool success = performConnection();
 
     if (success) {
+        if (reactivating) {
+            m_stats.sessionReactivations++;
+            logConnectionAttempt("Session reactivated on new secure channel");
+        }
         m_reconnectAttempt = 0;
         recordConnectionSuccess();//记录连接
         updateState(STATE_CONNECTED);//更新连接状态为已连接，正常工作
@@ -860,6 +1165,17 @@ bool OPCUAConnectionManager::performConnection()//连接执行函数
             return false;
         }
 
+        // 安全配置变化后重新应用（此时处于断开状态）
+        if (m_securityDirty) {
+            if (!applySecurityConfig(config)) {
+                return false;
+            }
+            m_securityDirty = false;
+        }
+
+        // 缓冲区和消息大小在HEL握手时协商，每次建立安全通道前按当前变量数量重新计算
+        applyConnectionTuning(config);
+
         // 清除之前的认证信息
         UA_ExtensionObject_clear(&config->userIdentityToken);
 
@@ -911,6 +1227,200 @@ bool OPCUAConnectionManager::performConnection()//连接执行函数
     }
 }
 
+bool OPCUAConnectionManager::applySecurityConfig(UA_ClientConfig *config)//应用安全策略和证书
+{
+    const bool secured = (m_security.mode == UA_MESSAGESECURITYMODE_SIGN ||
+                          m_security.mode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    if (secured && m_security.policy == SECURITY_POLICY_NONE) {
+        recordError("Sign/SignAndEncrypt requires a security policy");
+        return false;
+    }
+
+    // setDefault* 会重置回调和clientContext，先保存，每条出口都恢复
+    const auto stateCallback = config->stateCallback;
+    const auto inactivityCallback = config->inactivityCallback;
+    const auto subscriptionInactivityCallback = config->subscriptionInactivityCallback;
+    void *clientContext = config->clientContext;
+    auto restoreCallbacks = [&]() {
+        config->stateCallback = stateCallback;
+        config->inactivityCallback = inactivityCallback;
+        config->subscriptionInactivityCallback = subscriptionInactivityCallback;
+        config->clientContext = clientContext;
+    };
+
+    // UA_ClientConfig_setDefault* 要求配置中没有安全策略，先清除旧的策略和端点选择
+    for (size_t i = 0; i < config->securityPoliciesSize; i++) {
+        config->securityPolicies[i].clear(&config->securityPolicies[i]);
+    }
+    UA_free(config->securityPolicies);
+    config->securityPolicies = nullptr;
+    config->securityPoliciesSize = 0;
+    if (config->certificateVerification.clear) {
+        config->certificateVerification.clear(&config->certificateVerification);
+    }
+    UA_String_clear(&config->clientDescription.applicationUri);
+    UA_String_clear(&config->securityPolicyUri);
+    UA_EndpointDescription_clear(&config->endpoint);
+    UA_UserTokenPolicy_clear(&config->userTokenPolicy);
+
+    UA_StatusCode status = UA_STATUSCODE_GOOD;
+    if (secured) {
+#ifdef UA_ENABLE_ENCRYPTION
+        QByteArray certificate;
+        QByteArray privateKey;
+        if (!loadOrCreateCertificate(certificate, privateKey)) {
+            UA_ClientConfig_setDefault(config);
+            restoreCallbacks();
+            return false;
+        }
+
+        // 信任列表，UA_ClientConfig_setDefaultEncryption内部会拷贝
+        QList<QByteArray> trustData;
+        for (const QString &path : m_security.trustListPaths) {
+            QFile file(path);
+            if (file.open(QIODevice::ReadOnly)) {
+                trustData.append(file.readAll());
+            } else {
+                qWarning() << "Failed to read trusted certificate:" << path;
+            }
+        }
+        QVector<UA_ByteString> trustList;
+        for (QByteArray &data : trustData) {
+            UA_ByteString bs;
+            bs.length = static_cast<size_t>(data.size());
+            bs.data = reinterpret_cast<UA_Byte*>(data.data());
+            trustList.append(bs);
+        }
+
+        UA_ByteString cert;
+        cert.length = static_cast<size_t>(certificate.size());
+        cert.data = reinterpret_cast<UA_Byte*>(certificate.data());
+        UA_ByteString key;
+        key.length = static_cast<size_t>(privateKey.size());
+        key.data = reinterpret_cast<UA_Byte*>(privateKey.data());
+
+        status = UA_ClientConfig_setDefaultEncryption(config, cert, key,
+                                                      trustList.data(), trustList.size(),
+                                                      nullptr, 0);
+#else
+        recordError("Encryption not available: open62541 was built without UA_ENABLE_ENCRYPTION");
+        UA_ClientConfig_setDefault(config);
+        restoreCallbacks();
+        return false;
+#endif
+    } else {
+        status = UA_ClientConfig_setDefault(config);
+    }
+    restoreCallbacks();
+
+    if (status != UA_STATUSCODE_GOOD) {
+        recordError(QString("Failed to apply security config: %1").arg(UA_StatusCode_name(status)));
+        return false;
+    }
+
+    // setDefault 会重置以下配置，重新设置
+    config->timeout = 10000;
+    config->outStandingPublishRequests = 10;
+    UA_String_clear(&config->clientDescription.applicationUri);
+    config->clientDescription.applicationUri =
+        UA_STRING_ALLOC(m_security.applicationUri.toUtf8().constData());
+
+    // 限定安全通道选择的端点
+    config->securityMode = secured ? m_security.mode : UA_MESSAGESECURITYMODE_NONE;
+    config->securityPolicyUri = UA_STRING_ALLOC(
+        securityPolicyUri(secured ? m_security.policy : SECURITY_POLICY_NONE).toUtf8().constData());
+
+    logConnectionAttempt(QString("Security config applied: %1 mode %2")
+                             .arg(securityPolicyUri(m_security.policy)).arg(config->securityMode));
+    return true;
+}
+
+void OPCUAConnectionManager::applyConnectionTuning(UA_ClientConfig *config)//应用传输配置
+{
+    const int tagCount = m_expectedTagCount.load();
+    const ConnectionTuning tuned = m_tuning.sizedFor(tagCount);
+    {
+        QMutexLocker appliedLocker(&m_appliedTuningMutex);
+        m_appliedTuning = tuned;
+    }
+
+    UA_ConnectionConfig &connection = config->localConnectionConfig;
+    connection.sendBufferSize = qMax<UA_UInt32>(8192, tuned.sendBufferSize);  // 规范要求最小8192
+    connection.recvBufferSize = qMax<UA_UInt32>(8192, tuned.recvBufferSize);
+    connection.localMaxMessageSize = tuned.maxMessageSize;
+    connection.remoteMaxMessageSize = tuned.maxMessageSize;  // 握手后由服务器ACK覆盖
+    connection.localMaxChunkCount = tuned.maxChunkCount;
+    connection.remoteMaxChunkCount = tuned.maxChunkCount;
+
+    config->secureChannelLifeTime = tuned.secureChannelLifetime;
+    config->requestedSessionTimeout = tuned.sessionTimeout;
+
+    qDebug() << "Connection tuning for" << tagCount << "tags: buffer"
+             << connection.sendBufferSize << "/" << connection.recvBufferSize
+             << "message" << connection.localMaxMessageSize
+             << "chunks" << connection.localMaxChunkCount;
+}
+
+bool OPCUAConnectionManager::loadOrCreateCertificate(QByteArray &certificate,
+                                                     QByteArray &privateKey)//加载客户端证书，不存在时生成并保存
+{
+    QFile certFile(m_security.certificatePath);
+    QFile keyFile(m_security.privateKeyPath);
+
+    if (certFile.exists() && keyFile.exists()) {
+        if (!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly)) {
+            recordError("Failed to read client certificate or private key");
+            return false;
+        }
+        certificate = certFile.readAll();
+        privateKey = keyFile.readAll();
+        return !certificate.isEmpty() && !privateKey.isEmpty();
+    }
+
+#ifdef UA_ENABLE_ENCRYPTION
+    // 首次使用时生成自签名证书并保存，之后每次连接使用同一证书，服务器只需信任一次
+    QByteArray host = QSysInfo::machineHostName().toUtf8();
+    QByteArray commonName = "CN=OPCUAClient@" + host;
+    QByteArray dnsName = "DNS:" + host;
+    QByteArray uriName = "URI:" + m_security.applicationUri.toUtf8();
+
+    UA_String subject[3] = {UA_STRING_STATIC("C=CN"),
+                            UA_STRING_STATIC("O=Industrial"),
+                            UA_STRING(commonName.data())};
+    UA_String subjectAltName[2] = {UA_STRING(dnsName.data()),
+                                   UA_STRING(uriName.data())};
+
+    UA_ByteString newKey = UA_BYTESTRING_NULL;
+    UA_ByteString newCert = UA_BYTESTRING_NULL;
+    UA_StatusCode status = UA_CreateCertificate(&UA_Client_getConfig(m_client)->logger,
+                                                subject, 3, subjectAltName, 2,
+                                                2048, UA_CERTIFICATEFORMAT_DER,
+                                                &newKey, &newCert);
+    if (status != UA_STATUSCODE_GOOD) {
+        recordError(QString("Failed to create client certificate: %1").arg(UA_StatusCode_name(status)));
+        return false;
+    }
+
+    certificate = QByteArray(reinterpret_cast<const char*>(newCert.data), static_cast<int>(newCert.length));
+    privateKey = QByteArray(reinterpret_cast<const char*>(newKey.data), static_cast<int>(newKey.length));
+    UA_ByteString_clear(&newCert);
+    UA_ByteString_clear(&newKey);
+
+    QDir().mkpath(QFileInfo(m_security.certificatePath).absolutePath());
+    QDir().mkpath(QFileInfo(m_security.privateKeyPath).absolutePath());
+    if (!certFile.open(QIODevice::WriteOnly) || certFile.write(certificate) != certificate.size() ||
+        !keyFile.open(QIODevice::WriteOnly) || keyFile.write(privateKey) != privateKey.size()) {
+        qWarning() << "Failed to save client certificate to" << m_security.certificatePath;
+    } else {
+        qInfo() << "Client certificate created:" << m_security.certificatePath;
+    }
+    return true;
+#else
+    recordError("Client certificate not found and open62541 was built without UA_ENABLE_ENCRYPTION");
+    return false;
+#endif
+}
+
 void OPCUAConnectionManager::updateState(ConnectionState newState)//安全地更新连接状态
 {
     ConnectionState oldState = m_state.load();
@@ -1000,6 +1510,7 @@ OPCUAVariableManager::OPCUAVariableManager(QObject *parent)
     : QObject(parent)
     , m_threadPool(nullptr)
     , m_maxThreadCount(4)
+    , m_valueStore(std::make_shared<ValueCellStore>())
     , m_subscriptionMode(SUBSCRIPTION_MONITORED)
     , m_subscriptionId(0)
     , m_pollingInterval(1000)
@@ -1047,6 +1558,11 @@ OPCUAVariableManager::OPCUAVariableManager(QObject *parent)
     m_processTimer=new QTimer(this);
     QObject::connect(m_processTimer,&QTimer::timeout,this,&OPCUAVariableManager::startProcessing);
 
+    // 重连后分批恢复监控项，避免同时向网关创建大量监控项
+    m_restoreTimer = new QTimer(this);
+    m_restoreTimer->setSingleShot(false);
+    QObject::connect(m_restoreTimer, &QTimer::timeout, this, &OPCUAVariableManager::onRestoreTimer);
+
 
     m_isInitialized = true;//初始化完成
     qDebug() << "OPCUAVariableManager initialized successfully";
@@ -1078,6 +1594,15 @@ OPCUAVariableManager::~OPCUAVariableManager()
     {
         QWriteLocker locker(&m_variablesLock);
         m_variables.clear();
+        m_retiredHandles.clear();
+        m_handleArena.clear();
+    }
+
+    // 清理事件监控句柄
+    {
+        QWriteLocker locker(&m_eventMonitorsLock);
+        m_eventMonitors.clear();
+        m_eventMonitorsById.clear();
     }
 
     qDebug() << "OPCUAVariableManager destroyed";
@@ -1168,6 +1693,38 @@ ReconnectPolicy OPCUAVariableManager::reconnectPolicy() const//返回OPCUAConnec
     return m_connectionManager->reconnectPolicy();
 }
 
+void OPCUAVariableManager::setSecurityConfig(const SecurityConfig &config)//设置安全策略，下一次连接时生效
+{
+    if (m_isInitialized) {
+        m_connectionManager->setSecurityConfig(config);
+    }
+}
+
+SecurityConfig OPCUAVariableManager::securityConfig() const//返回安全策略
+{
+    if (!m_isInitialized) {
+        return SecurityConfig();
+    }
+
+    return m_connectionManager->securityConfig();
+}
+
+void OPCUAVariableManager::setConnectionTuning(const ConnectionTuning &tuning)//设置传输配置，下一次建立安全通道时生效
+{
+    // 连接管理器在构造时创建，配置只保存在连接管理器一处
+    m_connectionManager->setConnectionTuning(tuning);
+}
+
+ConnectionTuning OPCUAVariableManager::connectionTuning() const//返回传输配置
+{
+    return m_connectionManager->connectionTuning();
+}
+
+bool OPCUAVariableManager::connectionTuningOutdated() const//连接后注册的变量是否超出了当前通道的大小
+{
+    return m_connectionManager->connectionTuningOutdated();
+}
+
 void OPCUAVariableManager::setRequestTimeout(int timeoutMs)//设置异步操作的超时时间,相对异步来说的
 {
     QMutexLocker locker(&m_mutex);
@@ -1259,7 +1816,7 @@ bool OPCUAVariableManager::registerVariable(VariableDefinition* variable)
     }
 
     // 3. 创建变量句柄
-    auto handle = std::make_shared<OPCUAVariableHandle>();
+    auto handle = createHandle();
 
     // 4. 关键修改：直接解析到handle->nodeId创建变量解析
     if (!parseNodeId(variable->address(), handle->nodeId)) {
@@ -1267,12 +1824,14 @@ bool OPCUAVariableManager::registerVariable(VariableDefinition* variable)
         qDebug() << "Failed to parse address for" << tagName
                  << ":" << variable->address();
         recordError(QString("Failed to parse NodeId: %1").arg(variable->address()));
+        destroyHandle(handle.get());
         return false;
     }
 
     // 5. 验证解析结果（重要！）
     if (UA_NodeId_isNull(&handle->nodeId)) {
         recordError(QString("Parsed NodeId is null for: %1").arg(tagName));
+        destroyHandle(handle.get());
         return false;
     }
 
@@ -1280,6 +1839,17 @@ bool OPCUAVariableManager::registerVariable(VariableDefinition* variable)
     handle->tagName = tagName;
     handle->variableDef = variable;
 
+    // 实时值迁移到本管理器的连续单元数组（已被其他管理器接管的变量保持不变）
+    if (variable->valueCellStore() == ValueCellStore::global().get()) {
+        variable->bindValueCell(m_valueStore);
+    }
+    if (m_batchedChanges.load(std::memory_order_relaxed)) {
+        variable->setChangeSignalsEnabled(false);
+    }
+    if (variable->valueCellStore() == m_valueStore.get()) {
+        m_tagIndex.insert(tagName, variable->valueCellId());
+    }
+
     // 7. 初始化状态信息
     handle->lastStatus.isConnected = m_connectionManager->isConnected();
     handle->lastStatus.quality = handle->lastStatus.isConnected ?
@@ -1287,6 +1857,7 @@ bool OPCUAVariableManager::registerVariable(VariableDefinition* variable)
 
     // 8. 存储到容器
     m_variables.insert(tagName, handle);
+    m_connectionManager->setExpectedTagCount(m_variables.size());// 下一次建立安全通道时按变量数量计算缓冲区
     recordSuccess(QString("Registered variable: %1").arg(tagName));
 
     return true;
@@ -1305,6 +1876,112 @@ bool OPCUAVariableManager::registerVariables(const QList<VariableDefinition*> &v
     return allSuccess;
 }
 
+int OPCUAVariableManager::registerVariables(const VariableColumns &columns, QStringList *errors)//按列描述批量创建并注册变量
+{
+    QString error;
+    if (!columns.validate(&error)) {
+        recordError(QString("Invalid variable columns: %1").arg(error));
+        if (errors) {
+            errors->append(error);
+        }
+        return 0;
+    }
+    const int count = columns.size();
+    if (count == 0) {
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 1. 变量定义连续创建，实时值单元直接分配在本管理器的存储中
+    std::unique_ptr<VariableArena> arena(new VariableArena(columns, m_valueStore));
+
+    // 2. 地址解析与其他变量无关，按段交给线程池；句柄在加锁后从句柄块中创建
+    std::vector<UA_NodeId> nodeIds(static_cast<size_t>(count));
+    QVector<char> parsed(count, 0);
+    char *parsedFlags = parsed.data();  // 工作线程只写各自的元素，避免operator[]的共享检查
+    const int chunkSize = 512;
+    QVector<int> chunkStarts;
+    for (int start = 0; start < count; start += chunkSize) {
+        chunkStarts.append(start);
+    }
+    QtConcurrent::blockingMap(chunkStarts, [&](const int &start) {
+        const int end = qMin(start + chunkSize, count);
+        for (int i = start; i < end; i++) {
+            UA_NodeId &nodeId = nodeIds[static_cast<size_t>(i)];
+            if (columns.tagNames.at(i).isEmpty()) {
+                UA_NodeId_init(&nodeId);
+                continue;
+            }
+            if (parseNodeAddress(columns.addresses.at(i), nodeId)) {
+                parsedFlags[i] = 1;
+            } else {
+                UA_NodeId_clear(&nodeId);
+            }
+        }
+    });
+    const qint64 parseMs = timer.elapsed();
+
+    // 3. 一次加锁插入句柄表
+    const bool batched = m_batchedChanges.load(std::memory_order_relaxed);
+    const bool online = m_connectionManager->isConnected();
+    QList<OPCUAVariableHandle*> added;
+    added.reserve(count);
+
+    QWriteLocker locker(&m_variablesLock);
+    m_variables.reserve(m_variables.size() + count);
+    for (int i = 0; i < count; i++) {
+        const QString &tagName = columns.tagNames.at(i);
+        if (!parsed[i]) {
+            error = tagName.isEmpty() ? QString("Variable tag name cannot be empty (row %1)").arg(i)
+                                      : QString("Failed to parse NodeId for %1: %2").arg(tagName, columns.addresses.at(i));
+        } else if (m_variables.contains(tagName)) {
+            error = QString("Variable already registered: %1").arg(tagName);
+        } else {
+            auto handle = createHandle();
+            handle->nodeId = nodeIds[static_cast<size_t>(i)];  // 接管解析结果中的标识符内存
+            UA_NodeId_init(&nodeIds[static_cast<size_t>(i)]);
+            handle->tagName = tagName;
+            handle->variableDef = arena->at(i);
+            if (batched) {
+                handle->variableDef->setChangeSignalsEnabled(false);
+            }
+            m_tagIndex.insert(tagName, handle->variableDef->valueCellId());
+            handle->lastStatus.isConnected = online;
+            handle->lastStatus.quality = online ? QUALITY_GOOD : QUALITY_COMM_FAIL;
+            added.append(handle.get());
+            m_variables.insert(tagName, std::move(handle));
+            continue;
+        }
+
+        UA_NodeId_clear(&nodeIds[static_cast<size_t>(i)]);
+        recordError(error);
+        if (errors) {
+            errors->append(error);
+        }
+    }
+    m_variableArenas.push_back(std::move(arena));  // 注册失败的定义也留在块中，随块一起释放
+    m_connectionManager->setExpectedTagCount(m_variables.size());
+    if (m_connectionManager->connectionTuningOutdated()) {
+        // 缓冲区和消息大小只在建立安全通道时协商，新规模等通道重建后生效
+        qWarning() << "Registered" << m_variables.size()
+                   << "tags exceed the buffer sizes negotiated for the current secure channel;"
+                   << "they take effect after the next reconnect";
+    }
+
+    // 4. 订阅中时新变量的监控项按批创建，不再逐个请求
+    int subscribed = 0;
+    if (m_subscriptionMode == SUBSCRIPTION_MONITORED && m_subscriptionId > 0) {
+        subscribed = createMonitoredItemsInBatches(added);
+    }
+    locker.unlock();
+
+    qInfo() << "Bulk registered" << added.size() << "/" << count << "variables in" << timer.elapsed()
+            << "ms (parse" << parseMs << "ms, monitored items" << subscribed << ")";
+    return added.size();
+}
+
 bool OPCUAVariableManager::unregisterVariable(const QString &tagName)//取消注册（删除）一个已注册的变量
 {
     QWriteLocker locker(&m_variablesLock);
@@ -1319,8 +1996,15 @@ bool OPCUAVariableManager::unregisterVariable(const QString &tagName)//取消注
     if (it != m_variables.end() && (*it)->isSubscribed) {
         deleteMonitoredItem(it->get());
     }
+    if (it != m_variables.end() && (*it)->variableDef && m_batchedChanges.load(std::memory_order_relaxed)) {
+        (*it)->variableDef->setChangeSignalsEnabled(true);  // 交还给其他使用者时恢复逐个信号
+    }
 
+    OPCUAVariableHandle *removed = it != m_variables.end() ? it->get() : nullptr;
+    m_tagIndex.remove(tagName);
     int removedCount = m_variables.remove(tagName);  // ✅ 使用 remove()
+    destroyHandle(removed);
+    m_connectionManager->setExpectedTagCount(m_variables.size());
 
     qDebug() << "Variable unregistered successfully:" << tagName;
     recordSuccess(QString("Unregistered variable: %1").arg(tagName));
@@ -1340,13 +2024,165 @@ void OPCUAVariableManager::clearVariables()//清除所有已注册的变量
         if (handle && handle->isSubscribed) {
             deleteMonitoredItem(handle.get());
         }
+        if (handle && handle->variableDef && m_batchedChanges.load(std::memory_order_relaxed)) {
+            handle->variableDef->setChangeSignalsEnabled(true);
+        }
+    }
+    for (const auto &handle : m_variables) {
+        destroyHandle(handle.get());
     }
     m_variables.clear();
+    if (m_retiredHandles.isEmpty()) {
+        m_handleArena.clear();     // 句柄整块释放；有监控项删除失败的槽位时保留，订阅删除后归还
+    }
+    m_tagIndex.clear();
+    m_variableArenas.clear();  // 句柄已全部移除，批量注册的定义整块释放
+    m_connectionManager->setExpectedTagCount(0);
 
     qDebug() << "All variables cleared";
     recordSuccess("Cleared all variables");
 }
 
+std::shared_ptr<OPCUAVariableHandle> OPCUAVariableManager::createHandle()//调用者持有m_variablesLock写锁
+{
+    const int index = m_handleArena.create();
+    OPCUAVariableHandle *handle = m_handleArena.at(index);
+    handle->arenaIndex = index;
+    handle->serial = ++m_nextHandleSerial;
+    if (handle->serial == 0) {
+        handle->serial = ++m_nextHandleSerial;  // 0留给未分配的句柄
+    }
+    return std::shared_ptr<OPCUAVariableHandle>(m_handleLifetime, handle);
+}
+
+void OPCUAVariableManager::destroyHandle(OPCUAVariableHandle *handle)//调用者持有m_variablesLock写锁
+{
+    if (!handle || !m_handleArena.contains(handle->arenaIndex) || m_handleArena.at(handle->arenaIndex) != handle) {
+        return;
+    }
+    if (handle->isSubscribed && handle->monitoredItemId != 0) {
+        // 监控项没有删掉，服务器仍会用这个槽位作monContext发布：保留槽位不复用，
+        // 清掉序号和变量定义，之后的通知在updateVariableFromCallback中丢弃
+        handle->serial = 0;
+        handle->variableDef = nullptr;
+        m_retiredHandles.append(handle->arenaIndex);
+        return;
+    }
+    m_handleArena.destroy(handle->arenaIndex);
+}
+
+void OPCUAVariableManager::releaseRetiredHandles()//调用者持有m_variablesLock写锁
+{
+    for (int index : m_retiredHandles) {
+        if (m_handleArena.contains(index)) {
+            m_handleArena.destroy(index);
+        }
+    }
+    m_retiredHandles.clear();
+}
+
+void OPCUAVariableManager::setWriteAccessControl(const std::shared_ptr<WriteAccessControl> &control)
+{
+    QWriteLocker locker(&m_variablesLock);
+    m_writeAccess = control;
+}
+
+std::shared_ptr<WriteAccessControl> OPCUAVariableManager::writeAccessControl() const
+{
+    QReadLocker locker(&m_variablesLock);
+    return m_writeAccess;
+}
+
+TagMemoryUsage OPCUAVariableManager::memoryUsage() const
+{
+    TagMemoryUsage usage;
+    QReadLocker locker(&m_variablesLock);
+    usage.tagCount = m_variables.size();
+
+    usage.add("handles", m_handleArena.memoryUsage());
+    usage.add("handleTable", static_cast<qint64>(m_variables.capacity())
+                                 * (sizeof(QString) + sizeof(std::shared_ptr<OPCUAVariableHandle>) + sizeof(size_t)));
+
+    qint64 tagNames = 0;
+    qint64 nodeIds = 0;
+    qint64 lastValues = 0;
+    qint64 definitions = 0;
+    for (const auto &handle : m_variables) {
+        tagNames += handle->tagName.capacity() * static_cast<qint64>(sizeof(QChar));
+        if (handle->nodeId.identifierType == UA_NODEIDTYPE_STRING ||
+            handle->nodeId.identifierType == UA_NODEIDTYPE_BYTESTRING) {
+            nodeIds += static_cast<qint64>(handle->nodeId.identifier.string.length);
+        }
+        if (handle->lastValue.typeId() == QMetaType::QString) {
+            lastValues += handle->lastValue.toString().capacity() * static_cast<qint64>(sizeof(QChar));
+        }
+        if (handle->variableDef) {
+            definitions += sizeof(VariableDefinition);
+        }
+    }
+    usage.add("tagNames", tagNames);
+    usage.add("nodeIds", nodeIds);          // 字符串/字节串标识符，数字标识符在句柄内
+    usage.add("lastValues", lastValues);    // 只有字符串值另外分配
+    usage.add("definitions", definitions);
+    usage.add("valueCells", m_valueStore->memoryUsage());
+    return usage;
+}
+
+void OPCUAVariableManager::setBatchedChangeNotification(bool enabled)//逐个信号改为批量取走变化
+{
+    QReadLocker locker(&m_variablesLock);
+    m_batchedChanges.store(enabled, std::memory_order_relaxed);
+    for (const auto &handle : m_variables) {
+        if (handle && handle->variableDef) {
+            handle->variableDef->setChangeSignalsEnabled(!enabled);
+        }
+    }
+}
+
+QList<VariableDefinition*> OPCUAVariableManager::takeChangedVariables()
+{
+    QList<VariableDefinition*> changed;
+    QVector<quint32> ids;
+    if (m_valueStore->takeChanged(ids) == 0) {
+        return changed;
+    }
+
+    changed.reserve(ids.size());
+    for (quint32 id : ids) {
+        VariableDefinition *variable = m_valueStore->owner(id);
+        if (variable) {  // 变化后已注销的变量单元已释放
+            changed.append(variable);
+        }
+    }
+    return changed;
+}
+
+void OPCUAVariableManager::setStalenessMonitor(StalenessMonitor *monitor)
+{
+    if (m_stalenessMonitor == monitor) {
+        return;
+    }
+    if (m_stalenessMonitor) {
+        QObject::disconnect(this, &OPCUAVariableManager::connectionLost,
+                            this, &OPCUAVariableManager::onStalenessConnectionLost);
+    }
+    m_stalenessMonitor = monitor;
+    if (!monitor) {
+        return;
+    }
+
+    QObject::connect(this, &OPCUAVariableManager::connectionLost,
+                     this, &OPCUAVariableManager::onStalenessConnectionLost);
+
+    // 已订阅的变量补登记
+    QReadLocker locker(&m_variablesLock);
+    for (const auto &handle : m_variables) {
+        if (handle && handle->isSubscribed) {
+            watchStaleness(handle.get());
+        }
+    }
+}
+
 bool OPCUAVariableManager::browseVariableNode(const QString &tagName)//异步查询已注册变量的OPC UA节点详细信息，验证节点是否存在并获取节点属性
 {
     if (!m_connectionManager->isConnected()) {
@@ -1472,15 +2308,27 @@ int OPCUAVariableManager::writeVariableAsync(const QString &tagName,
         return requestId;
     }
 
-    // 检查变量是否存在且可写
+    // 检查变量是否存在且可写，设置了写入权限时同时检查当前用户的访问组
     {
         QReadLocker locker(&m_variablesLock);
         auto it = m_variables.find(tagName);
-        if (it == m_variables.end() || !(*it)->variableDef ||
-            !(*it)->variableDef->writable()) {
+        QString denied;
+        if (it == m_variables.end() || !(*it)->variableDef) {
+            denied = "Variable not found or not writable";
+        } else if (m_writeAccess) {
+            const WriteAccessControl::Decision decision = m_writeAccess->checker().check((*it)->variableDef);
+            if (decision == WriteAccessControl::DENIED_GROUP) {
+                denied = QString("Write access denied for user '%1'").arg(m_writeAccess->currentUser());
+            } else if (decision == WriteAccessControl::DENIED_NOT_WRITABLE) {
+                denied = "Variable not found or not writable";
+            }
+        } else if (!(*it)->variableDef->writable()) {
+            denied = "Variable not found or not writable";
+        }
+
+        if (!denied.isEmpty()) {
             int requestId = generateRequestId();
-            emit writeCompleted(requestId, tagName, false,
-                                "Variable not found or not writable");
+            emit writeCompleted(requestId, tagName, false, denied);
             return requestId;
         }
     }
@@ -1612,12 +2460,27 @@ bool OPCUAVariableManager::startSubscription(SubscriptionMode mode)//启动数
         // 监控项模式
         if (createSubscription()) {
             qInfo() << "Created monitored subscription with ID:" << m_subscriptionId;
+            m_subscriptionWanted = true;
 
-            // 为所有已注册变量创建监控项
+            // 为所有已注册变量创建监控项，按批一次请求多个
             QWriteLocker locker(&m_variablesLock);
+            QList<OPCUAVariableHandle*> pending;
+            pending.reserve(m_variables.size());
             for (const auto &handle : m_variables) {
                 if (!handle->isSubscribed) {
-                    createMonitoredItem(handle.get());
+                    pending.append(handle.get());
+                }
+            }
+            createMonitoredItemsInBatches(pending);
+            locker.unlock();
+
+            // 为所有事件监控创建事件监控项
+            {
+                QReadLocker eventLocker(&m_eventMonitorsLock);
+                for (const auto &eventHandle : m_eventMonitors) {
+                    if (!eventHandle->isSubscribed) {
+                        createEventMonitoredItem(eventHandle.get());
+                    }
                 }
             }
             m_processTimer->start(1000);
@@ -1633,22 +2496,43 @@ bool OPCUAVariableManager::startSubscription(SubscriptionMode mode)//启动数
 
 void OPCUAVariableManager::stopSubscription()//停止阅订
 {
+    m_subscriptionWanted = false;
+
     if (m_subscriptionMode == SUBSCRIPTION_POLLING) {
         m_pollingTimer->stop();//如果是轮训模式停止轮训定时器
     }
-    else if (m_subscriptionMode == SUBSCRIPTION_MONITORED && m_subscriptionId > 0) {
-        // 如果是监控模式，删除订阅
-        deleteSubscription();
-        m_subscriptionId = 0;
+    teardownSubscription();
 
-        // 更新所有句柄的订阅状态
-        QWriteLocker locker(&m_variablesLock);
-        for (const auto &handle : m_variables) {
-            handle->isSubscribed = false;
-        }
+    qInfo() << "Stopped subscription";
+}
+
+void OPCUAVariableManager::teardownSubscription()//拆除订阅和监控项状态，保留m_subscriptionWanted，连接恢复后据此重建
+{
+    m_restoreTimer->stop();
+    m_restoreQueue.clear();
+
+    if (m_subscriptionMode != SUBSCRIPTION_MONITORED || m_subscriptionId == 0) {
+        return;
     }
 
-    qInfo() << "Stopped subscription";
+    // 如果是监控模式，删除订阅
+    deleteSubscription();
+    m_subscriptionId = 0;
+
+    // 更新所有句柄的订阅状态
+    QWriteLocker locker(&m_variablesLock);
+    for (const auto &handle : m_variables) {
+        handle->isSubscribed = false;
+        handle->monitoredItemId = 0;
+    }
+    releaseRetiredHandles();  // 订阅已删除，旧监控项不再发布
+    locker.unlock();
+
+    QWriteLocker eventLocker(&m_eventMonitorsLock);
+    for (const auto &eventHandle : m_eventMonitors) {
+        eventHandle->isSubscribed = false;
+        eventHandle->monitoredItemId = 0;
+    }
 }
 
 bool OPCUAVariableManager::isSubscribed() const// 检查当前是否启用了数据订阅功能
@@ -1666,13 +2550,105 @@ void OPCUAVariableManager::setPollingInterval(int intervalMs)//设置轮询订
         intervalMs = 100; // 最小100ms
     }
 
-    m_pollingInterval = intervalMs;
-    m_pollingTimer->setInterval(intervalMs);
+    m_pollingInterval = intervalMs;
+    m_pollingTimer->setInterval(intervalMs);
+}
+
+int OPCUAVariableManager::pollingInterval() const//查询轮询订阅模式的时间间隔
+{
+    return m_pollingInterval;
+}
+
+// ==================== 事件/报警订阅 ====================
+
+bool OPCUAVariableManager::addEventMonitor(const QString &name,
+                                           const EventMonitorConfig &config)//添加事件监控（报警/条件事件）
+{
+    if (name.isEmpty() || config.selectFields.isEmpty()) {
+        recordError("Invalid event monitor configuration");
+        return false;
+    }
+
+    auto handle = std::make_shared<OPCUAEventHandle>();
+    handle->name = name;
+    handle->config = config;
+
+    if (!parseNodeId(config.notifierAddress, handle->notifierId)) {
+        recordError(QString("Failed to parse event notifier: %1").arg(config.notifierAddress));
+        return false;
+    }
+
+    {
+        QWriteLocker locker(&m_eventMonitorsLock);
+        if (m_eventMonitors.contains(name)) {
+            recordError(QString("Event monitor already exists: %1").arg(name));
+            return false;
+        }
+        handle->id = ++m_nextEventMonitorId;
+        m_eventMonitors.insert(name, handle);
+        m_eventMonitorsById.insert(handle->id, handle);
+    }
+
+    // 映射到的已注册变量由服务器报警驱动，不再做客户端限值判断
+    if (config.offloadClientAlarm) {
+        QReadLocker locker(&m_variablesLock);
+        for (const QString &tagName : config.sourceToTag) {
+            auto it = m_variables.constFind(tagName);
+            if (it != m_variables.constEnd() && it.value()->variableDef) {
+                it.value()->variableDef->setServerAlarmEnabled(true);
+            }
+        }
+    }
+
+    // 订阅已启动时立即创建事件监控项
+    if (m_subscriptionMode == SUBSCRIPTION_MONITORED && m_subscriptionId > 0) {
+        createEventMonitoredItem(handle.get());
+    }
+
+    qInfo() << "Event monitor added:" << name << "notifier:" << config.notifierAddress;
+    return true;
+}
+
+bool OPCUAVariableManager::removeEventMonitor(const QString &name)//删除事件监控
+{
+    std::shared_ptr<OPCUAEventHandle> handle;
+    {
+        QWriteLocker locker(&m_eventMonitorsLock);
+        handle = m_eventMonitors.take(name);
+        if (handle) {
+            m_eventMonitorsById.remove(handle->id);
+        }
+    }
+
+    if (!handle) {
+        return false;
+    }
+
+    // 删除失败或未执行时监控项仍可能送来通知，回调按编号查不到句柄即丢弃
+
+    if (handle->isSubscribed) {
+        deleteEventMonitoredItem(handle.get());
+    }
+
+    // 恢复客户端限值判断
+    if (handle->config.offloadClientAlarm) {
+        QReadLocker locker(&m_variablesLock);
+        for (const QString &tagName : handle->config.sourceToTag) {
+            auto it = m_variables.constFind(tagName);
+            if (it != m_variables.constEnd() && it.value()->variableDef) {
+                it.value()->variableDef->setServerAlarmEnabled(false);
+            }
+        }
+    }
+
+    qInfo() << "Event monitor removed:" << name;
+    return true;
 }
 
-int OPCUAVariableManager::pollingInterval() const//查询轮询订阅模式的时间间隔
+QStringList OPCUAVariableManager::eventMonitorNames() const//获取所有事件监控名称
 {
-    return m_pollingInterval;
+    QReadLocker locker(&m_eventMonitorsLock);
+    return m_eventMonitors.keys();
 }
 
 // ==================== 查询方法 ====================
@@ -1709,6 +2685,32 @@ QList<QString> OPCUAVariableManager::getRegisteredTagNames() const//获取所有
     return m_variables.keys();
 }
 
+QVector<quint32> OPCUAVariableManager::findTagIds(const QString &pattern) const//段通配查询
+{
+    return m_tagIndex.findWildcard(pattern);
+}
+
+QVector<quint32> OPCUAVariableManager::findTagIdsByPrefix(const QString &prefix) const
+{
+    return m_tagIndex.findPrefix(prefix);
+}
+
+QVector<quint32> OPCUAVariableManager::findTagIdsByRegex(const QRegularExpression &regex) const
+{
+    return m_tagIndex.findRegex(regex);
+}
+
+QList<VariableDefinition*> OPCUAVariableManager::findVariables(const QString &pattern) const
+{
+    QList<VariableDefinition*> variables;
+    for (quint32 id : m_tagIndex.findWildcard(pattern)) {
+        if (VariableDefinition *variable = m_valueStore->owner(id)) {
+            variables.append(variable);
+        }
+    }
+    return variables;
+}
+
 NodeStatus OPCUAVariableManager::getVariableStatus(const QString &tagName) const//获取已注册变量的最新状态信息
 {
     QReadLocker locker(&m_variablesLock);
@@ -2023,6 +3025,32 @@ bool OPCUAVariableManager::batchWrite(const QVariantMap &values, int timeoutMs)/
         return true;  // 空操作视为成功
     }
 
+    // 排队前检查整批的访问组权限，整批共用一个检查器；有变量被拒绝时整批不写（配方不能只写一部分）
+    {
+        QReadLocker locker(&m_variablesLock);
+        if (m_writeAccess) {
+            const WriteAccessControl::Checker checker = m_writeAccess->checker();
+            int denied = 0;
+            QString firstDenied;
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                auto handle = m_variables.constFind(it.key());
+                if (handle == m_variables.constEnd() || !handle.value()->variableDef) {
+                    continue;   // 未注册的变量由写入任务报告
+                }
+                if (checker.check(handle.value()->variableDef) == WriteAccessControl::DENIED_GROUP) {
+                    if (denied++ == 0) {
+                        firstDenied = it.key();
+                    }
+                }
+            }
+            if (denied > 0) {
+                recordError(QString("Batch write denied for user '%1': %2 of %3 variables not permitted (first: %4)")
+                                .arg(m_writeAccess->currentUser()).arg(denied).arg(values.size()).arg(firstDenied));
+                return false;
+            }
+        }
+    }
+
     int requestId = generateRequestId();
 
     // 直接传递 QVariantMap，不再需要转换
@@ -2306,19 +3334,29 @@ void OPCUAVariableManager::onSubscriptionDeleted(UA_UInt32 subId)
 
     // 清理状态
     m_subscriptionId = 0;
+    m_connectionManager->setSubscriptionKeepaliveWindow(0);
 
     QWriteLocker locker(&m_variablesLock);
     for (auto &handle : m_variables) {
         handle->isSubscribed = false;
         handle->monitoredItemId = 0;
     }
+    releaseRetiredHandles();
+    locker.unlock();
+
+    QWriteLocker eventLocker(&m_eventMonitorsLock);
+    for (auto &eventHandle : m_eventMonitors) {
+        eventHandle->isSubscribed = false;
+        eventHandle->monitoredItemId = 0;
+    }
+    eventLocker.unlock();
 
     recordError(QString("Subscription %1 was deleted").arg(subId));
 
-    // 尝试重新订阅
+    // 尝试重新订阅，并分批恢复监控项
     QTimer::singleShot(2000, this, [this]() {
         if (m_connectionManager->isConnected()) {
-            createSubscription();
+            restoreSubscriptionStaged();
         }
     });
 }
@@ -2383,6 +3421,14 @@ void OPCUAVariableManager::onConnectionStateChanged(ConnectionState newState,
 
         // 通知连接恢复
         emit connectionRestored();
+
+        // 恢复监控订阅：随机延迟后分批创建，避免所有客户端同时冲击网关
+        if (m_subscriptionMode == SUBSCRIPTION_MONITORED && m_subscriptionWanted) {
+            int interval = qMax(50, m_connectionManager->reconnectPolicy().restoreStageInterval);
+            QTimer::singleShot(QRandomGenerator::global()->bounded(interval * 5), this, [this]() {
+                restoreSubscriptionStaged();
+            });
+        }
         break;
 
     case STATE_DISCONNECTED:
@@ -2416,7 +3462,8 @@ void OPCUAVariableManager::onConnectionStateChanged(ConnectionState newState,
 
     case STATE_ERROR:
         qWarning() << "OPC UA connection error";
-        stopSubscription();
+        // 只拆除订阅，不清除m_subscriptionWanted，重新连上后分批恢复
+        teardownSubscription();
         // 停止轮询
         m_pollingTimer->stop();
         break;
@@ -2503,6 +3550,80 @@ void OPCUAVariableManager::onInternalReconnect()//强制重连的内部回调函
     reconnect();
 }
 
+void OPCUAVariableManager::restoreSubscriptionStaged()//重连后分批恢复订阅和监控项
+{
+    if (!m_connectionManager->isConnected() || !m_subscriptionWanted) {
+        return;
+    }
+
+    if (m_subscriptionId == 0 && !createSubscription()) {
+        recordError("Failed to recreate subscription after reconnect");
+        return;
+    }
+
+    // 收集未订阅的变量，交给定时器分批创建
+    {
+        QReadLocker locker(&m_variablesLock);
+        m_restoreQueue.clear();
+        for (auto it = m_variables.constBegin(); it != m_variables.constEnd(); ++it) {
+            if (!it.value()->isSubscribed) {
+                m_restoreQueue.append(it.key());
+            }
+        }
+    }
+    m_restoreTotal = m_restoreQueue.size();
+
+    // 事件监控项数量很少，直接恢复
+    {
+        QReadLocker locker(&m_eventMonitorsLock);
+        for (const auto &eventHandle : m_eventMonitors) {
+            if (!eventHandle->isSubscribed) {
+                createEventMonitoredItem(eventHandle.get());
+            }
+        }
+    }
+
+    if (!m_processTimer->isActive()) {
+        m_processTimer->start(1000);
+    }
+
+    if (m_restoreTotal > 0) {
+        qInfo() << "Restoring" << m_restoreTotal << "monitored items in stages";
+        m_restoreTimer->start(qMax(50, m_connectionManager->reconnectPolicy().restoreStageInterval));
+    }
+}
+
+void OPCUAVariableManager::onRestoreTimer()//分批恢复监控项
+{
+    if (!m_connectionManager->isConnected() || m_subscriptionId == 0) {
+        m_restoreTimer->stop();
+        return;
+    }
+
+    int batchSize = qMax(1, m_connectionManager->reconnectPolicy().restoreBatchSize);
+    QStringList batch = m_restoreQueue.mid(0, batchSize);
+    m_restoreQueue.erase(m_restoreQueue.begin(), m_restoreQueue.begin() + batch.size());
+
+    {
+        QWriteLocker locker(&m_variablesLock);
+        QList<OPCUAVariableHandle*> handles;
+        for (const QString &tagName : batch) {
+            auto it = m_variables.constFind(tagName);
+            if (it != m_variables.constEnd() && !it.value()->isSubscribed) {
+                handles.append(it.value().get());
+            }
+        }
+        createMonitoredItems(handles);
+    }
+
+    emit subscriptionRestoreProgress(m_restoreTotal - m_restoreQueue.size(), m_restoreTotal);
+
+    if (m_restoreQueue.isEmpty()) {
+        m_restoreTimer->stop();
+        qInfo() << "Monitored items restored:" << m_restoreTotal;
+    }
+}
+
 
 //------------------------open62541回调函数及处理-----------------------------------
 
@@ -2536,6 +3657,11 @@ void OPCUAVariableManager::dataChangeNotificationCallback(
         statTimer.restart();
     }
 
+    // 收到发布响应说明通道存活，心跳定时器据此省去显式读取
+    if (subContext) {
+        static_cast<OPCUAVariableManager*>(subContext)->m_connectionManager->notifyActivity();
+    }
+
     // 1. 快速参数检查（工业现场要求快速响应）
     if (!value || value->status != UA_STATUSCODE_GOOD) {
         return;  // 静默失败
@@ -2545,6 +3671,14 @@ void OPCUAVariableManager::dataChangeNotificationCallback(
     OPCUAVariableHandle* handle = static_cast<OPCUAVariableHandle*>(monContext);
     if (!manager || !handle) return;
 
+    // 句柄槽位注销后会被新变量复用：删除失败仍在发布的旧监控项，其monContext指向的槽位
+    // 可能已属于别的变量，监控项ID不符时丢弃
+    if (handle->monitoredItemId != monId) {
+        return;
+    }
+    const int arenaIndex = handle->arenaIndex;
+    const quint32 serial = handle->serial;
+
     // 2. 数据拷贝（必须深拷贝）
     UA_DataValue* valueCopy = UA_DataValue_new();
     UA_DataValue_init(valueCopy);
@@ -2577,11 +3711,11 @@ void OPCUAVariableManager::dataChangeNotificationCallback(
 
     // 5. 提交到专用线程池
     QtConcurrent::run(threadPools[poolIndex],
-                      [manager, handle, valueCopy, tagName]() {
+                      [manager, handle, arenaIndex, serial, valueCopy, tagName]() {
                           // 关键：异常安全的数据处理
                           try {
                               if (manager && handle && valueCopy) {
-                                  manager->updateVariableFromCallback(handle, valueCopy);
+                                  manager->updateVariableFromCallback(handle, arenaIndex, serial, valueCopy);
                               }
                           } catch (...) {
                               qWarning() << "处理变量" << tagName << "时发生异常";
@@ -2954,13 +4088,14 @@ void OPCUAVariableManager::dataChangeNotificationCallback(    UA_Client* client,
 
 
 void OPCUAVariableManager::updateVariableFromCallback(OPCUAVariableHandle* handle,
+                                                      int arenaIndex, quint32 serial,
                                                       UA_DataValue* value)
 {
    // qDebug() << "\n=== 处理回调数据 (使用复制数据) ===";
    // qDebug() << "变量:" << (handle ? handle->tagName : "NULL");
    // qDebug() << "DataValue指针:" << value;
     //qDebug()<<"updateVariableFromCallback函数线程号"<<QThread::currentThreadId();
-    if (!handle || !value || !handle->variableDef) {
+    if (!handle || !value) {
         qDebug() << "错误: 参数无效";
         return;
     }
@@ -2984,26 +4119,39 @@ void OPCUAVariableManager::updateVariableFromCallback(OPCUAVariableHandle* handl
     }
 
     if (qtValue.isValid()) {
-        // 更新时间戳
-        QDateTime timestamp = QDateTime::currentDateTime();
-        if (value->hasSourceTimestamp) {
-            timestamp = QDateTime::fromMSecsSinceEpoch(
-                UA_DateTime_toUnixTime(value->sourceTimestamp) * 1000);
+        // 源时间戳与UA_DateTime表示相同，直接写入，不截断到秒
+        UaTimestamp timestamp = value->hasSourceTimestamp ? value->sourceTimestamp : UaTime::now();
+
+        // 排队期间句柄可能已注销，槽位也可能已给了别的变量：在读锁内核对槽位和序号后再写入，
+        // 注销和clearVariables持有写锁，写入期间句柄和变量定义不会被释放
+        QReadLocker locker(&m_variablesLock);
+        if (!m_handleArena.contains(arenaIndex) || m_handleArena.at(arenaIndex) != handle ||
+            handle->serial != serial || !handle->variableDef) {
+            return;
         }
 
         // 更新变量定义
         handle->variableDef->setValue(qtValue,
                                       timestamp,
                                       statusCodeToQuality(value->status));
+        if (m_stalenessMonitor) {
+            m_stalenessMonitor->updated(handle->variableDef);
+        }
 
         // 更新缓存
         handle->lastValue = qtValue;
         handle->lastStatus.quality = statusCodeToQuality(value->status);
-
-        // 发出信号
-        emit variableValueChanged(handle->tagName, qtValue,
-                                  timestamp,
-                                  statusCodeToQuality(value->status));
+        const QString tagName = handle->tagName;
+        locker.unlock();
+
+        // 发出信号（批量通知时由消费者取走变化；QDateTime只在有接收者时构造）
+        static const QMetaMethod changedSignal =
+            QMetaMethod::fromSignal(&OPCUAVariableManager::variableValueChanged);
+        if (!m_batchedChanges.load(std::memory_order_relaxed) && isSignalConnected(changedSignal)) {
+            emit variableValueChanged(tagName, qtValue,
+                                      UaTime::toDateTime(timestamp),
+                                      statusCodeToQuality(value->status));
+        }
 
        // qDebug() << "✅ 数据更新成功";
     } else {
@@ -3013,6 +4161,21 @@ void OPCUAVariableManager::updateVariableFromCallback(OPCUAVariableHandle* handl
 
 
 
+void OPCUAVariableManager::subscriptionInactivityCallback(
+    UA_Client *client, UA_UInt32 subId, void *subContext)//订阅在保活周期内没有收到发布响应
+{
+    Q_UNUSED(client);
+
+    OPCUAVariableManager* manager = static_cast<OPCUAVariableManager*>(subContext);
+    if (!manager || subId != manager->m_subscriptionId) {
+        return;
+    }
+
+    // 在run_iterate内部回调，不能在此处发起同步读取，交给下一次心跳显式读取
+    qWarning() << "Subscription" << subId << "inactive, keepalive will verify the connection";
+    manager->m_connectionManager->notifySubscriptionInactive();
+}
+
 void OPCUAVariableManager::deleteSubscriptionCallback(
     UA_Client *client, UA_UInt32 subId, void *subContext)//OPC UA 订阅被删除时的回调函数
 {
@@ -3037,6 +4200,143 @@ void OPCUAVariableManager::deleteSubscriptionCallback(
                               Q_ARG(UA_UInt32, subId));
 }
 
+void OPCUAVariableManager::eventNotificationCallback(
+    UA_Client *client, UA_UInt32 subId, void *subContext,
+    UA_UInt32 monId, void *monContext,
+    size_t nEventFields, UA_Variant *eventFields)//OPC UA 事件通知回调（报警/条件事件）
+{
+    Q_UNUSED(client);
+    Q_UNUSED(subId);
+    Q_UNUSED(monId);
+
+    OPCUAVariableManager* manager = static_cast<OPCUAVariableManager*>(subContext);
+    if (!manager || !eventFields) return;
+
+    manager->m_connectionManager->notifyActivity();
+
+    // 上下文是监控编号：监控已删除（监控项删除失败时仍会有通知）则查不到，直接丢弃
+    const quint32 monitorId = static_cast<quint32>(reinterpret_cast<quintptr>(monContext));
+    std::shared_ptr<OPCUAEventHandle> handle;
+    {
+        QReadLocker locker(&manager->m_eventMonitorsLock);
+        handle = manager->m_eventMonitorsById.value(monitorId);
+    }
+    if (!handle) return;
+
+    // 按select子句顺序把事件字段转换成Qt类型（回调返回后eventFields即失效）
+    const QStringList &selectFields = handle->config.selectFields;
+    QVariantMap fields;
+    size_t count = qMin(nEventFields, static_cast<size_t>(selectFields.size()));
+    for (size_t i = 0; i < count; i++) {
+        fields.insert(selectFields.at(static_cast<int>(i)),
+                      manager->eventFieldToQVariant(eventFields[i]));
+    }
+
+    // 在管理器线程中处理，按名称查找句柄，避免句柄已被删除
+    QString monitorName = handle->name;
+    QMetaObject::invokeMethod(manager, [manager, monitorName, fields]() {
+        manager->processEventNotification(monitorName, fields);
+    }, Qt::QueuedConnection);
+}
+
+void OPCUAVariableManager::processEventNotification(const QString &monitorName,
+                                                    const QVariantMap &fields)//事件映射到报警信号
+{
+    std::shared_ptr<OPCUAEventHandle> handle;
+    {
+        QReadLocker locker(&m_eventMonitorsLock);
+        handle = m_eventMonitors.value(monitorName);
+    }
+    if (!handle) return;
+
+    emit eventReceived(monitorName, fields);
+
+    // 只处理带有来源的事件，来源映射到标签名
+    QString sourceName = fields.value("SourceName").toString();
+    if (sourceName.isEmpty()) return;
+    QString tagName = handle->config.sourceToTag.value(sourceName, sourceName);
+
+    // 没有ActiveState的普通事件视为一次触发
+    bool active = fields.contains("ActiveState/Id")
+                      ? fields.value("ActiveState/Id").toBool() : true;
+    AlarmLevel level = severityToAlarmLevel(fields.value("Severity").toInt());
+
+    // 取当前过程值，事件本身不携带过程值；lastValue由回调线程在读锁下写入，
+    // 这里从变量定义的值单元读（顺序锁，无锁且一致）
+    VariableDefinition *variableDef = nullptr;
+    double value = 0.0;
+    {
+        QReadLocker locker(&m_variablesLock);
+        auto it = m_variables.constFind(tagName);
+        if (it != m_variables.constEnd()) {
+            variableDef = it.value()->variableDef;
+            if (variableDef) {
+                value = variableDef->doubleValue();
+            }
+        }
+    }
+
+    if (variableDef && handle->config.offloadClientAlarm && !variableDef->serverAlarmEnabled()) {
+        variableDef->setServerAlarmEnabled(true);
+    }
+
+    if (active) {
+        handle->activeAlarms.insert(tagName, level);
+        if (variableDef) {
+            variableDef->setServerAlarmState(level);
+        }
+        emit alarmTriggered(tagName, level, value);
+    } else if (handle->activeAlarms.remove(tagName) > 0) {
+        if (variableDef) {
+            variableDef->setServerAlarmState(ALARM_NONE);
+        }
+        emit alarmCleared(tagName);
+    }
+}
+
+QVariant OPCUAVariableManager::eventFieldToQVariant(const UA_Variant &field) const//事件字段转换
+{
+    if (UA_Variant_isEmpty(&field) || !UA_Variant_isScalar(&field)) {
+        return QVariant();
+    }
+
+    // 事件字段中常见的非数值类型单独处理，其余走通用转换
+    if (field.type == &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]) {
+        const UA_LocalizedText *text = static_cast<const UA_LocalizedText*>(field.data);
+        return QString::fromUtf8(reinterpret_cast<const char*>(text->text.data),
+                                 static_cast<int>(text->text.length));
+    }
+    if (field.type == &UA_TYPES[UA_TYPES_STRING]) {
+        const UA_String *str = static_cast<const UA_String*>(field.data);
+        return QString::fromUtf8(reinterpret_cast<const char*>(str->data),
+                                 static_cast<int>(str->length));
+    }
+    if (field.type == &UA_TYPES[UA_TYPES_BYTESTRING]) {
+        const UA_ByteString *bytes = static_cast<const UA_ByteString*>(field.data);
+        return QByteArray(reinterpret_cast<const char*>(bytes->data),
+                          static_cast<int>(bytes->length));
+    }
+    if (field.type == &UA_TYPES[UA_TYPES_DATETIME]) {
+        UA_DateTime dt = *static_cast<const UA_DateTime*>(field.data);
+        return QDateTime::fromMSecsSinceEpoch(
+            (dt - UA_DATETIME_UNIX_EPOCH) / UA_DATETIME_MSEC);
+    }
+    if (field.type == &UA_TYPES[UA_TYPES_NODEID]) {
+        return nodeIdToString(*static_cast<const UA_NodeId*>(field.data));
+    }
+
+    return uaVariantToQVariant(field);
+}
+
+AlarmLevel OPCUAVariableManager::severityToAlarmLevel(int severity)//OPC UA Severity(1-1000)转报警等级
+{
+    if (severity >= 800) return ALARM_CRITICAL;
+    if (severity >= 600) return ALARM_MAJOR;
+    if (severity >= 400) return ALARM_MINOR;
+    if (severity >= 200) return ALARM_WARNING;
+    return ALARM_INFO;
+}
+
 
 
 /*
@@ -3218,6 +4518,8 @@ void OPCUAVariableManager::cleanup()
     {
         QWriteLocker locker(&m_variablesLock);
         m_variables.clear();
+        m_retiredHandles.clear();
+        m_handleArena.clear();
     }
 
     // 清理同步等待
@@ -3475,7 +4777,9 @@ bool OPCUAVariableManager::createSubscription()//创建阅订
     request.requestedPublishingInterval = m_subscriptionConfig.publishingInterval;
     request.requestedLifetimeCount = m_subscriptionConfig.lifetimeCount;// 生命周期计数60
     request.requestedMaxKeepAliveCount = m_subscriptionConfig.maxKeepAliveCount; // 最大保活计数10
-    request.maxNotificationsPerPublish = 100; // 无限制
+    //request.maxNotificationsPerPublish = 100; // 无限制
+    // 按变量数量放大，0表示不限制；这里由定时器或API调用进入，不在持有连接管理器锁的回调中
+    request.maxNotificationsPerPublish = m_connectionManager->effectiveConnectionTuning().maxNotificationsPerPublish;
     request.publishingEnabled = true; // 启用发布
     request.priority = m_subscriptionConfig.priority;// 订阅优先级
      //  创建订阅
@@ -3484,6 +4788,14 @@ bool OPCUAVariableManager::createSubscription()//创建阅订
     // 处理响应 清理资源
     if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
         m_subscriptionId = response.subscriptionId;
+        // 服务器在 发布间隔*保活计数 内至少发送一次发布响应（数据或保活），心跳据此推断通道状态
+        m_connectionManager->setSubscriptionKeepaliveWindow(
+            static_cast<int>(response.revisedPublishingInterval * response.revisedMaxKeepAliveCount));
+        m_connectionManager->notifyActivity();
+        UA_ClientConfig *config = UA_Client_getConfig(m_connectionManager->client());
+        if (config) {
+            config->subscriptionInactivityCallback = subscriptionInactivityCallback;
+        }
         UA_CreateSubscriptionResponse_clear(&response);
         return true;
     } else {
@@ -3505,6 +4817,7 @@ bool OPCUAVariableManager::deleteSubscription()//删除阅订
 
     if (status == UA_STATUSCODE_GOOD) {
         m_subscriptionId = 0;
+        m_connectionManager->setSubscriptionKeepaliveWindow(0);
         return true;
     } else {
         qWarning() << "Failed to delete subscription:" << UA_StatusCode_name(status);
@@ -3596,6 +4909,8 @@ bool OPCUAVariableManager::createMonitoredItem(OPCUAVariableHandle *handle)
     if (result.statusCode == UA_STATUSCODE_GOOD) {
         handle->monitoredItemId = result.monitoredItemId;
         handle->isSubscribed = true;
+        handle->revisedSamplingInterval = result.revisedSamplingInterval;
+        watchStaleness(handle);
 
         qDebug() << "监控项创建成功：" << handle->tagName
                  << "ID：" << handle->monitoredItemId
@@ -3626,6 +4941,10 @@ bool OPCUAVariableManager::deleteMonitoredItem(OPCUAVariableHandle *handle)//删
         if (status == UA_STATUSCODE_GOOD) {
             handle->isSubscribed = false;
             handle->monitoredItemId = 0;
+            handle->revisedSamplingInterval = 0.0;
+            if (m_stalenessMonitor && handle->variableDef) {
+                m_stalenessMonitor->unwatch(handle->variableDef);
+            }
 
             qDebug() << "Deleted monitored item for variable:" << handle->tagName;
             return true;
@@ -3635,6 +4954,267 @@ bool OPCUAVariableManager::deleteMonitoredItem(OPCUAVariableHandle *handle)//删
     return false;
 }
 
+int OPCUAVariableManager::createMonitoredItems(const QList<OPCUAVariableHandle*> &handles)//一次请求批量创建监控项
+{
+    if (m_subscriptionId == 0 || handles.isEmpty() || !m_connectionManager->client()) {
+        return 0;
+    }
+
+    const size_t count = static_cast<size_t>(handles.size());
+
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = m_subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.itemsToCreateSize = count;
+    request.itemsToCreate = static_cast<UA_MonitoredItemCreateRequest*>(
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_MONITOREDITEMCREATEREQUEST]));
+
+    QVector<void*> contexts(handles.size());
+    QVector<UA_Client_DataChangeNotificationCallback> callbacks(handles.size(), dataChangeNotificationCallback);
+    QVector<UA_Client_DeleteMonitoredItemCallback> deleteCallbacks(handles.size(), nullptr);
+
+    for (int i = 0; i < handles.size(); i++) {
+        UA_MonitoredItemCreateRequest &item = request.itemsToCreate[i];
+        UA_NodeId_copy(&handles[i]->nodeId, &item.itemToMonitor.nodeId);
+        item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+        item.requestedParameters.samplingInterval = m_monitoredItemConfig.samplingInterval;
+        item.requestedParameters.discardOldest = m_monitoredItemConfig.discardOldest;
+        item.requestedParameters.queueSize = m_monitoredItemConfig.queueSize;
+        contexts[i] = handles[i];
+    }
+
+    UA_CreateMonitoredItemsResponse response = UA_Client_MonitoredItems_createDataChanges(
+        m_connectionManager->client(), request, contexts.data(),
+        callbacks.data(), deleteCallbacks.data());
+
+    int created = 0;
+    if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD) {
+        for (size_t i = 0; i < response.resultsSize && i < count; i++) {
+            OPCUAVariableHandle *handle = handles[static_cast<int>(i)];
+            if (response.results[i].statusCode == UA_STATUSCODE_GOOD) {
+                handle->monitoredItemId = response.results[i].monitoredItemId;
+                handle->isSubscribed = true;
+                handle->revisedSamplingInterval = response.results[i].revisedSamplingInterval;
+                watchStaleness(handle);
+                created++;
+            } else {
+                qWarning() << "监控项创建失败：" << handle->tagName
+                           << "错误：" << UA_StatusCode_name(response.results[i].statusCode);
+            }
+        }
+    } else {
+        qWarning() << "批量创建监控项失败："
+                   << UA_StatusCode_name(response.responseHeader.serviceResult);
+    }
+
+    qDebug() << "批量创建监控项：" << created << "/" << handles.size();
+
+    UA_CreateMonitoredItemsRequest_clear(&request);
+    UA_CreateMonitoredItemsResponse_clear(&response);
+    return created;
+}
+
+const int OPCUAVariableManager::MONITORED_ITEMS_PER_REQUEST;
+
+int OPCUAVariableManager::createMonitoredItemsInBatches(const QList<OPCUAVariableHandle*> &handles)
+{
+    int created = 0;
+    for (int start = 0; start < handles.size(); start += MONITORED_ITEMS_PER_REQUEST) {
+        created += createMonitoredItems(handles.mid(start, MONITORED_ITEMS_PER_REQUEST));
+    }
+    return created;
+}
+
+void OPCUAVariableManager::watchStaleness(OPCUAVariableHandle *handle)
+{
+    if (!m_stalenessMonitor || !handle->variableDef) {
+        return;
+    }
+
+    // 值不变时服务器不发通知，期望周期取采样间隔与订阅保活周期中较长的一个，避免平稳的值被误判为陈旧
+    const double keepAlive = m_subscriptionConfig.publishingInterval * m_subscriptionConfig.maxKeepAliveCount;
+    const double interval = qMax(handle->revisedSamplingInterval, keepAlive);
+    m_stalenessMonitor->watch(handle->variableDef, qMax(1, qRound(interval)));
+}
+
+void OPCUAVariableManager::onStalenessConnectionLost()
+{
+    if (!m_stalenessMonitor) {
+        return;
+    }
+
+    QList<VariableDefinition*> subscribed;
+    {
+        QReadLocker locker(&m_variablesLock);
+        subscribed.reserve(m_variables.size());
+        for (const auto &handle : m_variables) {
+            if (handle && handle->isSubscribed && handle->variableDef) {
+                subscribed.append(handle->variableDef);
+            }
+        }
+    }
+    m_stalenessMonitor->markCommFail(subscribed);
+}
+
+bool OPCUAVariableManager::createEventMonitoredItem(OPCUAEventHandle *handle)//创建事件监控项
+{
+    if (m_subscriptionId == 0 || !handle || !m_connectionManager->client()) {
+        qDebug() << "创建事件监控项失败：参数无效";
+        return false;
+    }
+
+    const EventMonitorConfig &config = handle->config;
+
+    // select子句：每个字段一个SimpleAttributeOperand，BrowsePath按'/'拆分
+    UA_EventFilter *filter = UA_EventFilter_new();
+    filter->selectClausesSize = static_cast<size_t>(config.selectFields.size());
+    filter->selectClauses = static_cast<UA_SimpleAttributeOperand*>(
+        UA_Array_new(filter->selectClausesSize, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]));
+
+    for (int i = 0; i < config.selectFields.size(); i++) {
+        UA_SimpleAttributeOperand &clause = filter->selectClauses[i];
+        QStringList path = config.selectFields.at(i).split('/', Qt::SkipEmptyParts);
+
+        clause.typeDefinitionId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+        clause.attributeId = UA_ATTRIBUTEID_VALUE;
+        clause.browsePathSize = static_cast<size_t>(path.size());
+        clause.browsePath = static_cast<UA_QualifiedName*>(
+            UA_Array_new(clause.browsePathSize, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]));
+        for (int j = 0; j < path.size(); j++) {
+            clause.browsePath[j].namespaceIndex = 0;
+            clause.browsePath[j].name = qStringToUAString(path.at(j));
+        }
+    }
+
+    // where子句：OfType(AlarmConditionType) AND Severity >= minSeverity
+    bool filterType = config.alarmConditionsOnly;
+    bool filterSeverity = config.minSeverity > 0;
+    size_t elementCount = (filterType ? 1 : 0) + (filterSeverity ? 1 : 0);
+    if (elementCount == 2) {
+        elementCount = 3;  // 第0个元素为AND
+    }
+
+    if (elementCount > 0) {
+        UA_ContentFilter &where = filter->whereClause;
+        where.elementsSize = elementCount;
+        where.elements = static_cast<UA_ContentFilterElement*>(
+            UA_Array_new(elementCount, &UA_TYPES[UA_TYPES_CONTENTFILTERELEMENT]));
+
+        size_t index = 0;
+        if (elementCount == 3) {
+            UA_ContentFilterElement &andElement = where.elements[index++];
+            andElement.filterOperator = UA_FILTEROPERATOR_AND;
+            andElement.filterOperandsSize = 2;
+            andElement.filterOperands = static_cast<UA_ExtensionObject*>(
+                UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+            for (UA_UInt32 k = 0; k < 2; k++) {
+                UA_ElementOperand *operand = UA_ElementOperand_new();
+                operand->index = k + 1;
+                UA_ExtensionObject_setValue(&andElement.filterOperands[k], operand,
+                                            &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+            }
+        }
+
+        if (filterType) {
+            UA_ContentFilterElement &typeElement = where.elements[index++];
+            typeElement.filterOperator = UA_FILTEROPERATOR_OFTYPE;
+            typeElement.filterOperandsSize = 1;
+            typeElement.filterOperands = static_cast<UA_ExtensionObject*>(
+                UA_Array_new(1, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+            UA_LiteralOperand *typeOperand = UA_LiteralOperand_new();
+            UA_NodeId alarmType = UA_NODEID_NUMERIC(0, UA_NS0ID_ALARMCONDITIONTYPE);
+            UA_Variant_setScalarCopy(&typeOperand->value, &alarmType, &UA_TYPES[UA_TYPES_NODEID]);
+            UA_ExtensionObject_setValue(&typeElement.filterOperands[0], typeOperand,
+                                        &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+        }
+
+        if (filterSeverity) {
+            UA_ContentFilterElement &severityElement = where.elements[index++];
+            severityElement.filterOperator = UA_FILTEROPERATOR_GREATERTHANOREQUAL;
+            severityElement.filterOperandsSize = 2;
+            severityElement.filterOperands = static_cast<UA_ExtensionObject*>(
+                UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+
+            UA_SimpleAttributeOperand *severityOperand = UA_SimpleAttributeOperand_new();
+            severityOperand->typeDefinitionId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+            severityOperand->attributeId = UA_ATTRIBUTEID_VALUE;
+            severityOperand->browsePathSize = 1;
+            severityOperand->browsePath = UA_QualifiedName_new();
+            severityOperand->browsePath[0] = UA_QUALIFIEDNAME_ALLOC(0, "Severity");
+            UA_ExtensionObject_setValue(&severityElement.filterOperands[0], severityOperand,
+                                        &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+
+            UA_LiteralOperand *limitOperand = UA_LiteralOperand_new();
+            UA_UInt16 minSeverity = config.minSeverity;
+            UA_Variant_setScalarCopy(&limitOperand->value, &minSeverity, &UA_TYPES[UA_TYPES_UINT16]);
+            UA_ExtensionObject_setValue(&severityElement.filterOperands[1], limitOperand,
+                                        &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+        }
+    }
+
+    // 事件监控项：监控通知源的EventNotifier属性
+    UA_MonitoredItemCreateRequest monRequest;
+    UA_MonitoredItemCreateRequest_init(&monRequest);
+    UA_NodeId_copy(&handle->notifierId, &monRequest.itemToMonitor.nodeId);
+    monRequest.itemToMonitor.attributeId = UA_ATTRIBUTEID_EVENTNOTIFIER;
+    monRequest.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    monRequest.requestedParameters.samplingInterval = 0.0;
+    monRequest.requestedParameters.queueSize = config.queueSize;
+    monRequest.requestedParameters.discardOldest = true;
+    UA_ExtensionObject_setValue(&monRequest.requestedParameters.filter, filter,
+                                &UA_TYPES[UA_TYPES_EVENTFILTER]);
+
+    UA_MonitoredItemCreateResult result = UA_Client_MonitoredItems_createEvent(
+        m_connectionManager->client(), m_subscriptionId, UA_TIMESTAMPSTORETURN_BOTH,
+        monRequest, reinterpret_cast<void*>(static_cast<quintptr>(handle->id)),
+        eventNotificationCallback, nullptr);
+
+    UA_MonitoredItemCreateRequest_clear(&monRequest);  // 同时释放filter
+
+    if (result.statusCode == UA_STATUSCODE_GOOD) {
+        handle->monitoredItemId = result.monitoredItemId;
+        handle->isSubscribed = true;
+
+        qDebug() << "事件监控项创建成功：" << handle->name
+                 << "ID：" << handle->monitoredItemId;
+
+        UA_MonitoredItemCreateResult_clear(&result);
+        return true;
+    } else {
+        qWarning() << "事件监控项创建失败：" << handle->name
+                   << "错误：" << UA_StatusCode_name(result.statusCode);
+        recordError(QString("Failed to create event monitored item %1: %2")
+                        .arg(handle->name, UA_StatusCode_name(result.statusCode)));
+
+        UA_MonitoredItemCreateResult_clear(&result);
+        return false;
+    }
+}
+
+bool OPCUAVariableManager::deleteEventMonitoredItem(OPCUAEventHandle *handle)//删除事件监控项
+{
+    if (!handle || !handle->isSubscribed || m_subscriptionId == 0) {
+        return false;
+    }
+
+    if (handle->monitoredItemId > 0) {
+        UA_StatusCode status = UA_Client_MonitoredItems_deleteSingle(
+            m_connectionManager->client(), m_subscriptionId, handle->monitoredItemId);
+
+        if (status == UA_STATUSCODE_GOOD) {
+            handle->isSubscribed = false;
+            handle->monitoredItemId = 0;
+
+            qDebug() << "Deleted event monitored item:" << handle->name;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 QString OPCUAVariableManager::connectionStateToString(ConnectionState state) const//将链接状态转换为字符串
 {
    return  m_connectionManager->connectionStateName();
@@ -19,11 +19,19 @@
 #include <atomic>
 #include <QHash>
 #include <memory>
+#include <vector>
 #include <cmath>
 #include "variablesystem.h"
+#include "batchconverter.h"
+#include "alarmevaluator.h"
+#include "tagindex.h"
+#include "stalenessmonitor.h"
+#include "variablearena.h"
+#include "accesscontrol.h"
 #include <QMutexLocker>
 #include <QVariant>
 #include <QUuid>
+#include <QPointer>
 // 条件编译确保 open62541.h 只包含一次
 #ifndef OPEN62541_H_INCLUDED
 #include "open62541.h"
@@ -70,6 +78,10 @@ struct ReconnectPolicy {
     bool exponentialBackoff = true; // 是否使用指数退避
     int keepaliveInterval = 5000;  // 心跳间隔(ms)
     int keepaliveTimeout = 15000;   // 心跳超时(ms)
+    int keepaliveSilenceThreshold = 0; // 通道静默超过该时间才发送显式心跳读取(ms)，0表示自动（有订阅时按订阅保活周期）
+    int jitterPercent = 25;         // 重连延迟随机抖动（±百分比），避免多个客户端同时重连
+    int restoreBatchSize = 200;     // 重连后每批恢复的监控项数量
+    int restoreStageInterval = 200; // 重连后两批监控项恢复之间的间隔(ms)
 
     ReconnectPolicy() = default;
 
@@ -78,6 +90,54 @@ struct ReconnectPolicy {
         delayMultiplier(multiplier) {}
 };
 
+// 连接传输配置（缓冲区/消息大小/分块数在HEL/ACK握手时协商，下一次建立安全通道时生效）。
+// autoSize按建立安全通道时已注册的变量数量计算：先注册变量（或setExpectedTagCount）再连接，
+// 首次连接就能按实际规模协商；连接后再大量注册时，新规模要等安全通道重建（重连或通道续期失败）才生效
+struct ConnectionTuning {
+    UA_UInt32 sendBufferSize = 65536;       // 发送缓冲区（单个分块大小）(bytes)
+    UA_UInt32 recvBufferSize = 65536;       // 接收缓冲区（单个分块大小）(bytes)
+    UA_UInt32 maxMessageSize = 16 * 1024 * 1024; // 最大消息大小(bytes)，0表示不限制
+    UA_UInt32 maxChunkCount = 512;          // 最大分块数，0表示不限制
+    UA_UInt32 secureChannelLifetime = 600000;   // 安全通道生命周期(ms)
+    UA_UInt32 sessionTimeout = 1200000;     // 请求的会话超时(ms)
+    UA_UInt32 maxNotificationsPerPublish = 100; // 每个发布响应最多携带的通知数，0表示不限制
+    bool autoSize = true;                   // 按已注册变量数量自动计算缓冲区、消息大小和分块数
+    int bytesPerTag = 64;                   // 估算每个变量在读响应/数据变化通知中的编码大小(bytes)
+
+    ConnectionTuning() = default;
+
+    ConnectionTuning(UA_UInt32 bufferSize, UA_UInt32 messageSize, UA_UInt32 chunkCount)
+        : sendBufferSize(bufferSize), recvBufferSize(bufferSize),
+        maxMessageSize(messageSize), maxChunkCount(chunkCount), autoSize(false) {}
+
+    // 根据变量数量计算配置：整批读取/一次发布全部变量的响应能放进一条消息，且分块数适中
+    ConnectionTuning sizedFor(int tagCount) const;
+    bool coveredBy(const ConnectionTuning &negotiated) const;//缓冲区、消息大小和分块数都不超过negotiated
+};
+
+// 安全策略
+enum SecurityPolicyType {
+    SECURITY_POLICY_NONE = 0,               // 不加密
+    SECURITY_POLICY_BASIC256SHA256 = 1,     // Basic256Sha256
+    SECURITY_POLICY_AES128_SHA256_RSAOAEP = 2 // Aes128_Sha256_RsaOaep
+};
+
+// 安全配置（Sign/SignAndEncrypt需要open62541编译时启用UA_ENABLE_ENCRYPTION）
+struct SecurityConfig {
+    SecurityPolicyType policy = SECURITY_POLICY_NONE;
+    UA_MessageSecurityMode mode = UA_MESSAGESECURITYMODE_NONE; // None/Sign/SignAndEncrypt
+    QString certificatePath = "pki/own/client_cert.der";    // 客户端证书(DER)，不存在时自动生成并保存
+    QString privateKeyPath = "pki/own/client_key.der";      // 客户端私钥(DER)
+    QStringList trustListPaths;                             // 信任的服务器证书(DER)
+    QString applicationUri = "urn:Industrial:OPCUAClient";  // 必须与证书中的URI一致
+    bool reuseSession = true;       // 重连时只重建安全通道，通过ActivateSession复用原会话
+
+    SecurityConfig() = default;
+
+    SecurityConfig(SecurityPolicyType p, UA_MessageSecurityMode m)
+        : policy(p), mode(m) {}
+};
+
 // 节点状态
 struct NodeStatus {
     UA_StatusCode status;
@@ -108,6 +168,9 @@ struct SessionStatistics {
     QDateTime lastConnectTime;
     QDateTime lastDisconnectTime;
     int currentReconnectAttempt = 0;
+    int sessionReactivations = 0;   // 重连时复用会话（ActivateSession）的次数
+    int keepaliveReads = 0;         // 显式读取服务器时间的心跳次数
+    int keepalivesInferred = 0;     // 由订阅通知推断通道存活、省去显式读取的心跳次数
 
     SessionStatistics() = default;
 };
@@ -169,13 +232,19 @@ struct OPCUAVariableHandle {
     QVariant lastValue;  // 最后一次读取的值（转换为Qt类型）
     bool isSubscribed; // 是否已建立数据订阅（用于变化通知）
     bool isBrowsed;  // 节点是否已浏览
+    double revisedSamplingInterval; // 服务器修订后的采样间隔(ms)，未订阅时为0
+    int arenaIndex;  // 在管理器句柄块中的编号，注销前不变
+    quint32 serial;  // 创建时分配、不重复的序号；槽位被复用后排队的回调据此识别旧句柄
 
     OPCUAVariableHandle()
         : monitoredItemId(0),
         variableDef(nullptr),
         lastValue(QVariant()),
         isSubscribed(false),
-        isBrowsed(false) {
+        isBrowsed(false),
+        revisedSamplingInterval(0.0),
+        arenaIndex(-1),
+        serial(0) {
         UA_NodeId_init(&nodeId);
     }
 
@@ -202,6 +271,9 @@ struct OPCUAVariableHandle {
             lastValue = other.lastValue;
             isSubscribed = other.isSubscribed;
             isBrowsed = other.isBrowsed;
+            revisedSamplingInterval = other.revisedSamplingInterval;
+            arenaIndex = other.arenaIndex;
+            serial = other.serial;
 
             // 防止双重释放
             UA_NodeId_init(&other.nodeId);
@@ -251,6 +323,72 @@ struct MonitoredItemConfig {
         clientHandle(0) {}
 };
 
+// 事件监控配置（报警/条件事件，由PLC/服务器计算报警，客户端只接收）
+struct EventMonitorConfig {
+    QString notifierAddress = "i=2253";   // 事件通知源节点，默认Server对象，也可以是具体设备对象
+    QStringList selectFields;             // select子句，BrowsePath用'/'分隔，如"ActiveState/Id"
+    bool alarmConditionsOnly = true;      // where子句：只接收AlarmConditionType及其子类型
+    UA_UInt16 minSeverity = 0;            // where子句：Severity >= minSeverity（0表示不过滤）
+    UA_UInt32 queueSize = 100;            // 服务器端事件队列大小
+    bool offloadClientAlarm = true;       // 收到服务器报警的变量不再做客户端限值判断
+    QHash<QString, QString> sourceToTag;  // SourceName -> 标签名映射（为空时SourceName即标签名）
+
+    EventMonitorConfig()
+        : selectFields({"EventId", "SourceName", "Time", "Message",
+                        "Severity", "ActiveState/Id", "AckedState/Id"}) {}
+};
+
+// OPC UA 事件监控句柄
+struct OPCUAEventHandle {
+    QString name;                          // 监控名称（用户定义）
+    quint32 id = 0;                        // 监控项上下文：回调按编号查找句柄，不持有裸指针
+    UA_NodeId notifierId;                  // 事件通知源节点
+    UA_UInt32 monitoredItemId = 0;         // 服务器分配的监控项ID
+    EventMonitorConfig config;             // 监控配置
+    bool isSubscribed = false;             // 是否已在订阅中创建
+    QHash<QString, AlarmLevel> activeAlarms; // 当前激活的报警（标签名 -> 等级）
+
+    OPCUAEventHandle() { UA_NodeId_init(&notifierId); }
+    ~OPCUAEventHandle() { UA_NodeId_clear(&notifierId); }
+
+    // 禁用拷贝
+    OPCUAEventHandle(const OPCUAEventHandle&) = delete;
+    OPCUAEventHandle& operator=(const OPCUAEventHandle&) = delete;
+};
+
+}
+
+// ==================== 全局重连限流器 ====================
+namespace Industrial {
+// 进程内所有OPCUAConnectionManager共享：限制同时重连的数量和重连开始的最小间隔，
+// 并根据所有连接最近的连续失败次数给出共享退避，网关重启时避免自己的重连风暴
+class ReconnectLimiter
+{
+public:
+    static ReconnectLimiter* instance();
+
+    void setMaxConcurrent(int count);//同时进行的重连数量
+    int maxConcurrent() const;
+    void setMinInterval(int intervalMs);//两次重连开始之间的最小间隔(ms)
+    int minInterval() const;
+
+    bool tryAcquire(int &retryAfterMs);//获取重连许可，失败时给出建议等待时间
+    void release(bool success);//重连完成，释放许可并记录结果
+    int sharedBackoff() const;//共享退避附加延迟(ms)
+    int activeCount() const;
+
+private:
+    ReconnectLimiter() = default;
+    ReconnectLimiter(const ReconnectLimiter&) = delete;
+    ReconnectLimiter& operator=(const ReconnectLimiter&) = delete;
+
+    mutable QMutex m_mutex;
+    int m_maxConcurrent = 2;     // 同时重连数
+    int m_minInterval = 200;     // 重连开始最小间隔(ms)
+    int m_active = 0;            // 正在进行的重连数
+    qint64 m_lastStartTime = 0;  // 最后一次重连开始时间
+    int m_sharedFailures = 0;    // 所有连接的连续失败次数
+};
 }
 
 // ==================== OPCUAConnectionManager 类 ====================
@@ -279,6 +417,25 @@ public:
     SessionStatistics statistics() const;
     void resetStatistics();
 
+    // 安全配置（下一次连接时生效）
+    void setSecurityConfig(const SecurityConfig &config);
+    SecurityConfig securityConfig() const;
+    static QString securityPolicyUri(SecurityPolicyType policy);
+
+    // 传输配置（下一次建立安全通道时生效）
+    void setConnectionTuning(const ConnectionTuning &tuning);
+    ConnectionTuning connectionTuning() const;
+    ConnectionTuning effectiveConnectionTuning() const;//autoSize时按变量数量计算后的实际配置
+    ConnectionTuning appliedConnectionTuning() const;//当前安全通道建立时使用的配置
+    bool connectionTuningOutdated() const;//已连接且按当前变量数量算出的配置超过当前通道协商的大小
+    void setExpectedTagCount(int count) { m_expectedTagCount.store(count); }
+    int expectedTagCount() const { return m_expectedTagCount.load(); }
+
+    // 订阅流量即心跳（可在客户端回调线程中调用，无锁）
+    void notifyActivity() { m_lastActivityTime.store(QDateTime::currentMSecsSinceEpoch(), std::memory_order_relaxed); }
+    void notifySubscriptionInactive() { m_subscriptionInactive.store(true); }
+    void setSubscriptionKeepaliveWindow(int windowMs) { m_subscriptionKeepaliveWindow.store(windowMs); }//0表示没有订阅
+
 
 public:
     // 获取连接信息
@@ -298,8 +455,12 @@ private:
     bool sendKeepalive();
     qint64 lastKeepaliveTime() const { return m_lastKeepaliveTime.load(); }
     bool isKeepaliveExpired() const;//检查心跳是否已超
+    int keepaliveSilenceThreshold() const;//需要显式心跳读取的静默时间
 
     bool performConnection();
+    bool applySecurityConfig(UA_ClientConfig *config);
+    bool loadOrCreateCertificate(QByteArray &certificate, QByteArray &privateKey);
+    void applyConnectionTuning(UA_ClientConfig *config);
     void updateState(ConnectionState newState);
     void scheduleReconnect();
     int calculateReconnectDelay();
@@ -340,11 +501,20 @@ private:
 
     ReconnectPolicy m_policy;// 重连策略
     SessionStatistics m_stats;// 统计信息
+    SecurityConfig m_security;// 安全配置
+    bool m_securityDirty = false;// 安全配置已修改，连接前需要重新应用
+    ConnectionTuning m_tuning;// 传输配置
+    ConnectionTuning m_appliedTuning;// 最近一次建立安全通道时按变量数量计算后应用的配置
+    mutable QMutex m_appliedTuningMutex;// 保护m_appliedTuning；连接路径可能已持有m_mutex，加锁顺序为先m_mutex后本锁
+    std::atomic<int> m_expectedTagCount{0};// 已注册变量数量，用于自动计算传输配置
 
     QTimer *m_keepaliveTimer; // 心跳定时器
     QTimer *m_reconnectTimer; // 重连定时器
     std::atomic<qint64> m_lastKeepaliveTime;// 最后心跳时间
-    std::atomic<qint64> m_lastActivityTime;// 最后活动时间
+    std::atomic<qint64> m_lastActivityTime;// 最后活动时间（心跳读取或订阅通知）
+    std::atomic<bool> m_subscriptionInactive{false};// 客户端报告订阅发布响应/保活超时
+    std::atomic<int> m_subscriptionKeepaliveWindow{0};// 服务器最长保活间隔(ms)，0表示没有订阅
+    std::atomic<int> m_keepalivesInferred{0};// 由订阅流量推断存活的次数
     std::atomic<int> m_reconnectAttempt; // 重连尝试次数
 
     mutable QMutex m_mutex; // 互斥锁
@@ -384,6 +554,13 @@ public:
     void setReconnectPolicy(const ReconnectPolicy &policy);
     ReconnectPolicy reconnectPolicy() const;
 
+    void setSecurityConfig(const SecurityConfig &config);//设置安全策略，下一次连接时生效
+    SecurityConfig securityConfig() const;
+
+    void setConnectionTuning(const ConnectionTuning &tuning);//设置缓冲区/消息大小，下一次建立安全通道时生效
+    ConnectionTuning connectionTuning() const;
+    bool connectionTuningOutdated() const;//连接后注册的变量超出了当前通道按注册数量协商的大小
+
     void setRequestTimeout(int timeoutMs);//设置异步操作的超时时间
     void setRetryCount(int count);//设置失败操作的重试次数
     void setMaxThreadCount(int count);//动态调整线程池大小
@@ -398,8 +575,36 @@ public:
     // ==================== 变量管理 ====================
     bool registerVariable(VariableDefinition *variable);
     bool registerVariables(const QList<VariableDefinition*> &variables);
+    // 按列描述批量注册：变量定义连续创建在本管理器的定义块中，地址在线程池中并行解析，
+    // 句柄表只加一次锁，订阅中时新变量的监控项按批创建。返回注册成功的变量数，失败的标签和原因追加到errors。
+    // 所有权：这些定义属于本管理器，unregisterVariable后仍保留，clearVariables或管理器析构时整块释放。
+    // 释放时每个定义发出QObject::destroyed，CalculationEngine、StalenessMonitor、StatisticsEngine和
+    // VariableGroup据此自动移除；RealTimeVariableManager和DataBlock不跟踪，调用clearVariables前须先移除
+    int registerVariables(const VariableColumns &columns, QStringList *errors = nullptr);
     bool unregisterVariable(const QString &tagName);
     void clearVariables();
+    ValueCellStore* valueStore() const { return m_valueStore.get(); }//本管理器变量的实时值单元
+    BatchConverter createBatchConverter() const { return BatchConverter(m_valueStore); }//轮询批量转换，每个线程一个
+    AlarmEvaluator createAlarmEvaluator() const { return AlarmEvaluator(m_valueStore); }//批量报警限值计算，每个线程一个
+
+    // 批量变化通知：开启后注册变量不再逐个发出值/质量/时间戳信号，本管理器也不再发出variableValueChanged，
+    // 消费者按自己的节奏调用takeChangedVariables()取走变化集合（只包含实时值在本管理器存储中的变量）
+    void setBatchedChangeNotification(bool enabled);
+    bool batchedChangeNotification() const { return m_batchedChanges.load(std::memory_order_relaxed); }
+    QList<VariableDefinition*> takeChangedVariables();//取走上次调用以来值或质量变化的变量
+
+    // 陈旧检测：订阅成功的变量按服务器修订后的采样间隔（不短于订阅保活周期）登记，
+    // 收到数据时通知监视器，连接丢失时全部置为QUALITY_COMM_FAIL
+    void setStalenessMonitor(StalenessMonitor *monitor);
+    StalenessMonitor* stalenessMonitor() const { return m_stalenessMonitor; }
+
+    // 写入权限：设置后单个写入和批量写入在排队前按当前用户的权限位检查，批量写入有一个变量被拒绝时整批不写；
+    // 未设置时只检查writable
+    void setWriteAccessControl(const std::shared_ptr<WriteAccessControl> &control);
+    std::shared_ptr<WriteAccessControl> writeAccessControl() const;
+
+    // 注册变量的内存占用，按句柄、节点标识、变量定义、值单元等分项统计
+    TagMemoryUsage memoryUsage() const;
 
     bool browseVariableNode(const QString &tagName);
     bool browseAllVariables();
@@ -424,11 +629,25 @@ public:
     void setPollingInterval(int intervalMs);
     int pollingInterval() const;
 
+    // ==================== 事件/报警订阅 ====================
+    bool addEventMonitor(const QString &name,
+                         const EventMonitorConfig &config = EventMonitorConfig());
+    bool removeEventMonitor(const QString &name);
+    QStringList eventMonitorNames() const;
+
     // ==================== 查询方法 ====================
+    // 返回的指针不转移所有权：registerVariable注册的定义仍属于调用者；批量注册创建的定义属于本管理器，
+    // clearVariables后失效（见registerVariables(const VariableColumns&)）
     VariableDefinition* getVariable(const QString &tagName) const;
     QList<VariableDefinition*> getAllVariables() const;
     QList<QString> getRegisteredTagNames() const;
 
+    // 按标签名索引查询，返回本管理器的值单元编号（与takeChangedVariables、AlarmEvaluator的tagId相同），按标签名排序
+    QVector<quint32> findTagIds(const QString &pattern) const;          // 段通配，如"AREA1.*.TT*.PV"
+    QVector<quint32> findTagIdsByPrefix(const QString &prefix) const;
+    QVector<quint32> findTagIdsByRegex(const QRegularExpression &regex) const;
+    QList<VariableDefinition*> findVariables(const QString &pattern) const;
+
     OPCUAVariableHandle* getVariableHandle(const QString &tagName) const;
     NodeStatus getVariableStatus(const QString &tagName) const;
     QVariant getLastValue(const QString &tagName) const;
@@ -488,6 +707,10 @@ signals:
     // ==================== 报警信号 ====================
     void alarmTriggered(const QString &tagName, AlarmLevel level, double value);
     void alarmCleared(const QString &tagName);
+    void eventReceived(const QString &monitorName, const QVariantMap &fields);
+
+    // ==================== 订阅恢复信号 ====================
+    void subscriptionRestoreProgress(int restored, int total);
 
     // ==================== 心跳信号 ====================
     void heartbeatReceived();
@@ -540,8 +763,10 @@ private slots:
     // ==================== 内部槽 ====================
     void onInternalReconnect();
     //void onKeepaliveReceived();
+    void onRestoreTimer();//分批恢复监控项
 
-    void updateVariableFromCallback(OPCUAVariableHandle* handle,
+    // arenaIndex/serial为回调时句柄的槽位和序号，处理前在读锁内核对，句柄已注销或槽位已复用时丢弃
+    void updateVariableFromCallback(OPCUAVariableHandle* handle, int arenaIndex, quint32 serial,
                                     UA_DataValue* value);
 
 
@@ -558,6 +783,21 @@ private:
     // ==================== 变量管理 ====================
     QHash<QString, std::shared_ptr<OPCUAVariableHandle>> m_variables;
     mutable QReadWriteLock m_variablesLock;
+    std::shared_ptr<ValueCellStore> m_valueStore;  // 注册变量的实时值集中存放，按注册顺序连续
+    std::atomic<bool> m_batchedChanges{false};     // 批量变化通知
+    TagIndex m_tagIndex;                           // 注册变量的标签名 -> 值单元编号（只含本管理器存储中的变量）
+    QPointer<StalenessMonitor> m_stalenessMonitor; // 不属于本管理器
+    std::shared_ptr<WriteAccessControl> m_writeAccess;  // 由m_variablesLock保护
+    std::vector<std::unique_ptr<VariableArena>> m_variableArenas;  // 批量注册创建的变量定义
+    // 句柄按块存放，m_variables中的shared_ptr与m_handleLifetime共用控制块，不单独分配也不负责释放；
+    // 注销时归还句柄块，clearVariables时整块释放。由m_variablesLock保护
+    SlabArena<OPCUAVariableHandle> m_handleArena;
+    std::shared_ptr<char> m_handleLifetime = std::make_shared<char>(0);
+    quint32 m_nextHandleSerial = 0;
+    QVector<int> m_retiredHandles;  // 监控项删除失败的句柄槽位，旧监控项可能仍在发布，订阅删除前不复用
+    std::shared_ptr<OPCUAVariableHandle> createHandle();
+    void destroyHandle(OPCUAVariableHandle *handle);
+    void releaseRetiredHandles();//订阅已删除，归还停用的句柄槽位
 
     // ==================== 订阅管理 ====================
     SubscriptionMode m_subscriptionMode;
@@ -567,6 +807,18 @@ private:
     QTimer *m_pollingTimer;
     int m_pollingInterval;
 
+    // ==================== 订阅恢复 ====================
+    bool m_subscriptionWanted = false;  // 用户已启动监控订阅，断线后需要恢复
+    QTimer *m_restoreTimer;             // 分批恢复定时器
+    QStringList m_restoreQueue;         // 待恢复的标签
+    int m_restoreTotal = 0;             // 本轮需要恢复的总数
+
+    // ==================== 事件监控 ====================
+    QHash<QString, std::shared_ptr<OPCUAEventHandle>> m_eventMonitors;
+    QHash<quint32, std::shared_ptr<OPCUAEventHandle>> m_eventMonitorsById;  // 事件回调按上下文编号查找
+    quint32 m_nextEventMonitorId = 0;
+    mutable QReadWriteLock m_eventMonitorsLock;
+
     // ==================== 服务器时间 ====================
     //UA_DateTime getServerTime() const;
 
@@ -646,8 +898,22 @@ private:
     // 订阅管理
     bool createSubscription();
     bool deleteSubscription();
+    void teardownSubscription();//拆除订阅但保留恢复意图（连接错误时使用）
     bool createMonitoredItem(OPCUAVariableHandle *handle);
     bool deleteMonitoredItem(OPCUAVariableHandle *handle);
+    int createMonitoredItems(const QList<OPCUAVariableHandle*> &handles);
+    int createMonitoredItemsInBatches(const QList<OPCUAVariableHandle*> &handles);//按MONITORED_ITEMS_PER_REQUEST分批
+    static const int MONITORED_ITEMS_PER_REQUEST = 1000;   // 一次CreateMonitoredItems请求的监控项数上限
+    void watchStaleness(OPCUAVariableHandle *handle);
+    void onStalenessConnectionLost();
+    void restoreSubscriptionStaged();
+    bool createEventMonitoredItem(OPCUAEventHandle *handle);
+    bool deleteEventMonitoredItem(OPCUAEventHandle *handle);
+
+    // 事件处理
+    void processEventNotification(const QString &monitorName, const QVariantMap &fields);
+    QVariant eventFieldToQVariant(const UA_Variant &field) const;
+    static AlarmLevel severityToAlarmLevel(int severity);
 
     // 数据转换
     QString connectionStateToString(ConnectionState state) const;
@@ -666,9 +932,17 @@ private:
         UA_Client *client, UA_UInt32 subId, void *subContext,
         UA_UInt32 monId, void *monContext, UA_DataValue *value);
 
+    static void subscriptionInactivityCallback(
+        UA_Client *client, UA_UInt32 subId, void *subContext);
+
     static void deleteSubscriptionCallback(
         UA_Client *client, UA_UInt32 subId, void *subContext);
 
+    static void eventNotificationCallback(
+        UA_Client *client, UA_UInt32 subId, void *subContext,
+        UA_UInt32 monId, void *monContext,
+        size_t nEventFields, UA_Variant *eventFields);
+
 
     // 内部任务
     void executeBrowseTask(const QString &tagName);
@@ -720,11 +994,10 @@ private:
                                        const QVariant& value,
                                        UA_StatusCode status,
                                        const OPCUAVariableManager* manager) {
-        QDateTime timestamp = QDateTime::currentDateTime();
         DataQuality quality = manager->statusCodeToQuality(status);
 
-        // 使用完整的 setValue（如果支持）
-        handle->variableDef->setValue(value, timestamp, quality);
+        // 使用完整的 setValue（如果支持），时间戳由变量在写入时取
+        handle->variableDef->setValue(value, UaTime::NOW, quality);
         handle->lastValue = value;
         handle->lastStatus.quality = quality;
         handle->lastStatus.status = status;  // 可选：存储原始状态码
@@ -0,0 +1,76 @@
+// OPCUASecurityBenchmark.h - 安全模式通知路径性能测试
+#ifndef OPCUASECURITYBENCHMARK_H
+#define OPCUASECURITYBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include "opcuaclientmanager.h"
+
+namespace Industrial {
+
+// ==================== 测试用例 ====================
+struct SecurityBenchmarkCase {
+    QString name;              // 用例名称，如 "None" / "Sign" / "SignAndEncrypt"
+    SecurityConfig security;   // 连接使用的安全配置
+};
+
+// ==================== 测试结果 ====================
+struct SecurityBenchmarkResult {
+    QString name;                    // 用例名称
+    bool connected = false;          // 是否连接成功
+    qint64 connectTimeMs = 0;        // 建立安全通道和会话的耗时(ms)
+    qint64 notifications = 0;        // 测试期间收到的数据变化通知数
+    double notificationsPerSecond = 0.0; // 通知吞吐量
+    double cpuMsPerThousand = 0.0;   // 每千条通知消耗的进程CPU时间(ms)
+    double overheadPercent = 0.0;    // 相对第一个用例（通常为None）的CPU开销增加(%)
+    QString error;                   // 失败原因
+};
+
+// ==================== 安全模式性能测试 ====================
+// 依次用不同安全模式连接同一服务器，订阅同一组节点，统计通知路径的吞吐量和CPU开销，
+// 用于在全厂启用加密前评估并限定加解密成本
+class OPCUASecurityBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OPCUASecurityBenchmark(QObject *parent = nullptr);
+
+    void setEndpoint(const QString &endpointUrl,
+                     const QString &username = "",
+                     const QString &password = "");
+    void setNodeAddresses(const QStringList &addresses);//测试订阅的节点地址
+    void setDuration(int durationMs);//每个用例的测量时间
+    void setWarmup(int warmupMs);//每个用例测量前的预热时间
+    void setSamplingInterval(double intervalMs);//监控项采样间隔
+
+    void addCase(const QString &name, const SecurityConfig &security);
+    void addDefaultCases(SecurityPolicyType policy = SECURITY_POLICY_BASIC256SHA256);//None/Sign/SignAndEncrypt
+    void clearCases();
+
+    QList<SecurityBenchmarkResult> run();
+    static QString formatReport(const QList<SecurityBenchmarkResult> &results);
+
+signals:
+    void caseFinished(const SecurityBenchmarkResult &result);
+
+private:
+    SecurityBenchmarkResult runCase(const SecurityBenchmarkCase &benchCase);
+    void drive(OPCUAVariableManager &manager, int durationMs);//驱动客户端处理通知
+    static qint64 processCpuTimeMs();
+
+    QString m_endpointUrl;
+    QString m_username;
+    QString m_password;
+    QStringList m_nodeAddresses;
+    int m_durationMs = 10000;
+    int m_warmupMs = 2000;
+    double m_samplingInterval = 10.0;
+    QList<SecurityBenchmarkCase> m_cases;
+};
+
+} // namespace Industrial
+
+#endif // OPCUASECURITYBENCHMARK_H
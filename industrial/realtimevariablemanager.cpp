@@ -7,6 +7,7 @@
 #include <QDateTime>
 #include <QMutexLocker>
 #include <QMetaObject>
+#include <QMetaMethod>
 #include <cmath>
 #include <algorithm>
 #include <limits>
@@ -14,32 +15,34 @@
 namespace Industrial {
 // ==================== 静态成员定义 ====================
 const int RealTimeVariable::HISTORY_BUFFER_SIZE = 3600; // 1小时数据，每秒一点
+const int RealTimeVariable::MAX_STAT_WINDOWS = 8;
 // ==================== RealTimeVariable 实现 ====================
 
 RealTimeVariable::RealTimeVariable(VariableDefinition *definition, QObject *parent)
     : QObject(parent)
     , m_definition(definition)
-    , m_timestamp(QDateTime::currentDateTime())
+    , m_timestamp(UaTime::now())
     , m_quality(QUALITY_GOOD)
     , m_alarmLevel(ALARM_NONE)
     , m_alarmAcknowledged(true)
-    , m_history(HISTORY_BUFFER_SIZE)
+    , m_rawAlarmLevel(ALARM_NONE)
+    , m_candidateLevel(ALARM_NONE)
+    , m_hysteresisSuppressed(0)
+    , m_alarmTimerArmed(false)
     , m_historyIndex(0)
 {
     if (m_definition) {
         // 设置初始值
         m_value = m_definition->initialValue();
 
-        // 初始化历史缓冲区
+        // 历史缓冲区随数据增长，写满HISTORY_BUFFER_SIZE后循环覆盖；只放入一个初始点
         HistoryPoint initialPoint;
         initialPoint.timestamp = m_timestamp;
         initialPoint.value = m_value;
         initialPoint.quality = m_quality;
         initialPoint.alarmLevel = m_alarmLevel;
-
-        for (int i = 0; i < HISTORY_BUFFER_SIZE; i++) {
-            m_history[i] = initialPoint;
-        }
+        m_history.append(initialPoint);
+        m_historyIndex = 1;
     }
 }
 QVariant RealTimeVariable::value() const
@@ -48,7 +51,18 @@ QVariant RealTimeVariable::value() const
     return m_value;
 }
 
-void RealTimeVariable::updateValue(const QVariant &value, DataQuality quality)
+VariableSnapshot RealTimeVariable::snapshot() const
+{
+    QReadLocker locker(&m_lock);
+    VariableSnapshot snap;
+    snap.value = m_value;
+    snap.quality = m_quality;
+    snap.timestamp = UaTime::toDateTime(m_timestamp);
+    snap.valid = m_value.isValid();
+    return snap;
+}
+
+void RealTimeVariable::updateValue(const QVariant &value, DataQuality quality, UaTimestamp timestamp)
 {
     QWriteLocker locker(&m_lock);
     // 检查死区
@@ -65,7 +79,8 @@ void RealTimeVariable::updateValue(const QVariant &value, DataQuality quality)
     }  
     // 更新值
     m_value = value;
-    m_timestamp = QDateTime::currentDateTime();
+    m_timestamp = timestamp != UaTime::NOW ? timestamp : UaTime::now();
+    UaTimestamp newTimestamp = m_timestamp;
 
     // 检查质量变化
     if (m_quality != quality) {
@@ -83,24 +98,44 @@ void RealTimeVariable::updateValue(const QVariant &value, DataQuality quality)
     locker.unlock();
 
     emit valueChanged(value);
-    emit timestampChanged(m_timestamp);
+    static const QMetaMethod timestampSignal = QMetaMethod::fromSignal(&RealTimeVariable::timestampChanged);
+    if (isSignalConnected(timestampSignal)) {
+        emit timestampChanged(UaTime::toDateTime(newTimestamp));
+    }
 }
 
 void RealTimeVariable::addToHistory()
 {
     QMutexLocker locker(&m_historyMutex);  // 保护整个操作
-    if (m_historyIndex >= HISTORY_BUFFER_SIZE) {
-        m_historyIndex = 0;
-    }
-
     HistoryPoint newPoint;
     newPoint.timestamp = m_timestamp;
     newPoint.value = m_value;
     newPoint.quality = m_quality;
     newPoint.alarmLevel = m_alarmLevel;
 
-    m_history[m_historyIndex] = newPoint;
-    m_historyIndex++;
+    if (m_history.size() < HISTORY_BUFFER_SIZE) {
+        m_history.append(newPoint);
+        m_historyIndex = m_history.size();
+        if (m_history.size() == HISTORY_BUFFER_SIZE) {
+            m_history.squeeze();    // 写满后不再增长，释放扩容余量
+        }
+    } else {
+        if (m_historyIndex >= HISTORY_BUFFER_SIZE) {
+            m_historyIndex = 0;
+        }
+        m_history[m_historyIndex] = newPoint;
+        m_historyIndex++;
+    }
+
+    if (!m_statWindows.isEmpty() && newPoint.quality == QUALITY_GOOD) {
+        bool ok = false;
+        double val = newPoint.value.toDouble(&ok);
+        if (ok) {
+            for (auto it = m_statWindows.begin(); it != m_statWindows.end(); ++it) {
+                it.value().add(val, newPoint.timestamp);
+            }
+        }
+    }
     /*--------------以前的程序-----------
     if (m_historyIndex >= HISTORY_BUFFER_SIZE) {
         m_historyIndex = 0;
@@ -129,6 +164,9 @@ void RealTimeVariable::acknowledgeAlarm()
 void RealTimeVariable::resetAlarm()
 {
     QWriteLocker locker(&m_lock);
+    m_rawAlarmLevel = ALARM_NONE;
+    m_candidateLevel = ALARM_NONE;
+    m_alarmFilter.reset();
     if (m_alarmLevel != ALARM_NONE) {
         m_alarmLevel = ALARM_NONE;
         m_alarmAcknowledged = true;
@@ -144,146 +182,197 @@ void RealTimeVariable::checkAlarm(const QVariant &value)
         return;
     }
 
+    // 报警由服务器事件给出时，直接使用服务器报警状态，不做限值判断
+    if (m_definition->serverAlarmEnabled()) {
+        AlarmLevel serverLevel = m_definition->serverAlarmState();
+        m_candidateLevel = serverLevel;     // 切回客户端判断时从服务器级别开始
+        m_alarmFilter.confirmed = serverLevel;
+        m_alarmFilter.pending = serverLevel;
+        if (serverLevel != m_alarmLevel) {
+            m_alarmLevel = serverLevel;
+            m_alarmAcknowledged = false;
+            m_alarmTime = QDateTime::currentDateTime();
+
+            emit alarmChanged(serverLevel);
+        }
+        return;
+    }
+
     bool ok = false;
     double val = value.toDouble(&ok);
     if (!ok) {
         // 无法转换为数值，跳过报警检查
         return;
     }
-    // 使用快速报警检查（带缓存优化）
-    AlarmLevel newLevel = ALARM_NONE;
-
-    if(m_definition){
-        // 使用优化后的方法
-        newLevel = m_definition->checkAlarmFast(val);
-    }
-    else{
-        if (val <= m_definition->alarmLoLo()) {
-            newLevel = ALARM_CRITICAL;
-        } else if (val >= m_definition->alarmHiHi()) {
-            newLevel = ALARM_CRITICAL;
-        } else if (val <= m_definition->alarmLo()) {
-            newLevel = ALARM_MAJOR;
-        } else if (val >= m_definition->alarmHi()) {
-            newLevel = ALARM_MAJOR;
+    // 限值判断带复位滞环，结果再经过升级/降级确认延时
+    AlarmLevel rawLevel = m_definition->checkAlarmFast(val);
+    AlarmLevel candidate = m_definition->checkAlarmFast(val, m_candidateLevel);
+    if (rawLevel != m_rawAlarmLevel && candidate == m_candidateLevel) {
+        m_hysteresisSuppressed++;  // 没有滞环时这里会产生一次变化
+    }
+    m_rawAlarmLevel = rawLevel;
+    m_candidateLevel = candidate;
+
+    applyAlarmCandidate(UaTime::now());
+}
+
+void RealTimeVariable::applyAlarmCandidate(UaTimestamp now)
+{
+    qint64 onDelay = static_cast<qint64>(m_definition->alarmOnDelay()) * UaTime::TICKS_PER_MSEC;
+    qint64 offDelay = static_cast<qint64>(m_definition->alarmOffDelay()) * UaTime::TICKS_PER_MSEC;
+
+    if (m_alarmFilter.update(m_candidateLevel, now, onDelay, offDelay)) {
+        AlarmLevel newLevel = m_alarmFilter.confirmed;
+        if (newLevel != m_alarmLevel) {
+            m_alarmLevel = newLevel;
+            m_alarmAcknowledged = false;
+            m_alarmTime = QDateTime::currentDateTime();
+
+            emit alarmChanged(newLevel);
         }
+        return;
+    }
+
+    // 等待确认：值不再刷新时也要按时确认，到期前只挂一个定时器
+    if (m_alarmFilter.hasPending() && !m_alarmTimerArmed) {
+        qint64 delay = m_alarmFilter.pending > m_alarmFilter.confirmed ? onDelay : offDelay;
+        qint64 remaining = m_alarmFilter.pendingSince + delay - now;
+        int msecs = static_cast<int>(qMax<qint64>(0, remaining / UaTime::TICKS_PER_MSEC)) + 1;
+        m_alarmTimerArmed = true;
+        QTimer::singleShot(msecs, this, &RealTimeVariable::onAlarmDelayTimeout);
     }
-    if (newLevel != m_alarmLevel) {
-        m_alarmLevel = newLevel;
-        m_alarmAcknowledged = false;
-        m_alarmTime = QDateTime::currentDateTime();
+}
 
-        emit alarmChanged(newLevel);
+void RealTimeVariable::onAlarmDelayTimeout()
+{
+    QWriteLocker locker(&m_lock);
+    m_alarmTimerArmed = false;
+    if (!m_definition || m_definition->serverAlarmEnabled()) {
+        return;
     }
+    applyAlarmCandidate(UaTime::now());
+}
+
+quint32 RealTimeVariable::suppressedByHysteresis() const
+{
+    QReadLocker locker(&m_lock);
+    return m_hysteresisSuppressed;
+}
+
+quint32 RealTimeVariable::suppressedByDelay() const
+{
+    QReadLocker locker(&m_lock);
+    return m_alarmFilter.suppressed;
 }
 
 void RealTimeVariable::updateQuality(DataQuality quality)
 {
-    if (quality != m_quality) {
-        m_quality = quality;
-        emit qualityChanged(quality);
+    QWriteLocker locker(&m_lock);
+    if (quality == m_quality) {
+        return;
     }
+    m_quality = quality;
+    locker.unlock();
+    emit qualityChanged(quality);
 }
 
 QVector<QPair<QDateTime, QVariant>> RealTimeVariable::getHistory(int maxPoints) const
 {
     QReadLocker locker(&m_lock);
 
-    int points = qMin(maxPoints, HISTORY_BUFFER_SIZE);
+    const int stored = m_history.size();
+    int points = qMin(maxPoints, stored);
     QVector<QPair<QDateTime, QVariant>> result;
+    if (points <= 0) {
+        return result;
+    }
     result.reserve(points);
 
-    // 计算起始索引
-    int startIdx = (m_historyIndex - points + HISTORY_BUFFER_SIZE) % HISTORY_BUFFER_SIZE;
+    // 计算起始索引（未写满时m_historyIndex等于已存点数）
+    int startIdx = (m_historyIndex - points + stored) % stored;
 
     for (int i = 0; i < points; i++) {
-        int idx = (startIdx + i) % HISTORY_BUFFER_SIZE;
-        if (m_history[idx].timestamp.isValid()) {
-            result.append(qMakePair(m_history[idx].timestamp, m_history[idx].value));
+        int idx = (startIdx + i) % stored;
+        if (m_history[idx].timestamp != 0) {
+            result.append(qMakePair(UaTime::toDateTime(m_history[idx].timestamp), m_history[idx].value));
         }
     }
 
     return result;
 }
 
-double RealTimeVariable::averageValue(int seconds) const
+RollingStatistics& RealTimeVariable::statWindow(int seconds) const
 {
-    QReadLocker locker(&m_lock);
-
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-seconds);
-    double sum = 0.0;
-    int count = 0;
+    auto it = m_statWindows.find(seconds);
+    if (it != m_statWindows.end()) {
+        return it.value();
+    }
+    if (m_statWindows.size() >= MAX_STAT_WINDOWS) {
+        m_statWindows.erase(m_statWindows.begin());
+    }
 
-    for (int i = 0; i < HISTORY_BUFFER_SIZE; i++) {
-        if (m_history[i].timestamp >= cutoff && m_history[i].quality == QUALITY_GOOD) {
+    // 按时间顺序回放历史缓冲区，只在建立时扫描一次
+    RollingStatistics window(static_cast<qint64>(seconds) * UaTime::TICKS_PER_SEC, HISTORY_BUFFER_SIZE);
+    const int stored = m_history.size();
+    for (int i = 0; i < stored; i++) {
+        const HistoryPoint &point = m_history[(m_historyIndex + i) % stored];
+        if (point.timestamp != 0 && point.quality == QUALITY_GOOD) {
             bool ok = false;
-            double val = m_history[i].value.toDouble(&ok);
+            double val = point.value.toDouble(&ok);
             if (ok) {
-                sum += val;
-                count++;
+                window.add(val, point.timestamp);
             }
         }
     }
+    return m_statWindows.insert(seconds, window).value();
+}
 
-    return count > 0 ? sum / count : 0.0;
+double RealTimeVariable::averageValue(int seconds) const
+{
+    if (seconds <= 0) {
+        return 0.0;
+    }
+    QMutexLocker locker(&m_historyMutex);
+    RollingStatistics &window = statWindow(seconds);
+    window.expire(UaTime::now());
+    return window.average();
 }
 
 double RealTimeVariable::maxValue(int seconds) const
 {
-    QReadLocker locker(&m_lock);
-
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-seconds);
-    double maxVal = -std::numeric_limits<double>::max();
-    bool found = false;
-
-    for (int i = 0; i < HISTORY_BUFFER_SIZE; i++) {
-        if (m_history[i].timestamp >= cutoff && m_history[i].quality == QUALITY_GOOD) {
-            bool ok = false;
-            double val = m_history[i].value.toDouble(&ok);
-            if (ok && val > maxVal) {
-                maxVal = val;
-                found = true;
-            }
-        }
+    if (seconds <= 0) {
+        return 0.0;
     }
-
-    return found ? maxVal : 0.0;
+    QMutexLocker locker(&m_historyMutex);
+    RollingStatistics &window = statWindow(seconds);
+    window.expire(UaTime::now());
+    return window.maximum();
 }
 
 double RealTimeVariable::minValue(int seconds) const
 {
-    QReadLocker locker(&m_lock);
-
-    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-seconds);
-    double minVal = std::numeric_limits<double>::max();
-    bool found = false;
-
-    for (int i = 0; i < HISTORY_BUFFER_SIZE; i++) {
-        if (m_history[i].timestamp >= cutoff && m_history[i].quality == QUALITY_GOOD) {
-            bool ok = false;
-            double val = m_history[i].value.toDouble(&ok);
-            if (ok && val < minVal) {
-                minVal = val;
-                found = true;
-            }
-        }
+    if (seconds <= 0) {
+        return 0.0;
     }
-
-    return found ? minVal : 0.0;
+    QMutexLocker locker(&m_historyMutex);
+    RollingStatistics &window = statWindow(seconds);
+    window.expire(UaTime::now());
+    return window.minimum();
 }
 
 double RealTimeVariable::rateOfChange() const
 {
     QReadLocker locker(&m_lock);
 
-    if (m_historyIndex < 2) {
+    const int stored = m_history.size();
+    if (stored < 2) {
         return 0.0;
     }
 
-    int idx1 = (m_historyIndex - 1 + HISTORY_BUFFER_SIZE) % HISTORY_BUFFER_SIZE;
-    int idx2 = (m_historyIndex - 2 + HISTORY_BUFFER_SIZE) % HISTORY_BUFFER_SIZE;
+    int idx1 = (m_historyIndex - 1 + stored) % stored;
+    int idx2 = (m_historyIndex - 2 + stored) % stored;
 
-    if (!m_history[idx1].timestamp.isValid() || !m_history[idx2].timestamp.isValid()) {
+    if (m_history[idx1].timestamp == 0 || m_history[idx2].timestamp == 0) {
         return 0.0;
     }
 
@@ -295,13 +384,23 @@ double RealTimeVariable::rateOfChange() const
         return 0.0;
     }
 
-    qint64 timeDiff = m_history[idx2].timestamp.msecsTo(m_history[idx1].timestamp);
+    double timeDiff = UaTime::secondsBetween(m_history[idx2].timestamp, m_history[idx1].timestamp);
 
-    if (timeDiff == 0) {
+    if (timeDiff == 0.0) {
         return 0.0;
     }
 
-    return (val1 - val2) / (timeDiff / 1000.0); // 变化率：单位/秒
+    return (val1 - val2) / timeDiff; // 变化率：单位/秒
+}
+
+qint64 RealTimeVariable::memoryUsage() const
+{
+    QMutexLocker locker(&m_historyMutex);
+    qint64 bytes = m_history.capacity() * static_cast<qint64>(sizeof(HistoryPoint));
+    for (auto it = m_statWindows.constBegin(); it != m_statWindows.constEnd(); ++it) {
+        bytes += it.value().memoryUsage();
+    }
+    return bytes;
 }
 
 // ==================== RealTimeVariableManager 实现 ====================
@@ -309,6 +408,8 @@ double RealTimeVariable::rateOfChange() const
 RealTimeVariableManager::RealTimeVariableManager(QObject *parent)
     : QObject(parent)
     , m_database(nullptr)
+    , m_valueStore(std::make_shared<ValueCellStore>())
+    , m_stalenessMonitor(new StalenessMonitor(this))
     , m_updateTimer(new QTimer(this))
     , m_loggingTimer(new QTimer(this))
     , m_cleanupTimer(new QTimer(this))
@@ -324,6 +425,12 @@ RealTimeVariableManager::RealTimeVariableManager(QObject *parent)
     connect(m_cleanupTimer, &QTimer::timeout, this, &RealTimeVariableManager::cleanupOldData);
     connect(m_statsTimer, &QTimer::timeout, this, &RealTimeVariableManager::checkConnectionStatus);
     connect(m_statsTimer, &QTimer::timeout, this, &RealTimeVariableManager::onStatsTimerTimeout);
+    connect(m_stalenessMonitor, &StalenessMonitor::tagsStale, this, [this](const QList<VariableDefinition*> &variables) {
+        onStalenessChanged(variables, QUALITY_OLD);
+    });
+    connect(m_stalenessMonitor, &StalenessMonitor::tagsFailed, this, [this](const QList<VariableDefinition*> &variables) {
+        onStalenessChanged(variables, QUALITY_COMM_FAIL);
+    });
 
     // 初始化统计
     m_stats = PerformanceStats();
@@ -403,9 +510,11 @@ bool RealTimeVariableManager::initialize(VariableDatabase *db)
 
     QWriteLocker locker(&m_lock);
     for (VariableDefinition *var : allVars) {
+        bindValueCell(var);
         RealTimeVariable *rtVar = new RealTimeVariable(var, this);
         m_variables.insert(var->tagName(), rtVar);
     }
+    m_stalenessMonitor->watchAll(allVars);
 
     qInfo() << "Initialized RealTimeVariableManager with" << m_variables.size() << "variables";
     return true;
@@ -423,8 +532,10 @@ bool RealTimeVariableManager::addVariable(VariableDefinition *definition)
         return false;
     }
 
+    bindValueCell(definition);
     RealTimeVariable *rtVar = new RealTimeVariable(definition, this);
     m_variables.insert(tagName, rtVar);
+    m_stalenessMonitor->watch(definition);
 
     locker.unlock();
 
@@ -432,12 +543,39 @@ bool RealTimeVariableManager::addVariable(VariableDefinition *definition)
     return true;
 }
 
+void RealTimeVariableManager::bindValueCell(VariableDefinition *definition)//实时值迁移到本管理器的连续单元数组
+{
+    // 已被其他管理器（如OPC UA采集）接管的变量保持不变，避免来回迁移
+    if (definition->valueCellStore() == ValueCellStore::global().get()) {
+        definition->bindValueCell(m_valueStore);
+    }
+}
+
+QList<VariableDefinition*> RealTimeVariableManager::takeChangedVariables()
+{
+    QList<VariableDefinition*> changed;
+    QVector<quint32> ids;
+    if (m_valueStore->takeChanged(ids) == 0) {
+        return changed;
+    }
+
+    changed.reserve(ids.size());
+    for (quint32 id : ids) {
+        VariableDefinition *definition = m_valueStore->owner(id);
+        if (definition) {
+            changed.append(definition);
+        }
+    }
+    return changed;
+}
+
 bool RealTimeVariableManager::removeVariable(const QString &tagName)
 {
     QWriteLocker locker(&m_lock);
 
     if (m_variables.contains(tagName)) {
         RealTimeVariable *var = m_variables.take(tagName);
+        m_stalenessMonitor->unwatch(var->definition());
         delete var;
 
         // 同时移除相关订阅
@@ -587,6 +725,7 @@ void RealTimeVariableManager::updateVariables(const QMap<QString, QVariant> &val
             RealTimeVariable* rtVar = getVariable(tagName);
             if (rtVar) {
                 rtVar->updateValue(value);
+                m_stalenessMonitor->updated(rtVar->definition());
             }
         });
     }
@@ -790,6 +929,7 @@ void RealTimeVariableManager::cleanupAllVariables()
     QWriteLocker locker(&m_lock);
     QList<RealTimeVariable*> varsToDelete = m_variables.values();
     m_variables.clear();
+    m_stalenessMonitor->clear();
     m_subscriptions.clear();
     locker.unlock();  // 尽早释放锁
 
@@ -859,26 +999,51 @@ void RealTimeVariableManager::cleanupOldData()
 
 void RealTimeVariableManager::checkConnectionStatus()
 {
+    // 陈旧和通信故障由m_stalenessMonitor在到期时批量标记，这里只读计数，不再遍历全部变量
+    const int staleCount = m_stalenessMonitor->staleCount();
+    const int failedCount = m_stalenessMonitor->failedCount();
+    if (staleCount > 0 || failedCount > 0) {
+        qWarning() << "Connection check:" << failedCount << "variables have communication errors,"
+                   << staleCount << "variables are stale";
+    }
+}
+
+TagMemoryUsage RealTimeVariableManager::memoryUsage() const
+{
+    TagMemoryUsage usage;
     QReadLocker locker(&m_lock);
+    usage.tagCount = m_variables.size();
 
-    int activeCount = 0;
-    int errorCount = 0;
+    qint64 history = 0;
+    for (RealTimeVariable *rtVar : m_variables) {
+        history += rtVar->memoryUsage();
+    }
+    usage.add("realtimeVariables", static_cast<qint64>(m_variables.size()) * sizeof(RealTimeVariable));
+    usage.add("history", history);
+    usage.add("valueCells", m_valueStore->memoryUsage());
+    return usage;
+}
 
-    for (RealTimeVariable *rtVar : m_variables.values()) {
-        if (rtVar) {
-            if (rtVar->quality() == QUALITY_GOOD) {
-                activeCount++;
-            } else if (rtVar->quality() == QUALITY_COMM_FAIL ||
-                       rtVar->quality() == QUALITY_BAD) {
-                errorCount++;
-                QString errorMsg = qualityToString(rtVar->quality());
-                emit communicationError(rtVar->tagName(), errorMsg);
+void RealTimeVariableManager::onStalenessChanged(const QList<VariableDefinition*> &variables, DataQuality quality)
+{
+    QList<RealTimeVariable*> affected;
+    {
+        QReadLocker locker(&m_lock);
+        for (VariableDefinition *definition : variables) {
+            RealTimeVariable *rtVar = m_variables.value(definition->tagName());
+            if (rtVar && rtVar->definition() == definition) {
+                affected.append(rtVar);
             }
         }
     }
 
-    if (errorCount > 0) {
-        qWarning() << "Connection check:" << errorCount << "variables have communication errors";
+    // 只对本次新进入该状态的变量报告，不再每个统计周期重复发出
+    const QString errorMsg = qualityToString(quality);
+    for (RealTimeVariable *rtVar : affected) {
+        rtVar->updateQuality(quality);
+        if (quality == QUALITY_COMM_FAIL) {
+            emit communicationError(rtVar->tagName(), errorMsg);
+        }
     }
 }
 
@@ -904,10 +1069,14 @@ void RealTimeVariableManager::calculatePerformanceStats()
     {
         QReadLocker locker(&m_lock);
         newStats.alarmCount = 0;
+        newStats.suppressedAlarms = 0;
         for (RealTimeVariable *rtVar : m_variables.values()) {
             if (rtVar && rtVar->isInAlarm()) {
                 newStats.alarmCount++;
             }
+            if (rtVar) {
+                newStats.suppressedAlarms += rtVar->suppressedByHysteresis() + rtVar->suppressedByDelay();
+            }
         }
     }
 
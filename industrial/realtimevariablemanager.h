@@ -4,6 +4,9 @@
 
 #include"variablesystem.h"
 #include"variabledatabase.h"
+#include"statisticsengine.h"
+#include"stalenessmonitor.h"
+#include"variablearena.h"
 #include <QObject>
 #include <QTimer>
 #include <QThreadPool>
@@ -31,19 +34,24 @@ public:
 
     // 实时值访问
     QVariant value() const;
-    QDateTime timestamp() const { return m_timestamp; }
+    QDateTime timestamp() const { return UaTime::toDateTime(m_timestamp); }
+    UaTimestamp uaTimestamp() const { return m_timestamp; }
     DataQuality quality() const { return m_quality; }
+    VariableSnapshot snapshot() const;//值、质量、时间戳一次读取，扫描和界面刷新使用
 
     // 报警状态
     AlarmLevel alarmLevel() const { return m_alarmLevel; }
     bool isInAlarm() const { return m_alarmLevel != ALARM_NONE; }
     bool isAcknowledged() const { return m_alarmAcknowledged; }
+    quint32 suppressedByHysteresis() const;    // 被复位滞环吸收的报警变化次数
+    quint32 suppressedByDelay() const;         // 被确认延时吸收的报警变化次数
 
-    // 历史数据
+    // 历史数据（缓冲区随数据增长，最多HISTORY_BUFFER_SIZE个点）
     void addToHistory();
     QVector<QPair<QDateTime, QVariant>> getHistory(int maxPoints = 1000) const;
+    qint64 memoryUsage() const;//历史缓冲区和统计窗口占用的字节数
 
-    // 统计计算
+    // 统计计算：每个窗口长度一个滚动窗口，首次查询时从历史缓冲区建立，之后随addToHistory增量更新
     double averageValue(int seconds = 60) const;
     double maxValue(int seconds = 60) const;
     double minValue(int seconds = 60) const;
@@ -58,29 +66,39 @@ signals:
     void valueOutOfRange(const QVariant &value);
 
 public slots:
-    void updateValue(const QVariant &value, DataQuality quality = QUALITY_GOOD);
+    void updateValue(const QVariant &value, DataQuality quality = QUALITY_GOOD,
+                     UaTimestamp timestamp = UaTime::NOW);//timestamp可传入源时间戳
     void acknowledgeAlarm();
     void resetAlarm();
+    void updateQuality(DataQuality quality);//只改质量（陈旧检测标记），值和时间戳不变
 
 private:
     void checkAlarm(const QVariant &value);
-    void updateQuality(DataQuality quality);
+    void applyAlarmCandidate(UaTimestamp now);//调用者持有写锁
+    void onAlarmDelayTimeout();
 
     VariableDefinition *m_definition;
 
     // 实时值
     QVariant m_value;
-    QDateTime m_timestamp;
+    UaTimestamp m_timestamp;
     DataQuality m_quality;
 
     // 报警
-    AlarmLevel m_alarmLevel;
+    AlarmLevel m_alarmLevel;       // 确认后的报警级别
     bool m_alarmAcknowledged;
     QDateTime m_alarmTime;
 
+    // 报警防抖
+    AlarmLevel m_rawAlarmLevel;        // 不带滞环的限值判断结果
+    AlarmLevel m_candidateLevel;       // 带滞环的判断结果，经延时确认后成为m_alarmLevel
+    AlarmFilter m_alarmFilter;
+    quint32 m_hysteresisSuppressed;
+    bool m_alarmTimerArmed;
+
     // 历史数据（环形缓冲区）
     struct HistoryPoint {
-        QDateTime timestamp;
+        UaTimestamp timestamp = 0;   // 0为空点
         QVariant value;
         DataQuality quality;
         AlarmLevel alarmLevel;
@@ -90,6 +108,11 @@ private:
     QVector<HistoryPoint> m_history;
     int m_historyIndex;
 
+    // 统计窗口（秒数 -> 窗口），由m_historyMutex保护
+    static const int MAX_STAT_WINDOWS;
+    mutable QMap<int, RollingStatistics> m_statWindows;
+    RollingStatistics& statWindow(int seconds) const;
+
     // 读写锁
     mutable QReadWriteLock m_lock;
     //------------------------------后加----------
@@ -112,6 +135,10 @@ public:
     bool removeVariable(const QString &tagName);
     RealTimeVariable* getVariable(const QString &tagName) const;
     QList<RealTimeVariable*> getAllVariables() const;
+    ValueCellStore* valueStore() const { return m_valueStore.get(); }//本管理器变量的实时值单元
+    QList<VariableDefinition*> takeChangedVariables();//取走上次调用以来值或质量变化的变量（批量通知）
+    StalenessMonitor* stalenessMonitor() const { return m_stalenessMonitor; }//按updateRate检测陈旧数据
+    TagMemoryUsage memoryUsage() const;//实时变量、历史缓冲区、值单元按变量平均的内存占用
 
     // ==================== 分组查询 ====================
     QList<RealTimeVariable*> getVariablesByGroup(const QString &groupName) const;
@@ -142,6 +169,7 @@ public:
     struct PerformanceStats {
         int updateCount = 0;
         int alarmCount = 0;
+        int suppressedAlarms = 0;       // 滞环和延时吸收的报警变化累计
         double avgUpdateRate = 0.0;
         double maxUpdateRate = 0.0;
         int missedUpdates = 0;
@@ -186,6 +214,11 @@ private:
     VariableDatabase *m_database;
     QMap<QString, RealTimeVariable*> m_variables;
     QMap<QString, QList<Subscription>> m_subscriptions;
+    std::shared_ptr<ValueCellStore> m_valueStore;  // 变量实时值集中存放
+    StalenessMonitor *m_stalenessMonitor;          // 超时未更新的变量批量标记为QUALITY_OLD/QUALITY_COMM_FAIL
+
+    void bindValueCell(VariableDefinition *definition);
+    void onStalenessChanged(const QList<VariableDefinition*> &variables, DataQuality quality);
 
     // 定时器
     QTimer *m_updateTimer;
@@ -0,0 +1,432 @@
+// StalenessMonitor.cpp - 陈旧检测时间轮
+#include "stalenessmonitor.h"
+#include "calculationengine.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace Industrial {
+
+const int StalenessMonitor::RESOLUTION_MS;
+const int StalenessMonitor::WHEEL_SLOTS;
+
+StalenessMonitor::StalenessMonitor(QObject *parent)
+    : QObject(parent)
+    , m_slots(WHEEL_SLOTS, -1)
+    , m_tickTimer(new QTimer(this))
+{
+    m_clock.start();
+    connect(m_tickTimer, &QTimer::timeout, this, &StalenessMonitor::onTick);
+    m_tickTimer->start(RESOLUTION_MS);
+}
+
+StalenessMonitor::~StalenessMonitor()
+{
+}
+
+// ==================== 变量登记 ====================
+void StalenessMonitor::watch(VariableDefinition *var, int intervalMs)
+{
+    if (!var) {
+        return;
+    }
+
+    const bool followsUpdateRate = intervalMs <= 0;
+    int interval = followsUpdateRate ? var->updateRate() : intervalMs;
+    if (interval <= 0) {
+        interval = 1000;
+    }
+
+    bool added = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        int index = m_index.value(var, -1);
+        if (index < 0) {
+            if (!m_freeEntries.isEmpty()) {
+                index = m_freeEntries.takeLast();
+            } else {
+                index = m_entries.size();
+                m_entries.append(Entry());
+            }
+            m_index.insert(var, index);
+            m_entries[index].var = var;
+            added = true;
+        }
+
+        Entry &entry = m_entries[index];
+        entry.intervalMs = interval;
+        entry.followsUpdateRate = followsUpdateRate;
+        if (added) {
+            restart(index, m_clock.elapsed());
+        } else if (entry.state != STATE_FAILED) {
+            unlink(index);
+            link(index, m_clock.elapsed() + timeout(entry, entry.state));
+        }
+    }
+
+    if (added) {
+        // 直接连接：在写入线程中重新计时，不经过事件队列
+        connect(var, &VariableDefinition::valueChanged, this, [this, var]() {
+            updated(var);
+        }, Qt::DirectConnection);
+        connect(var, &VariableDefinition::qualityChanged, this, [this, var]() {
+            updated(var);
+        }, Qt::DirectConnection);
+        connect(var, &VariableDefinition::updateRateChanged, this, [this, var](int rate) {
+            onUpdateRateChanged(var, rate);
+        }, Qt::DirectConnection);
+        connect(var, &QObject::destroyed, this, [this, var]() {
+            unwatch(var);
+        }, Qt::DirectConnection);
+    }
+}
+
+void StalenessMonitor::watchAll(const QList<VariableDefinition*> &variables)
+{
+    for (VariableDefinition *var : variables) {
+        watch(var);
+    }
+}
+
+void StalenessMonitor::unwatch(VariableDefinition *var)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_index.find(var);
+        if (it == m_index.end()) {
+            return;
+        }
+        const int index = it.value();
+        m_index.erase(it);
+        unlink(index);
+        setState(m_entries[index], STATE_FRESH);
+        m_entries[index] = Entry();
+        m_freeEntries.append(index);
+    }
+    disconnect(var, nullptr, this, nullptr);
+}
+
+void StalenessMonitor::clear()
+{
+    QList<VariableDefinition*> watched;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+            watched.append(m_entries[it.value()].var);
+        }
+        m_entries.clear();
+        m_freeEntries.clear();
+        m_index.clear();
+        m_slots.fill(-1);
+        m_staleCount = 0;
+        m_failedCount = 0;
+    }
+    for (VariableDefinition *var : watched) {
+        disconnect(var, nullptr, this, nullptr);
+    }
+}
+
+int StalenessMonitor::watchedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_index.size();
+}
+
+void StalenessMonitor::setFactors(double staleFactor, double failFactor)
+{
+    QMutexLocker locker(&m_mutex);
+    m_staleFactor = qMax(1.0, staleFactor);
+    m_failFactor = qMax(m_staleFactor, failFactor);
+}
+
+// ==================== 新值通知 ====================
+void StalenessMonitor::updated(VariableDefinition *var)
+{
+    // 本监视器标记的质量（以及源头报告的陈旧/通信故障）不算新值
+    const DataQuality quality = var->quality();
+    if (quality == QUALITY_OLD || quality == QUALITY_COMM_FAIL) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    int index = m_index.value(var, -1);
+    if (index >= 0) {
+        restart(index, m_clock.elapsed());
+    }
+}
+
+void StalenessMonitor::updated(const QList<VariableDefinition*> &variables)
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    for (VariableDefinition *var : variables) {
+        int index = m_index.value(var, -1);
+        if (index < 0) {
+            continue;
+        }
+        const DataQuality quality = var->quality();
+        if (quality != QUALITY_OLD && quality != QUALITY_COMM_FAIL) {
+            restart(index, now);
+        }
+    }
+}
+
+void StalenessMonitor::markCommFail()
+{
+    QVector<Expired> expired;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+            Entry &entry = m_entries[it.value()];
+            if (entry.state != STATE_FAILED) {
+                unlink(it.value());
+                setState(entry, STATE_FAILED);
+                entry.seenVersion = cellVersion(entry.var);
+                expired.append(Expired{ it.value(), entry.var, QUALITY_COMM_FAIL, entry.seenVersion });
+            }
+        }
+    }
+    applyExpired(expired);
+}
+
+void StalenessMonitor::markCommFail(const QList<VariableDefinition*> &variables)
+{
+    QVector<Expired> expired;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (VariableDefinition *var : variables) {
+            int index = m_index.value(var, -1);
+            if (index < 0 || m_entries[index].state == STATE_FAILED) {
+                continue;
+            }
+            Entry &entry = m_entries[index];
+            unlink(index);
+            setState(entry, STATE_FAILED);
+            entry.seenVersion = cellVersion(var);
+            expired.append(Expired{ index, var, QUALITY_COMM_FAIL, entry.seenVersion });
+        }
+    }
+    applyExpired(expired);
+}
+
+// ==================== 查询 ====================
+int StalenessMonitor::staleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_staleCount;
+}
+
+int StalenessMonitor::failedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_failedCount;
+}
+
+// ==================== 时间轮 ====================
+void StalenessMonitor::link(int index, qint64 deadline)
+{
+    Entry &entry = m_entries[index];
+    entry.deadline = deadline;
+
+    qint64 tick = (deadline + RESOLUTION_MS - 1) / RESOLUTION_MS;
+    if (tick <= m_currentTick) {
+        tick = m_currentTick + 1;
+    } else if (tick - m_currentTick >= WHEEL_SLOTS) {
+        tick = m_currentTick + WHEEL_SLOTS - 1;     // 超出范围，到期时按剩余时间重挂
+    }
+
+    const int slot = static_cast<int>(tick % WHEEL_SLOTS);
+    entry.slot = slot;
+    entry.prev = -1;
+    entry.next = m_slots[slot];
+    if (entry.next >= 0) {
+        m_entries[entry.next].prev = index;
+    }
+    m_slots[slot] = index;
+}
+
+void StalenessMonitor::unlink(int index)
+{
+    Entry &entry = m_entries[index];
+    if (entry.slot < 0) {
+        return;
+    }
+    if (entry.prev >= 0) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_slots[entry.slot] = entry.next;
+    }
+    if (entry.next >= 0) {
+        m_entries[entry.next].prev = entry.prev;
+    }
+    entry.slot = -1;
+    entry.prev = -1;
+    entry.next = -1;
+}
+
+void StalenessMonitor::restart(int index, qint64 now)
+{
+    Entry &entry = m_entries[index];
+    entry.seenVersion = cellVersion(entry.var);
+    setState(entry, STATE_FRESH);
+    unlink(index);
+    link(index, now + timeout(entry, STATE_FRESH));
+}
+
+void StalenessMonitor::setState(Entry &entry, State state)
+{
+    if (entry.state == state) {
+        return;
+    }
+    if (entry.state == STATE_STALE) {
+        m_staleCount--;
+    } else if (entry.state == STATE_FAILED) {
+        m_failedCount--;
+    }
+    if (state == STATE_STALE) {
+        m_staleCount++;
+    } else if (state == STATE_FAILED) {
+        m_failedCount++;
+    }
+    entry.state = state;
+}
+
+qint64 StalenessMonitor::timeout(const Entry &entry, State from) const
+{
+    const double periods = from == STATE_FRESH ? m_staleFactor : m_failFactor - m_staleFactor;
+    return qMax(static_cast<qint64>(RESOLUTION_MS), static_cast<qint64>(entry.intervalMs * periods));
+}
+
+quint32 StalenessMonitor::cellVersion(const VariableDefinition *var)
+{
+    const ValueCell *cell = var->valueCell();
+    return cell ? cell->version() : 0;
+}
+
+void StalenessMonitor::onTick()
+{
+    checkPending();
+}
+
+int StalenessMonitor::checkPending()
+{
+    QVector<Expired> expired;
+    {
+        QMutexLocker locker(&m_mutex);
+        const qint64 now = m_clock.elapsed();
+        const qint64 nowTick = now / RESOLUTION_MS;
+        if (nowTick <= m_currentTick) {
+            return 0;
+        }
+
+        // 落后超过一圈时每格只需处理一次
+        qint64 tick = qMax(m_currentTick + 1, nowTick - WHEEL_SLOTS + 1);
+        for (; tick <= nowTick; tick++) {
+            m_currentTick = tick;
+            const int slot = static_cast<int>(tick % WHEEL_SLOTS);
+            int index = m_slots[slot];
+            m_slots[slot] = -1;
+
+            while (index >= 0) {
+                Entry &entry = m_entries[index];
+                const int next = entry.next;
+                entry.slot = -1;
+                entry.prev = -1;
+                entry.next = -1;
+
+                if (entry.deadline > now) {
+                    link(index, entry.deadline);
+                } else if (cellVersion(entry.var) != entry.seenVersion) {
+                    restart(index, now);    // 有未通知的写入（只改时间戳）
+                } else if (entry.state == STATE_FRESH) {
+                    setState(entry, STATE_STALE);
+                    expired.append(Expired{ index, entry.var, QUALITY_OLD, entry.seenVersion });
+                    link(index, now + timeout(entry, STATE_STALE));
+                } else {
+                    setState(entry, STATE_FAILED);
+                    expired.append(Expired{ index, entry.var, QUALITY_COMM_FAIL, entry.seenVersion });
+                }
+                index = next;
+            }
+        }
+    }
+
+    applyExpired(expired);
+    return expired.size();
+}
+
+void StalenessMonitor::applyExpired(const QVector<Expired> &expired)
+{
+    if (expired.isEmpty()) {
+        return;
+    }
+
+    // 在锁外写质量：写入会发出qualityChanged，直接连接回到updated()
+    QList<VariableDefinition*> stale;
+    QList<VariableDefinition*> failed;
+    QVector<const Expired*> applied;
+    applied.reserve(expired.size());
+    for (const Expired &item : expired) {
+        if (!item.var->setQuality(item.quality, item.version)) {
+            continue;   // 新值刚好到达，或质量已相同
+        }
+        applied.append(&item);
+        if (item.quality == QUALITY_OLD) {
+            stale.append(item.var);
+        } else {
+            failed.append(item.var);
+        }
+    }
+
+    {
+        // 标记本身也是一次写入，不能当作新值
+        QMutexLocker locker(&m_mutex);
+        for (const Expired *item : applied) {
+            if (item->entry < m_entries.size()) {
+                Entry &entry = m_entries[item->entry];
+                if (entry.var == item->var && entry.seenVersion == item->version) {
+                    entry.seenVersion = item->version + 1;
+                }
+            }
+        }
+    }
+
+    if (stale.isEmpty() && failed.isEmpty()) {
+        return;
+    }
+    if (m_calculationEngine) {
+        // 计算引擎非线程安全，这里可能在时间轮定时器或连接线程（markCommFail）中：
+        // 排队到引擎所在线程执行；排队期间被删除的变量不再交给引擎
+        QVector<QPointer<VariableDefinition>> changed;
+        changed.reserve(stale.size() + failed.size());
+        for (VariableDefinition *var : stale + failed) {
+            changed.append(var);
+        }
+        CalculationEngine *engine = m_calculationEngine;
+        QMetaObject::invokeMethod(engine, [engine, changed]() {
+            QList<VariableDefinition*> alive;
+            for (const QPointer<VariableDefinition> &var : changed) {
+                if (var) {
+                    alive.append(var.data());
+                }
+            }
+            engine->inputsChanged(alive);
+        }, Qt::QueuedConnection);
+    }
+    if (!stale.isEmpty()) {
+        emit tagsStale(stale);
+    }
+    if (!failed.isEmpty()) {
+        emit tagsFailed(failed);
+    }
+}
+
+void StalenessMonitor::onUpdateRateChanged(VariableDefinition *var, int rate)
+{
+    QMutexLocker locker(&m_mutex);
+    int index = m_index.value(var, -1);
+    if (index >= 0 && m_entries[index].followsUpdateRate && rate > 0) {
+        m_entries[index].intervalMs = rate;     // 下次计时生效
+    }
+}
+
+} // namespace Industrial
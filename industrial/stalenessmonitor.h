@@ -0,0 +1,130 @@
+// StalenessMonitor.h - 按期望更新周期检测陈旧数据，批量标记质量
+#ifndef STALENESSMONITOR_H
+#define STALENESSMONITOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+class CalculationEngine;
+
+// ==================== 陈旧检测 ====================
+// 每个登记的变量有一个期望更新周期（缺省取updateRate，订阅变量取服务器修订后的采样间隔），
+// 超过staleFactor个周期没有新值时质量置为QUALITY_OLD，超过failFactor个周期置为QUALITY_COMM_FAIL，
+// 值和时间戳保持不变；新值写入后质量随之恢复。
+// 截止时间挂在时间轮上（100ms一格，1024格），新值到达时把变量摘下重挂到新的截止格，O(1)；
+// 每格到期时只处理挂在该格上的变量，每次检查的代价与到期变量数成正比，与登记总数无关。
+// 超出时间轮范围的截止时间先挂在最远的格上，到期时再挂到剩余时间对应的格。
+// 只改时间戳的写入不发信号，到期时再比较值单元的写入次数，有写入的按新值重新计时。
+// 值变化的通知：变量开启信号时自动连接；批量变化通知的消费者把takeChangedVariables()的结果交给updated()。
+// 订阅只在值变化时通知，值长期不变的变量应把周期设为订阅的保活间隔。
+// 登记和更新可在任意线程调用；到期检查在监视器所在线程的定时器中进行
+class StalenessMonitor : public QObject {
+    Q_OBJECT
+public:
+    static const int RESOLUTION_MS = 100;   // 时间轮一格的时长
+    static const int WHEEL_SLOTS = 1024;
+
+    explicit StalenessMonitor(QObject *parent = nullptr);
+    ~StalenessMonitor();
+
+    // ==================== 变量登记 ====================
+    // intervalMs<=0时跟随变量的updateRate；重复登记时更新周期
+    void watch(VariableDefinition *var, int intervalMs = 0);
+    void watchAll(const QList<VariableDefinition*> &variables);
+    void unwatch(VariableDefinition *var);
+    void clear();
+    int watchedCount() const;
+
+    // 超过staleFactor个周期为QUALITY_OLD，超过failFactor个周期为QUALITY_COMM_FAIL
+    double staleFactor() const { return m_staleFactor; }
+    double failFactor() const { return m_failFactor; }
+    void setFactors(double staleFactor, double failFactor);     // 对之后的计时生效
+
+    // ==================== 新值通知 ====================
+    void updated(VariableDefinition *var);
+    void updated(const QList<VariableDefinition*> &variables);
+
+    // 连接断开：全部登记变量（或给出的变量）立即置为QUALITY_COMM_FAIL，新值到达后恢复计时
+    void markCommFail();
+    void markCommFail(const QList<VariableDefinition*> &variables);
+
+    // 质量变化的变量交给计算引擎，依赖它们的计算变量随之重算并沿用该质量；
+    // 通知排队到引擎所在线程，由该线程的事件循环执行
+    void setCalculationEngine(CalculationEngine *engine) { m_calculationEngine = engine; }
+
+    // ==================== 查询 ====================
+    int staleCount() const;             // 当前为QUALITY_OLD的登记变量数
+    int failedCount() const;            // 当前为QUALITY_COMM_FAIL的登记变量数
+    int checkPending();                 // 立即处理到期的格，返回本次改质量的变量数
+
+signals:
+    void tagsStale(const QList<VariableDefinition*> &variables);
+    void tagsFailed(const QList<VariableDefinition*> &variables);
+
+private:
+    enum State : quint8 {
+        STATE_FRESH,
+        STATE_STALE,
+        STATE_FAILED
+    };
+
+    struct Entry {
+        VariableDefinition *var = nullptr;      // nullptr为空闲项
+        int intervalMs = 0;
+        bool followsUpdateRate = false;
+        State state = STATE_FRESH;
+        qint64 deadline = 0;                    // m_clock毫秒
+        quint32 seenVersion = 0;                // 上次计时时值单元的写入次数
+        int slot = -1;                          // -1为不在时间轮上
+        int prev = -1;
+        int next = -1;
+    };
+
+    struct Expired {
+        int entry;
+        VariableDefinition *var;
+        DataQuality quality;
+        quint32 version;
+    };
+
+    // 以下由m_mutex保护
+    void link(int index, qint64 deadline);
+    void unlink(int index);
+    void restart(int index, qint64 now);        // 有新值，从FRESH重新计时
+    void setState(Entry &entry, State state);
+    qint64 timeout(const Entry &entry, State from) const;
+    static quint32 cellVersion(const VariableDefinition *var);
+
+    void onTick();
+    void applyExpired(const QVector<Expired> &expired);
+    void onUpdateRateChanged(VariableDefinition *var, int rate);
+
+    mutable QMutex m_mutex;
+    QVector<Entry> m_entries;
+    QVector<int> m_freeEntries;
+    QHash<const VariableDefinition*, int> m_index;
+    QVector<int> m_slots;               // 每格链表头（Entry下标）
+    qint64 m_currentTick = 0;           // 已处理到的格序号（m_clock毫秒 / RESOLUTION_MS）
+    int m_staleCount = 0;
+    int m_failedCount = 0;
+
+    double m_staleFactor = 3.0;
+    double m_failFactor = 10.0;
+
+    QElapsedTimer m_clock;              // 单调时钟，不受系统时间调整影响
+    QTimer *m_tickTimer;
+    QPointer<CalculationEngine> m_calculationEngine;
+};
+
+} // namespace Industrial
+
+#endif // STALENESSMONITOR_H
@@ -0,0 +1,573 @@
+// StatisticsEngine.cpp - 统计变量（TYPE_STAT）滚动窗口增量计算
+#include "statisticsengine.h"
+#include <QDebug>
+#include <cmath>
+
+// ==================== RollingStatistics 实现 ====================
+namespace Industrial {
+
+RollingStatistics::RollingStatistics(qint64 windowTicks, int maxSamples)
+    : m_window(qMax<qint64>(0, windowTicks))
+    , m_maxSamples(qMax(0, maxSamples))
+{
+}
+
+void RollingStatistics::setWindow(qint64 windowTicks)
+{
+    m_window = qMax<qint64>(0, windowTicks);
+}
+
+void RollingStatistics::add(double value, UaTimestamp timestamp)
+{
+    if (!std::isfinite(value)) {
+        return;
+    }
+    if (!m_samples.empty() && timestamp < m_samples.back().timestamp) {
+        timestamp = m_samples.back().timestamp;  // 保持队列按时间有序，过期才能只看队首
+    }
+    if (m_maxSamples > 0 && static_cast<int>(m_samples.size()) >= m_maxSamples) {
+        popFront();
+    }
+    if (m_samples.empty()) {
+        m_base = value;
+        m_sum = 0.0;
+        m_sumSquares = 0.0;
+        m_removedSinceResum = 0;
+    } else {
+        // 上一个样本的保持区段到此结束
+        const Sample &last = m_samples.back();
+        double seconds = UaTime::secondsBetween(last.timestamp, timestamp);
+        double delta = last.value - m_base;
+        m_sum += seconds * delta;
+        m_sumSquares += seconds * delta * delta;
+    }
+
+    Sample sample = { timestamp, value, m_nextSequence++ };
+    m_samples.push_back(sample);
+    m_now = qMax(m_now, timestamp);
+
+    // 新样本进队前弹出不可能再成为最值的样本
+    while (!m_minQueue.empty() && m_minQueue.back().value >= value) {
+        m_minQueue.pop_back();
+    }
+    m_minQueue.push_back(sample);
+    while (!m_maxQueue.empty() && m_maxQueue.back().value <= value) {
+        m_maxQueue.pop_back();
+    }
+    m_maxQueue.push_back(sample);
+}
+
+void RollingStatistics::expire(UaTimestamp now)
+{
+    m_now = qMax(m_now, now);
+    const UaTimestamp cutoff = m_now - m_window;
+    // 下一个样本也早于窗口起点时，队首的区段整段在窗口外；否则队首是左边界，保留
+    while (m_samples.size() >= 2 && m_samples[1].timestamp <= cutoff) {
+        popFront();
+    }
+}
+
+void RollingStatistics::clear()
+{
+    m_samples.clear();
+    m_minQueue.clear();
+    m_maxQueue.clear();
+    m_now = 0;
+    m_base = 0.0;
+    m_sum = 0.0;
+    m_sumSquares = 0.0;
+    m_removedSinceResum = 0;
+}
+
+void RollingStatistics::popFront()
+{
+    const Sample sample = m_samples.front();
+    m_samples.pop_front();
+    if (!m_minQueue.empty() && m_minQueue.front().sequence == sample.sequence) {
+        m_minQueue.pop_front();
+    }
+    if (!m_maxQueue.empty() && m_maxQueue.front().sequence == sample.sequence) {
+        m_maxQueue.pop_front();
+    }
+
+    if (m_samples.empty()) {
+        m_sum = 0.0;
+        m_sumSquares = 0.0;
+        m_removedSinceResum = 0;
+        return;
+    }
+
+    // 移出的是该样本到新队首之间的区段
+    double seconds = UaTime::secondsBetween(sample.timestamp, m_samples.front().timestamp);
+    double delta = sample.value - m_base;
+    m_sum -= seconds * delta;
+    m_sumSquares -= seconds * delta * delta;
+    if (++m_removedSinceResum >= static_cast<int>(m_samples.size())) {
+        resum();    // 每移出一个窗口长度的样本重算一次，均摊仍为O(1)
+    }
+}
+
+void RollingStatistics::resum()
+{
+    m_base = m_samples.front().value;
+    m_sum = 0.0;
+    m_sumSquares = 0.0;
+    for (size_t i = 0; i + 1 < m_samples.size(); i++) {
+        double seconds = UaTime::secondsBetween(m_samples[i].timestamp, m_samples[i + 1].timestamp);
+        double delta = m_samples[i].value - m_base;
+        m_sum += seconds * delta;
+        m_sumSquares += seconds * delta * delta;
+    }
+    m_removedSinceResum = 0;
+}
+
+UaTimestamp RollingStatistics::windowStart() const
+{
+    return qMax(m_samples.front().timestamp, m_now - m_window);
+}
+
+void RollingStatistics::weighted(double &seconds, double &sum, double &squares) const
+{
+    const Sample &first = m_samples.front();
+    const Sample &last = m_samples.back();
+    const UaTimestamp start = windowStart();
+    sum = m_sum;
+    squares = m_sumSquares;
+
+    // 右端：最后一个样本保持到当前
+    double open = UaTime::secondsBetween(last.timestamp, m_now);
+    double delta = last.value - m_base;
+    sum += open * delta;
+    squares += open * delta * delta;
+
+    // 左端：左边界样本只计窗口起点之后的部分
+    double trim = UaTime::secondsBetween(first.timestamp, start);
+    delta = first.value - m_base;
+    sum -= trim * delta;
+    squares -= trim * delta * delta;
+
+    seconds = UaTime::secondsBetween(start, m_now);
+}
+
+int RollingStatistics::count() const
+{
+    if (m_samples.empty()) {
+        return 0;
+    }
+    const bool edge = m_samples.front().timestamp < m_now - m_window;
+    return static_cast<int>(m_samples.size()) - (edge ? 1 : 0);
+}
+
+double RollingStatistics::duration() const
+{
+    return m_samples.empty() ? 0.0 : UaTime::secondsBetween(windowStart(), m_now);
+}
+
+double RollingStatistics::sum() const
+{
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    double seconds, sum, squares;
+    weighted(seconds, sum, squares);
+    return m_base * seconds + sum;
+}
+
+double RollingStatistics::average() const
+{
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    double seconds, sum, squares;
+    weighted(seconds, sum, squares);
+    if (seconds <= 0.0) {
+        return m_samples.back().value;  // 样本都在同一时刻，取最新值
+    }
+    return m_base + sum / seconds;
+}
+
+double RollingStatistics::minimum() const
+{
+    return m_minQueue.empty() ? 0.0 : m_minQueue.front().value;
+}
+
+double RollingStatistics::maximum() const
+{
+    return m_maxQueue.empty() ? 0.0 : m_maxQueue.front().value;
+}
+
+double RollingStatistics::variance() const
+{
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    double seconds, sum, squares;
+    weighted(seconds, sum, squares);
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    double mean = sum / seconds;
+    return qMax(0.0, squares / seconds - mean * mean);
+}
+
+double RollingStatistics::standardDeviation() const
+{
+    return std::sqrt(variance());
+}
+
+double RollingStatistics::rate() const
+{
+    if (m_samples.empty()) {
+        return 0.0;
+    }
+    double seconds = duration();
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    // 左边界样本的值保持到窗口起点，即窗口起点处的值
+    return (m_samples.back().value - m_samples.front().value) / seconds;
+}
+
+qint64 RollingStatistics::memoryUsage() const
+{
+    const size_t samples = m_samples.size() + m_minQueue.size() + m_maxQueue.size();
+    return static_cast<qint64>(sizeof(RollingStatistics) + samples * sizeof(Sample));
+}
+
+} // namespace Industrial
+
+// ==================== StatisticsEngine 实现 ====================
+namespace Industrial {
+
+static const StatisticsEngine::StatFunction ALL_STAT_FUNCTIONS[] = {
+    StatisticsEngine::STAT_AVG,
+    StatisticsEngine::STAT_MIN,
+    StatisticsEngine::STAT_MAX,
+    StatisticsEngine::STAT_SUM,
+    StatisticsEngine::STAT_STDDEV,
+    StatisticsEngine::STAT_COUNT,
+    StatisticsEngine::STAT_RATE
+};
+
+StatisticsEngine::StatisticsEngine(QObject *parent)
+    : QObject(parent)
+    , m_slideTimer(new QTimer(this))
+{
+    connect(m_slideTimer, &QTimer::timeout, this, &StatisticsEngine::onSlideTimeout);
+}
+
+StatisticsEngine::~StatisticsEngine()
+{
+}
+
+QString StatisticsEngine::suffix(StatFunction function)
+{
+    switch (function) {
+    case STAT_AVG:    return VariableNaming::SUFFIX_AVG;
+    case STAT_MIN:    return VariableNaming::SUFFIX_MIN;
+    case STAT_MAX:    return VariableNaming::SUFFIX_MAX;
+    case STAT_SUM:    return VariableNaming::SUFFIX_SUM;
+    case STAT_STDDEV: return VariableNaming::SUFFIX_STD;
+    case STAT_COUNT:  return VariableNaming::SUFFIX_CNT;
+    case STAT_RATE:   return VariableNaming::SUFFIX_RATE;
+    }
+    return QString();
+}
+
+QString StatisticsEngine::statTagName(const QString &sourceTag, StatFunction function)
+{
+    int last = sourceTag.lastIndexOf(TagName::SEPARATOR);
+    if (last < 0) {
+        return sourceTag + TagName::SEPARATOR + suffix(function);
+    }
+    return sourceTag.left(last + 1) + suffix(function);
+}
+
+// ==================== 统计登记 ====================
+QList<VariableDefinition*> StatisticsEngine::addStatistic(VariableDefinition *source, int windowSeconds,
+                                                          StatFunctions functions)
+{
+    QList<VariableDefinition*> published;
+    if (!source || windowSeconds <= 0 || !functions) {
+        qWarning() << "Invalid statistic definition for" << (source ? source->tagName() : QString());
+        return published;
+    }
+
+    const QString sourceTag = source->tagName();
+    if (!m_entries.contains(sourceTag)) {
+        Entry entry;
+        entry.source = source;
+        entry.window = RollingStatistics(static_cast<qint64>(windowSeconds) * UaTime::TICKS_PER_SEC);
+        acceptSample(entry);     // 当前值作为第一个样本
+        entry.dirty = true;
+        m_entries.insert(sourceTag, entry);
+
+        connect(source, &VariableDefinition::valueChanged, this, [this, source]() {
+            sourceChanged(source);
+        });
+        connect(source, &QObject::destroyed, this, [this, sourceTag]() {
+            removeStatistic(sourceTag);
+        });
+    }
+
+    Entry &entry = m_entries[sourceTag];
+    entry.window.setWindow(static_cast<qint64>(windowSeconds) * UaTime::TICKS_PER_SEC);
+    entry.functions = functions;
+
+    // 不再统计的项删除对应的统计变量
+    for (int i = entry.outputs.size() - 1; i >= 0; i--) {
+        if (!functions.testFlag(entry.outputs[i].function)) {
+            VariableDefinition *var = entry.outputs[i].variable;
+            m_outputs.remove(var->tagName());
+            var->deleteLater();
+            entry.outputs.remove(i);
+        }
+    }
+
+    const QString description = source->description().isEmpty() ? sourceTag : source->description();
+    for (StatFunction function : ALL_STAT_FUNCTIONS) {
+        if (!functions.testFlag(function)) {
+            continue;
+        }
+        VariableDefinition *var = nullptr;
+        for (const Output &output : entry.outputs) {
+            if (output.function == function) {
+                var = output.variable;
+            }
+        }
+        if (!var) {
+            var = createOutput(entry, function);
+            if (!var) {
+                continue;
+            }
+            entry.outputs.append({ function, var });
+        }
+        var->setDescription(QString("%1 %2 (%3s)").arg(description, suffix(function)).arg(windowSeconds));
+        published.append(var);
+    }
+
+    entry.dirty = true;
+    schedulePublish();
+    setSlideInterval(m_slideInterval);
+    return published;
+}
+
+VariableDefinition* StatisticsEngine::createOutput(const Entry &entry, StatFunction function)
+{
+    const QString tagName = statTagName(entry.source->tagName(), function);
+    if (tagName == entry.source->tagName() || m_outputs.contains(tagName)) {
+        qWarning() << "Statistic tag already in use:" << tagName;
+        return nullptr;
+    }
+
+    VariableDefinition *var = new VariableDefinition(tagName, TYPE_STAT, this);
+    switch (function) {
+    case STAT_AVG:
+    case STAT_MIN:
+    case STAT_MAX:
+        var->setUnit(entry.source->unit());
+        var->setRange(entry.source->minValue(), entry.source->maxValue());
+        break;
+    case STAT_SUM:
+    case STAT_STDDEV:
+        var->setUnit(entry.source->unit());
+        var->setRange(0.0, 0.0);    // 相等时不做范围检查
+        break;
+    case STAT_COUNT:
+    case STAT_RATE:
+        var->setRange(0.0, 0.0);
+        break;
+    }
+    var->setAlarmLevel(ALARM_NONE);
+    var->setWritable(false);
+    var->addRelatedVariable(entry.source->tagName());
+
+    m_outputs.insert(tagName, var);
+    return var;
+}
+
+void StatisticsEngine::removeStatistic(const QString &sourceTag)
+{
+    auto it = m_entries.find(sourceTag);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    disconnect(it->source, nullptr, this, nullptr);
+    for (const Output &output : it->outputs) {
+        m_outputs.remove(output.variable->tagName());
+        output.variable->deleteLater();
+    }
+    m_entries.erase(it);
+
+    if (m_entries.isEmpty()) {
+        m_slideTimer->stop();
+    }
+}
+
+void StatisticsEngine::clear()
+{
+    const QStringList sources = m_entries.keys();
+    for (const QString &sourceTag : sources) {
+        removeStatistic(sourceTag);
+    }
+}
+
+// ==================== 样本输入 ====================
+void StatisticsEngine::acceptSample(Entry &entry)
+{
+    ValueSample sample = entry.source->sample();
+    if (!VariableDefinition::isNumericSample(sample) || sample.quality != QUALITY_GOOD) {
+        return;
+    }
+    entry.window.add(VariableDefinition::sampleToDouble(sample),
+                     sample.timestamp > 0 ? sample.timestamp : UaTime::now());
+}
+
+void StatisticsEngine::sourceChanged(VariableDefinition *source)
+{
+    auto it = m_entries.find(source->tagName());
+    if (it == m_entries.end() || it->source != source) {
+        return;
+    }
+    acceptSample(*it);
+    it->dirty = true;
+    schedulePublish();
+}
+
+void StatisticsEngine::sourcesChanged(const QList<VariableDefinition*> &sources)
+{
+    for (VariableDefinition *source : sources) {
+        sourceChanged(source);
+    }
+}
+
+void StatisticsEngine::schedulePublish()
+{
+    if (!m_publishScheduled) {
+        m_publishScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            publishPending();
+        });
+    }
+}
+
+int StatisticsEngine::publishPending()
+{
+    m_publishScheduled = false;
+    const UaTimestamp now = UaTime::now();
+
+    int written = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->dirty) {
+            publishEntry(*it, now, written);
+        }
+    }
+
+    if (written > 0) {
+        emit statisticsPublished(written);
+    }
+    return written;
+}
+
+void StatisticsEngine::setSlideInterval(int msecs)
+{
+    m_slideInterval = qMax(0, msecs);
+    if (m_slideInterval > 0 && !m_entries.isEmpty()) {
+        if (!m_slideTimer->isActive() || m_slideTimer->interval() != m_slideInterval) {
+            m_slideTimer->start(m_slideInterval);
+        }
+    } else {
+        m_slideTimer->stop();
+    }
+}
+
+void StatisticsEngine::onSlideTimeout()
+{
+    const UaTimestamp now = UaTime::now();
+
+    // 时间加权的结果随时间推移变化，全部重算；值不变的不写入
+    int written = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        publishEntry(*it, now, written);
+    }
+
+    if (written > 0) {
+        emit statisticsPublished(written);
+    }
+}
+
+void StatisticsEngine::publishEntry(Entry &entry, UaTimestamp now, int &written)
+{
+    RollingStatistics &window = entry.window;
+    window.expire(now);
+
+    // 新样本触发时用样本时间戳，窗口滑动触发时用当前时间
+    const UaTimestamp timestamp = entry.dirty && !window.isEmpty() ? window.lastTimestamp() : now;
+    entry.dirty = false;
+
+    // 源变量失去GOOD质量时窗口仍保持最后的好值，结果降为UNCERTAIN
+    const bool usable = !window.isEmpty() && entry.source->quality() == QUALITY_GOOD;
+    for (const Output &output : entry.outputs) {
+        double value = 0.0;
+        DataQuality quality = usable ? QUALITY_GOOD : QUALITY_UNCERTAIN;
+        switch (output.function) {
+        case STAT_AVG:    value = window.average(); break;
+        case STAT_MIN:    value = window.minimum(); break;
+        case STAT_MAX:    value = window.maximum(); break;
+        case STAT_SUM:    value = window.sum(); break;
+        case STAT_STDDEV: value = window.standardDeviation(); break;
+        case STAT_COUNT:
+            value = window.count();
+            quality = QUALITY_GOOD;
+            break;
+        case STAT_RATE:
+            value = window.rate();
+            if (window.duration() <= 0.0) {
+                quality = QUALITY_UNCERTAIN;
+            }
+            break;
+        }
+
+        ValueSample before = output.variable->sample();
+        if (VariableDefinition::isNumericSample(before) && before.quality == quality &&
+            VariableDefinition::sampleToDouble(before) == value) {
+            continue;
+        }
+        output.variable->setDoubleValue(value, timestamp, quality);
+        written++;
+    }
+}
+
+// ==================== 查询 ====================
+bool StatisticsEngine::statistics(const QString &sourceTag, StatisticsResult &result)
+{
+    auto it = m_entries.find(sourceTag);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    RollingStatistics &window = it->window;
+    window.expire(UaTime::now());
+    result.count = window.count();
+    result.sum = window.sum();
+    result.average = window.average();
+    result.minimum = window.minimum();
+    result.maximum = window.maximum();
+    result.standardDeviation = window.standardDeviation();
+    result.rate = window.rate();
+    result.timestamp = window.lastTimestamp();
+    return true;
+}
+
+QList<VariableDefinition*> StatisticsEngine::statVariables() const
+{
+    return m_outputs.values();
+}
+
+VariableDefinition* StatisticsEngine::statVariable(const QString &tagName) const
+{
+    return m_outputs.value(tagName, nullptr);
+}
+
+} // namespace Industrial
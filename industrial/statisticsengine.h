@@ -0,0 +1,166 @@
+// StatisticsEngine.h - 统计变量（TYPE_STAT）滚动窗口增量计算
+#ifndef STATISTICSENGINE_H
+#define STATISTICSENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <deque>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 滚动窗口统计 ====================
+// 按采样保持做时间加权：每个样本的值保持到下一个样本，权重为保持的时长，最后一个样本保持到当前时间。
+// 窗口滑动时，最后一个早于窗口起点的样本留作左边界，从窗口起点开始计入，值长期不变的变量窗口不会变空。
+// 相邻样本之间的区段进出窗口时增减加权和与加权平方和，两端不完整的区段在查询时补算；
+// 最小/最大值用单调队列维护，每个样本进出队列各一次，更新和查询均摊O(1)。
+// 累计和以窗口内某个样本值为基准，移出的样本数达到窗口内样本数时按新基准重算，误差不随运行时间累积
+class RollingStatistics {
+public:
+    explicit RollingStatistics(qint64 windowTicks = 60 * UaTime::TICKS_PER_SEC, int maxSamples = 0);
+
+    qint64 window() const { return m_window; }
+    void setWindow(qint64 windowTicks);             // 缩短时下次expire生效
+    int maxSamples() const { return m_maxSamples; }
+
+    void add(double value, UaTimestamp timestamp);  // 非有限数忽略；时间戳早于上一个样本时按上一个计
+    void expire(UaTimestamp now);                   // 窗口滑到now，整段早于窗口起点的样本移出，保留左边界
+    void clear();
+
+    int count() const;                  // 窗口内收到的样本数（不含左边界）
+    bool isEmpty() const { return m_samples.empty(); }     // 没有任何可用样本
+    double duration() const;            // 窗口实际覆盖的秒数（样本不足一个窗口时从第一个样本算起）
+    double sum() const;                 // 时间积分（值×秒）
+    double average() const;             // 时间加权平均；窗口为空时以下各值为0
+    double minimum() const;
+    double maximum() const;
+    double variance() const;            // 时间加权的总体方差
+    double standardDeviation() const;
+    double rate() const;                // 窗口起点到当前的平均每秒变化率
+    UaTimestamp lastTimestamp() const { return m_samples.empty() ? 0 : m_samples.back().timestamp; }
+    qint64 memoryUsage() const;         // 窗口和单调队列中样本占用的字节数
+
+private:
+    struct Sample {
+        UaTimestamp timestamp;
+        double value;
+        quint64 sequence;
+    };
+
+    void popFront();
+    void resum();
+    UaTimestamp windowStart() const;    // max(第一个样本, 当前 - 窗口)
+    void weighted(double &seconds, double &sum, double &squares) const;  // 含两端补算，相对m_base
+
+    qint64 m_window;
+    int m_maxSamples;                   // 0为不限
+    std::deque<Sample> m_samples;
+    std::deque<Sample> m_minQueue;      // 值递增，队首为最小值
+    std::deque<Sample> m_maxQueue;      // 值递减，队首为最大值
+    quint64 m_nextSequence = 0;
+    UaTimestamp m_now = 0;              // 最近一次add/expire的时间，查询按此计算
+    double m_base = 0.0;
+    double m_sum = 0.0;                 // 相邻样本之间的区段：Σ 时长 × (值 - m_base)
+    double m_sumSquares = 0.0;          // Σ 时长 × (值 - m_base)²
+    int m_removedSinceResum = 0;
+};
+
+// ==================== 统计结果 ====================
+struct StatisticsResult {
+    int count = 0;
+    double sum = 0.0;
+    double average = 0.0;
+    double minimum = 0.0;
+    double maximum = 0.0;
+    double standardDeviation = 0.0;
+    double rate = 0.0;
+    UaTimestamp timestamp = 0;          // 窗口内最新样本的时间戳
+};
+
+// ==================== 统计引擎 ====================
+// 对源变量的GOOD质量数值样本维护滚动窗口，结果发布为TYPE_STAT变量：
+// 标签名把源标签最后一段换成后缀，例如AREA1.TT101.TEMP.PV -> AREA1.TT101.TEMP.AVG。
+// 源变量变化时更新窗口，同一轮事件中的变化合并后发布；时间加权的结果随时间推移变化，
+// 定时器每次滑动都重新计算全部窗口，发布的值与原值相同时不写入。源变量质量不是GOOD时结果为UNCERTAIN。
+// 报表和界面直接读统计变量，不再扫描历史。
+// 输入关闭逐个信号（批量变化通知）时由消费者调用sourcesChanged()。非线程安全，在引擎所在线程使用
+class StatisticsEngine : public QObject {
+    Q_OBJECT
+public:
+    enum StatFunction {
+        STAT_AVG    = 0x01,
+        STAT_MIN    = 0x02,
+        STAT_MAX    = 0x04,
+        STAT_SUM    = 0x08,
+        STAT_STDDEV = 0x10,
+        STAT_COUNT  = 0x20,
+        STAT_RATE   = 0x40
+    };
+    Q_DECLARE_FLAGS(StatFunctions, StatFunction)
+
+    explicit StatisticsEngine(QObject *parent = nullptr);
+    ~StatisticsEngine();
+
+    // ==================== 统计登记 ====================
+    // 每个源变量一个窗口，重复登记时替换窗口长度和统计项；返回本次发布的统计变量（属于引擎）
+    QList<VariableDefinition*> addStatistic(VariableDefinition *source, int windowSeconds,
+                                            StatFunctions functions = StatFunctions(STAT_AVG | STAT_SUM | STAT_RATE));
+    void removeStatistic(const QString &sourceTag);
+    void clear();
+
+    // ==================== 样本输入 ====================
+    void sourceChanged(VariableDefinition *source);
+    void sourcesChanged(const QList<VariableDefinition*> &sources);
+    int publishPending();               // 发布有变化的窗口，返回写入的统计变量数
+
+    // 窗口滑动的检查周期（毫秒），0为只在有新样本时发布
+    int slideInterval() const { return m_slideInterval; }
+    void setSlideInterval(int msecs);
+
+    // ==================== 查询 ====================
+    bool statistics(const QString &sourceTag, StatisticsResult &result);
+    QList<VariableDefinition*> statVariables() const;
+    VariableDefinition* statVariable(const QString &tagName) const;
+    int windowCount() const { return m_entries.size(); }
+
+    static QString suffix(StatFunction function);
+    static QString statTagName(const QString &sourceTag, StatFunction function);
+
+signals:
+    void statisticsPublished(int count);
+
+private:
+    struct Output {
+        StatFunction function;
+        VariableDefinition *variable;
+    };
+
+    struct Entry {
+        VariableDefinition *source = nullptr;
+        RollingStatistics window;
+        StatFunctions functions;
+        QVector<Output> outputs;
+        bool dirty = false;
+    };
+
+    void acceptSample(Entry &entry);
+    void publishEntry(Entry &entry, UaTimestamp now, int &written);
+    void schedulePublish();
+    void onSlideTimeout();
+    VariableDefinition* createOutput(const Entry &entry, StatFunction function);
+
+    QHash<QString, Entry> m_entries;            // 源标签名 -> 窗口
+    QHash<QString, VariableDefinition*> m_outputs;  // 统计标签名 -> 统计变量
+    QTimer *m_slideTimer;
+    int m_slideInterval = 1000;
+    bool m_publishScheduled = false;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StatisticsEngine::StatFunctions)
+
+} // namespace Industrial
+
+#endif // STATISTICSENGINE_H
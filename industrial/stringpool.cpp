@@ -0,0 +1,174 @@
+// StringPool.cpp - 字符串池与分段标签名
+#include "stringpool.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace Industrial {
+
+StringPool::StringPool()
+{
+    intern(QString());  // 编号0为空字符串
+}
+
+StringPool::~StringPool()
+{
+}
+
+StringPool* StringPool::global()
+{
+    // 不析构：变量可能在静态对象析构之后才读取字符串
+    static StringPool *pool = new StringPool;
+    return pool;
+}
+
+StringPool::Id StringPool::intern(const QString &text)//取得编号
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_ids.constFind(text);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    Id id = m_count.load(std::memory_order_relaxed);
+    int block = static_cast<int>(id / BLOCK_SIZE);
+    if (block >= MAX_BLOCKS) {
+        qCritical() << "StringPool exhausted:" << id << "strings";
+        return EMPTY_ID;
+    }
+    if (!m_blocks[block]) {
+        m_blocks[block].reset(new QString[BLOCK_SIZE]);
+    }
+
+    // 池中和索引中保存同一份数据，调用者传入的字符串也共享它
+    m_blocks[block][id % BLOCK_SIZE] = text;
+    m_ids.insert(text, id);
+    m_textBytes += static_cast<qint64>(text.size()) * static_cast<qint64>(sizeof(QChar));
+    m_count.store(id + 1, std::memory_order_release);  // 写入完成后才对读者可见
+    return id;
+}
+
+StringPool::Id StringPool::find(const QString &text) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ids.value(text, INVALID_ID);
+}
+
+QString StringPool::string(Id id) const
+{
+    if (id >= m_count.load(std::memory_order_acquire)) {
+        return QString();
+    }
+    return m_blocks[id / BLOCK_SIZE][id % BLOCK_SIZE];
+}
+
+qint64 StringPool::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 blocks = 0;
+    for (int i = 0; i < MAX_BLOCKS && m_blocks[i]; i++) {
+        blocks++;
+    }
+    // 块表 + 文本 + 哈希索引（每项按键、值和节点指针估算）
+    return blocks * BLOCK_SIZE * static_cast<qint64>(sizeof(QString))
+           + m_textBytes
+           + static_cast<qint64>(m_ids.size()) * static_cast<qint64>(sizeof(QString) + sizeof(Id) + 2 * sizeof(void*));
+}
+
+// ==================== 分段标签名 ====================
+const QChar TagName::SEPARATOR = QLatin1Char('.');
+
+TagName::TagName(const QString &name, StringPool *pool)
+{
+    if (name.isEmpty()) {
+        return;
+    }
+    int start = 0;
+    while (true) {
+        int end = name.indexOf(SEPARATOR, start);
+        if (end < 0) {
+            m_segments.append(pool->intern(name.mid(start)));
+            break;
+        }
+        m_segments.append(pool->intern(name.mid(start, end - start)));
+        start = end + 1;
+    }
+}
+
+TagName TagName::fromSegments(const QStringList &segments, StringPool *pool)
+{
+    TagName name;
+    for (const QString &segment : segments) {
+        name.m_segments.append(pool->intern(segment));
+    }
+    return name;
+}
+
+QString TagName::toString(StringPool *pool) const
+{
+    if (m_segments.size() == 1) {
+        return pool->string(m_segments[0]);   // 只有一段时直接共享池中的字符串
+    }
+
+    // 先取各段求总长，只分配一次
+    QVarLengthArray<QString, 4> parts;
+    int length = qMax(0, m_segments.size() - 1);
+    for (SegmentId id : m_segments) {
+        parts.append(pool->string(id));
+        length += parts.last().size();
+    }
+    QString result;
+    result.reserve(length);
+    for (int i = 0; i < parts.size(); i++) {
+        if (i > 0) {
+            result += SEPARATOR;
+        }
+        result += parts[i];
+    }
+    return result;
+}
+
+QString TagName::segmentString(int index, StringPool *pool) const
+{
+    if (index < 0 || index >= m_segments.size()) {
+        return QString();
+    }
+    return pool->string(m_segments[index]);
+}
+
+bool TagName::startsWith(const TagName &prefix) const
+{
+    if (prefix.m_segments.size() > m_segments.size()) {
+        return false;
+    }
+    for (int i = 0; i < prefix.m_segments.size(); i++) {
+        if (m_segments[i] != prefix.m_segments[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TagName::operator==(const TagName &other) const
+{
+    if (m_segments.size() != other.m_segments.size()) {
+        return false;
+    }
+    for (int i = 0; i < m_segments.size(); i++) {
+        if (m_segments[i] != other.m_segments[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t qHash(const TagName &name, size_t seed)
+{
+    size_t h = seed ^ static_cast<size_t>(name.segmentCount());
+    for (int i = 0; i < name.segmentCount(); i++) {
+        h = h * 31u + name.segment(i);
+    }
+    return h;
+}
+
+} // namespace Industrial
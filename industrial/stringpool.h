@@ -0,0 +1,89 @@
+// StringPool.h - 字符串池与分段标签名
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <QVarLengthArray>
+#include <memory>
+#include <atomic>
+
+namespace Industrial {
+
+// ==================== 字符串池 ====================
+// 低基数字符串（数据类型、访问组、显示格式、单位后缀、标签名各段）只存一份，变量里只保存编号。
+// 编号在进程内稳定：只增不删，相同字符串总是得到相同编号，比较编号即比较字符串。
+// 按块存放，扩容时不移动已有字符串；intern()加锁，string()无锁读取
+class StringPool {
+public:
+    typedef quint32 Id;
+
+    static const Id EMPTY_ID = 0;                   // 空字符串固定为0
+    static const Id INVALID_ID = 0xFFFFFFFFu;
+    static const int BLOCK_SIZE = 1024;
+    static const int MAX_BLOCKS = 4096;
+
+    StringPool();
+    ~StringPool();
+
+    static StringPool* global();
+
+    Id intern(const QString &text);                 // 取得编号，不存在时加入
+    Id find(const QString &text) const;             // 只查找，不存在返回INVALID_ID
+    QString string(Id id) const;                    // 返回共享的QString，只增加引用计数
+    bool contains(Id id) const { return id < static_cast<Id>(size()); }
+
+    int size() const { return static_cast<int>(m_count.load(std::memory_order_acquire)); }
+    qint64 memoryUsage() const;                     // 字符串和索引占用的内存估算(bytes)
+
+private:
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    mutable QMutex m_mutex;                         // intern之间互斥，保护m_ids
+    QHash<QString, Id> m_ids;
+    std::unique_ptr<QString[]> m_blocks[MAX_BLOCKS];
+    std::atomic<quint32> m_count{0};                // 已发布的字符串数，读者据此判断编号有效
+    qint64 m_textBytes = 0;
+};
+
+// ==================== 分段标签名 ====================
+// VariableNaming生成的"区域.设备.变量.后缀"按'.'拆开，每段保存字符串池编号。
+// 同一区域、设备下的标签共享段字符串；相等和前缀比较只比较编号
+class TagName {
+public:
+    typedef StringPool::Id SegmentId;
+    static const QChar SEPARATOR;
+
+    TagName() = default;
+    explicit TagName(const QString &name, StringPool *pool = StringPool::global());
+    static TagName fromSegments(const QStringList &segments, StringPool *pool = StringPool::global());
+
+    QString toString(StringPool *pool = StringPool::global()) const;
+
+    int segmentCount() const { return m_segments.size(); }
+    SegmentId segment(int index) const { return m_segments.value(index, StringPool::EMPTY_ID); }
+    QString segmentString(int index, StringPool *pool = StringPool::global()) const;
+    bool isEmpty() const { return m_segments.isEmpty(); }
+
+    // 按VariableNaming的约定取各段编号（段数不足时为EMPTY_ID）
+    SegmentId area() const { return segment(0); }
+    SegmentId device() const { return segment(1); }
+    SegmentId suffix() const { return m_segments.isEmpty() ? StringPool::EMPTY_ID : m_segments.last(); }
+
+    bool startsWith(const TagName &prefix) const;   // prefix的各段是否为本名的前几段
+    bool operator==(const TagName &other) const;
+    bool operator!=(const TagName &other) const { return !(*this == other); }
+
+private:
+    QVarLengthArray<SegmentId, 4> m_segments;       // 常见的4段不单独分配
+};
+
+size_t qHash(const TagName &name, size_t seed = 0);
+
+} // namespace Industrial
+
+#endif // STRINGPOOL_H
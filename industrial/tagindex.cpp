@@ -0,0 +1,461 @@
+// TagIndex.cpp - 标签名分段索引
+#include "tagindex.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace Industrial {
+
+namespace {
+// 按'.'拆分，只引用原字符串
+QVector<QStringView> splitSegments(const QString &text)
+{
+    QVector<QStringView> segments;
+    QStringView view(text);
+    qsizetype start = 0;
+    while (true) {
+        qsizetype end = view.indexOf(TagName::SEPARATOR, start);
+        if (end < 0) {
+            segments.append(view.mid(start));
+            break;
+        }
+        segments.append(view.mid(start, end - start));
+        start = end + 1;
+    }
+    return segments;
+}
+
+bool isDoubleStar(QStringView segment)
+{
+    return segment.size() == 2 && segment[0] == QLatin1Char('*') && segment[1] == QLatin1Char('*');
+}
+
+// 第一个通配符之前的字面前缀
+QStringView literalPrefix(QStringView segment)
+{
+    for (qsizetype i = 0; i < segment.size(); i++) {
+        if (segment[i] == QLatin1Char('*') || segment[i] == QLatin1Char('?')) {
+            return segment.left(i);
+        }
+    }
+    return segment;
+}
+
+bool hasWildcard(QStringView segment)
+{
+    return literalPrefix(segment).size() != segment.size();
+}
+}
+
+TagIndex::TagIndex(StringPool *pool)
+    : m_pool(pool)
+{
+    m_nodes.append(Node());     // 根节点
+}
+
+// ==================== 修改 ====================
+bool TagIndex::insert(const QString &tagName, TagId id)
+{
+    if (tagName.isEmpty() || id == INVALID_ID) {
+        qWarning() << "TagIndex: invalid tag" << tagName << id;
+        return false;
+    }
+
+    QWriteLocker locker(&m_lock);
+
+    int existing = findNode(tagName);
+    auto owner = m_idNodes.constFind(id);
+    if (owner != m_idNodes.constEnd() && owner.value() != existing) {
+        qWarning() << "TagIndex: id" << id << "already used by" << tagName;
+        return false;
+    }
+
+    int node = existing;
+    if (node < 0) {
+        node = 0;
+        for (QStringView segment : splitSegments(tagName)) {
+            int child = findChild(node, segment);
+            if (child < 0) {
+                int pos = lowerBound(node, segment);
+                child = allocateNode(segment.toString(), node);
+                m_nodes[node].children.insert(pos, child);
+            }
+            node = child;
+        }
+    }
+
+    Node &target = m_nodes[node];
+    if (target.id != INVALID_ID && target.id != id) {
+        m_idNodes.remove(target.id);
+    }
+    target.id = id;
+    m_idNodes.insert(id, node);
+    return true;
+}
+
+bool TagIndex::remove(const QString &tagName)
+{
+    QWriteLocker locker(&m_lock);
+    int node = findNode(tagName);
+    if (node <= 0 || m_nodes[node].id == INVALID_ID) {
+        return false;
+    }
+    releaseTag(node);
+    return true;
+}
+
+bool TagIndex::removeId(TagId id)
+{
+    QWriteLocker locker(&m_lock);
+    int node = m_idNodes.value(id, -1);
+    if (node <= 0) {
+        return false;
+    }
+    releaseTag(node);
+    return true;
+}
+
+void TagIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+    m_nodes.clear();
+    m_nodes.append(Node());
+    m_freeNodes.clear();
+    m_idNodes.clear();
+}
+
+// ==================== 查询 ====================
+TagIndex::TagId TagIndex::find(const QString &tagName) const
+{
+    QReadLocker locker(&m_lock);
+    int node = findNode(tagName);
+    return node > 0 ? m_nodes[node].id : INVALID_ID;
+}
+
+QString TagIndex::tagName(TagId id) const
+{
+    QReadLocker locker(&m_lock);
+    int node = m_idNodes.value(id, -1);
+    if (node <= 0) {
+        return QString();
+    }
+
+    QVarLengthArray<int, 8> path;
+    for (; node > 0; node = m_nodes[node].parent) {
+        path.append(node);
+    }
+    QString result;
+    for (int i = path.size() - 1; i >= 0; i--) {
+        result += m_nodes[path[i]].segment;
+        if (i > 0) {
+            result += TagName::SEPARATOR;
+        }
+    }
+    return result;
+}
+
+int TagIndex::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_idNodes.size();
+}
+
+QVector<TagIndex::TagId> TagIndex::findPrefix(const QString &prefix) const
+{
+    QVector<TagId> result;
+    QReadLocker locker(&m_lock);
+
+    if (prefix.isEmpty()) {
+        collect(0, result);
+        return result;
+    }
+
+    // 前面各段须完整匹配，最后一段按字符串前缀
+    QVector<QStringView> segments = splitSegments(prefix);
+    int node = 0;
+    for (int i = 0; i < segments.size() - 1; i++) {
+        node = findChild(node, segments[i]);
+        if (node < 0) {
+            return result;
+        }
+    }
+
+    QStringView last = segments.last();
+    const QVector<int> &children = m_nodes[node].children;
+    for (int pos = lowerBound(node, last); pos < children.size(); pos++) {
+        int child = children[pos];
+        if (!QStringView(m_nodes[child].segment).startsWith(last)) {
+            break;
+        }
+        collect(child, result);
+    }
+    return result;
+}
+
+QVector<TagIndex::TagId> TagIndex::findWildcard(const QString &pattern) const
+{
+    QVector<TagId> result;
+    if (pattern.isEmpty()) {
+        return result;
+    }
+
+    QVector<QStringView> segments = splitSegments(pattern);
+    if (segments.size() > MAX_PATTERN_SEGMENTS) {
+        qWarning() << "TagIndex: pattern has too many segments:" << pattern;
+        return result;
+    }
+
+    QReadLocker locker(&m_lock);
+    matchWildcard(0, closure(1, segments), segments, result);
+    return result;
+}
+
+QVector<TagIndex::TagId> TagIndex::findRegex(const QRegularExpression &regex) const
+{
+    QVector<TagId> result;
+    if (!regex.isValid()) {
+        qWarning() << "TagIndex: invalid regular expression:" << regex.errorString();
+        return result;
+    }
+
+    // 须匹配整个标签名，部分匹配才能判断分支下是否可能有结果
+    QRegularExpression anchored(QRegularExpression::anchoredPattern(regex.pattern()),
+                                regex.patternOptions());
+    QReadLocker locker(&m_lock);
+    QString path;
+    matchRegex(0, path, anchored, result);
+    return result;
+}
+
+QStringList TagIndex::childSegments(const QString &path) const
+{
+    QStringList result;
+    QReadLocker locker(&m_lock);
+
+    int node = path.isEmpty() ? 0 : findNode(path);
+    if (node < 0) {
+        return result;
+    }
+    for (int child : m_nodes[node].children) {
+        result.append(m_nodes[child].segment);
+    }
+    return result;
+}
+
+bool TagIndex::matchSegment(QStringView pattern, QStringView segment)
+{
+    qsizetype p = 0;
+    qsizetype s = 0;
+    qsizetype star = -1;
+    qsizetype mark = 0;
+
+    while (s < segment.size()) {
+        if (p < pattern.size() && (pattern[p] == QLatin1Char('?') || pattern[p] == segment[s])) {
+            p++;
+            s++;
+        } else if (p < pattern.size() && pattern[p] == QLatin1Char('*')) {
+            star = p++;
+            mark = s;
+        } else if (star >= 0) {
+            // 回到上一个'*'，让它多吃一个字符
+            p = star + 1;
+            s = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == QLatin1Char('*')) {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+// ==================== 私有方法 ====================
+int TagIndex::lowerBound(int node, QStringView segment) const
+{
+    const QVector<int> &children = m_nodes[node].children;
+    auto it = std::lower_bound(children.constBegin(), children.constEnd(), segment,
+                               [this](int child, QStringView value) {
+        return QStringView(m_nodes[child].segment).compare(value) < 0;
+    });
+    return static_cast<int>(it - children.constBegin());
+}
+
+int TagIndex::findChild(int node, QStringView segment) const
+{
+    const QVector<int> &children = m_nodes[node].children;
+    int pos = lowerBound(node, segment);
+    if (pos < children.size() && QStringView(m_nodes[children[pos]].segment) == segment) {
+        return children[pos];
+    }
+    return -1;
+}
+
+int TagIndex::findNode(const QString &tagName) const
+{
+    if (tagName.isEmpty()) {
+        return -1;
+    }
+    int node = 0;
+    for (QStringView segment : splitSegments(tagName)) {
+        node = findChild(node, segment);
+        if (node < 0) {
+            return -1;
+        }
+    }
+    return node;
+}
+
+int TagIndex::allocateNode(const QString &segment, int parent)
+{
+    Node node;
+    node.segment = m_pool->string(m_pool->intern(segment));   // 共享池中的字符串
+    node.parent = parent;
+
+    if (!m_freeNodes.isEmpty()) {
+        int index = m_freeNodes.takeLast();
+        m_nodes[index] = node;
+        return index;
+    }
+    m_nodes.append(node);
+    return m_nodes.size() - 1;
+}
+
+void TagIndex::releaseTag(int node)
+{
+    m_idNodes.remove(m_nodes[node].id);
+    m_nodes[node].id = INVALID_ID;
+
+    // 既不是标签也没有子节点的节点从父节点摘下，放回空闲表
+    while (node > 0 && m_nodes[node].id == INVALID_ID && m_nodes[node].children.isEmpty()) {
+        int parent = m_nodes[node].parent;
+        QVector<int> &siblings = m_nodes[parent].children;
+        siblings.remove(lowerBound(parent, m_nodes[node].segment));
+        m_nodes[node] = Node();
+        m_freeNodes.append(node);
+        node = parent;
+    }
+}
+
+void TagIndex::collect(int node, QVector<TagId> &result) const
+{
+    const Node &current = m_nodes[node];
+    if (current.id != INVALID_ID) {
+        result.append(current.id);
+    }
+    for (int child : current.children) {
+        collect(child, result);
+    }
+}
+
+quint64 TagIndex::closure(quint64 positions, const QVector<QStringView> &pattern)
+{
+    // "**"可以不匹配任何段，直接进入下一位置
+    for (int i = 0; i < pattern.size(); i++) {
+        if ((positions & (quint64(1) << i)) && isDoubleStar(pattern[i])) {
+            positions |= quint64(1) << (i + 1);
+        }
+    }
+    return positions;
+}
+
+void TagIndex::matchWildcard(int node, quint64 positions, const QVector<QStringView> &pattern,
+                             QVector<TagId> &result) const
+{
+    // positions的第i位表示下一段从模式第i段开始匹配，第pattern.size()位表示已完整匹配
+    const int count = pattern.size();
+    const Node &current = m_nodes[node];
+    if (node > 0 && current.id != INVALID_ID && (positions & (quint64(1) << count))) {
+        result.append(current.id);
+    }
+    if (current.children.isEmpty()) {
+        return;
+    }
+
+    // 只有字面前缀的位置按二分查找取子节点范围，以通配符开头的位置要看全部子节点
+    QVarLengthArray<int, 16> candidates;
+    bool scanAll = false;
+    int active = 0;
+    for (int i = 0; i < count && !scanAll; i++) {
+        if (!(positions & (quint64(1) << i))) {
+            continue;
+        }
+        active++;
+        QStringView prefix = literalPrefix(pattern[i]);
+        if (prefix.isEmpty()) {
+            scanAll = true;
+            break;
+        }
+        int pos = lowerBound(node, prefix);
+        if (!hasWildcard(pattern[i])) {
+            if (pos < current.children.size() && QStringView(m_nodes[current.children[pos]].segment) == prefix) {
+                candidates.append(pos);
+            }
+            continue;
+        }
+        for (; pos < current.children.size(); pos++) {
+            if (!QStringView(m_nodes[current.children[pos]].segment).startsWith(prefix)) {
+                break;
+            }
+            candidates.append(pos);
+        }
+    }
+    if (active == 0 && !scanAll) {
+        return;
+    }
+    if (!scanAll && active > 1) {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    int total = scanAll ? current.children.size() : candidates.size();
+    for (int k = 0; k < total; k++) {
+        int child = current.children[scanAll ? k : candidates[k]];
+        QStringView segment(m_nodes[child].segment);
+
+        quint64 next = 0;
+        for (int i = 0; i < count; i++) {
+            if (!(positions & (quint64(1) << i))) {
+                continue;
+            }
+            if (isDoubleStar(pattern[i])) {
+                next |= quint64(1) << i;
+            } else if (matchSegment(pattern[i], segment)) {
+                next |= quint64(1) << (i + 1);
+            }
+        }
+        if (next) {
+            matchWildcard(child, closure(next, pattern), pattern, result);
+        }
+    }
+}
+
+void TagIndex::matchRegex(int node, QString &path, const QRegularExpression &regex,
+                          QVector<TagId> &result) const
+{
+    const int length = path.size();
+    for (int child : m_nodes[node].children) {
+        const Node &next = m_nodes[child];
+        if (length > 0) {
+            path += TagName::SEPARATOR;
+        }
+        path += next.segment;
+
+        if (next.id != INVALID_ID && regex.match(path).hasMatch()) {
+            result.append(next.id);
+        }
+        if (!next.children.isEmpty()) {
+            // 加上分隔符后仍可能匹配才进入子树
+            path += TagName::SEPARATOR;
+            QRegularExpressionMatch partial = regex.match(path, 0, QRegularExpression::PartialPreferFirstMatch);
+            path.chop(1);
+            if (partial.hasMatch() || partial.hasPartialMatch()) {
+                matchRegex(child, path, regex, result);
+            }
+        }
+        path.truncate(length);
+    }
+}
+
+} // namespace Industrial
@@ -0,0 +1,82 @@
+// TagIndex.h - 标签名分段索引
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QRegularExpression>
+#include "stringpool.h"
+
+namespace Industrial {
+
+// ==================== 标签名索引 ====================
+// 按VariableNaming的"区域.设备.变量.后缀"把标签名拆成段，组织成段前缀树，每个节点的子节点按段名排序。
+// 查询只走与条件相关的分支，结果按段名顺序（与ORDER BY tag_name一致，段内含'.'之前字符时除外）返回编号：
+//   findPrefix("AREA1.TT")      —— 字符串前缀，最后一段可不完整
+//   findWildcard("AREA1.*.TT*.PV") —— 段通配：段内'*'/'?'，单独的"**"匹配零到多段
+//   findRegex(re)               —— 正则须匹配整个标签名，用部分匹配剪掉不可能匹配的分支
+// 段字符串取自字符串池，与VariableDefinition::tagPath()共享同一份数据。
+// 编号由调用者给出（例如值单元编号），同一编号只能对应一个标签。线程安全：查询共享读锁
+class TagIndex {
+public:
+    typedef quint32 TagId;
+    static const TagId INVALID_ID = 0xFFFFFFFFu;
+    static const int MAX_PATTERN_SEGMENTS = 63;     // 通配模式的段数上限（匹配位置用64位掩码）
+
+    explicit TagIndex(StringPool *pool = StringPool::global());
+
+    bool insert(const QString &tagName, TagId id);  // 已有同名标签时更新编号；编号被其他标签占用时失败
+    bool remove(const QString &tagName);
+    bool removeId(TagId id);
+    void clear();
+
+    TagId find(const QString &tagName) const;
+    QString tagName(TagId id) const;
+    bool contains(const QString &tagName) const { return find(tagName) != INVALID_ID; }
+    int size() const;
+
+    QVector<TagId> findPrefix(const QString &prefix) const;
+    QVector<TagId> findWildcard(const QString &pattern) const;
+    QVector<TagId> findRegex(const QRegularExpression &regex) const;
+
+    // 浏览：path下一级的段名（已排序），path为空时返回所有区域
+    QStringList childSegments(const QString &path = QString()) const;
+
+    // 段内通配匹配，'*'匹配任意个字符，'?'匹配一个字符
+    static bool matchSegment(QStringView pattern, QStringView segment);
+
+private:
+    struct Node {
+        QString segment;            // 与字符串池共享
+        int parent = -1;
+        QVector<int> children;      // 按段名排序的节点下标
+        TagId id = INVALID_ID;      // 本节点是标签时的编号
+    };
+
+    int findChild(int node, QStringView segment) const;         // 没有时返回-1
+    int lowerBound(int node, QStringView segment) const;        // children中第一个不小于segment的位置
+    int findNode(const QString &tagName) const;
+    int allocateNode(const QString &segment, int parent);
+    void releaseTag(int node);                                  // 清除标签并删除不再需要的节点
+    void collect(int node, QVector<TagId> &result) const;       // 子树内全部标签，按顺序
+    void matchWildcard(int node, quint64 positions, const QVector<QStringView> &pattern,
+                       QVector<TagId> &result) const;
+    void matchRegex(int node, QString &path, const QRegularExpression &regex,
+                    QVector<TagId> &result) const;
+    static quint64 closure(quint64 positions, const QVector<QStringView> &pattern);
+
+    StringPool *m_pool;
+    mutable QReadWriteLock m_lock;
+    QVector<Node> m_nodes;          // 下标0为根节点
+    QVector<int> m_freeNodes;
+    QHash<TagId, int> m_idNodes;    // 编号 -> 节点
+};
+
+} // namespace Industrial
+
+#endif // TAGINDEX_H
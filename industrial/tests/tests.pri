@@ -0,0 +1,10 @@
+# 各测试工程共用：链接整个industrial模块
+QT       += core gui testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+QMAKE_CXXFLAGS += -finput-charset=UTF-8 -fexec-charset=UTF-8
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+include($$PWD/../industrial.pri)
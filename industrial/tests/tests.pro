@@ -0,0 +1,17 @@
+# 单元测试：qmake tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_accesscontrol \
+    tst_calculationengine \
+    tst_connectiontuning \
+    tst_conversionfunctions \
+    tst_realtimevariable \
+    tst_stalenessmonitor \
+    tst_statisticsengine \
+    tst_tagindex \
+    tst_valuecellstore \
+    tst_variablearena \
+    tst_variabledatabase \
+    tst_variablegroup \
+    tst_variablemanager
@@ -0,0 +1,148 @@
+// tst_accesscontrol.cpp - 访问组编号和写入权限检查
+#include <QtTest>
+#include "accesscontrol.h"
+
+using namespace Industrial;
+
+class TestAccessControl : public QObject {
+    Q_OBJECT
+
+private slots:
+    void registerGroupIsIdempotent();
+    void groupLimit();
+    void userMaskFollowsGroups();
+    void emptyGroupOpenToAll();
+    void notWritableDenied();
+    void unregisteredGroupDenied();
+    void checkerKeepsSnapshot();
+    void deniedCounters();
+};
+
+// ==================== 访问组 ====================
+void TestAccessControl::registerGroupIsIdempotent()
+{
+    WriteAccessControl access;
+    QCOMPARE(access.registerGroup("Operators"), 0);
+    QCOMPARE(access.registerGroup("Engineers"), 1);
+    QCOMPARE(access.registerGroup("Operators"), 0);
+    QCOMPARE(access.registerGroup(QString()), -1);
+    QCOMPARE(access.groupIndex("Engineers"), 1);
+    QCOMPARE(access.groupIndex("Nobody"), -1);
+    QCOMPARE(access.groups(), QStringList() << "Operators" << "Engineers");
+}
+
+void TestAccessControl::groupLimit()
+{
+    WriteAccessControl access;
+    for (int i = 0; i < WriteAccessControl::MAX_GROUPS; i++) {
+        QCOMPARE(access.registerGroup(QString("Group%1").arg(i)), i);
+    }
+    QCOMPARE(access.registerGroup("Overflow"), -1);
+    QVERIFY(!access.setUserGroups("alice", QStringList() << "Group63" << "Overflow"));
+    QCOMPARE(access.userMask("alice"), Q_UINT64_C(1) << 63);
+}
+
+// ==================== 用户 ====================
+void TestAccessControl::userMaskFollowsGroups()
+{
+    WriteAccessControl access;
+    QVERIFY(access.setUserGroups("alice", QStringList() << "Operators" << "Engineers"));
+    QCOMPARE(access.userMask("alice"), Q_UINT64_C(3));
+
+    access.setCurrentUser("alice");
+    QCOMPARE(access.checker().mask(), Q_UINT64_C(3));
+
+    // 当前用户的组变化立即生效
+    QVERIFY(access.setUserGroups("alice", QStringList() << "Engineers"));
+    QCOMPARE(access.checker().mask(), Q_UINT64_C(2));
+
+    access.removeUser("alice");
+    QCOMPARE(access.checker().mask(), Q_UINT64_C(0));
+    QVERIFY(access.users().isEmpty());
+}
+
+// ==================== 检查 ====================
+void TestAccessControl::emptyGroupOpenToAll()
+{
+    WriteAccessControl access;
+    VariableDefinition var("Area1.Pump1.Speed.SP", TYPE_AO);
+    var.setWritable(true);
+    QCOMPARE(access.checker().check(&var), WriteAccessControl::ALLOWED);
+    QCOMPARE(access.checker("anyone").check(&var), WriteAccessControl::ALLOWED);
+}
+
+void TestAccessControl::notWritableDenied()
+{
+    WriteAccessControl access;
+    access.setUserGroups("alice", QStringList() << "Operators");
+    VariableDefinition var("Area1.Pump1.Speed.PV", TYPE_AI);
+    var.setWritable(false);
+    var.setAccessGroup("Operators");
+
+    WriteAccessControl::Checker checker = access.checker("alice");
+    QCOMPARE(checker.check(&var), WriteAccessControl::DENIED_NOT_WRITABLE);
+    QCOMPARE(checker.check(nullptr), WriteAccessControl::DENIED_NOT_WRITABLE);
+    QCOMPARE(access.deniedNotWritable(), Q_UINT64_C(2));
+    QCOMPARE(access.deniedByGroup(), Q_UINT64_C(0));
+}
+
+void TestAccessControl::unregisteredGroupDenied()
+{
+    WriteAccessControl access;
+    access.setUserGroups("alice", QStringList() << "Operators");
+    VariableDefinition allowed("Area1.Pump1.Speed.SP", TYPE_AO);
+    VariableDefinition unknown("Area1.Pump1.Mode.SP", TYPE_AO);
+    allowed.setWritable(true);
+    allowed.setAccessGroup("Operators");
+    unknown.setWritable(true);
+    unknown.setAccessGroup("Maintenance");
+
+    WriteAccessControl::Checker checker = access.checker("alice");
+    QVERIFY(checker.canWrite(&allowed));
+    QCOMPARE(checker.check(&unknown), WriteAccessControl::DENIED_GROUP);
+    QCOMPARE(access.checker("bob").check(&allowed), WriteAccessControl::DENIED_GROUP);
+}
+
+void TestAccessControl::checkerKeepsSnapshot()
+{
+    WriteAccessControl access;
+    access.setUserGroups("alice", QStringList() << "Operators");
+    access.setCurrentUser("alice");
+    VariableDefinition var("Area1.Valve1.Position.SP", TYPE_AO);
+    var.setWritable(true);
+    var.setAccessGroup("Engineers");
+
+    // 取得后的配置修改不影响已有的检查器
+    WriteAccessControl::Checker before = access.checker();
+    access.setUserGroups("alice", QStringList() << "Operators" << "Engineers");
+    WriteAccessControl::Checker after = access.checker();
+    QCOMPARE(before.check(&var), WriteAccessControl::DENIED_GROUP);
+    QCOMPARE(after.check(&var), WriteAccessControl::ALLOWED);
+}
+
+// ==================== 统计 ====================
+void TestAccessControl::deniedCounters()
+{
+    WriteAccessControl access;
+    access.setUserGroups("alice", QStringList() << "Operators");
+    const int engineers = access.registerGroup("Engineers");
+    VariableDefinition var("Area1.Valve2.Position.SP", TYPE_AO);
+    var.setWritable(true);
+    var.setAccessGroup("Engineers");
+
+    WriteAccessControl::Checker checker = access.checker("alice");
+    for (int i = 0; i < 3; i++) {
+        QVERIFY(!checker.canWrite(&var));
+    }
+    QCOMPARE(access.deniedByGroup(), Q_UINT64_C(3));
+    QCOMPARE(access.deniedCount(engineers), Q_UINT64_C(3));
+    QCOMPARE(access.deniedCount(access.groupIndex("Operators")), Q_UINT64_C(0));
+    QCOMPARE(access.deniedCount(WriteAccessControl::MAX_GROUPS), Q_UINT64_C(0));
+
+    access.resetStatistics();
+    QCOMPARE(access.deniedByGroup(), Q_UINT64_C(0));
+    QCOMPARE(access.deniedCount(engineers), Q_UINT64_C(0));
+}
+
+QTEST_MAIN(TestAccessControl)
+#include "tst_accesscontrol.moc"
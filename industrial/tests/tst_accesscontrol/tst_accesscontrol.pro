@@ -0,0 +1,5 @@
+TARGET = tst_accesscontrol
+include(../tests.pri)
+
+SOURCES += \
+    tst_accesscontrol.cpp
@@ -0,0 +1,195 @@
+// tst_calculationengine.cpp - 公式编译和依赖图增量求值
+#include <QtTest>
+#include "calculationengine.h"
+
+using namespace Industrial;
+
+class TestCalculationEngine : public QObject {
+    Q_OBJECT
+
+private slots:
+    void compileCollectsInputs();
+    void compileRejectsSyntaxError();
+    void conditionalAndFunctions();
+    void chainEvaluatesInTopologicalOrder();
+    void unchangedResultStopsPropagation();
+    void circularReferenceDisablesNodes();
+    void unknownTagDisablesNode();
+    void badInputQualityPropagates();
+    void nonFiniteResultIsBad();
+};
+
+// ==================== 公式编译 ====================
+void TestCalculationEngine::compileCollectsInputs()
+{
+    CompiledExpression expression =
+        CompiledExpression::compile("Area1.FT1.Flow + [TT-101.PV] * 2 - Area1.FT1.Flow / 4");
+    QVERIFY(expression.isValid());
+    QCOMPARE(expression.inputs(), QStringList() << "Area1.FT1.Flow" << "TT-101.PV");
+
+    const double values[2] = { 8.0, 3.0 };
+    const UaTimestamp times[2] = { 0, 0 };
+    QCOMPARE(expression.evaluate(values, times), 12.0);
+}
+
+void TestCalculationEngine::compileRejectsSyntaxError()
+{
+    CompiledExpression missingOperand = CompiledExpression::compile("Area1.FT1.Flow + ");
+    QVERIFY(!missingOperand.isValid());
+    QVERIFY(!missingOperand.errorString().isEmpty());
+
+    CompiledExpression unclosedTag = CompiledExpression::compile("[TT-101.PV * 2");
+    QVERIFY(!unclosedTag.isValid());
+}
+
+void TestCalculationEngine::conditionalAndFunctions()
+{
+    CompiledExpression expression =
+        CompiledExpression::compile("Area1.LT1.Level > 50 ? max(Area1.LT1.Level, 80) : clamp(Area1.LT1.Level, 10, 20)");
+    QVERIFY(expression.isValid());
+    QCOMPARE(expression.inputs().size(), 1);
+
+    const UaTimestamp time = 0;
+    double value = 60.0;
+    QCOMPARE(expression.evaluate(&value, &time), 80.0);
+    value = 5.0;
+    QCOMPARE(expression.evaluate(&value, &time), 10.0);
+}
+
+// ==================== 依赖图 ====================
+void TestCalculationEngine::chainEvaluatesInTopologicalOrder()
+{
+    CalculationEngine engine;
+    VariableDefinition flow("Area1.FT1.Flow", TYPE_AI);
+    VariableDefinition doubled("Area1.FT1.Doubled", TYPE_CALC);
+    VariableDefinition offset("Area1.FT1.Offset", TYPE_CALC);
+    flow.setDoubleValue(3.0);
+
+    // 下游先登记，计算顺序仍按依赖
+    engine.addVariable(&flow);
+    QVERIFY(engine.setFormula(&offset, "Area1.FT1.Doubled + 1"));
+    QVERIFY(engine.setFormula(&doubled, "Area1.FT1.Flow * 2"));
+    QVERIFY(engine.rebuild());
+    QCOMPARE(engine.calculatedTags(), QStringList() << "Area1.FT1.Doubled" << "Area1.FT1.Offset");
+    QCOMPARE(engine.dependencies("Area1.FT1.Offset"), QStringList() << "Area1.FT1.Doubled");
+    QCOMPARE(engine.dependents("Area1.FT1.Flow"), QStringList() << "Area1.FT1.Doubled");
+
+    QCOMPARE(engine.evaluatePending(), 2);
+    QCOMPARE(doubled.doubleValue(), 6.0);
+    QCOMPARE(offset.doubleValue(), 7.0);
+
+    // 输入变化只标脏，下一次求值时按顺序算受影响的节点
+    flow.setDoubleValue(5.0);
+    QCOMPARE(engine.pendingCount(), 1);
+    QCOMPARE(engine.evaluatePending(), 2);
+    QCOMPARE(offset.doubleValue(), 11.0);
+    QCOMPARE(offset.quality(), QUALITY_GOOD);
+
+    // 不调用evaluatePending时由事件循环完成
+    flow.setDoubleValue(1.0);
+    QTRY_COMPARE_WITH_TIMEOUT(offset.doubleValue(), 3.0, 1000);
+}
+
+void TestCalculationEngine::unchangedResultStopsPropagation()
+{
+    CalculationEngine engine;
+    VariableDefinition level("Area1.LT1.Level", TYPE_AI);
+    VariableDefinition high("Area1.LT1.High", TYPE_CALC);
+    VariableDefinition alarm("Area1.LT1.Alarm", TYPE_CALC);
+    level.setDoubleValue(10.0);
+
+    engine.addVariable(&level);
+    QVERIFY(engine.setFormula(&high, "Area1.LT1.Level > 50"));
+    QVERIFY(engine.setFormula(&alarm, "Area1.LT1.High * 100"));
+    QCOMPARE(engine.evaluateAll(), 2);
+
+    // 比较结果不变，下游不再计算
+    level.setDoubleValue(20.0);
+    QCOMPARE(engine.evaluatePending(), 1);
+    QCOMPARE(alarm.doubleValue(), 0.0);
+
+    level.setDoubleValue(60.0);
+    QCOMPARE(engine.evaluatePending(), 2);
+    QCOMPARE(alarm.doubleValue(), 100.0);
+}
+
+void TestCalculationEngine::circularReferenceDisablesNodes()
+{
+    CalculationEngine engine;
+    VariableDefinition first("Area1.Loop.A", TYPE_CALC);
+    VariableDefinition second("Area1.Loop.B", TYPE_CALC);
+    QSignalSpy errors(&engine, &CalculationEngine::calculationError);
+
+    QVERIFY(engine.setFormula(&first, "Area1.Loop.B + 1"));
+    QVERIFY(engine.setFormula(&second, "Area1.Loop.A + 1"));
+    QVERIFY(!engine.rebuild());
+    QCOMPARE(engine.errorString("Area1.Loop.A"), QString("Circular reference"));
+    QCOMPARE(engine.errorString("Area1.Loop.B"), QString("Circular reference"));
+    QVERIFY(engine.calculatedTags().isEmpty());
+    QCOMPARE(errors.count(), 2);
+    QCOMPARE(engine.evaluatePending(), 0);
+}
+
+void TestCalculationEngine::unknownTagDisablesNode()
+{
+    CalculationEngine engine;
+    VariableDefinition target("Area1.FT2.Total", TYPE_CALC);
+    QVERIFY(engine.setFormula(&target, "Area1.FT2.Missing * 2"));
+    QVERIFY(!engine.rebuild());
+    QVERIFY(engine.errorString("Area1.FT2.Total").startsWith("Unknown tag"));
+
+    // 补上输入后重建恢复
+    VariableDefinition input("Area1.FT2.Missing", TYPE_AI);
+    input.setDoubleValue(4.0);
+    engine.addVariable(&input);
+    QVERIFY(engine.rebuild());
+    QCOMPARE(engine.evaluatePending(), 1);
+    QCOMPARE(target.doubleValue(), 8.0);
+}
+
+// ==================== 质量 ====================
+void TestCalculationEngine::badInputQualityPropagates()
+{
+    CalculationEngine engine;
+    VariableDefinition a("Area1.PT1.Pressure", TYPE_AI);
+    VariableDefinition b("Area1.PT2.Pressure", TYPE_AI);
+    VariableDefinition diff("Area1.PT.Diff", TYPE_CALC);
+    a.setDoubleValue(5.0);
+    b.setDoubleValue(2.0);
+    engine.addVariables(QList<VariableDefinition*>() << &a << &b);
+    QVERIFY(engine.setFormula(&diff, "Area1.PT1.Pressure - Area1.PT2.Pressure"));
+    engine.evaluateAll();
+    QCOMPARE(diff.doubleValue(), 3.0);
+    QCOMPARE(diff.quality(), QUALITY_GOOD);
+
+    // 结果沿用输入的坏质量，值照常计算
+    QVERIFY(b.setQuality(QUALITY_COMM_FAIL));
+    QCOMPARE(engine.evaluatePending(), 1);
+    QCOMPARE(diff.quality(), QUALITY_COMM_FAIL);
+    QCOMPARE(diff.doubleValue(), 3.0);
+
+    b.setDoubleValue(1.0);
+    engine.evaluatePending();
+    QCOMPARE(diff.quality(), QUALITY_GOOD);
+    QCOMPARE(diff.doubleValue(), 4.0);
+}
+
+void TestCalculationEngine::nonFiniteResultIsBad()
+{
+    CalculationEngine engine;
+    VariableDefinition flow("Area1.FT3.Flow", TYPE_AI);
+    VariableDefinition ratio("Area1.FT3.Ratio", TYPE_CALC);
+    flow.setDoubleValue(0.0);
+    engine.addVariable(&flow);
+    QVERIFY(engine.setFormula(&ratio, "1 / Area1.FT3.Flow"));
+    engine.evaluateAll();
+    QCOMPARE(ratio.quality(), QUALITY_BAD);
+
+    flow.setDoubleValue(2.0);
+    engine.evaluatePending();
+    QCOMPARE(ratio.quality(), QUALITY_GOOD);
+    QCOMPARE(ratio.doubleValue(), 0.5);
+}
+
+QTEST_MAIN(TestCalculationEngine)
+#include "tst_calculationengine.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_calculationengine
+include(../tests.pri)
+
+SOURCES += \
+    tst_calculationengine.cpp
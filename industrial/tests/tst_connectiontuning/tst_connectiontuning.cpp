@@ -0,0 +1,101 @@
+// tst_connectiontuning.cpp - 按变量数量计算传输配置
+#include <QtTest>
+#include "opcuaclientmanager.h"
+
+using namespace Industrial;
+
+class TestConnectionTuning : public QObject {
+    Q_OBJECT
+
+private slots:
+    void noTagsKeepsConfigured();
+    void sizedForGrowsWithTags();
+    void manualTuningIsNotResized();
+    void coveredByComparesNegotiatedSizes();
+    void managerFollowsExpectedTagCount();
+    void variableManagerKeepsSingleCopy();
+};
+
+// ==================== 自动计算 ====================
+void TestConnectionTuning::noTagsKeepsConfigured()
+{
+    // 首次连接前没有注册变量时按配置值协商
+    const ConnectionTuning base;
+    const ConnectionTuning tuned = base.sizedFor(0);
+    QCOMPARE(tuned.sendBufferSize, base.sendBufferSize);
+    QCOMPARE(tuned.recvBufferSize, base.recvBufferSize);
+    QCOMPARE(tuned.maxMessageSize, base.maxMessageSize);
+    QCOMPARE(tuned.maxChunkCount, base.maxChunkCount);
+    QCOMPARE(tuned.maxNotificationsPerPublish, base.maxNotificationsPerPublish);
+}
+
+void TestConnectionTuning::sizedForGrowsWithTags()
+{
+    const ConnectionTuning base;
+
+    const ConnectionTuning small = base.sizedFor(1000);
+    QCOMPARE(small.sendBufferSize, 65536u);
+    QCOMPARE(small.maxMessageSize, base.maxMessageSize);
+    QCOMPARE(small.maxNotificationsPerPublish, 1000u);
+
+    // 20万个变量约25MB：分块加大到1MB，消息向上取整到32MB
+    const ConnectionTuning large = base.sizedFor(200000);
+    QCOMPARE(large.sendBufferSize, 1024u * 1024u);
+    QCOMPARE(large.recvBufferSize, 1024u * 1024u);
+    QCOMPARE(large.maxMessageSize, 32u * 1024u * 1024u);
+    QVERIFY(large.maxChunkCount * large.recvBufferSize >= large.maxMessageSize);
+    QCOMPARE(large.maxNotificationsPerPublish, 200000u);
+}
+
+void TestConnectionTuning::manualTuningIsNotResized()
+{
+    const ConnectionTuning manual(131072, 4 * 1024 * 1024, 64);
+    const ConnectionTuning tuned = manual.sizedFor(200000);
+    QCOMPARE(tuned.sendBufferSize, 131072u);
+    QCOMPARE(tuned.maxMessageSize, 4u * 1024u * 1024u);
+    QCOMPARE(tuned.maxChunkCount, 64u);
+}
+
+void TestConnectionTuning::coveredByComparesNegotiatedSizes()
+{
+    const ConnectionTuning base;
+    const ConnectionTuning large = base.sizedFor(200000);
+    QVERIFY(base.coveredBy(base));
+    QVERIFY(base.coveredBy(large));
+    QVERIFY(!large.coveredBy(base));
+
+    // 0表示不限制
+    ConnectionTuning unlimited = base;
+    unlimited.maxMessageSize = 0;
+    QVERIFY(base.coveredBy(unlimited));
+    QVERIFY(!unlimited.coveredBy(base));
+}
+
+// ==================== 管理器 ====================
+void TestConnectionTuning::managerFollowsExpectedTagCount()
+{
+    OPCUAConnectionManager manager;
+    manager.setConnectionTuning(ConnectionTuning());
+    QCOMPARE(manager.effectiveConnectionTuning().recvBufferSize, 65536u);
+
+    // 先注册变量再连接：建立安全通道时按这里的数量计算
+    manager.setExpectedTagCount(200000);
+    QCOMPARE(manager.effectiveConnectionTuning().recvBufferSize, 1024u * 1024u);
+    QCOMPARE(manager.effectiveConnectionTuning().maxNotificationsPerPublish, 200000u);
+
+    // 未连接时没有需要重建的通道
+    QVERIFY(!manager.connectionTuningOutdated());
+}
+
+void TestConnectionTuning::variableManagerKeepsSingleCopy()
+{
+    OPCUAVariableManager manager;
+    manager.setConnectionTuning(ConnectionTuning(131072, 0, 0));
+    QCOMPARE(manager.connectionTuning().sendBufferSize, 131072u);
+    QCOMPARE(manager.connectionTuning().maxMessageSize, 0u);
+    QVERIFY(!manager.connectionTuning().autoSize);
+    QVERIFY(!manager.connectionTuningOutdated());
+}
+
+QTEST_MAIN(TestConnectionTuning)
+#include "tst_connectiontuning.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_connectiontuning
+include(../tests.pri)
+
+SOURCES += \
+    tst_connectiontuning.cpp
@@ -0,0 +1,131 @@
+// tst_conversionfunctions.cpp - 非线性转换函数和批量转换
+#include <QtTest>
+#include <QJsonArray>
+#include "conversionfunctions.h"
+#include "batchconverter.h"
+
+using namespace Industrial;
+
+class TestConversionFunctions : public QObject {
+    Q_OBJECT
+
+private slots:
+    void lookupInterpolatesAndClamps();
+    void lookupPropagatesNaN();
+    void polynomialEvaluates();
+    void polynomialRejectsHighOrder();
+    void piecewiseMatchesBreakpoints();
+    void batchConverterGroupsCustomTags();
+};
+
+// ==================== 查表 ====================
+void TestConversionFunctions::lookupInterpolatesAndClamps()
+{
+    LookupTableConversion lookup(0.0, 10.0, QVector<double>() << 0.0 << 100.0 << 400.0);
+    QCOMPARE(lookup.rawToEngineering(5.0), 50.0);
+    QCOMPARE(lookup.rawToEngineering(15.0), 250.0);
+    QCOMPARE(lookup.rawToEngineering(-5.0), 0.0);
+    QCOMPARE(lookup.rawToEngineering(25.0), 400.0);
+    QCOMPARE(lookup.engineeringToRaw(250.0), 15.0);
+}
+
+void TestConversionFunctions::lookupPropagatesNaN()
+{
+    LookupTableConversion lookup(0.0, 10.0, QVector<double>() << 0.0 << 100.0 << 400.0);
+    QVERIFY(qIsNaN(lookup.rawToEngineering(qQNaN())));
+
+    const double raw[3] = { 5.0, qQNaN(), 25.0 };
+    double eng[3] = { 0.0, 0.0, 0.0 };
+    lookup.rawToEngineeringBatch(raw, eng, 3);
+    QCOMPARE(eng[0], 50.0);
+    QVERIFY(qIsNaN(eng[1]));
+    QCOMPARE(eng[2], 400.0);
+}
+
+// ==================== 多项式 ====================
+void TestConversionFunctions::polynomialEvaluates()
+{
+    PolynomialConversion polynomial(QVector<double>() << 1.0 << 2.0 << 3.0, 0.0, 10.0);
+    QVERIFY(polynomial.isValid());
+    QCOMPARE(polynomial.order(), 2);
+    QCOMPARE(polynomial.rawToEngineering(2.0), 17.0);
+    QVERIFY(polynomial.isInvertible());
+    QVERIFY(qAbs(polynomial.engineeringToRaw(17.0) - 2.0) < 1e-9);
+}
+
+void TestConversionFunctions::polynomialRejectsHighOrder()
+{
+    QVector<double> maxOrder(PolynomialConversion::MAX_ORDER + 1, 1.0);
+    QVERIFY(PolynomialConversion(maxOrder).isValid());
+
+    QVector<double> tooHigh(PolynomialConversion::MAX_ORDER + 2, 1.0);
+    PolynomialConversion rejected(tooHigh);
+    QVERIFY(!rejected.isValid());
+    QCOMPARE(rejected.rawToEngineering(3.0), 3.0);
+
+    QJsonArray coefficients;
+    for (double c : tooHigh) {
+        coefficients.append(c);
+    }
+    QJsonObject parameters;
+    parameters["coefficients"] = coefficients;
+    QVERIFY(createConversionFunction("polynomial", parameters) == nullptr);
+}
+
+// ==================== 分段线性 ====================
+void TestConversionFunctions::piecewiseMatchesBreakpoints()
+{
+    PiecewiseLinearConversion piecewise(QVector<double>() << 0.0 << 10.0 << 20.0,
+                                        QVector<double>() << 0.0 << 50.0 << 150.0);
+    QVERIFY(piecewise.isValid());
+    QCOMPARE(piecewise.rawToEngineering(10.0), 50.0);
+    QCOMPARE(piecewise.rawToEngineering(15.0), 100.0);
+    QCOMPARE(piecewise.engineeringToRaw(100.0), 15.0);
+}
+
+// ==================== 批量转换 ====================
+void TestConversionFunctions::batchConverterGroupsCustomTags()
+{
+    auto store = std::make_shared<ValueCellStore>();
+    const QVector<double> table = QVector<double>() << 0.0 << 100.0 << 400.0;
+
+    // 三个参数相同的查表变量合为一组，多项式单独一组，缺省量程换算走线性路径
+    VariableDefinition lookup1("Area1.TT1.Temp", TYPE_AI, store, nullptr);
+    VariableDefinition lookup2("Area1.TT2.Temp", TYPE_AI, store, nullptr);
+    VariableDefinition lookup3("Area1.TT3.Temp", TYPE_AI, store, nullptr);
+    VariableDefinition polynomial("Area1.FT1.Flow", TYPE_AI, store, nullptr);
+    VariableDefinition linear("Area1.PT1.Pressure", TYPE_AI, store, nullptr);
+    lookup1.setConversionFunction(new LookupTableConversion(0.0, 10.0, table));
+    lookup2.setConversionFunction(new LookupTableConversion(0.0, 10.0, table));
+    lookup3.setConversionFunction(new LookupTableConversion(0.0, 10.0, table));
+    polynomial.setConversionFunction(new PolynomialConversion(QVector<double>() << 1.0 << 2.0 << 3.0));
+
+    BatchConverter converter(store);
+    QVector<quint32> tagIds;
+    tagIds << lookup1.valueCellId() << linear.valueCellId() << polynomial.valueCellId()
+           << lookup2.valueCellId() << lookup3.valueCellId() << ValueCellStore::INVALID_ID;
+    QVector<double> raw;
+    raw << 5.0 << 7.0 << 2.0 << 15.0 << qQNaN() << 42.0;
+    QVector<double> eng;
+    converter.rawToEngineering(tagIds, raw, eng);
+
+    QCOMPARE(converter.customCount(), 4);
+    QCOMPARE(converter.customGroupCount(), 2);
+    QCOMPARE(converter.linearCount(), 1);
+
+    QCOMPARE(eng.size(), raw.size());
+    QCOMPARE(eng[0], 50.0);
+    QCOMPARE(eng[1], linear.rawToEngineering(7.0));
+    QCOMPARE(eng[2], 17.0);
+    QCOMPARE(eng[3], 250.0);
+    QVERIFY(qIsNaN(eng[4]));
+    QCOMPARE(eng[5], 42.0);
+
+    // 转换函数修改后按新的分组重建
+    lookup3.setConversionFunction(new LookupTableConversion(0.0, 20.0, table));
+    converter.rawToEngineering(tagIds, raw, eng);
+    QCOMPARE(converter.customGroupCount(), 3);
+}
+
+QTEST_MAIN(TestConversionFunctions)
+#include "tst_conversionfunctions.moc"
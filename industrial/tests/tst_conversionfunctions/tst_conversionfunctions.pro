@@ -0,0 +1,5 @@
+TARGET = tst_conversionfunctions
+include(../tests.pri)
+
+SOURCES += \
+    tst_conversionfunctions.cpp
@@ -0,0 +1,164 @@
+// tst_realtimevariable.cpp - 实时变量报警复位滞环、确认延时和抑制计数
+#include <QtTest>
+#include "realtimevariablemanager.h"
+
+using namespace Industrial;
+
+class TestRealTimeVariable : public QObject {
+    Q_OBJECT
+
+private slots:
+    void definitionCrossingUsesHysteresis();
+    void hysteresisAbsorbsChatter();
+    void onDelayConfirmsWithoutNewSample();
+    void onDelaySuppressesChatter();
+    void offDelayHoldsAlarm();
+    void managerSumsSuppressedAlarms();
+};
+
+// ==================== 越限信号 ====================
+void TestRealTimeVariable::definitionCrossingUsesHysteresis()
+{
+    VariableDefinition var("Area1.Tank1.Level", TYPE_AI);
+    var.setDeadband(0.0);
+    var.setAlarmHysteresis(2.0);
+    var.setDoubleValue(50.0);
+
+    QList<AlarmLevel> crossings;
+    connect(&var, &VariableDefinition::alarmLimitCrossed, this, [&crossings](AlarmLevel level) {
+        crossings.append(level);
+    });
+
+    // 在高限附近来回抖动，复位滞环内不再发出信号
+    var.setDoubleValue(91.0);
+    for (int i = 0; i < 5; i++) {
+        var.setDoubleValue(89.0);
+        var.setDoubleValue(91.0);
+    }
+    QCOMPARE(crossings, QList<AlarmLevel>() << ALARM_MAJOR);
+
+    var.setDoubleValue(87.0);
+    QCOMPARE(crossings, QList<AlarmLevel>() << ALARM_MAJOR << ALARM_NONE);
+}
+
+// ==================== 复位滞环 ====================
+void TestRealTimeVariable::hysteresisAbsorbsChatter()
+{
+    VariableDefinition def("Area1.Tank2.Level", TYPE_AI);
+    def.setAlarmHysteresis(2.0);
+    RealTimeVariable var(&def);
+
+    QList<AlarmLevel> transitions;
+    connect(&var, &RealTimeVariable::alarmChanged, this, [&transitions](AlarmLevel level) {
+        transitions.append(level);
+    });
+
+    var.updateValue(50.0);
+    var.updateValue(91.0);
+    QCOMPARE(var.alarmLevel(), ALARM_MAJOR);
+
+    // 每次越过原始高限都被滞环吸收
+    const double chatter[] = { 89.0, 91.0, 89.0, 91.0, 89.0 };
+    for (double value : chatter) {
+        var.updateValue(value);
+        QCOMPARE(var.alarmLevel(), ALARM_MAJOR);
+    }
+    QCOMPARE(var.suppressedByHysteresis(), 5u);
+
+    var.updateValue(87.0);
+    QCOMPARE(var.alarmLevel(), ALARM_NONE);
+    QCOMPARE(transitions, QList<AlarmLevel>() << ALARM_MAJOR << ALARM_NONE);
+    QCOMPARE(var.suppressedByDelay(), 0u);
+}
+
+// ==================== 确认延时 ====================
+void TestRealTimeVariable::onDelayConfirmsWithoutNewSample()
+{
+    VariableDefinition def("Area1.Tank3.Level", TYPE_AI);
+    def.setAlarmOnDelay(200);
+    RealTimeVariable var(&def);
+
+    int transitions = 0;
+    connect(&var, &RealTimeVariable::alarmChanged, this, [&transitions]() { transitions++; });
+
+    var.updateValue(50.0);
+    var.updateValue(92.0);
+    QCOMPARE(var.alarmLevel(), ALARM_NONE);
+
+    // 不再有新值，由延时定时器确认
+    QTRY_COMPARE_WITH_TIMEOUT(var.alarmLevel(), ALARM_MAJOR, 2000);
+    QCOMPARE(transitions, 1);
+    QCOMPARE(var.suppressedByDelay(), 0u);
+}
+
+void TestRealTimeVariable::onDelaySuppressesChatter()
+{
+    VariableDefinition def("Area1.Tank4.Level", TYPE_AI);
+    def.setAlarmOnDelay(300);
+    RealTimeVariable var(&def);
+
+    int transitions = 0;
+    connect(&var, &RealTimeVariable::alarmChanged, this, [&transitions]() { transitions++; });
+
+    // 延时内两次越限又回到正常，等待的升级都作废
+    var.updateValue(50.0);
+    var.updateValue(92.0);
+    var.updateValue(50.0);
+    var.updateValue(92.0);
+    var.updateValue(50.0);
+    QTest::qWait(500);
+
+    QCOMPARE(var.alarmLevel(), ALARM_NONE);
+    QCOMPARE(transitions, 0);
+    QCOMPARE(var.suppressedByDelay(), 2u);
+    QCOMPARE(var.suppressedByHysteresis(), 0u);
+}
+
+void TestRealTimeVariable::offDelayHoldsAlarm()
+{
+    VariableDefinition def("Area1.Tank5.Level", TYPE_AI);
+    def.setAlarmOffDelay(200);
+    RealTimeVariable var(&def);
+
+    var.updateValue(50.0);
+    var.updateValue(92.0);
+    QCOMPARE(var.alarmLevel(), ALARM_MAJOR);
+
+    // 复位需持续offDelay
+    var.updateValue(50.0);
+    QCOMPARE(var.alarmLevel(), ALARM_MAJOR);
+    QTRY_COMPARE_WITH_TIMEOUT(var.alarmLevel(), ALARM_NONE, 2000);
+}
+
+// ==================== 性能统计 ====================
+void TestRealTimeVariable::managerSumsSuppressedAlarms()
+{
+    VariableDefinition hysteresis("Area1.Tank6.Level", TYPE_AI);
+    VariableDefinition delayed("Area1.Tank7.Level", TYPE_AI);
+    hysteresis.setAlarmHysteresis(2.0);
+    delayed.setAlarmOnDelay(300);
+
+    RealTimeVariableManager manager;
+    QVERIFY(manager.addVariable(&hysteresis));
+    QVERIFY(manager.addVariable(&delayed));
+
+    RealTimeVariable *first = manager.getVariable(hysteresis.tagName());
+    RealTimeVariable *second = manager.getVariable(delayed.tagName());
+    QVERIFY(first && second);
+
+    first->updateValue(50.0);
+    first->updateValue(91.0);
+    first->updateValue(89.0);
+    first->updateValue(91.0);
+    second->updateValue(50.0);
+    second->updateValue(92.0);
+    second->updateValue(50.0);
+
+    manager.onStatsTimerTimeout();
+    RealTimeVariableManager::PerformanceStats stats = manager.getPerformanceStats();
+    QCOMPARE(stats.suppressedAlarms, 3);
+    QCOMPARE(stats.alarmCount, 1);
+}
+
+QTEST_MAIN(TestRealTimeVariable)
+#include "tst_realtimevariable.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_realtimevariable
+include(../tests.pri)
+
+SOURCES += \
+    tst_realtimevariable.cpp
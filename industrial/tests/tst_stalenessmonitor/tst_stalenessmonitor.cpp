@@ -0,0 +1,172 @@
+// tst_stalenessmonitor.cpp - 陈旧检测时间轮和质量恢复
+#include <QtTest>
+#include "stalenessmonitor.h"
+#include "calculationengine.h"
+
+using namespace Industrial;
+
+class TestStalenessMonitor : public QObject {
+    Q_OBJECT
+
+private slots:
+    void staleTagRecoversOnSameGoodValue();
+    void staleTagRecoversWithinDeadband();
+    void discreteTagsRecoverOnSameGoodValue();
+    void wheelMarksStaleThenFailed();
+    void updateRestartsTimer();
+    void unwatchStopsTimer();
+    void calculationFollowsCommFail();
+    void deletedTagSkippedByQueuedCalculation();
+};
+
+// ==================== 质量恢复 ====================
+void TestStalenessMonitor::staleTagRecoversOnSameGoodValue()
+{
+    StalenessMonitor monitor;
+    VariableDefinition var("Area1.Pump1.Flow", TYPE_AI);
+    var.setDoubleValue(10.0);
+    monitor.watch(&var, 100);
+
+    monitor.markCommFail(QList<VariableDefinition*>() << &var);
+    QCOMPARE(var.quality(), QUALITY_COMM_FAIL);
+    QCOMPARE(monitor.failedCount(), 1);
+
+    // 连接恢复后服务器送来相同的值，质量必须回到GOOD
+    var.setDoubleValue(10.0);
+    QCOMPARE(var.quality(), QUALITY_GOOD);
+    QCOMPARE(var.doubleValue(), 10.0);
+    QCOMPARE(monitor.failedCount(), 0);
+}
+
+void TestStalenessMonitor::staleTagRecoversWithinDeadband()
+{
+    StalenessMonitor monitor;
+    VariableDefinition var("Area1.Pump1.Pressure", TYPE_AI);
+    var.setDeadband(0.5);
+    var.setDoubleValue(10.0);
+    monitor.watch(&var, 100);
+
+    QVERIFY(var.setQuality(QUALITY_OLD));
+    var.setDoubleValue(10.2);
+    QCOMPARE(var.quality(), QUALITY_GOOD);
+
+    // 质量不变时死区照常生效
+    var.setDoubleValue(10.3);
+    QCOMPARE(var.doubleValue(), 10.2);
+}
+
+void TestStalenessMonitor::discreteTagsRecoverOnSameGoodValue()
+{
+    VariableDefinition boolVar("Area1.Pump1.Running", TYPE_DI);
+    boolVar.setBoolValue(true);
+    QVERIFY(boolVar.setQuality(QUALITY_OLD));
+    boolVar.setBoolValue(true);
+    QCOMPARE(boolVar.quality(), QUALITY_GOOD);
+
+    VariableDefinition intVar("Area1.Pump1.Mode", TYPE_DI);
+    intVar.setIntValue(3);
+    QVERIFY(intVar.setQuality(QUALITY_COMM_FAIL));
+    intVar.setIntValue(3);
+    QCOMPARE(intVar.quality(), QUALITY_GOOD);
+
+    VariableDefinition stringVar("Area1.Pump1.Recipe", TYPE_DI);
+    stringVar.setStringValue("A");
+    QVERIFY(stringVar.setQuality(QUALITY_OLD));
+    stringVar.setStringValue("A");
+    QCOMPARE(stringVar.quality(), QUALITY_GOOD);
+}
+
+// ==================== 时间轮 ====================
+void TestStalenessMonitor::wheelMarksStaleThenFailed()
+{
+    StalenessMonitor monitor;
+    monitor.setFactors(2.0, 5.0);
+    VariableDefinition var("Area1.Tank1.Level", TYPE_AI);
+    var.setDoubleValue(1.0);
+    monitor.watch(&var, 100);
+    QCOMPARE(monitor.watchedCount(), 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(var.quality(), QUALITY_OLD, 2000);
+    QCOMPARE(monitor.staleCount(), 1);
+    QCOMPARE(var.doubleValue(), 1.0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(var.quality(), QUALITY_COMM_FAIL, 2000);
+    QCOMPARE(monitor.staleCount(), 0);
+    QCOMPARE(monitor.failedCount(), 1);
+}
+
+void TestStalenessMonitor::updateRestartsTimer()
+{
+    StalenessMonitor monitor;
+    monitor.setFactors(3.0, 10.0);
+    VariableDefinition var("Area1.Tank1.Temp", TYPE_AI);
+    var.setDoubleValue(0.0);
+    monitor.watch(&var, 100);
+
+    // 每50ms一个新值，始终不超过300ms的陈旧期限
+    for (int i = 1; i <= 10; i++) {
+        QTest::qWait(50);
+        var.setDoubleValue(i);
+        QCOMPARE(var.quality(), QUALITY_GOOD);
+    }
+    monitor.checkPending();
+    QCOMPARE(monitor.staleCount(), 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(var.quality(), QUALITY_OLD, 2000);
+}
+
+void TestStalenessMonitor::unwatchStopsTimer()
+{
+    StalenessMonitor monitor;
+    VariableDefinition var("Area1.Tank2.Level", TYPE_AI);
+    var.setDoubleValue(1.0);
+    monitor.watch(&var, 100);
+    monitor.unwatch(&var);
+    QCOMPARE(monitor.watchedCount(), 0);
+
+    QTest::qWait(500);
+    monitor.checkPending();
+    QCOMPARE(var.quality(), QUALITY_GOOD);
+}
+
+// ==================== 计算引擎 ====================
+void TestStalenessMonitor::calculationFollowsCommFail()
+{
+    StalenessMonitor monitor;
+    CalculationEngine engine;
+    monitor.setCalculationEngine(&engine);
+    VariableDefinition flow("Area1.Pump3.Flow", TYPE_AI);
+    VariableDefinition total("Area1.Pump3.Total", TYPE_CALC);
+    flow.setDoubleValue(4.0);
+    monitor.watch(&flow, 1000);
+    engine.addVariable(&flow);
+    QVERIFY(engine.setFormula(&total, "Area1.Pump3.Flow * 2"));
+    engine.evaluateAll();
+    QCOMPARE(total.quality(), QUALITY_GOOD);
+
+    // 通知排队到引擎线程，由事件循环计算
+    monitor.markCommFail(QList<VariableDefinition*>() << &flow);
+    QTRY_COMPARE_WITH_TIMEOUT(total.quality(), QUALITY_COMM_FAIL, 1000);
+    QCOMPARE(total.doubleValue(), 8.0);
+}
+
+void TestStalenessMonitor::deletedTagSkippedByQueuedCalculation()
+{
+    StalenessMonitor monitor;
+    CalculationEngine engine;
+    monitor.setCalculationEngine(&engine);
+    VariableDefinition *flow = new VariableDefinition("Area1.Pump4.Flow", TYPE_AI);
+    flow->setDoubleValue(1.0);
+    monitor.watch(flow, 1000);
+    engine.addVariable(flow);
+
+    // 排队的通知执行前变量已删除，不能再交给引擎
+    monitor.markCommFail(QList<VariableDefinition*>() << flow);
+    delete flow;
+    QTest::qWait(50);
+    QCOMPARE(monitor.watchedCount(), 0);
+    QCOMPARE(engine.pendingCount(), 0);
+}
+
+QTEST_MAIN(TestStalenessMonitor)
+#include "tst_stalenessmonitor.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_stalenessmonitor
+include(../tests.pri)
+
+SOURCES += \
+    tst_stalenessmonitor.cpp
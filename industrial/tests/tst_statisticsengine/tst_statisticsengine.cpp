@@ -0,0 +1,161 @@
+// tst_statisticsengine.cpp - 时间加权滚动窗口和统计变量发布
+#include <QtTest>
+#include "statisticsengine.h"
+
+using namespace Industrial;
+
+static const qint64 SEC = UaTime::TICKS_PER_SEC;
+static const UaTimestamp T0 = UaTime::fromMSecsSinceEpoch(1700000000000LL);
+
+class TestStatisticsEngine : public QObject {
+    Q_OBJECT
+
+private slots:
+    void flatTagKeepsValueAfterSliding();
+    void averageIsTimeWeighted();
+    void leftEdgeIsCarriedForward();
+    void rateFollowsRamp();
+    void maxSamplesCap();
+    void clearEmptiesWindow();
+    void enginePublishesFlatTagAsGood();
+    void engineMarksBadSourceUncertain();
+};
+
+// ==================== 滚动窗口 ====================
+void TestStatisticsEngine::flatTagKeepsValueAfterSliding()
+{
+    RollingStatistics window(60 * SEC);
+    window.add(10.0, T0);
+    for (int i = 1; i <= 600; i++) {
+        window.expire(T0 + i * SEC);
+    }
+
+    QVERIFY(!window.isEmpty());
+    QCOMPARE(window.count(), 0);
+    QCOMPARE(window.average(), 10.0);
+    QCOMPARE(window.minimum(), 10.0);
+    QCOMPARE(window.maximum(), 10.0);
+    QVERIFY(qAbs(window.duration() - 60.0) < 1e-9);
+    QVERIFY(qAbs(window.sum() - 600.0) < 1e-6);
+    QVERIFY(window.standardDeviation() < 1e-6);
+    QCOMPARE(window.rate(), 0.0);
+}
+
+void TestStatisticsEngine::averageIsTimeWeighted()
+{
+    // 前30秒每秒一个10，之后一个20保持30秒：按样本平均约为10.3，按时间加权为15
+    RollingStatistics window(60 * SEC);
+    for (int i = 0; i < 30; i++) {
+        window.add(10.0, T0 + i * SEC);
+    }
+    window.add(20.0, T0 + 30 * SEC);
+    window.expire(T0 + 60 * SEC);
+
+    QVERIFY(qAbs(window.average() - 15.0) < 1e-9);
+    QVERIFY(qAbs(window.standardDeviation() - 5.0) < 1e-9);
+    QCOMPARE(window.maximum(), 20.0);
+    QCOMPARE(window.count(), 31);
+}
+
+void TestStatisticsEngine::leftEdgeIsCarriedForward()
+{
+    RollingStatistics window(60 * SEC);
+    window.add(10.0, T0);
+    window.add(20.0, T0 + 30 * SEC);
+
+    // 窗口[15, 75]：10保持15秒，20保持45秒
+    window.expire(T0 + 75 * SEC);
+    QVERIFY(qAbs(window.average() - 17.5) < 1e-9);
+    QCOMPARE(window.minimum(), 10.0);
+    QCOMPARE(window.count(), 1);
+
+    // 窗口[35, 95]：只剩20，10的区段整段移出
+    window.expire(T0 + 95 * SEC);
+    QVERIFY(qAbs(window.average() - 20.0) < 1e-9);
+    QCOMPARE(window.minimum(), 20.0);
+    QCOMPARE(window.count(), 0);
+}
+
+void TestStatisticsEngine::rateFollowsRamp()
+{
+    RollingStatistics window(10 * SEC);
+    for (int i = 0; i <= 100; i++) {
+        window.add(i, T0 + i * SEC);
+        window.expire(T0 + i * SEC);
+    }
+    QVERIFY(qAbs(window.rate() - 1.0) < 1e-9);
+    QVERIFY(qAbs(window.average() - 94.5) < 1e-9);
+    QCOMPARE(window.minimum(), 90.0);
+    QCOMPARE(window.maximum(), 100.0);
+}
+
+void TestStatisticsEngine::maxSamplesCap()
+{
+    RollingStatistics window(3600 * SEC, 5);
+    for (int i = 0; i < 20; i++) {
+        window.add(i, T0 + i * SEC);
+    }
+    QCOMPARE(window.count(), 5);
+    QCOMPARE(window.minimum(), 15.0);
+    QCOMPARE(window.maximum(), 19.0);
+}
+
+void TestStatisticsEngine::clearEmptiesWindow()
+{
+    RollingStatistics window(60 * SEC);
+    window.add(1.0, T0);
+    window.add(qQNaN(), T0 + SEC);
+    QCOMPARE(window.count(), 1);
+
+    window.clear();
+    QVERIFY(window.isEmpty());
+    QCOMPARE(window.average(), 0.0);
+    QCOMPARE(window.sum(), 0.0);
+}
+
+// ==================== 统计引擎 ====================
+void TestStatisticsEngine::enginePublishesFlatTagAsGood()
+{
+    StatisticsEngine engine;
+    engine.setSlideInterval(100);
+    VariableDefinition source("Area1.TT101.Temp.PV", TYPE_AI);
+    source.setDoubleValue(42.0);
+
+    QList<VariableDefinition*> outputs = engine.addStatistic(&source, 1,
+                                                             StatisticsEngine::STAT_AVG | StatisticsEngine::STAT_RATE);
+    QCOMPARE(outputs.size(), 2);
+    VariableDefinition *avg = engine.statVariable(
+        StatisticsEngine::statTagName(source.tagName(), StatisticsEngine::STAT_AVG));
+    QVERIFY(avg);
+
+    // 值不变超过窗口长度后仍为原值，质量GOOD
+    QTest::qWait(1500);
+    engine.publishPending();
+    QCOMPARE(avg->doubleValue(), 42.0);
+    QCOMPARE(avg->quality(), QUALITY_GOOD);
+
+    StatisticsResult result;
+    QVERIFY(engine.statistics(source.tagName(), result));
+    QCOMPARE(result.average, 42.0);
+    QCOMPARE(result.rate, 0.0);
+}
+
+void TestStatisticsEngine::engineMarksBadSourceUncertain()
+{
+    StatisticsEngine engine;
+    engine.setSlideInterval(100);
+    VariableDefinition source("Area1.TT102.Temp.PV", TYPE_AI);
+    source.setDoubleValue(5.0);
+    engine.addStatistic(&source, 10, StatisticsEngine::STAT_AVG);
+    VariableDefinition *avg = engine.statVariable(
+        StatisticsEngine::statTagName(source.tagName(), StatisticsEngine::STAT_AVG));
+    QVERIFY(avg);
+
+    QTRY_COMPARE_WITH_TIMEOUT(avg->quality(), QUALITY_GOOD, 1000);
+    QVERIFY(source.setQuality(QUALITY_COMM_FAIL));
+    QTRY_COMPARE_WITH_TIMEOUT(avg->quality(), QUALITY_UNCERTAIN, 1000);
+    QCOMPARE(avg->doubleValue(), 5.0);
+}
+
+QTEST_MAIN(TestStatisticsEngine)
+#include "tst_statisticsengine.moc"
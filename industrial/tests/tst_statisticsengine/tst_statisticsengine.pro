@@ -0,0 +1,5 @@
+TARGET = tst_statisticsengine
+include(../tests.pri)
+
+SOURCES += \
+    tst_statisticsengine.cpp
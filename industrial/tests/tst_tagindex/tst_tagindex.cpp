@@ -0,0 +1,154 @@
+// tst_tagindex.cpp - 标签名分段索引的前缀、通配和正则查询
+#include <QtTest>
+#include "tagindex.h"
+
+using namespace Industrial;
+
+typedef QVector<TagIndex::TagId> Ids;
+
+class TestTagIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void insertFindRemove();
+    void idConflictRejected();
+    void removePrunesBranches();
+    void prefixQuery();
+    void wildcardQuery();
+    void matchSegment();
+    void regexQuery();
+    void childSegments();
+
+private:
+    TagIndex m_index;
+};
+
+// 编号按标签名顺序给出，查询结果应为递增序列；插入顺序故意打乱
+void TestTagIndex::init()
+{
+    m_index.clear();
+    QVERIFY(m_index.insert("AREA2.PUMP201.FLOW.PV", 5));
+    QVERIFY(m_index.insert("AREA1.TT101.TEMP.PV", 4));
+    QVERIFY(m_index.insert("AREA1.PUMP101.FLOW.SP", 2));
+    QVERIFY(m_index.insert("AREA1.PUMP102.FLOW.PV", 3));
+    QVERIFY(m_index.insert("AREA1.PUMP101.FLOW.PV", 1));
+}
+
+// ==================== 修改 ====================
+void TestTagIndex::insertFindRemove()
+{
+    QCOMPARE(m_index.size(), 5);
+    QCOMPARE(m_index.find("AREA1.PUMP102.FLOW.PV"), TagIndex::TagId(3));
+    QCOMPARE(m_index.tagName(4), QString("AREA1.TT101.TEMP.PV"));
+    QVERIFY(!m_index.contains("AREA1.PUMP101.FLOW"));      // 中间节点不是标签
+    QVERIFY(!m_index.contains("AREA1.PUMP101.FLOW.PV.X"));
+    QCOMPARE(m_index.find(QString()), TagIndex::INVALID_ID);
+
+    // 同名再插入更新编号
+    QVERIFY(m_index.insert("AREA1.PUMP101.FLOW.PV", 10));
+    QCOMPARE(m_index.find("AREA1.PUMP101.FLOW.PV"), TagIndex::TagId(10));
+    QVERIFY(m_index.tagName(1).isEmpty());
+    QCOMPARE(m_index.size(), 5);
+
+    QVERIFY(m_index.remove("AREA1.PUMP101.FLOW.PV"));
+    QVERIFY(!m_index.remove("AREA1.PUMP101.FLOW.PV"));
+    QVERIFY(m_index.removeId(2));
+    QVERIFY(!m_index.removeId(2));
+    QCOMPARE(m_index.size(), 3);
+}
+
+void TestTagIndex::idConflictRejected()
+{
+    QVERIFY(!m_index.insert("AREA3.NEW.TAG", 1));
+    QVERIFY(!m_index.contains("AREA3.NEW.TAG"));
+    QVERIFY(!m_index.insert("AREA3.NEW.TAG", TagIndex::INVALID_ID));
+    QCOMPARE(m_index.tagName(1), QString("AREA1.PUMP101.FLOW.PV"));
+}
+
+void TestTagIndex::removePrunesBranches()
+{
+    QVERIFY(m_index.remove("AREA1.TT101.TEMP.PV"));
+    QCOMPARE(m_index.childSegments("AREA1"), QStringList() << "PUMP101" << "PUMP102");
+
+    QVERIFY(m_index.remove("AREA2.PUMP201.FLOW.PV"));
+    QCOMPARE(m_index.childSegments(), QStringList() << "AREA1");
+
+    // 空出的节点被复用
+    QVERIFY(m_index.insert("AREA2.PUMP202.FLOW.PV", 6));
+    QCOMPARE(m_index.tagName(6), QString("AREA2.PUMP202.FLOW.PV"));
+}
+
+// ==================== 查询 ====================
+void TestTagIndex::prefixQuery()
+{
+    QCOMPARE(m_index.findPrefix(QString()), Ids() << 1 << 2 << 3 << 4 << 5);
+    QCOMPARE(m_index.findPrefix("AREA"), Ids() << 1 << 2 << 3 << 4 << 5);
+    QCOMPARE(m_index.findPrefix("AREA1.PUMP10"), Ids() << 1 << 2 << 3);
+    QCOMPARE(m_index.findPrefix("AREA1.PUMP101."), Ids() << 1 << 2);
+    QCOMPARE(m_index.findPrefix("AREA1.PUMP101.FLOW.S"), Ids() << 2);
+    QVERIFY(m_index.findPrefix("AREA3").isEmpty());
+    QVERIFY(m_index.findPrefix("AREA3.PUMP").isEmpty());
+}
+
+void TestTagIndex::wildcardQuery()
+{
+    QCOMPARE(m_index.findWildcard("AREA1.*.FLOW.PV"), Ids() << 1 << 3);
+    QCOMPARE(m_index.findWildcard("*.PUMP?0?.FLOW.*"), Ids() << 1 << 2 << 3 << 5);
+    QCOMPARE(m_index.findWildcard("**.PV"), Ids() << 1 << 3 << 4 << 5);
+    QCOMPARE(m_index.findWildcard("AREA1.**"), Ids() << 1 << 2 << 3 << 4);
+    QCOMPARE(m_index.findWildcard("AREA1.PUMP101.FLOW.PV"), Ids() << 1);
+
+    // 设备名是除首尾以外的任意一段
+    QCOMPARE(m_index.findWildcard("*.**.PUMP101.*.**"), Ids() << 1 << 2);
+    QCOMPARE(m_index.findWildcard("*.**.FLOW.*.**"), Ids() << 1 << 2 << 3 << 5);
+
+    QVERIFY(m_index.findWildcard("AREA1.*.PV").isEmpty());
+    QVERIFY(m_index.findWildcard(QString()).isEmpty());
+
+    QStringList tooMany;
+    for (int i = 0; i <= TagIndex::MAX_PATTERN_SEGMENTS; i++) {
+        tooMany << "*";
+    }
+    QVERIFY(m_index.findWildcard(tooMany.join('.')).isEmpty());
+}
+
+void TestTagIndex::matchSegment()
+{
+    QVERIFY(TagIndex::matchSegment(u"PUMP*", u"PUMP101"));
+    QVERIFY(TagIndex::matchSegment(u"P*1", u"PUMP101"));
+    QVERIFY(TagIndex::matchSegment(u"*", u""));
+    QVERIFY(TagIndex::matchSegment(u"PUMP10?", u"PUMP101"));
+    QVERIFY(!TagIndex::matchSegment(u"PUMP10?", u"PUMP10"));
+    QVERIFY(!TagIndex::matchSegment(u"PUMP", u"PUMP101"));
+    QVERIFY(!TagIndex::matchSegment(u"*2", u"PUMP101"));
+}
+
+void TestTagIndex::regexQuery()
+{
+    QCOMPARE(m_index.findRegex(QRegularExpression("AREA\\d\\.PUMP\\d+\\.FLOW\\.PV")),
+             Ids() << 1 << 3 << 5);
+
+    // 须匹配整个标签名
+    QVERIFY(m_index.findRegex(QRegularExpression("PUMP101")).isEmpty());
+    QCOMPARE(m_index.findRegex(QRegularExpression(".*PUMP101.*")), Ids() << 1 << 2);
+
+    // 转义后的字面段
+    QVERIFY(m_index.insert("AREA1.P*1.FLOW.PV", 7));
+    QCOMPARE(m_index.findRegex(QRegularExpression(".+\\." + QRegularExpression::escape("P*1") + "\\..+")),
+             Ids() << 7);
+
+    QVERIFY(m_index.findRegex(QRegularExpression("(")).isEmpty());
+}
+
+// ==================== 浏览 ====================
+void TestTagIndex::childSegments()
+{
+    QCOMPARE(m_index.childSegments(), QStringList() << "AREA1" << "AREA2");
+    QCOMPARE(m_index.childSegments("AREA1"), QStringList() << "PUMP101" << "PUMP102" << "TT101");
+    QCOMPARE(m_index.childSegments("AREA1.PUMP101.FLOW"), QStringList() << "PV" << "SP");
+    QVERIFY(m_index.childSegments("AREA9").isEmpty());
+}
+
+QTEST_MAIN(TestTagIndex)
+#include "tst_tagindex.moc"
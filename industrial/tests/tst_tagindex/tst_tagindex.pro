@@ -0,0 +1,5 @@
+TARGET = tst_tagindex
+include(../tests.pri)
+
+SOURCES += \
+    tst_tagindex.cpp
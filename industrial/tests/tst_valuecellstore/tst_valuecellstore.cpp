@@ -0,0 +1,164 @@
+// tst_valuecellstore.cpp - 值单元顺序锁和单元存储
+#include <QtTest>
+#include <QThread>
+#include <atomic>
+#include "valuecellstore.h"
+
+using namespace Industrial;
+
+namespace {
+// 值、时间戳和质量互相推得出来，读到撕裂的采样时对不上
+ValueSample makeSample(qint64 n)
+{
+    ValueSample sample;
+    sample.value.asLong = n;
+    sample.timestamp = n;
+    sample.quality = static_cast<quint8>(n & 0xFF);
+    sample.storageType = static_cast<quint8>((n >> 8) & 0xFF);
+    sample.flags = ValueSample::FLAG_VALID;
+    return sample;
+}
+
+bool isConsistent(const ValueSample &sample)
+{
+    if (!sample.isValid()) {
+        return sample.value.asLong == 0 && sample.timestamp == 0;
+    }
+    const qint64 n = sample.value.asLong;
+    return sample.timestamp == n &&
+           sample.quality == static_cast<quint8>(n & 0xFF) &&
+           sample.storageType == static_cast<quint8>((n >> 8) & 0xFF);
+}
+}
+
+class TestValueCellStore : public QObject {
+    Q_OBJECT
+
+private slots:
+    void storeAndLoad();
+    void concurrentReadsAreConsistent();
+    void releasedIdsAreReused();
+    void cellPointersSurviveGrowth();
+    void changedBitmapCollectsIds();
+};
+
+// ==================== 顺序锁 ====================
+void TestValueCellStore::storeAndLoad()
+{
+    ValueCell cell;
+    QCOMPARE(cell.version(), 0u);
+    QVERIFY(!cell.load().isValid());
+
+    cell.store(makeSample(42));
+    ValueSample sample = cell.load();
+    QVERIFY(isConsistent(sample));
+    QCOMPARE(sample.value.asLong, qint64(42));
+    QCOMPARE(cell.version(), 1u);
+
+    cell.store(makeSample(43));
+    QCOMPARE(cell.version(), 2u);
+
+    cell.reset();
+    QCOMPARE(cell.version(), 0u);
+    QVERIFY(!cell.load().isValid());
+}
+
+void TestValueCellStore::concurrentReadsAreConsistent()
+{
+    ValueCell cell;
+    const qint64 writes = 200000;
+    std::atomic<bool> done{false};
+
+    QThread *writer = QThread::create([&cell, &done, writes]() {
+        for (qint64 n = 1; n <= writes; n++) {
+            cell.store(makeSample(n));
+        }
+        done.store(true, std::memory_order_release);
+    });
+    writer->start();
+
+    // 读者不加锁，读到的采样必须是某一次完整的写入，且不会倒退
+    qint64 reads = 0;
+    qint64 last = 0;
+    bool consistent = true;
+    bool monotonic = true;
+    while (!done.load(std::memory_order_acquire) || reads == 0) {
+        ValueSample sample = cell.load();
+        consistent = consistent && isConsistent(sample);
+        monotonic = monotonic && sample.value.asLong >= last;
+        last = sample.value.asLong;
+        reads++;
+    }
+    writer->wait();
+    delete writer;
+
+    QVERIFY(consistent);
+    QVERIFY(monotonic);
+    QCOMPARE(cell.load().value.asLong, writes);
+    QCOMPARE(cell.version(), static_cast<quint32>(writes));
+}
+
+// ==================== 单元存储 ====================
+void TestValueCellStore::releasedIdsAreReused()
+{
+    ValueCellStore store;
+    const quint32 first = store.allocate();
+    const quint32 second = store.allocate();
+    QVERIFY(first != ValueCellStore::INVALID_ID);
+    QVERIFY(second != first);
+    QCOMPARE(store.size(), 2);
+
+    store.cell(second)->store(makeSample(7));
+    const quint32 version = store.configVersion();
+    store.release(second);
+    QCOMPARE(store.size(), 1);
+    QVERIFY(store.configVersion() != version);
+
+    // 复用的单元已复位
+    QCOMPARE(store.allocate(), second);
+    QCOMPARE(store.cell(second)->version(), 0u);
+    QVERIFY(!store.cell(second)->load().isValid());
+    QVERIFY(store.owner(second) == nullptr);
+}
+
+void TestValueCellStore::cellPointersSurviveGrowth()
+{
+    ValueCellStore store;
+    const quint32 first = store.allocate();
+    ValueCell *cell = store.cell(first);
+    cell->store(makeSample(5));
+
+    for (int i = 0; i < ValueCellStore::BLOCK_SIZE * 2; i++) {
+        QVERIFY(store.allocate() != ValueCellStore::INVALID_ID);
+    }
+    QVERIFY(store.capacity() >= ValueCellStore::BLOCK_SIZE * 2 + 1);
+    QVERIFY(store.cell(first) == cell);
+    QCOMPARE(cell->load().value.asLong, qint64(5));
+}
+
+// ==================== 变化位图 ====================
+void TestValueCellStore::changedBitmapCollectsIds()
+{
+    ValueCellStore store;
+    for (int i = 0; i < ValueCellStore::BLOCK_SIZE + 16; i++) {
+        store.allocate();
+    }
+    QVERIFY(!store.hasChanges());
+
+    store.markChanged(70);
+    store.markChanged(3);
+    store.markChanged(ValueCellStore::BLOCK_SIZE + 5);
+    store.markChanged(70);
+    store.markChanged(ValueCellStore::INVALID_ID);
+    QVERIFY(store.hasChanges());
+
+    QVector<quint32> ids;
+    QCOMPARE(store.takeChanged(ids), 3);
+    QCOMPARE(ids, QVector<quint32>() << 3 << 70 << quint32(ValueCellStore::BLOCK_SIZE + 5));
+    QVERIFY(!store.hasChanges());
+    QCOMPARE(store.takeChanged(ids), 0);
+    QVERIFY(ids.isEmpty());
+}
+
+QTEST_MAIN(TestValueCellStore)
+#include "tst_valuecellstore.moc"
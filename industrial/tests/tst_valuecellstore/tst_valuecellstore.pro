@@ -0,0 +1,5 @@
+TARGET = tst_valuecellstore
+include(../tests.pri)
+
+SOURCES += \
+    tst_valuecellstore.cpp
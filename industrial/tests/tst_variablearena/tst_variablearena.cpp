@@ -0,0 +1,175 @@
+// tst_variablearena.cpp - 定长对象块、变量定义块和内存统计
+#include <QtTest>
+#include "variablearena.h"
+
+using namespace Industrial;
+
+namespace {
+// 记录构造和析构次数
+struct Counted {
+    static int alive;
+    int value;
+
+    explicit Counted(int v) : value(v) { alive++; }
+    ~Counted() { alive--; }
+};
+int Counted::alive = 0;
+}
+
+class TestVariableArena : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void slabReusesFreedSlots();
+    void slabAddressesSurviveGrowth();
+    void slabClearDestroysLiveObjects();
+    void columnsValidateLengths();
+    void arenaBuildsDefinitions();
+    void memoryUsagePerTag();
+};
+
+void TestVariableArena::init()
+{
+    Counted::alive = 0;
+}
+
+// ==================== 定长对象块 ====================
+void TestVariableArena::slabReusesFreedSlots()
+{
+    SlabArena<Counted, 4> slab;
+    const int first = slab.create(1);
+    const int second = slab.create(2);
+    QCOMPARE(slab.size(), 2);
+    QCOMPARE(slab.at(second)->value, 2);
+
+    slab.destroy(first);
+    QCOMPARE(Counted::alive, 1);
+    QVERIFY(!slab.contains(first));
+    slab.destroy(first);                    // 重复释放无效
+    QCOMPARE(slab.size(), 1);
+
+    // 释放的编号复用，其他对象不受影响
+    QCOMPARE(slab.create(3), first);
+    QCOMPARE(slab.at(first)->value, 3);
+    QCOMPARE(slab.at(second)->value, 2);
+    QVERIFY(!slab.contains(-1));
+    QVERIFY(!slab.contains(100));
+}
+
+void TestVariableArena::slabAddressesSurviveGrowth()
+{
+    SlabArena<Counted, 4> slab;
+    const int first = slab.create(0);
+    Counted *address = slab.at(first);
+    for (int i = 1; i < 10; i++) {
+        slab.create(i);
+    }
+    QCOMPARE(slab.capacity(), 12);
+    QVERIFY(slab.at(first) == address);
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(slab.at(i)->value, i);
+    }
+    QVERIFY(slab.memoryUsage() >= static_cast<qint64>(12 * sizeof(Counted)));
+}
+
+void TestVariableArena::slabClearDestroysLiveObjects()
+{
+    {
+        SlabArena<Counted, 4> slab;
+        for (int i = 0; i < 6; i++) {
+            slab.create(i);
+        }
+        slab.destroy(2);
+        QCOMPARE(Counted::alive, 5);
+
+        slab.clear();
+        QCOMPARE(Counted::alive, 0);
+        QCOMPARE(slab.size(), 0);
+        QCOMPARE(slab.capacity(), 0);
+        QCOMPARE(slab.create(7), 0);
+    }
+    // 析构时释放剩余对象
+    QCOMPARE(Counted::alive, 0);
+}
+
+// ==================== 变量定义块 ====================
+void TestVariableArena::columnsValidateLengths()
+{
+    VariableColumns columns;
+    columns.append("Area1.FT1.Flow", "ns=2;s=FT1");
+    columns.append("Area1.FT2.Flow", "ns=2;s=FT2", TYPE_DI, "Boolean", 500);
+    QVERIFY(columns.validate());
+
+    columns.updateRates.removeLast();
+    QString error;
+    QVERIFY(!columns.validate(&error));
+    QVERIFY(error.startsWith("updateRates"));
+
+    // 可选列为空时取缺省值
+    VariableColumns minimal;
+    minimal.tagNames << "Area1.FT3.Flow";
+    minimal.addresses << "ns=2;s=FT3";
+    QVERIFY(minimal.validate());
+    minimal.addresses.clear();
+    QVERIFY(!minimal.validate());
+}
+
+void TestVariableArena::arenaBuildsDefinitions()
+{
+    auto store = std::make_shared<ValueCellStore>();
+    VariableColumns columns;
+    columns.append("Area1.FT1.Flow", "ns=2;s=FT1");
+    columns.append("Area1.XV1.Open", "ns=2;s=XV1", TYPE_DI, "Boolean", 250);
+
+    {
+        VariableArena arena(columns, store);
+        QCOMPARE(arena.size(), 2);
+        QCOMPARE(store->size(), 2);
+        QCOMPARE(arena.memoryUsage(), static_cast<qint64>(2 * sizeof(VariableDefinition)));
+
+        VariableDefinition *flow = arena.at(0);
+        VariableDefinition *valve = arena.at(1);
+        QCOMPARE(flow->tagName(), QString("Area1.FT1.Flow"));
+        QCOMPARE(flow->type(), TYPE_AI);
+        QCOMPARE(flow->address(), QString("ns=2;s=FT1"));
+        QCOMPARE(valve->type(), TYPE_DI);
+        QCOMPARE(valve->dataType(), QString("Boolean"));
+        QCOMPARE(valve->updateRate(), 250);
+        QVERIFY(arena.contains(valve));
+
+        VariableDefinition outside("Area1.FT9.Flow", TYPE_AI);
+        QVERIFY(!arena.contains(&outside));
+    }
+    // 块析构时变量释放各自的值单元
+    QCOMPARE(store->size(), 0);
+
+    VariableArena empty(VariableColumns(), store);
+    QCOMPARE(empty.size(), 0);
+}
+
+// ==================== 内存统计 ====================
+void TestVariableArena::memoryUsagePerTag()
+{
+    TagMemoryUsage usage;
+    usage.tagCount = 4;
+    usage.add("handles", 400);
+    usage.add("cells", 128);
+    usage.add("handles", 100);
+    QCOMPARE(usage.total(), qint64(628));
+    QCOMPARE(usage.bytesPerTag("handles"), 125.0);
+    QCOMPARE(usage.bytesPerTag(), 157.0);
+
+    TagMemoryUsage other;
+    other.tagCount = 2;
+    other.add("cells", 72);
+    usage.merge(other);
+    QCOMPARE(usage.tagCount, 4);
+    QCOMPARE(usage.components.value("cells"), qint64(200));
+    QVERIFY(usage.toString().contains("handles: 500 bytes"));
+
+    QCOMPARE(TagMemoryUsage().bytesPerTag(), 0.0);
+}
+
+QTEST_MAIN(TestVariableArena)
+#include "tst_variablearena.moc"
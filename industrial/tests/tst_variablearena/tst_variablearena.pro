@@ -0,0 +1,5 @@
+TARGET = tst_variablearena
+include(../tests.pri)
+
+SOURCES += \
+    tst_variablearena.cpp
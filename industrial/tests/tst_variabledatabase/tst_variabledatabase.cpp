@@ -0,0 +1,102 @@
+// tst_variabledatabase.cpp - 变量定义的保存、加载和JSON导入导出
+#include <QtTest>
+#include <QTemporaryDir>
+#include "variabledatabase.h"
+
+using namespace Industrial;
+
+class TestVariableDatabase : public QObject {
+    Q_OBJECT
+
+private slots:
+    void alarmFilterSettingsRoundTrip();
+    void alarmFilterSettingsSurviveReopen();
+    void alarmFilterSettingsSurviveJson();
+};
+
+// ==================== 报警防抖参数 ====================
+void TestVariableDatabase::alarmFilterSettingsRoundTrip()
+{
+    VariableDatabase db;
+    QVERIFY(db.initialize());
+
+    VariableDefinition var("Area1.Tank1.Level", TYPE_AI);
+    var.setAlarmHysteresis(1.5);
+    var.setAlarmOnDelay(2000);
+    var.setAlarmOffDelay(500);
+    QVERIFY(db.saveVariableDefinition(&var));
+
+    VariableDefinition *loaded = db.loadVariableDefinition(var.tagName());
+    QVERIFY(loaded);
+    QVERIFY(loaded != &var);
+    QCOMPARE(loaded->alarmHysteresis(), 1.5);
+    QCOMPARE(loaded->alarmOnDelay(), 2000);
+    QCOMPARE(loaded->alarmOffDelay(), 500);
+
+    // 修改后再保存，重新加载得到新值
+    var.setAlarmHysteresis(0.25);
+    var.setAlarmOnDelay(0);
+    var.setAlarmOffDelay(3000);
+    QVERIFY(db.updateVariableDefinition(&var));
+    db.clearCache();
+    loaded = db.loadVariableDefinition(var.tagName());
+    QVERIFY(loaded);
+    QCOMPARE(loaded->alarmHysteresis(), 0.25);
+    QCOMPARE(loaded->alarmOnDelay(), 0);
+    QCOMPARE(loaded->alarmOffDelay(), 3000);
+}
+
+void TestVariableDatabase::alarmFilterSettingsSurviveReopen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("variables.db");
+
+    {
+        VariableDatabase db;
+        QVERIFY(db.initialize(path));
+        VariableDefinition var("Area1.Tank2.Level", TYPE_AI);
+        var.setAlarmHysteresis(2.0);
+        var.setAlarmOnDelay(1000);
+        var.setAlarmOffDelay(4000);
+        QVERIFY(db.saveVariableDefinition(&var));
+    }
+
+    VariableDatabase db;
+    QVERIFY(db.initialize(path));
+    VariableDefinition *loaded = db.loadVariableDefinition("Area1.Tank2.Level");
+    QVERIFY(loaded);
+    QCOMPARE(loaded->alarmHysteresis(), 2.0);
+    QCOMPARE(loaded->alarmOnDelay(), 1000);
+    QCOMPARE(loaded->alarmOffDelay(), 4000);
+}
+
+void TestVariableDatabase::alarmFilterSettingsSurviveJson()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString file = dir.filePath("variables.json");
+
+    {
+        VariableDatabase db;
+        QVERIFY(db.initialize());
+        VariableDefinition var("Area1.Tank3.Level", TYPE_AI);
+        var.setAlarmHysteresis(0.5);
+        var.setAlarmOnDelay(750);
+        var.setAlarmOffDelay(250);
+        QVERIFY(db.saveVariableDefinition(&var));
+        QVERIFY(db.exportToJson(file));
+    }
+
+    VariableDatabase db;
+    QVERIFY(db.initialize());
+    QVERIFY(db.importFromJson(file));
+    VariableDefinition *loaded = db.loadVariableDefinition("Area1.Tank3.Level");
+    QVERIFY(loaded);
+    QCOMPARE(loaded->alarmHysteresis(), 0.5);
+    QCOMPARE(loaded->alarmOnDelay(), 750);
+    QCOMPARE(loaded->alarmOffDelay(), 250);
+}
+
+QTEST_MAIN(TestVariableDatabase)
+#include "tst_variabledatabase.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_variabledatabase
+include(../tests.pri)
+
+SOURCES += \
+    tst_variabledatabase.cpp
@@ -0,0 +1,113 @@
+// tst_variablegroup.cpp - 变量组层级和报警汇总
+#include <QtTest>
+#include "variablesystem.h"
+
+using namespace Industrial;
+
+class TestVariableGroup : public QObject {
+    Q_OBJECT
+
+private slots:
+    void subGroupCycleRejected();
+    void alarmCountStaysLocal();
+    void onDelayHoldsGroupLevel();
+    void hysteresisHoldsGroupLevel();
+};
+
+// ==================== 层级 ====================
+void TestVariableGroup::subGroupCycleRejected()
+{
+    VariableGroup a("A");
+    VariableGroup b("B");
+    VariableGroup c("C");
+
+    QVERIFY(a.addSubGroup(&b));
+    QVERIFY(b.addSubGroup(&c));
+    QVERIFY(!a.addSubGroup(&b));
+    QVERIFY(!a.addSubGroup(&a));
+    QVERIFY(!b.addSubGroup(&a));
+    QVERIFY(!c.addSubGroup(&a));
+    QVERIFY(a.containsGroup(&c));
+    QVERIFY(!c.containsGroup(&a));
+    QCOMPARE(c.subGroups().size(), 0);
+}
+
+// ==================== 报警计数 ====================
+void TestVariableGroup::alarmCountStaysLocal()
+{
+    VariableGroup parent("Area1");
+    VariableGroup child("Area1.Pumps");
+    VariableDefinition shared("Area1.Pump1.Flow", TYPE_AI);
+    VariableDefinition childOnly("Area1.Pump2.Flow", TYPE_AI);
+    shared.setDoubleValue(50.0);
+    childOnly.setDoubleValue(50.0);
+
+    parent.addVariable(&shared);
+    child.addVariable(&shared);
+    child.addVariable(&childOnly);
+    QVERIFY(parent.addSubGroup(&child));
+
+    shared.setDoubleValue(92.0);
+    QCOMPARE(parent.alarmCount(), 1);
+    QCOMPARE(child.alarmCount(), 1);
+    // 汇总按组相加，同一变量计两次；去重后只有一个
+    QCOMPARE(parent.alarmRollup().activeCount, 2);
+    QCOMPARE(parent.rolledUpAlarmCount(), 1);
+
+    childOnly.setDoubleValue(96.0);
+    QCOMPARE(parent.alarmCount(), 1);
+    QCOMPARE(child.alarmCount(), 2);
+    QCOMPARE(parent.rolledUpAlarmCount(), 2);
+    QCOMPARE(parent.alarmCount(ALARM_CRITICAL), 1);
+
+    parent.acknowledgeAllAlarms();
+    QCOMPARE(parent.localRollup().unacknowledgedCount, 0);
+    QCOMPARE(child.unacknowledgedCount(), 2);
+}
+
+// ==================== 报警防抖 ====================
+void TestVariableGroup::onDelayHoldsGroupLevel()
+{
+    VariableGroup group("Area1");
+    VariableDefinition var("Area1.Tank1.Level", TYPE_AI);
+    var.setAlarmOnDelay(200);
+    var.setDoubleValue(50.0);
+    group.addVariable(&var);
+
+    // 越限后在确认延时内不计入，值不再刷新也要按时确认
+    var.setDoubleValue(92.0);
+    QCOMPARE(group.alarmCount(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(group.alarmCount(), 1, 2000);
+    QCOMPARE(group.alarmCount(ALARM_MAJOR), 1);
+
+    // 延时内回到正常，等待的升级作废
+    var.setDoubleValue(50.0);
+    QCOMPARE(group.alarmCount(), 0);
+    var.setDoubleValue(96.0);
+    var.setDoubleValue(50.0);
+    QTest::qWait(400);
+    QCOMPARE(group.alarmCount(ALARM_CRITICAL), 0);
+}
+
+void TestVariableGroup::hysteresisHoldsGroupLevel()
+{
+    VariableGroup group("Area1");
+    VariableDefinition var("Area1.Tank2.Level", TYPE_AI);
+    var.setAlarmHysteresis(2.0);
+    var.setDoubleValue(50.0);
+    group.addVariable(&var);
+
+    var.setDoubleValue(92.0);
+    QCOMPARE(group.alarmCount(), 1);
+
+    // 回到高限内侧但仍在滞环内，保持报警
+    var.setDoubleValue(89.0);
+    QCOMPARE(group.alarmCount(), 1);
+
+    // 越过复位限值才复位
+    var.setDoubleValue(87.0);
+    QCOMPARE(group.alarmCount(), 0);
+}
+
+QTEST_MAIN(TestVariableGroup)
+#include "tst_variablegroup.moc"
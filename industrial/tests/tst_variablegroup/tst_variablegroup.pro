@@ -0,0 +1,5 @@
+TARGET = tst_variablegroup
+include(../tests.pri)
+
+SOURCES += \
+    tst_variablegroup.cpp
@@ -0,0 +1,91 @@
+// tst_variablemanager.cpp - 按列批量注册和定义块的所有权
+#include <QtTest>
+#include "opcuaclientmanager.h"
+#include "stalenessmonitor.h"
+
+using namespace Industrial;
+
+class TestVariableManager : public QObject {
+    Q_OBJECT
+
+private slots:
+    void bulkRegisterReportsRejectedRows();
+    void bulkRegisterRejectsMismatchedColumns();
+    void clearVariablesNotifiesHolders();
+};
+
+// ==================== 批量注册 ====================
+void TestVariableManager::bulkRegisterReportsRejectedRows()
+{
+    OPCUAVariableManager manager;
+
+    VariableColumns columns;
+    columns.append("Area1.TT1.Temp", "ns=2;s=Area1.TT1.Temp");
+    columns.append("", "ns=2;s=Area1.Empty");
+    columns.append("Area1.TT2.Temp", "i=abc");
+    columns.append("Area1.TT1.Temp", "ns=2;s=Area1.Other");
+    columns.append("Area1.TT3.Temp", "Area1.TT3.Temp");
+
+    QStringList errors;
+    QCOMPARE(manager.registerVariables(columns, &errors), 2);
+    QCOMPARE(errors.size(), 3);
+    QVERIFY(errors.at(0).contains("row 1"));
+    QVERIFY(errors.at(1).contains("Area1.TT2.Temp"));
+    QVERIFY(errors.at(2).contains("already registered"));
+
+    QCOMPARE(manager.getRegisteredTagNames().size(), 2);
+    VariableDefinition *var = manager.getVariable("Area1.TT3.Temp");
+    QVERIFY(var);
+    QCOMPARE(var->tagName(), QString("Area1.TT3.Temp"));
+    QVERIFY(!manager.getVariable("Area1.TT2.Temp"));
+
+    // 与已注册变量重复的行整批拒绝，不影响已有变量
+    VariableColumns again;
+    again.append("Area1.TT3.Temp", "ns=2;s=Area1.TT3.Temp");
+    errors.clear();
+    QCOMPARE(manager.registerVariables(again, &errors), 0);
+    QCOMPARE(errors.size(), 1);
+    QCOMPARE(manager.getVariable("Area1.TT3.Temp"), var);
+}
+
+void TestVariableManager::bulkRegisterRejectsMismatchedColumns()
+{
+    OPCUAVariableManager manager;
+
+    VariableColumns columns;
+    columns.tagNames << "Area1.TT1.Temp" << "Area1.TT2.Temp";
+    columns.addresses << "ns=2;s=Area1.TT1.Temp";
+
+    QStringList errors;
+    QCOMPARE(manager.registerVariables(columns, &errors), 0);
+    QCOMPARE(errors.size(), 1);
+    QVERIFY(manager.getRegisteredTagNames().isEmpty());
+}
+
+// ==================== 所有权 ====================
+void TestVariableManager::clearVariablesNotifiesHolders()
+{
+    OPCUAVariableManager manager;
+    VariableColumns columns;
+    columns.append("Area1.Pump1.Flow", "ns=2;s=Area1.Pump1.Flow");
+    columns.append("Area1.Pump2.Flow", "ns=2;s=Area1.Pump2.Flow");
+    QCOMPARE(manager.registerVariables(columns), 2);
+
+    // 定义属于管理器：clearVariables释放时跟踪destroyed的持有者自动移除
+    VariableGroup group("Area1");
+    StalenessMonitor monitor;
+    for (VariableDefinition *var : manager.getAllVariables()) {
+        group.addVariable(var);
+        monitor.watch(var, 1000);
+    }
+    QCOMPARE(group.variableCount(), 2);
+    QCOMPARE(monitor.watchedCount(), 2);
+
+    manager.clearVariables();
+    QCOMPARE(group.variableCount(), 0);
+    QCOMPARE(monitor.watchedCount(), 0);
+    QVERIFY(!manager.getVariable("Area1.Pump1.Flow"));
+}
+
+QTEST_MAIN(TestVariableManager)
+#include "tst_variablemanager.moc"
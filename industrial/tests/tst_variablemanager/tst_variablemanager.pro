@@ -0,0 +1,5 @@
+TARGET = tst_variablemanager
+include(../tests.pri)
+
+SOURCES += \
+    tst_variablemanager.cpp
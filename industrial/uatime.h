@@ -0,0 +1,60 @@
+// UaTime.h - 值路径使用的整数时间戳
+#ifndef UATIME_H
+#define UATIME_H
+
+#include <QtGlobal>
+#include <QDateTime>
+#include <chrono>
+
+namespace Industrial {
+
+// ==================== 时间戳 ====================
+// 与UA_DateTime相同的表示：1601-01-01 UTC起的100ns计数。服务器的sourceTimestamp可直接保存，
+// 取当前时间不经过时区换算，QDateTime只在接口边界（界面、信号、数据库）转换
+typedef qint64 UaTimestamp;
+
+namespace UaTime {
+
+const qint64 TICKS_PER_MSEC = 10000;                    // UA_DATETIME_MSEC
+const qint64 TICKS_PER_SEC = 10000000;                  // UA_DATETIME_SEC
+const qint64 UNIX_EPOCH = 11644473600LL * TICKS_PER_SEC; // UA_DATETIME_UNIX_EPOCH
+
+const UaTimestamp NOW = 0;      // 写入时由变量取当前时间（0不是有效的时间戳）
+
+inline UaTimestamp now()
+{
+    qint64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    return ns / 100 + UNIX_EPOCH;
+}
+
+inline UaTimestamp fromMSecsSinceEpoch(qint64 msecs)
+{
+    return msecs * TICKS_PER_MSEC + UNIX_EPOCH;
+}
+
+inline qint64 toMSecsSinceEpoch(UaTimestamp ticks)
+{
+    return (ticks - UNIX_EPOCH) / TICKS_PER_MSEC;
+}
+
+inline UaTimestamp fromDateTime(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? fromMSecsSinceEpoch(dateTime.toMSecsSinceEpoch()) : NOW;
+}
+
+inline QDateTime toDateTime(UaTimestamp ticks)
+{
+    return ticks ? QDateTime::fromMSecsSinceEpoch(toMSecsSinceEpoch(ticks)) : QDateTime();
+}
+
+inline double secondsBetween(UaTimestamp from, UaTimestamp to)
+{
+    return static_cast<double>(to - from) / TICKS_PER_SEC;
+}
+
+} // namespace UaTime
+
+} // namespace Industrial
+
+#endif // UATIME_H
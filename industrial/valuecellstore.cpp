@@ -0,0 +1,167 @@
+// ValueCellStore.cpp - 实时值单元存储
+#include "valuecellstore.h"
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <QDebug>
+
+namespace Industrial {
+
+ValueCellStore::ValueCellStore()
+{
+}
+
+ValueCellStore::~ValueCellStore()
+{
+    if (m_used > 0) {
+        qWarning() << "ValueCellStore destroyed with" << m_used << "cells still in use";
+    }
+}
+
+std::shared_ptr<ValueCellStore> ValueCellStore::global()
+{
+    // 不析构：VariableDefinition可能在静态对象析构之后才释放单元
+    static std::shared_ptr<ValueCellStore> *store =
+        new std::shared_ptr<ValueCellStore>(std::make_shared<ValueCellStore>());
+    return *store;
+}
+
+quint32 ValueCellStore::allocate(VariableDefinition *owner)//分配单元
+{
+    QMutexLocker locker(&m_mutex);
+
+    quint32 id;
+    if (!m_freeList.isEmpty()) {
+        id = m_freeList.takeLast();
+    } else {
+        id = m_nextId;
+        int block = static_cast<int>(id / BLOCK_SIZE);
+        if (block >= MAX_BLOCKS) {
+            qCritical() << "ValueCellStore exhausted:" << id << "cells";
+            return INVALID_ID;
+        }
+        if (block >= m_blockCount) {
+            m_blocks[block].reset(new ValueCell[BLOCK_SIZE]);
+            m_owners[block].reset(new std::atomic<VariableDefinition*>[BLOCK_SIZE]);
+            m_dirty[block].reset(new std::atomic<quint64>[WORDS_PER_BLOCK]);
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                m_owners[block][i].store(nullptr, std::memory_order_relaxed);
+            }
+            for (int i = 0; i < WORDS_PER_BLOCK; i++) {
+                m_dirty[block][i].store(0, std::memory_order_relaxed);
+            }
+            m_blockCount = block + 1;
+            m_publishedBlocks.store(m_blockCount, std::memory_order_release);
+        }
+        m_nextId++;
+    }
+
+    ValueCell *valueCell = &m_blocks[id / BLOCK_SIZE][id % BLOCK_SIZE];
+    valueCell->reset();
+    valueCell->tagId = id;
+    m_owners[id / BLOCK_SIZE][id % BLOCK_SIZE].store(owner, std::memory_order_release);
+    m_used++;
+    touchConfig();
+    return id;
+}
+
+void ValueCellStore::release(quint32 id)//释放单元
+{
+    if (id == INVALID_ID) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (id >= m_nextId) {
+        qWarning() << "ValueCellStore: release of unknown cell" << id;
+        return;
+    }
+    m_blocks[id / BLOCK_SIZE][id % BLOCK_SIZE].reset();
+    m_owners[id / BLOCK_SIZE][id % BLOCK_SIZE].store(nullptr, std::memory_order_release);
+    m_freeList.append(id);
+    m_used--;
+    touchConfig();
+}
+
+ValueCell* ValueCellStore::cell(quint32 id) const
+{
+    if (id == INVALID_ID) {
+        return nullptr;
+    }
+    // 编号分配时块已经创建，块指针之后不再改变
+    return &m_blocks[id / BLOCK_SIZE][id % BLOCK_SIZE];
+}
+
+VariableDefinition* ValueCellStore::owner(quint32 id) const
+{
+    if (id == INVALID_ID) {
+        return nullptr;
+    }
+    return m_owners[id / BLOCK_SIZE][id % BLOCK_SIZE].load(std::memory_order_acquire);
+}
+
+// ==================== 变化位图 ====================
+void ValueCellStore::markChanged(quint32 id)
+{
+    if (id == INVALID_ID) {
+        return;
+    }
+    std::atomic<quint64> &word = m_dirty[id / BLOCK_SIZE][(id % BLOCK_SIZE) / 64];
+    quint64 bit = quint64(1) << (id % 64);
+    // 已置位（消费者还没取走）时只读不写，高频变化的变量不会反复争用缓存行
+    if (!(word.load(std::memory_order_relaxed) & bit)) {
+        word.fetch_or(bit, std::memory_order_release);
+    }
+    if (!m_pendingChanges.load(std::memory_order_relaxed)) {
+        m_pendingChanges.store(true, std::memory_order_release);
+    }
+}
+
+int ValueCellStore::takeChanged(QVector<quint32> &ids)
+{
+    ids.clear();
+    // 先清标志再扫描，扫描期间的新变化会重新置位标志
+    if (!m_pendingChanges.exchange(false, std::memory_order_acq_rel)) {
+        return 0;
+    }
+
+    int blocks = m_publishedBlocks.load(std::memory_order_acquire);
+    for (int block = 0; block < blocks; block++) {
+        std::atomic<quint64> *words = m_dirty[block].get();
+        for (int w = 0; w < WORDS_PER_BLOCK; w++) {
+            if (words[w].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            quint64 bits = words[w].exchange(0, std::memory_order_acquire);
+            quint32 base = static_cast<quint32>(block) * BLOCK_SIZE + static_cast<quint32>(w) * 64;
+            while (bits) {
+                int bit = qCountTrailingZeroBits(bits);
+                ids.append(base + static_cast<quint32>(bit));
+                bits &= bits - 1;
+            }
+        }
+    }
+    return ids.size();
+}
+
+int ValueCellStore::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_used;
+}
+
+int ValueCellStore::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_blockCount * BLOCK_SIZE;
+}
+
+qint64 ValueCellStore::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<qint64>(m_blockCount) * BLOCK_SIZE
+               * (sizeof(ValueCell) + sizeof(VariableDefinition*))
+           + static_cast<qint64>(m_blockCount) * WORDS_PER_BLOCK * sizeof(quint64)
+           + m_freeList.capacity() * sizeof(quint32);
+}
+
+} // namespace Industrial
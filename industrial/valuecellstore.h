@@ -0,0 +1,149 @@
+// ValueCellStore.h - 实时值单元存储
+#ifndef VALUECELLSTORE_H
+#define VALUECELLSTORE_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QVector>
+#include <memory>
+#include <atomic>
+#include "uatime.h"
+
+namespace Industrial {
+
+class VariableDefinition;
+
+// ==================== 值采样 ====================
+// 一次完整的值（原生值、类型、质量、时间戳），可整体拷贝
+struct ValueSample {
+    enum Flags : quint8 {
+        FLAG_VALID = 0x01   // 已写入过有效值
+    };
+
+    union NativeValue {
+        double asDouble;
+        bool asBool;
+        int asInt;
+        qint64 asLong;
+    };
+
+    NativeValue value;      // 原生值（字符串单独存放在VariableDefinition中）
+    UaTimestamp timestamp;  // 时间戳（UA_DateTime，100ns），0为未写入
+    quint8 storageType;     // 存储类型（VariableDefinition::StorageType）
+    quint8 quality;         // DataQuality
+    quint8 flags;           // Flags
+
+    ValueSample() {
+        value.asLong = 0;
+        timestamp = 0;
+        storageType = 0;
+        quality = 1;        // QUALITY_BAD
+        flags = 0;
+    }
+
+    bool isValid() const { return (flags & FLAG_VALID) != 0; }
+};
+
+// ==================== 值单元 ====================
+// 变量的实时值，与VariableDefinition的配置元数据分开存放。32字节对齐，一次更新只写一个缓存行。
+// 顺序锁：写者写入前后各把序号加1（写入期间为奇数），读者拷贝采样后序号不变即为一致快照，
+// 读者不加锁也不阻塞写者。写者之间需要外部互斥（VariableDefinition::m_valueMutex）
+struct alignas(32) ValueCell {
+    std::atomic<quint32> sequence;  // 顺序锁序号
+    quint32 tagId;                  // 单元在所属存储中的编号
+    ValueSample sample;             // 跨线程只能通过load()/store()访问
+
+    ValueCell() : sequence(0), tagId(0) {}
+
+    ValueSample load() const {
+        ValueSample result;
+        quint32 begin;
+        quint32 end;
+        do {
+            begin = sequence.load(std::memory_order_acquire);
+            while (begin & 1u) {    // 写入中，写者临界区只有一次结构拷贝
+                begin = sequence.load(std::memory_order_acquire);
+            }
+            result = sample;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end = sequence.load(std::memory_order_relaxed);
+        } while (begin != end);
+        return result;
+    }
+
+    void store(const ValueSample &newSample) {
+        quint32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        sample = newSample;
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    quint32 version() const { return sequence.load(std::memory_order_acquire) >> 1; }//写入次数
+
+    void reset() {
+        sequence.store(0, std::memory_order_relaxed);
+        sample = ValueSample();
+    }
+};
+
+static_assert(sizeof(ValueCell) == 32, "ValueCell must stay half a cache line");
+
+// ==================== 值单元存储 ====================
+// 按块连续分配值单元，扩容时不移动已有单元，单元指针在存储生命周期内保持有效。
+// 分配/释放加锁，单元本身的读写不经过存储。变量持有所在存储的shared_ptr，
+// 管理器先于变量析构时存储随最后一个变量释放。
+// 变化位图：值或质量变化时置位单元编号，消费者按自己的节奏批量取走，代替逐个变量的信号
+class ValueCellStore {
+public:
+    static const int BLOCK_SIZE = 1024;     // 每块单元数
+    static const int MAX_BLOCKS = 4096;     // 最多约400万个单元
+    static const int WORDS_PER_BLOCK = BLOCK_SIZE / 64;  // 每块的变化位图字数
+
+    ValueCellStore();
+    ~ValueCellStore();
+
+    // 未绑定到管理器的变量使用的进程级存储
+    static std::shared_ptr<ValueCellStore> global();
+
+    quint32 allocate(VariableDefinition *owner = nullptr);  // 分配单元并返回编号
+    void release(quint32 id);           // 释放单元，编号可被复用
+    ValueCell* cell(quint32 id) const;  // 按编号取单元
+    VariableDefinition* owner(quint32 id) const;  // 单元所属变量（已释放为nullptr）
+
+    // ==================== 变化位图 ====================
+    void markChanged(quint32 id);               // 无锁置位，已置位时不写缓存行
+    int takeChanged(QVector<quint32> &ids);     // 取走并清除所有变化编号，返回个数
+    bool hasChanges() const { return m_pendingChanges.load(std::memory_order_acquire); }
+
+    // ==================== 配置版本 ====================
+    // 单元分配/释放或变量转换参数变化时递增，按编号缓存变量配置的使用者（如BatchConverter）据此重建
+    quint32 configVersion() const { return m_configVersion.load(std::memory_order_acquire); }
+    void touchConfig() { m_configVersion.fetch_add(1, std::memory_order_release); }
+
+    int size() const;                   // 使用中的单元数
+    int capacity() const;               // 已分配的单元数
+    qint64 memoryUsage() const;         // 单元占用的内存(bytes)
+
+    static const quint32 INVALID_ID = 0xFFFFFFFFu;
+
+private:
+    ValueCellStore(const ValueCellStore&) = delete;
+    ValueCellStore& operator=(const ValueCellStore&) = delete;
+
+    mutable QMutex m_mutex;
+    std::unique_ptr<ValueCell[]> m_blocks[MAX_BLOCKS];  // 块表固定大小，读取单元时无需加锁
+    std::unique_ptr<std::atomic<VariableDefinition*>[]> m_owners[MAX_BLOCKS];
+    std::unique_ptr<std::atomic<quint64>[]> m_dirty[MAX_BLOCKS];  // 变化位图，每块WORDS_PER_BLOCK字
+    std::atomic<int> m_publishedBlocks{0};              // 无锁扫描位图时可见的块数
+    std::atomic<bool> m_pendingChanges{false};
+    std::atomic<quint32> m_configVersion{0};
+    int m_blockCount = 0;
+    quint32 m_nextId = 0;               // 尚未使用过的下一个编号
+    QVector<quint32> m_freeList;        // 已释放可复用的编号
+    int m_used = 0;
+};
+
+} // namespace Industrial
+
+#endif // VALUECELLSTORE_H
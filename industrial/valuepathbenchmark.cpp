@@ -0,0 +1,123 @@
+// ValuePathBenchmark.cpp - 值写入路径单样本耗时测试
+
+#include "valuepathbenchmark.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace Industrial {
+
+ValuePathBenchmark::ValuePathBenchmark(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void ValuePathBenchmark::setSamples(int samples)
+{
+    m_samples = qMax(1000, samples);
+}
+
+void ValuePathBenchmark::setWarmup(int samples)
+{
+    m_warmup = qMax(0, samples);
+}
+
+QList<ValuePathBenchmarkResult> ValuePathBenchmark::run()
+{
+    QList<ValuePathBenchmarkResult> results;
+    results.append(runCase("QDateTime now", CASE_QDATETIME_NOW));
+    results.append(runCase("QDateTime source", CASE_QDATETIME_SOURCE));
+    results.append(runCase("UaTimestamp now", CASE_UATIME_NOW));
+    results.append(runCase("UaTimestamp source", CASE_UATIME_SOURCE));
+    results.append(runCase("clock QDateTime", CASE_CLOCK_QDATETIME));
+    results.append(runCase("clock UaTime", CASE_CLOCK_UATIME));
+
+    // 写入用例以旧路径为基准，取时间用例以QDateTime取时间为基准
+    for (int i = 0; i < results.size(); i++) {
+        const ValuePathBenchmarkResult &base = results.at(i < 4 ? 0 : 4);
+        if (results[i].nsPerSample > 0.0) {
+            results[i].speedup = base.nsPerSample / results[i].nsPerSample;
+        }
+        emit caseFinished(results.at(i));
+    }
+
+    qInfo().noquote() << formatReport(results);
+    return results;
+}
+
+ValuePathBenchmarkResult ValuePathBenchmark::runCase(const QString &name, CaseType type)
+{
+    ValuePathBenchmarkResult result;
+    result.name = name;
+
+    VariableDefinition var("bench_value_path", TYPE_AI);
+    var.setDeadband(0.0);  // 每个样本都要真正写入
+
+    const UaTimestamp sourceBase = UaTime::now();
+    qint64 sink = 0;       // 防止只取时间的用例被优化掉
+
+    auto writeSample = [&](int i) {
+        double value = static_cast<double>(i & 0xFFFF);
+        UaTimestamp source = sourceBase + static_cast<qint64>(i) * UaTime::TICKS_PER_MSEC;
+        switch (type) {
+        case CASE_QDATETIME_NOW:
+            var.setDoubleValue(value, QDateTime::currentDateTime(), QUALITY_GOOD);
+            break;
+        case CASE_QDATETIME_SOURCE:
+            var.setDoubleValue(value, QDateTime::fromMSecsSinceEpoch(UaTime::toMSecsSinceEpoch(source)),
+                               QUALITY_GOOD);
+            break;
+        case CASE_UATIME_NOW:
+            var.setDoubleValue(value);
+            break;
+        case CASE_UATIME_SOURCE:
+            var.setDoubleValue(value, source, QUALITY_GOOD);
+            break;
+        case CASE_CLOCK_QDATETIME:
+            sink += QDateTime::currentDateTime().toMSecsSinceEpoch();
+            break;
+        case CASE_CLOCK_UATIME:
+            sink += UaTime::now();
+            break;
+        }
+    };
+
+    for (int i = 0; i < m_warmup; i++) {
+        writeSample(i);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < m_samples; i++) {
+        writeSample(i + 1);  // 与上一个值不同，避免变化检测跳过
+    }
+    result.elapsedNs = timer.nsecsElapsed();
+    result.samples = m_samples;
+    result.nsPerSample = static_cast<double>(result.elapsedNs) / m_samples;
+
+    if (sink == 1) {
+        qDebug() << "ValuePathBenchmark sink" << sink;
+    }
+    return result;
+}
+
+QString ValuePathBenchmark::formatReport(const QList<ValuePathBenchmarkResult> &results)
+{
+    QString report = "=== 值写入路径单样本耗时 ===\n";
+    report += QString("%1 %2 %3 %4\n")
+                  .arg("Case", -20)
+                  .arg("Samples", 10)
+                  .arg("ns/sample", 10)
+                  .arg("Speedup", 8);
+
+    for (const ValuePathBenchmarkResult &result : results) {
+        report += QString("%1 %2 %3 %4\n")
+                      .arg(result.name, -20)
+                      .arg(result.samples, 10)
+                      .arg(result.nsPerSample, 10, 'f', 1)
+                      .arg(QString::number(result.speedup, 'f', 2) + "x", 8);
+    }
+
+    return report;
+}
+
+} // namespace Industrial
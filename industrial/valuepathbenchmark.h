@@ -0,0 +1,58 @@
+// ValuePathBenchmark.h - 值写入路径单样本耗时测试
+#ifndef VALUEPATHBENCHMARK_H
+#define VALUEPATHBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 测试结果 ====================
+struct ValuePathBenchmarkResult {
+    QString name;                // 用例名称
+    qint64 samples = 0;          // 写入样本数
+    qint64 elapsedNs = 0;        // 总耗时(ns)
+    double nsPerSample = 0.0;    // 单样本耗时(ns)
+    double speedup = 1.0;        // 相对第一个用例（QDateTime::currentDateTime）的倍数
+};
+
+// ==================== 值写入路径测试 ====================
+// 对同一变量反复写入，比较QDateTime时间戳和UA_DateTime整数时间戳的单样本开销。
+// 不需要服务器，只测变量自身的写入路径
+class ValuePathBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ValuePathBenchmark(QObject *parent = nullptr);
+
+    void setSamples(int samples);//每个用例写入的样本数
+    void setWarmup(int samples);//每个用例测量前的预热样本数
+
+    QList<ValuePathBenchmarkResult> run();
+    static QString formatReport(const QList<ValuePathBenchmarkResult> &results);
+
+signals:
+    void caseFinished(const ValuePathBenchmarkResult &result);
+
+private:
+    enum CaseType {
+        CASE_QDATETIME_NOW,      // 旧路径：每个样本QDateTime::currentDateTime()
+        CASE_QDATETIME_SOURCE,   // 旧路径：源时间戳转换为QDateTime后写入
+        CASE_UATIME_NOW,         // 新路径：缺省时间戳，写入时取UaTime::now()
+        CASE_UATIME_SOURCE,      // 新路径：直接传入UA_DateTime源时间戳
+        CASE_CLOCK_QDATETIME,    // 仅取时间：QDateTime::currentDateTime()
+        CASE_CLOCK_UATIME        // 仅取时间：UaTime::now()
+    };
+
+    ValuePathBenchmarkResult runCase(const QString &name, CaseType type);
+
+    int m_samples = 1000000;
+    int m_warmup = 10000;
+};
+
+} // namespace Industrial
+
+#endif // VALUEPATHBENCHMARK_H
@@ -0,0 +1,132 @@
+// VariableArena.cpp - 批量注册的列描述和变量定义的连续存放
+#include "variablearena.h"
+#include <QDebug>
+#include <new>
+
+namespace Industrial {
+
+// ==================== VariableColumns 实现 ====================
+void VariableColumns::reserve(int count)
+{
+    tagNames.reserve(count);
+    addresses.reserve(count);
+    types.reserve(count);
+    dataTypes.reserve(count);
+    updateRates.reserve(count);
+}
+
+void VariableColumns::append(const QString &tagName, const QString &address, VariableType type,
+                             const QString &dataType, int updateRate)
+{
+    tagNames.append(tagName);
+    addresses.append(address);
+    types.append(type);
+    dataTypes.append(dataType);
+    updateRates.append(updateRate);
+}
+
+bool VariableColumns::validate(QString *error) const
+{
+    const int count = tagNames.size();
+    QString message;
+    if (addresses.size() != count) {
+        message = QString("addresses has %1 entries, expected %2").arg(addresses.size()).arg(count);
+    } else if (!types.isEmpty() && types.size() != count) {
+        message = QString("types has %1 entries, expected %2").arg(types.size()).arg(count);
+    } else if (!dataTypes.isEmpty() && dataTypes.size() != count) {
+        message = QString("dataTypes has %1 entries, expected %2").arg(dataTypes.size()).arg(count);
+    } else if (!updateRates.isEmpty() && updateRates.size() != count) {
+        message = QString("updateRates has %1 entries, expected %2").arg(updateRates.size()).arg(count);
+    }
+
+    if (!message.isEmpty()) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+    return true;
+}
+
+// ==================== VariableArena 实现 ====================
+VariableArena::VariableArena(const VariableColumns &columns, const std::shared_ptr<ValueCellStore> &store)
+    : m_variables(nullptr)
+    , m_count(0)
+{
+    const int count = columns.size();
+    if (count <= 0) {
+        return;
+    }
+
+    m_variables = static_cast<VariableDefinition*>(::operator new(sizeof(VariableDefinition) * count));
+
+    const bool hasTypes = !columns.types.isEmpty();
+    const bool hasDataTypes = !columns.dataTypes.isEmpty();
+    const bool hasUpdateRates = !columns.updateRates.isEmpty();
+    for (int i = 0; i < count; i++) {
+        VariableDefinition *var = new (m_variables + i) VariableDefinition(
+            columns.tagNames.at(i), hasTypes ? columns.types.at(i) : TYPE_AI, store, nullptr);
+        m_count = i + 1;
+
+        var->setAddress(columns.addresses.at(i));
+        if (hasDataTypes && !columns.dataTypes.at(i).isEmpty()) {
+            var->setDataType(columns.dataTypes.at(i));
+        }
+        if (hasUpdateRates && columns.updateRates.at(i) > 0) {
+            var->setUpdateRate(columns.updateRates.at(i));
+        }
+    }
+}
+
+VariableArena::~VariableArena()
+{
+    for (int i = m_count - 1; i >= 0; i--) {
+        m_variables[i].~VariableDefinition();
+    }
+    ::operator delete(m_variables);
+}
+
+qint64 VariableArena::memoryUsage() const
+{
+    return static_cast<qint64>(sizeof(VariableDefinition)) * m_count;
+}
+
+// ==================== TagMemoryUsage 实现 ====================
+void TagMemoryUsage::merge(const TagMemoryUsage &other)
+{
+    tagCount = qMax(tagCount, other.tagCount);
+    for (auto it = other.components.constBegin(); it != other.components.constEnd(); ++it) {
+        components[it.key()] += it.value();
+    }
+}
+
+qint64 TagMemoryUsage::total() const
+{
+    qint64 sum = 0;
+    for (qint64 bytes : components) {
+        sum += bytes;
+    }
+    return sum;
+}
+
+double TagMemoryUsage::bytesPerTag(const QString &component) const
+{
+    if (tagCount <= 0) {
+        return 0.0;
+    }
+    const qint64 bytes = component.isEmpty() ? total() : components.value(component);
+    return static_cast<double>(bytes) / tagCount;
+}
+
+QString TagMemoryUsage::toString() const
+{
+    QString text = QString("%1 tags, %2 bytes total, %3 bytes/tag")
+                       .arg(tagCount).arg(total()).arg(bytesPerTag(), 0, 'f', 1);
+    for (auto it = components.constBegin(); it != components.constEnd(); ++it) {
+        text += QString("\n  %1: %2 bytes, %3 bytes/tag")
+                    .arg(it.key()).arg(it.value()).arg(bytesPerTag(it.key()), 0, 'f', 1);
+    }
+    return text;
+}
+
+} // namespace Industrial
@@ -0,0 +1,156 @@
+// VariableArena.h - 批量注册的列描述、变量定义和每变量运行状态的连续存放
+#ifndef VARIABLEARENA_H
+#define VARIABLEARENA_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "variablesystem.h"
+
+namespace Industrial {
+
+// ==================== 变量列描述 ====================
+// N个变量按列存放，每列一个数组，下标相同的元素属于同一个变量。
+// tagNames和addresses必须齐全；其余列可以为空（取缺省值），不为空时长度须与tagNames相同
+struct VariableColumns {
+    QStringList tagNames;
+    QStringList addresses;          // OPC UA节点地址
+    QVector<VariableType> types;    // 缺省TYPE_AI
+    QStringList dataTypes;          // OPC UA数据类型名，缺省为空
+    QVector<int> updateRates;       // 期望更新周期(ms)，缺省1000
+
+    int size() const { return tagNames.size(); }
+    bool isEmpty() const { return tagNames.isEmpty(); }
+    void reserve(int count);
+    void append(const QString &tagName, const QString &address, VariableType type = TYPE_AI,
+                const QString &dataType = QString(), int updateRate = 0);  // updateRate<=0取缺省
+    bool validate(QString *error = nullptr) const;  // 检查各列长度
+};
+
+// ==================== 变量定义块 ====================
+// 一次分配容纳N个VariableDefinition的连续内存，逐个原位构造，析构时按相反顺序析构后整体释放。
+// 变量属于块：不能单独delete，也不能设置父对象（父对象析构时会delete它）。
+// 变量在构造块的线程中创建，线程归属与普通new出来的变量相同
+class VariableArena {
+public:
+    VariableArena(const VariableColumns &columns, const std::shared_ptr<ValueCellStore> &store);
+    ~VariableArena();
+
+    int size() const { return m_count; }
+    VariableDefinition* at(int index) const { return m_variables + index; }
+    bool contains(const VariableDefinition *var) const { return var >= m_variables && var < m_variables + m_count; }
+    qint64 memoryUsage() const;         // 定义本身占用的字节数（不含字符串等间接分配）
+
+private:
+    VariableArena(const VariableArena&) = delete;
+    VariableArena& operator=(const VariableArena&) = delete;
+
+    VariableDefinition *m_variables;
+    int m_count;
+};
+
+// ==================== 定长对象块 ====================
+// 同一类型的对象按块分配（每块BLOCK_SIZE个），块分配后不移动，对象的编号和地址在释放前保持不变；
+// 释放的编号进入空闲表，下次创建时复用。clear()析构全部对象并整体释放所有块。
+// 非线程安全，由使用者加锁
+template <typename T, int BLOCK_SIZE = 1024>
+class SlabArena {
+public:
+    SlabArena() = default;
+    ~SlabArena() { clear(); }
+
+    template <typename... Args>
+    int create(Args&&... args)
+    {
+        int index;
+        if (!m_freeList.isEmpty()) {
+            index = m_freeList.takeLast();
+        } else {
+            index = m_next++;
+            if (index / BLOCK_SIZE >= static_cast<int>(m_blocks.size())) {
+                m_blocks.emplace_back(new Slot[BLOCK_SIZE]);
+            }
+            m_live.push_back(false);
+        }
+        new (slot(index)) T(std::forward<Args>(args)...);
+        m_live[static_cast<size_t>(index)] = true;
+        m_used++;
+        return index;
+    }
+
+    void destroy(int index)
+    {
+        if (!contains(index)) {
+            return;
+        }
+        at(index)->~T();
+        m_live[static_cast<size_t>(index)] = false;
+        m_freeList.append(index);
+        m_used--;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < m_next; i++) {
+            if (m_live[static_cast<size_t>(i)]) {
+                at(i)->~T();
+            }
+        }
+        m_blocks.clear();
+        m_live.clear();
+        m_freeList.clear();
+        m_next = 0;
+        m_used = 0;
+    }
+
+    T* at(int index) const { return std::launder(reinterpret_cast<T*>(slot(index))); }
+    bool contains(int index) const { return index >= 0 && index < m_next && m_live[static_cast<size_t>(index)]; }
+
+    int size() const { return m_used; }                                 // 使用中的对象数
+    int capacity() const { return static_cast<int>(m_blocks.size()) * BLOCK_SIZE; }
+    qint64 memoryUsage() const                                          // 块和簿记占用的字节数
+    {
+        return static_cast<qint64>(capacity()) * sizeof(Slot) + m_live.capacity() / 8
+               + m_freeList.capacity() * static_cast<qint64>(sizeof(int));
+    }
+
+private:
+    SlabArena(const SlabArena&) = delete;
+    SlabArena& operator=(const SlabArena&) = delete;
+
+    struct alignas(T) Slot {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    Slot* slot(int index) const { return &m_blocks[static_cast<size_t>(index / BLOCK_SIZE)][index % BLOCK_SIZE]; }
+
+    std::vector<std::unique_ptr<Slot[]>> m_blocks;
+    std::vector<bool> m_live;
+    QVector<int> m_freeList;
+    int m_next = 0;                     // 尚未使用过的下一个编号
+    int m_used = 0;
+};
+
+// ==================== 内存统计 ====================
+// 按组成部分（句柄、节点标识、值单元、历史缓冲区等）汇总字节数，换算为每个变量的平均占用。
+// 只统计各部分自身的分配，Qt容器和字符串的头部开销按近似值计入
+struct TagMemoryUsage {
+    int tagCount = 0;
+    QMap<QString, qint64> components;   // 组成部分 -> 字节数
+
+    void add(const QString &component, qint64 bytes) { components[component] += bytes; }
+    void merge(const TagMemoryUsage &other);    // 变量数取较大者（同一批变量在不同管理器中的状态）
+    qint64 total() const;
+    double bytesPerTag(const QString &component = QString()) const;  // component为空时为合计
+    QString toString() const;                   // 每个组成部分一行
+};
+
+} // namespace Industrial
+
+#endif // VARIABLEARENA_H
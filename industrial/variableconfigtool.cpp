@@ -357,13 +357,25 @@ void VariableConfigDialog::saveVariableData()
 
     m_variable->setDescription(m_editDescription->text());
     m_variable->setUnit(static_cast<EngineeringUnit>(m_comboUnit->currentData().toInt()));
-    m_variable->setRange(m_spinMin->value(), m_spinMax->value());
-    m_variable->setDeadband(m_spinDeadband->value());
     m_variable->setUpdateRate(m_spinUpdateRate->value());
     m_variable->setPriority(m_spinPriority->value());
-    m_variable->setAlarmLimits(m_spinAlarmLo->value(), m_spinAlarmHi->value(),
-                               m_spinAlarmLoLo->value(), m_spinAlarmHiHi->value());
-    m_variable->setAlarmLevel(static_cast<AlarmLevel>(m_comboAlarmLevel->currentData().toInt()));
+
+    // 范围、死区和报警参数作为一个快照发布，采集线程不会看到新旧参数混在一起
+    VariableConfig config = *m_variable->configSnapshot();
+    config.minValue = m_spinMin->value();
+    config.maxValue = m_spinMax->value();
+    config.deadband = m_spinDeadband->value();
+    config.alarmLo = m_spinAlarmLo->value();
+    config.alarmHi = m_spinAlarmHi->value();
+    config.alarmLoLo = m_spinAlarmLoLo->value();
+    config.alarmHiHi = m_spinAlarmHiHi->value();
+    config.alarmLevel = static_cast<AlarmLevel>(m_comboAlarmLevel->currentData().toInt());
+    QStringList errors;
+    if (config.validate(&errors)) {
+        m_variable->applyConfig(config);
+    } else {
+        QMessageBox::warning(this, tr("Error"), errors.join("\n"));
+    }
     m_variable->setAddress(m_editAddress->text());
     m_variable->setDataType(m_editDataType->text());
     m_variable->setAccessGroup(m_comboAccessGroup->currentText());
@@ -618,8 +630,8 @@ void VariableBrowser::populateTree()
     root->setText(0, tr("Plant"));
     root->setData(0, Qt::UserRole, "ROOT");
 
-    // 从数据库加载区域（简化示例）
-    QStringList areas = {"Area1", "Area2", "Area3"};
+    // 区域、设备取自标签名索引的前两级
+    QStringList areas = m_database->childTagSegments();
     m_comboFilterArea->clear();
     m_comboFilterArea->addItem(tr("All Areas"));
 
@@ -631,8 +643,7 @@ void VariableBrowser::populateTree()
         areaItem->setData(0, Qt::UserRole, "AREA:" + area);
         areaItem->setIcon(0, QApplication::style()->standardIcon(QStyle::SP_DirIcon));
 
-        // 示例设备
-        QStringList devices = {"Pump101", "Valve201", "Tank301"};
+        QStringList devices = m_database->childTagSegments(area);
         for (const QString &device : devices) {
             QTreeWidgetItem *deviceItem = new QTreeWidgetItem(areaItem);
             deviceItem->setText(0, device);
@@ -650,7 +661,13 @@ void VariableBrowser::populateTable()
 
     if (!m_database) return;
 
-    QList<VariableDefinition*> allVars = m_database->loadAllVariables();
+    // 选了区域时只加载该区域的变量
+    QList<VariableDefinition*> allVars;
+    if (!m_filterArea.isEmpty() && m_filterArea != tr("All Areas")) {
+        allVars = m_database->findVariablesByArea(m_filterArea);
+    } else {
+        allVars = m_database->loadAllVariables();
+    }
     QList<VariableDefinition*> filteredVars;
 
     // 应用过滤器
@@ -697,10 +714,11 @@ void VariableBrowser::populateTable()
         if (m_rtManager) {
             RealTimeVariable *rtVar = m_rtManager->getVariable(var->tagName());
             if (rtVar) {
-                currentValue = rtVar->value();
-                qualityStr = dataQualityToString(rtVar->quality());
+                VariableSnapshot snap = rtVar->snapshot();
+                currentValue = snap.value;
+                qualityStr = dataQualityToString(snap.quality);
                 alarmStr = alarmLevelToString(rtVar->alarmLevel());
-                timestampStr = rtVar->timestamp().toString("hh:mm:ss");
+                timestampStr = snap.timestamp.toString("hh:mm:ss");
             }
         }
 
@@ -789,10 +807,13 @@ void VariableBrowser::updateVariableStatus()
         RealTimeVariable *rtVar = m_rtManager->getVariable(tagName);
         if (!rtVar) continue;
 
+        // 一次读取值、质量、时间戳
+        VariableSnapshot snap = rtVar->snapshot();
+
         // 更新值
         QTableWidgetItem *valueItem = m_tableWidget->item(row, 3);
         if (valueItem) {
-            valueItem->setText(rtVar->value().toString());
+            valueItem->setText(snap.value.toString());
 
             // 更新报警颜色
             if (rtVar->isInAlarm()) {
@@ -821,7 +842,7 @@ void VariableBrowser::updateVariableStatus()
         // 更新质量
         QTableWidgetItem *qualityItem = m_tableWidget->item(row, 4);
         if (qualityItem) {
-            qualityItem->setText(dataQualityToString(rtVar->quality()));
+            qualityItem->setText(dataQualityToString(snap.quality));
         }
 
         // 更新报警状态
@@ -833,7 +854,7 @@ void VariableBrowser::updateVariableStatus()
         // 更新时间戳
         QTableWidgetItem *timeItem = m_tableWidget->item(row, 6);
         if (timeItem) {
-            timeItem->setText(rtVar->timestamp().toString("hh:mm:ss"));
+            timeItem->setText(snap.timestamp.toString("hh:mm:ss"));
         }
     }
 }
@@ -1,5 +1,6 @@
 // VariableDatabase.cpp - 修正版本
 #include"variabledatabase.h"
+#include"conversionfunctions.h"
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QFile>
@@ -21,6 +22,8 @@ QString getQueryError(const QSqlQuery& query) {
 VariableDatabase::VariableDatabase(QObject *parent)
     : QObject(parent)
     , m_initialized(false)
+    , m_tagIndexValid(false)
+    , m_nextTagId(0)
 {
 }
 
@@ -105,6 +108,9 @@ bool VariableDatabase::createTables()
             alarm_lolo REAL,
             alarm_hihi REAL,
             alarm_level INTEGER DEFAULT 0,
+            alarm_hysteresis REAL DEFAULT 0.0,
+            alarm_on_delay INTEGER DEFAULT 0,
+            alarm_off_delay INTEGER DEFAULT 0,
             history_enabled INTEGER DEFAULT 0,
             history_interval INTEGER DEFAULT 60,
             writable INTEGER DEFAULT 1,
@@ -112,6 +118,7 @@ bool VariableDatabase::createTables()
             address TEXT,
             data_type TEXT,
             format_string TEXT,
+            expression TEXT DEFAULT '',
             created_time DATETIME DEFAULT CURRENT_TIMESTAMP,
             modified_time DATETIME DEFAULT CURRENT_TIMESTAMP
         )
@@ -123,6 +130,16 @@ bool VariableDatabase::createTables()
         return false;
     }
 
+    // 旧版本数据库补充报警防抖字段
+    if (!ensureColumn("variable_definitions", "alarm_hysteresis", "REAL DEFAULT 0.0") ||
+        !ensureColumn("variable_definitions", "alarm_on_delay", "INTEGER DEFAULT 0") ||
+        !ensureColumn("variable_definitions", "alarm_off_delay", "INTEGER DEFAULT 0")) {
+        return false;
+    }
+    if (!ensureColumn("variable_definitions", "expression", "TEXT DEFAULT ''")) {
+        return false;
+    }
+
     // 变量组表
     sql = R"(
         CREATE TABLE IF NOT EXISTS variable_groups (
@@ -207,6 +224,22 @@ bool VariableDatabase::createTables()
         return false;
     }
 
+    // 转换函数表（非线性转换的类型和参数，参数为JSON）
+    sql = R"(
+        CREATE TABLE IF NOT EXISTS variable_conversions (
+            tag_name TEXT PRIMARY KEY,
+            conversion_type TEXT NOT NULL,
+            parameters TEXT NOT NULL,
+            FOREIGN KEY (tag_name) REFERENCES variable_definitions(tag_name) ON DELETE CASCADE
+        )
+    )";
+
+    if (!query.exec(sql)) {
+        QString error = query.lastError().text();
+        qCritical() << "Failed to create variable_conversions table:" << error;
+        return false;
+    }
+
     // 历史版本表
     sql = R"(
         CREATE TABLE IF NOT EXISTS variable_versions (
@@ -243,6 +276,30 @@ bool VariableDatabase::createTables()
     return true;
 }
 
+bool VariableDatabase::ensureColumn(const QString &table, const QString &column,
+                                    const QString &definition)
+{
+    QSqlQuery query(m_database);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        QString error = query.lastError().text();
+        qCritical() << "Failed to read columns of" << table << ":" << error;
+        return false;
+    }
+    while (query.next()) {
+        if (query.value(1).toString() == column) {
+            return true;
+        }
+    }
+
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        QString error = query.lastError().text();
+        qCritical() << "Failed to add column" << column << "to" << table << ":" << error;
+        return false;
+    }
+    qInfo() << "Added column" << column << "to" << table;
+    return true;
+}
+
 bool VariableDatabase::createIndexes()
 {
     QSqlQuery query(m_database);
@@ -304,8 +361,9 @@ bool VariableDatabase::saveVariableDefinition(VariableDefinition *var)
         (tag_name, description, type, unit, min_value, max_value, deadband,
          initial_value, update_rate, priority, alarm_lo, alarm_hi, alarm_lolo,
          alarm_hihi, alarm_level, history_enabled, history_interval, writable,
-         access_group, address, data_type, format_string)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+         access_group, address, data_type, format_string,
+         alarm_hysteresis, alarm_on_delay, alarm_off_delay, expression)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
     )");
 
     query.addBindValue(var->tagName());
@@ -330,6 +388,10 @@ bool VariableDatabase::saveVariableDefinition(VariableDefinition *var)
     query.addBindValue(var->address());
     query.addBindValue(var->dataType());
     query.addBindValue(var->formatString());
+    query.addBindValue(var->alarmHysteresis());
+    query.addBindValue(var->alarmOnDelay());
+    query.addBindValue(var->alarmOffDelay());
+    query.addBindValue(var->expression());
 
     if (!query.exec()) {
         QString error = query.lastError().text();
@@ -360,7 +422,30 @@ bool VariableDatabase::saveVariableDefinition(VariableDefinition *var)
         }
     }
 
+    // 保存转换函数（没有或不可序列化时删除旧记录）
+    QJsonObject conversion = conversionToJson(var->conversionFunction());
+    if (conversion.isEmpty()) {
+        query.prepare("DELETE FROM variable_conversions WHERE tag_name = ?");
+        query.addBindValue(var->tagName());
+    } else {
+        query.prepare(R"(
+            INSERT OR REPLACE INTO variable_conversions (tag_name, conversion_type, parameters)
+            VALUES (?, ?, ?)
+        )");
+        query.addBindValue(var->tagName());
+        query.addBindValue(conversion["type"].toString());
+        query.addBindValue(QString::fromUtf8(
+            QJsonDocument(conversion["parameters"].toObject()).toJson(QJsonDocument::Compact)));
+    }
+    if (!query.exec()) {
+        QString error = query.lastError().text();
+        qWarning() << "Failed to save conversion:" << error;
+    }
+
     updateCache(var);
+    if (m_tagIndexValid && !m_tagIndex.contains(var->tagName())) {
+        m_tagIndex.insert(var->tagName(), m_nextTagId++);
+    }
 
     emit variableSaved(var->tagName());
     emit databaseChanged();
@@ -390,6 +475,9 @@ bool VariableDatabase::deleteVariableDefinition(const QString &tagName)
     }
 
     removeFromCache(tagName);
+    if (m_tagIndexValid) {
+        m_tagIndex.remove(tagName);
+    }
     emit variableDeleted(tagName);
     emit databaseChanged();
 
@@ -413,7 +501,8 @@ VariableDefinition* VariableDatabase::loadVariableDefinition(const QString &tagN
                initial_value, update_rate, priority, alarm_lo, alarm_hi,
                alarm_lolo, alarm_hihi, alarm_level, history_enabled,
                history_interval, writable, access_group, address, data_type,
-               format_string
+               format_string, alarm_hysteresis, alarm_on_delay, alarm_off_delay,
+               expression
         FROM variable_definitions
         WHERE tag_name = ?
     )");
@@ -453,6 +542,10 @@ VariableDefinition* VariableDatabase::loadVariableDefinition(const QString &tagN
     var->setAddress(query.value(18).toString());
     var->setDataType(query.value(19).toString());
     var->setFormatString(query.value(20).toString());
+    var->setAlarmHysteresis(query.value(21).toDouble());
+    var->setAlarmOnDelay(query.value(22).toInt());
+    var->setAlarmOffDelay(query.value(23).toInt());
+    var->setExpression(query.value(24).toString());
 
     // 加载关联变量
     query.prepare("SELECT related_tag FROM variable_relations WHERE tag_name = ?");
@@ -466,6 +559,22 @@ VariableDefinition* VariableDatabase::loadVariableDefinition(const QString &tagN
         qWarning() << "Failed to load variable relations:" << error;
     }
 
+    // 加载转换函数
+    query.prepare("SELECT conversion_type, parameters FROM variable_conversions WHERE tag_name = ?");
+    query.addBindValue(tagName);
+    if (query.exec()) {
+        if (query.next()) {
+            QJsonObject params = QJsonDocument::fromJson(query.value(1).toString().toUtf8()).object();
+            ConversionFunction *func = createConversionFunction(query.value(0).toString(), params);
+            if (func) {
+                var->setConversionFunction(func);
+            }
+        }
+    } else {
+        QString error = query.lastError().text();
+        qWarning() << "Failed to load variable conversion:" << error;
+    }
+
     m_variableCache.insert(tagName, var);
 
     return var;
@@ -691,24 +800,8 @@ QList<VariableDefinition*> VariableDatabase::findVariablesByArea(const QString &
 
     if (!m_initialized) return result;
 
-    // 这个查询需要结合多个表
-    QSqlQuery query(m_database);
-    query.prepare(R"(
-        SELECT DISTINCT vd.tag_name
-        FROM variable_definitions vd
-        WHERE vd.tag_name LIKE ? || '.%'
-        ORDER BY vd.tag_name
-    )");
-    query.addBindValue(areaCode);
-
-    if (!query.exec()) {
-        QString error = query.lastError().text();
-        qWarning() << "Failed to find variables by area:" << error;
-        return result;
-    }
-
-    while (query.next()) {
-        QString tagName = query.value(0).toString();
+    // 区域是标签名第一段，按索引取该段下的全部标签
+    for (const QString &tagName : findTagNamesByPrefix(areaCode + TagName::SEPARATOR)) {
         VariableDefinition *var = loadVariableDefinition(tagName);
         if (var) {
             result.append(var);
@@ -722,25 +815,21 @@ QList<VariableDefinition*> VariableDatabase::findVariablesByDevice(const QString
 {
     QList<VariableDefinition*> result;
 
-    if (!m_initialized) return result;
+    if (!m_initialized || deviceName.isEmpty()) return result;
 
-    QSqlQuery query(m_database);
-    query.prepare(R"(
-        SELECT DISTINCT vd.tag_name
-        FROM variable_definitions vd
-        WHERE vd.tag_name LIKE '%.' || ? || '.%'
-        ORDER BY vd.tag_name
-    )");
-    query.addBindValue(deviceName);
-
-    if (!query.exec()) {
-        QString error = query.lastError().text();
-        qWarning() << "Failed to find variables by device:" << error;
-        return result;
+    // 与原LIKE '%.设备.%'一致：设备名是除首尾以外的任意一段。
+    // 设备名含'*'/'?'/'.'时不能直接拼进段通配模式，改用转义后的正则按字面匹配
+    QStringList tagNames;
+    if (deviceName.contains(QLatin1Char('*')) || deviceName.contains(QLatin1Char('?'))
+        || deviceName.contains(TagName::SEPARATOR)) {
+        QRegularExpression regex(QStringLiteral(".+\\.") + QRegularExpression::escape(deviceName)
+                                 + QStringLiteral("\\..+"));
+        tagNames = findTagNamesByRegex(regex);
+    } else {
+        tagNames = findTagNames("*.**." + deviceName + ".*.**");
     }
 
-    while (query.next()) {
-        QString tagName = query.value(0).toString();
+    for (const QString &tagName : tagNames) {
         VariableDefinition *var = loadVariableDefinition(tagName);
         if (var) {
             result.append(var);
@@ -750,6 +839,62 @@ QList<VariableDefinition*> VariableDatabase::findVariablesByDevice(const QString
     return result;
 }
 
+QStringList VariableDatabase::findTagNames(const QString &pattern)
+{
+    ensureTagIndex();
+    return tagNamesOf(m_tagIndex.findWildcard(pattern));
+}
+
+QStringList VariableDatabase::findTagNamesByPrefix(const QString &prefix)
+{
+    ensureTagIndex();
+    return tagNamesOf(m_tagIndex.findPrefix(prefix));
+}
+
+QStringList VariableDatabase::findTagNamesByRegex(const QRegularExpression &regex)
+{
+    ensureTagIndex();
+    return tagNamesOf(m_tagIndex.findRegex(regex));
+}
+
+QStringList VariableDatabase::childTagSegments(const QString &path)
+{
+    ensureTagIndex();
+    return m_tagIndex.childSegments(path);
+}
+
+QStringList VariableDatabase::tagNamesOf(const QVector<TagIndex::TagId> &ids) const
+{
+    QStringList names;
+    names.reserve(ids.size());
+    for (TagIndex::TagId id : ids) {
+        names.append(m_tagIndex.tagName(id));
+    }
+    return names;
+}
+
+void VariableDatabase::ensureTagIndex()
+{
+    if (m_tagIndexValid || !m_initialized) {
+        return;
+    }
+
+    m_tagIndex.clear();
+    m_nextTagId = 0;
+
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT tag_name FROM variable_definitions")) {
+        QString error = query.lastError().text();
+        qWarning() << "Failed to build tag index:" << error;
+        return;
+    }
+    while (query.next()) {
+        m_tagIndex.insert(query.value(0).toString(), m_nextTagId++);
+    }
+    m_tagIndexValid = true;
+}
+
 QList<VariableDefinition*> VariableDatabase::findAlarmVariables()
 {
     QList<VariableDefinition*> result;
@@ -882,8 +1027,18 @@ bool VariableDatabase::exportToJson(const QString &filename)
         varObj["updateRate"] = var->updateRate();
         varObj["alarmLo"] = var->alarmLo();
         varObj["alarmHi"] = var->alarmHi();
+        varObj["alarmHysteresis"] = var->alarmHysteresis();
+        varObj["alarmOnDelay"] = var->alarmOnDelay();
+        varObj["alarmOffDelay"] = var->alarmOffDelay();
+        if (!var->expression().isEmpty()) {
+            varObj["expression"] = var->expression();
+        }
         varObj["address"] = var->address();
         varObj["dataType"] = var->dataType();
+        QJsonObject conversion = conversionToJson(var->conversionFunction());
+        if (!conversion.isEmpty()) {
+            varObj["conversion"] = conversion;
+        }
 
         variables.append(varObj);
     }
@@ -967,12 +1122,27 @@ bool VariableDatabase::importFromJson(const QString &filename)
             var->setAlarmLimits(varObj["alarmLo"].toDouble(),
                                 varObj["alarmHi"].toDouble());
         }
+        if (varObj.contains("alarmHysteresis")) {
+            var->setAlarmHysteresis(varObj["alarmHysteresis"].toDouble());
+        }
+        if (varObj.contains("alarmOnDelay")) {
+            var->setAlarmOnDelay(varObj["alarmOnDelay"].toInt());
+        }
+        if (varObj.contains("alarmOffDelay")) {
+            var->setAlarmOffDelay(varObj["alarmOffDelay"].toInt());
+        }
+        if (varObj.contains("expression")) {
+            var->setExpression(varObj["expression"].toString());
+        }
         if (varObj.contains("address")) {
             var->setAddress(varObj["address"].toString());
         }
         if (varObj.contains("dataType")) {
             var->setDataType(varObj["dataType"].toString());
         }
+        if (varObj.contains("conversion")) {
+            var->setConversionFunction(conversionFromJson(varObj["conversion"].toObject()));
+        }
 
         if (saveVariableDefinition(var)) {
             successCount++;
@@ -986,6 +1156,7 @@ bool VariableDatabase::importFromJson(const QString &filename)
     // 提交事务
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;  // 回滚的增删不在索引中撤销，下次查询时重建
         qCritical() << "Failed to commit transaction";
         return false;
     }
@@ -1118,6 +1289,7 @@ bool VariableDatabase::importFromCsv(const QString &filename)
 
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;
         qCritical() << "Failed to commit transaction";
         return false;
     }
@@ -1289,6 +1461,7 @@ bool VariableDatabase::restore(const QString &backupFile)
 
     // 清空缓存
     clearCache();
+    m_tagIndexValid = false;
 
     emit databaseChanged();
 
@@ -1313,6 +1486,7 @@ bool VariableDatabase::batchSave(const QList<VariableDefinition*> &variables)
 
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;
         return false;
     }
 
@@ -1337,6 +1511,7 @@ bool VariableDatabase::batchDelete(const QStringList &tagNames)
 
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;
         return false;
     }
 
@@ -1387,9 +1562,19 @@ bool VariableDatabase::createVersion(const QString &versionName,
         varObj["alarmLo"] = var->alarmLo();
         varObj["alarmHi"] = var->alarmHi();
         varObj["alarmLevel"] = static_cast<int>(var->alarmLevel());
+        varObj["alarmHysteresis"] = var->alarmHysteresis();
+        varObj["alarmOnDelay"] = var->alarmOnDelay();
+        varObj["alarmOffDelay"] = var->alarmOffDelay();
+        if (!var->expression().isEmpty()) {
+            varObj["expression"] = var->expression();
+        }
         varObj["address"] = var->address();
         varObj["dataType"] = var->dataType();
         varObj["formatString"] = var->formatString();
+        QJsonObject conversion = conversionToJson(var->conversionFunction());
+        if (!conversion.isEmpty()) {
+            varObj["conversion"] = conversion;
+        }
 
         QJsonDocument doc(varObj);
         QString jsonData = doc.toJson(QJsonDocument::Compact);
@@ -1404,6 +1589,7 @@ bool VariableDatabase::createVersion(const QString &versionName,
 
         if (!query.exec()) {
             m_database.rollback();
+            m_tagIndexValid = false;
             QString error = query.lastError().text();
             qCritical() << "Failed to save variable to version:" << error;
             return false;
@@ -1412,6 +1598,7 @@ bool VariableDatabase::createVersion(const QString &versionName,
 
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;
         return false;
     }
 
@@ -1492,6 +1679,18 @@ bool VariableDatabase::restoreVersion(const QString &versionName)
             var->setAlarmLimits(varObj["alarmLo"].toDouble(),
                                 varObj["alarmHi"].toDouble());
         }
+        if (varObj.contains("alarmHysteresis")) {
+            var->setAlarmHysteresis(varObj["alarmHysteresis"].toDouble());
+        }
+        if (varObj.contains("alarmOnDelay")) {
+            var->setAlarmOnDelay(varObj["alarmOnDelay"].toInt());
+        }
+        if (varObj.contains("alarmOffDelay")) {
+            var->setAlarmOffDelay(varObj["alarmOffDelay"].toInt());
+        }
+        if (varObj.contains("expression")) {
+            var->setExpression(varObj["expression"].toString());
+        }
         if (varObj.contains("alarmLevel")) {
             var->setAlarmLevel(static_cast<AlarmLevel>(varObj["alarmLevel"].toInt()));
         }
@@ -1504,9 +1703,13 @@ bool VariableDatabase::restoreVersion(const QString &versionName)
         if (varObj.contains("formatString")) {
             var->setFormatString(varObj["formatString"].toString());
         }
+        if (varObj.contains("conversion")) {
+            var->setConversionFunction(conversionFromJson(varObj["conversion"].toObject()));
+        }
 
         if (!saveVariableDefinition(var)) {
             m_database.rollback();
+            m_tagIndexValid = false;
             delete var;
             return false;
         }
@@ -1516,6 +1719,7 @@ bool VariableDatabase::restoreVersion(const QString &versionName)
 
     if (!m_database.commit()) {
         m_database.rollback();
+        m_tagIndexValid = false;
         return false;
     }
 
@@ -3,6 +3,7 @@
 #define VARIABLEDATABASE_H
 
 #include"variablesystem.h"
+#include"tagindex.h"
 #include <QObject>
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -55,6 +56,12 @@ public:
     // 搜索功能
     QList<VariableDefinition*> searchVariables(const QString &keyword);
 
+    // 标签名索引（内存中，首次查询时建立），结果按标签名排序，只返回标签名不加载定义
+    QStringList findTagNames(const QString &pattern);           // 段通配，如"AREA1.*.TT*.PV"
+    QStringList findTagNamesByPrefix(const QString &prefix);
+    QStringList findTagNamesByRegex(const QRegularExpression &regex);
+    QStringList childTagSegments(const QString &path = QString());//浏览：下一级段名
+
     // ==================== 导入导出 ====================
     bool exportToJson(const QString &filename);
     bool importFromJson(const QString &filename);
@@ -101,6 +108,9 @@ private:
     bool createTables();
     bool createIndexes();
     bool createTriggers();
+    bool ensureColumn(const QString &table, const QString &column, const QString &definition);//旧库缺少字段时补上
+    void ensureTagIndex();
+    QStringList tagNamesOf(const QVector<TagIndex::TagId> &ids) const;
 
     QSqlDatabase m_database;
     bool m_initialized;
@@ -108,6 +118,11 @@ private:
     // 缓存
     QMap<QString, VariableDefinition*> m_variableCache;
     mutable QMutex m_cacheMutex;
+
+    // 标签名索引：保存/删除时增量维护，恢复备份或事务回滚后重建
+    TagIndex m_tagIndex;
+    bool m_tagIndexValid;
+    TagIndex::TagId m_nextTagId;
 public:
     // 清理缓存
     void clearCache();
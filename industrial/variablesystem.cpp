@@ -4,7 +4,12 @@
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMetaMethod>
+#include <QTimer>
+#include <QSet>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 namespace Industrial {
 
@@ -136,6 +141,103 @@ double lminToM3h(double lmin) {
     return lmin * 60.0 / 1000.0;
 }
 
+// ==================== 变量命名后缀 ====================
+const QString VariableNaming::SUFFIX_PV = "PV";
+const QString VariableNaming::SUFFIX_SP = "SP";
+const QString VariableNaming::SUFFIX_OUT = "OUT";
+const QString VariableNaming::SUFFIX_ALM = "ALM";
+const QString VariableNaming::SUFFIX_ACK = "ACK";
+const QString VariableNaming::SUFFIX_HI = "HI";
+const QString VariableNaming::SUFFIX_LO = "LO";
+const QString VariableNaming::SUFFIX_HIHI = "HIHI";
+const QString VariableNaming::SUFFIX_LOLO = "LOLO";
+const QString VariableNaming::SUFFIX_AVG = "AVG";
+const QString VariableNaming::SUFFIX_SUM = "SUM";
+const QString VariableNaming::SUFFIX_RATE = "RATE";
+const QString VariableNaming::SUFFIX_MIN = "MIN";
+const QString VariableNaming::SUFFIX_MAX = "MAX";
+const QString VariableNaming::SUFFIX_STD = "STD";
+const QString VariableNaming::SUFFIX_CNT = "CNT";
+
+}
+
+// ==================== VariableConfig 实现 ====================
+namespace Industrial {
+
+void VariableConfig::finalize() {
+    // 换算系数按工程范围和原始范围计算，原始范围为零时不换算
+    const double rawSpan = rawMaxValue - rawMinValue;
+    conversionScale = qFuzzyCompare(rawSpan, 0.0) ? 1.0 : (maxValue - minValue) / rawSpan;
+    conversionOffset = minValue - conversionScale * rawMinValue;
+
+    // 报警区段：限值严格有序时才判断，限值落在量程外的区段不会触发
+    alarmValid = alarmLoLo < alarmLo && alarmLo < alarmHi && alarmHi < alarmHiHi;
+    hasCriticalAlarm = alarmValid && (alarmLoLo > minValue || alarmHiHi < maxValue);
+    hasMajorAlarm = alarmValid && (alarmLo > minValue || alarmHi < maxValue);
+}
+
+bool VariableConfig::validate(QStringList *errors) const {
+    QStringList found;
+    const double values[] = { minValue, maxValue, rawMinValue, rawMaxValue, scaleFactor, offset, deadband,
+                              alarmLo, alarmHi, alarmLoLo, alarmHiHi, alarmHysteresis };
+    for (double value : values) {
+        if (!std::isfinite(value)) {
+            found << "Parameter is not a finite number";
+            break;
+        }
+    }
+    if (minValue > maxValue) {
+        found << "Invalid range: min > max";
+    }
+    if (rawMinValue > rawMaxValue) {
+        found << "Invalid raw range: min > max";
+    }
+    if (deadband < 0.0 || alarmHysteresis < 0.0 || alarmOnDelay < 0 || alarmOffDelay < 0) {
+        found << "Deadband, hysteresis and alarm delays must not be negative";
+    }
+    if (!(alarmLoLo <= alarmLo && alarmLo <= alarmHi && alarmHi <= alarmHiHi)) {
+        found << "Invalid alarm limits: LoLo <= Lo <= Hi <= HiHi required";
+    }
+
+    if (errors) {
+        *errors << found;
+    }
+    return found.isEmpty();
+}
+
+bool VariableConfig::sameParameters(const VariableConfig &other) const {
+    return minValue == other.minValue && maxValue == other.maxValue &&
+           rawMinValue == other.rawMinValue && rawMaxValue == other.rawMaxValue &&
+           scaleFactor == other.scaleFactor && offset == other.offset && deadband == other.deadband &&
+           alarmLo == other.alarmLo && alarmHi == other.alarmHi &&
+           alarmLoLo == other.alarmLoLo && alarmHiHi == other.alarmHiHi &&
+           alarmLevel == other.alarmLevel && alarmHysteresis == other.alarmHysteresis &&
+           alarmOnDelay == other.alarmOnDelay && alarmOffDelay == other.alarmOffDelay;
+}
+
+namespace {
+
+// 配置版本号全局递增，批量发布的变量共用一个
+std::atomic<quint64> s_configVersion{0};
+// 批量发布期间为奇数
+std::atomic<quint64> s_configGeneration{0};
+QMutex s_batchMutex;
+
+quint64 nextConfigVersion() {
+    return s_configVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+const VariableConfigPtr& defaultConfig() {
+    static const VariableConfigPtr config = [] {
+        std::shared_ptr<VariableConfig> c = std::make_shared<VariableConfig>();
+        c->finalize();
+        return c;
+    }();
+    return config;
+}
+
+} // namespace
+
 }
 
 // ==================== VariableDefinition 实现 ====================
@@ -144,35 +246,37 @@ namespace Industrial {
 VariableDefinition::VariableDefinition(const QString &tagName,
                                        VariableType type,
                                        QObject *parent)
+    : VariableDefinition(tagName, type, ValueCellStore::global(), parent)
+{
+}
+
+VariableDefinition::VariableDefinition(const QString &tagName,
+                                       VariableType type,
+                                       const std::shared_ptr<ValueCellStore> &store,
+                                       QObject *parent)
     : QObject(parent)
-    , m_tagName(tagName)
+    , m_tagPath(tagName)
     , m_type(type)
     , m_unit(UNIT_NONE)
-    , m_minValue(0.0)
-    , m_maxValue(100.0)
-    , m_rawMinValue(0.0)
-    , m_rawMaxValue(100.0)
-    , m_scaleFactor(1.0)
-    , m_offset(0.0)
-    , m_deadband(0.1)
+    , m_unitSuffixId(StringPool::EMPTY_ID)
+    , m_configOwner(defaultConfig())
     , m_initialValue(0.0)
     , m_updateRate(1000)
     , m_priority(50)
-    , m_storageType(ST_Invalid)
-    , m_variantCacheValid(false)
-    , m_quality(QUALITY_BAD)
-    , m_valueValid(false)
-    , m_alarmLo(10.0)
-    , m_alarmHi(90.0)
-    , m_alarmLoLo(5.0)
-    , m_alarmHiHi(95.0)
-    , m_alarmLevel(ALARM_WARNING)
+    , m_cellId(ValueCellStore::INVALID_ID)
+    , m_cell(nullptr)
     , m_historyEnabled(false)
     , m_historyInterval(60)
     , m_writable(true)
-    , m_cacheValid(false)
+    , m_accessGroupId(StringPool::EMPTY_ID)
+    , m_dataTypeId(StringPool::EMPTY_ID)
+    , m_formatId(StringPool::EMPTY_ID)
 {
+    // 缺省参数的快照所有变量共用，第一次修改时复制
+    initValueCell(store);
+
     // 根据类型初始化存储
+    ValueSample initial;
     switch (m_type) {
     case TYPE_AI:
     case TYPE_AO:
@@ -182,117 +286,109 @@ VariableDefinition::VariableDefinition(const QString &tagName,
     case TYPE_SETPOINT:
     case TYPE_PID:
     case TYPE_CONTROL:
-        m_storageType = ST_Double;
-        m_nativeValue.asDouble = m_initialValue;
+        initial.storageType = ST_Double;
+        initial.value.asDouble = m_initialValue;
         break;
     case TYPE_DI:
     case TYPE_DO:
-        m_storageType = ST_Bool;
-        m_nativeValue.asBool = false;
+        initial.storageType = ST_Bool;
+        initial.value.asBool = false;
         break;
     case TYPE_STATUS:
     case TYPE_ALARM:
     case TYPE_EVENT:
-        m_storageType = ST_Int;
-        m_nativeValue.asInt = 0;
+        initial.storageType = ST_Int;
+        initial.value.asInt = 0;
         break;
     default:
-        m_storageType = ST_Invalid;
+        initial.storageType = ST_Invalid;
         break;
     }
-
-    updateScalingParameters();
+    m_cell->store(initial);
 }
 
 VariableDefinition::~VariableDefinition() {
+    if (m_cellStore) {
+        m_cellStore->release(m_cellId);
+    }
 }
 
 VariableDefinition::VariableDefinition(const VariableDefinition& other)
     : QObject(other.parent())
-    , m_tagName(other.m_tagName)
+    , m_tagPath(other.m_tagPath)
     , m_description(other.m_description)
     , m_type(other.m_type)
     , m_unit(other.m_unit)
-    , m_unitSuffix(other.m_unitSuffix)
-    , m_minValue(other.m_minValue)
-    , m_maxValue(other.m_maxValue)
-    , m_rawMinValue(other.m_rawMinValue)
-    , m_rawMaxValue(other.m_rawMaxValue)
-    , m_scaleFactor(other.m_scaleFactor)
-    , m_offset(other.m_offset)
+    , m_unitSuffixId(other.m_unitSuffixId)
+    , m_configOwner(other.configSnapshot())
     , m_conversionFunc(other.m_conversionFunc ? other.m_conversionFunc->clone() : nullptr)
-    , m_deadband(other.m_deadband)
     , m_initialValue(other.m_initialValue)
     , m_updateRate(other.m_updateRate)
     , m_priority(other.m_priority)
-    , m_storageType(other.m_storageType)
-    , m_nativeValue(other.m_nativeValue)
+    , m_cellId(ValueCellStore::INVALID_ID)
+    , m_cell(nullptr)
     , m_stringValue(other.m_stringValue)
-    , m_variantCacheValid(false)
-    , m_quality(other.m_quality)
-    , m_valueValid(other.m_valueValid)
-    , m_timestamp(other.m_timestamp)
-    , m_alarmLo(other.m_alarmLo)
-    , m_alarmHi(other.m_alarmHi)
-    , m_alarmLoLo(other.m_alarmLoLo)
-    , m_alarmHiHi(other.m_alarmHiHi)
-    , m_alarmLevel(other.m_alarmLevel)
+    , m_serverAlarmEnabled(other.m_serverAlarmEnabled.load(std::memory_order_relaxed))
+    , m_serverAlarmState(other.m_serverAlarmState.load(std::memory_order_relaxed))
     , m_historyEnabled(other.m_historyEnabled)
     , m_historyInterval(other.m_historyInterval)
     , m_writable(other.m_writable)
-    , m_accessGroup(other.m_accessGroup)
+    , m_accessGroupId(other.m_accessGroupId)
     , m_address(other.m_address)
-    , m_dataType(other.m_dataType)
-    , m_format(other.m_format)
+    , m_dataTypeId(other.m_dataTypeId)
+    , m_formatId(other.m_formatId)
     , m_relatedVariables(other.m_relatedVariables)
-    , m_cacheValid(false)
+    , m_expression(other.m_expression)
 {
+    // 副本在同一存储中使用自己的单元
+    initValueCell(other.m_cellStore);
+    m_cell->store(other.m_cell->load());
 }
 
 VariableDefinition& VariableDefinition::operator=(const VariableDefinition& other) {
     if (this != &other) {
-        m_tagName = other.m_tagName;
+        m_tagPath = other.m_tagPath;
         m_description = other.m_description;
         m_type = other.m_type;
         m_unit = other.m_unit;
-        m_unitSuffix = other.m_unitSuffix;
-        m_minValue = other.m_minValue;
-        m_maxValue = other.m_maxValue;
-        m_rawMinValue = other.m_rawMinValue;
-        m_rawMaxValue = other.m_rawMaxValue;
-        m_scaleFactor = other.m_scaleFactor;
-        m_offset = other.m_offset;
+        m_unitSuffixId = other.m_unitSuffixId;
+        {
+            const VariableConfigPtr config = other.configSnapshot();
+            QMutexLocker locker(&m_configMutex);
+            if (config != m_configOwner) {
+                publishConfig(config);
+            }
+        }
         m_conversionFunc.reset(other.m_conversionFunc ? other.m_conversionFunc->clone() : nullptr);
-        m_deadband = other.m_deadband;
         m_initialValue = other.m_initialValue;
         m_updateRate = other.m_updateRate;
         m_priority = other.m_priority;
-        m_storageType = other.m_storageType;
-        m_nativeValue = other.m_nativeValue;
-        m_stringValue = other.m_stringValue;
-        m_variantCacheValid = false;
-        m_quality = other.m_quality;
-        m_valueValid = other.m_valueValid;
-        m_timestamp = other.m_timestamp;
-        m_alarmLo = other.m_alarmLo;
-        m_alarmHi = other.m_alarmHi;
-        m_alarmLoLo = other.m_alarmLoLo;
-        m_alarmHiHi = other.m_alarmHiHi;
-        m_alarmLevel = other.m_alarmLevel;
+        {
+            QMutexLocker locker(&m_valueMutex);
+            m_cell->store(other.m_cell->load());
+            m_stringValue = other.stringCopy();
+        }
+        m_serverAlarmEnabled.store(other.m_serverAlarmEnabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_serverAlarmState.store(other.m_serverAlarmState.load(std::memory_order_relaxed), std::memory_order_relaxed);
         m_historyEnabled = other.m_historyEnabled;
         m_historyInterval = other.m_historyInterval;
         m_writable = other.m_writable;
-        m_accessGroup = other.m_accessGroup;
+        m_accessGroupId = other.m_accessGroupId;
         m_address = other.m_address;
-        m_dataType = other.m_dataType;
-        m_format = other.m_format;
+        m_dataTypeId = other.m_dataTypeId;
+        m_formatId = other.m_formatId;
         m_relatedVariables = other.m_relatedVariables;
-        m_cacheValid = false;
+        m_expression = other.m_expression;
+        m_cellStore->touchConfig();
     }
     return *this;
 }
 
 // ==================== 基本信息方法 ====================
+QString VariableDefinition::tagName() const {
+    return m_tagPath.toString();
+}
+
 void VariableDefinition::setDescription(const QString &desc) {
     if (m_description != desc) {
         m_description = desc;
@@ -303,82 +399,98 @@ void VariableDefinition::setDescription(const QString &desc) {
 void VariableDefinition::setUnit(EngineeringUnit unit) {
     if (m_unit != unit) {
         m_unit = unit;
-        invalidateVariantCache();
         emit unitChanged(unit);
     }
 }
 
 // ==================== 工程参数方法 ====================
 void VariableDefinition::setMinValue(double minValue) {
-    if (!qFuzzyCompare(m_minValue, minValue)) {
-        m_minValue = minValue;
-        updateScalingParameters();
-        invalidateCache();
-        emit rangeChanged(m_minValue, m_maxValue);
-    }
+    updateConfig([minValue](VariableConfig &config) {
+        if (qFuzzyCompare(config.minValue, minValue)) {
+            return false;
+        }
+        config.minValue = minValue;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setMaxValue(double maxValue) {
-    if (!qFuzzyCompare(m_maxValue, maxValue)) {
-        m_maxValue = maxValue;
-        updateScalingParameters();
-        invalidateCache();
-        emit rangeChanged(m_minValue, m_maxValue);
-    }
+    updateConfig([maxValue](VariableConfig &config) {
+        if (qFuzzyCompare(config.maxValue, maxValue)) {
+            return false;
+        }
+        config.maxValue = maxValue;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setRange(double min, double max) {
-    if (!qFuzzyCompare(m_minValue, min) || !qFuzzyCompare(m_maxValue, max)) {
-        m_minValue = min;
-        m_maxValue = max;
-        updateScalingParameters();
-        invalidateCache();
-        emit rangeChanged(min, max);
-    }
+    updateConfig([min, max](VariableConfig &config) {
+        if (qFuzzyCompare(config.minValue, min) && qFuzzyCompare(config.maxValue, max)) {
+            return false;
+        }
+        config.minValue = min;
+        config.maxValue = max;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setRawMinValue(double rawMin) {
-    if (!qFuzzyCompare(m_rawMinValue, rawMin)) {
-        m_rawMinValue = rawMin;
-        updateScalingParameters();
-        invalidateCache();
-        emit rawRangeChanged(m_rawMinValue, m_rawMaxValue);
-    }
+    updateConfig([rawMin](VariableConfig &config) {
+        if (qFuzzyCompare(config.rawMinValue, rawMin)) {
+            return false;
+        }
+        config.rawMinValue = rawMin;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setRawMaxValue(double rawMax) {
-    if (!qFuzzyCompare(m_rawMaxValue, rawMax)) {
-        m_rawMaxValue = rawMax;
-        updateScalingParameters();
-        invalidateCache();
-        emit rawRangeChanged(m_rawMinValue, m_rawMaxValue);
-    }
+    updateConfig([rawMax](VariableConfig &config) {
+        if (qFuzzyCompare(config.rawMaxValue, rawMax)) {
+            return false;
+        }
+        config.rawMaxValue = rawMax;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setRawRange(double rawMin, double rawMax) {
-    if (!qFuzzyCompare(m_rawMinValue, rawMin) || !qFuzzyCompare(m_rawMaxValue, rawMax)) {
-        m_rawMinValue = rawMin;
-        m_rawMaxValue = rawMax;
-        updateScalingParameters();
-        invalidateCache();
-        emit rawRangeChanged(rawMin, rawMax);
-    }
+    updateConfig([rawMin, rawMax](VariableConfig &config) {
+        if (qFuzzyCompare(config.rawMinValue, rawMin) && qFuzzyCompare(config.rawMaxValue, rawMax)) {
+            return false;
+        }
+        config.rawMinValue = rawMin;
+        config.rawMaxValue = rawMax;
+        updateScalingParameters(config);
+        return true;
+    });
 }
 
 void VariableDefinition::setScaling(double scaleFactor, double offset) {
-    if (!qFuzzyCompare(m_scaleFactor, scaleFactor) || !qFuzzyCompare(m_offset, offset)) {
-        m_scaleFactor = scaleFactor;
-        m_offset = offset;
-        invalidateCache();
-        emit scalingChanged(scaleFactor, offset);
-    }
+    updateConfig([scaleFactor, offset](VariableConfig &config) {
+        if (qFuzzyCompare(config.scaleFactor, scaleFactor) && qFuzzyCompare(config.offset, offset)) {
+            return false;
+        }
+        config.scaleFactor = scaleFactor;
+        config.offset = offset;
+        return true;
+    });
 }
 
 void VariableDefinition::setDeadband(double deadband) {
-    if (!qFuzzyCompare(m_deadband, deadband)) {
-        m_deadband = deadband;
-        emit deadbandChanged(deadband);
-    }
+    updateConfig([deadband](VariableConfig &config) {
+        if (qFuzzyCompare(config.deadband, deadband)) {
+            return false;
+        }
+        config.deadband = deadband;
+        return true;
+    });
 }
 
 void VariableDefinition::setInitialValue(double value) {
@@ -396,40 +508,109 @@ void VariableDefinition::setPriority(int priority) {
     m_priority = qBound(0, priority, 100);
 }
 
+// ==================== 值单元 ====================
+void VariableDefinition::initValueCell(const std::shared_ptr<ValueCellStore> &store) {
+    m_cellStore = store ? store : ValueCellStore::global();
+    m_cellId = m_cellStore->allocate(this);
+    if (m_cellId == ValueCellStore::INVALID_ID) {
+        // 管理器存储已满时退回进程级存储
+        m_cellStore = ValueCellStore::global();
+        m_cellId = m_cellStore->allocate(this);
+    }
+    m_cell = m_cellStore->cell(m_cellId);
+}
+
+void VariableDefinition::setChangeSignalsEnabled(bool enabled) {
+    m_changeSignalsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool VariableDefinition::changeSignalsEnabled() const {
+    return m_changeSignalsEnabled.load(std::memory_order_relaxed);
+}
+
+void VariableDefinition::bindValueCell(const std::shared_ptr<ValueCellStore> &store) {
+    if (!store || store == m_cellStore) {
+        return;
+    }
+
+    QMutexLocker locker(&m_valueMutex);
+
+    quint32 newId = store->allocate(this);
+    if (newId == ValueCellStore::INVALID_ID) {
+        qWarning() << "Variable" << tagName() << ": no value cell available in target store";
+        return;
+    }
+
+    // 迁移当前值，编号使用新存储中的编号
+    ValueCell *newCell = store->cell(newId);
+    newCell->store(m_cell->load());
+
+    std::shared_ptr<ValueCellStore> oldStore = m_cellStore;
+    quint32 oldId = m_cellId;
+    m_cellStore = store;
+    m_cellId = newId;
+    m_cell = newCell;
+    oldStore->release(oldId);
+}
+
 // ==================== 值访问方法 ====================
+// 数值类型通过值单元的顺序锁无锁读取，只有字符串仍需加锁
 QVariant VariableDefinition::value() const {
-    return getCachedVariant();
+    ValueSample sample = m_cell->load();
+    if (sample.storageType == ST_String) {
+        return QVariant(stringCopy());
+    }
+    return variantFromSample(sample);
+}
+
+VariableSnapshot VariableDefinition::snapshot() const {
+    VariableSnapshot snap;
+    ValueSample sample = m_cell->load();
+    if (sample.storageType == ST_String) {
+        // 字符串和值单元由写锁保护，一起读取保证一致
+        QMutexLocker locker(&m_valueMutex);
+        sample = m_cell->load();
+        snap.value = variantFromSample(sample);
+    } else {
+        snap.value = variantFromSample(sample);
+    }
+    snap.quality = static_cast<DataQuality>(sample.quality);
+    snap.timestamp = UaTime::toDateTime(sample.timestamp);
+    snap.valid = sample.isValid();
+    return snap;
 }
 
 double VariableDefinition::doubleValue() const {
-    switch (m_storageType) {
+    ValueSample sample = m_cell->load();
+    switch (sample.storageType) {
     case ST_Double:
-        return m_nativeValue.asDouble;
+        return sample.value.asDouble;
     case ST_Bool:
-        return m_nativeValue.asBool ? 1.0 : 0.0;
+        return sample.value.asBool ? 1.0 : 0.0;
     case ST_Int:
-        return static_cast<double>(m_nativeValue.asInt);
+        return static_cast<double>(sample.value.asInt);
     case ST_Long:
-        return static_cast<double>(m_nativeValue.asLong);
+        return static_cast<double>(sample.value.asLong);
     case ST_String:
-        return m_stringValue.toDouble();
+        return stringCopy().toDouble();
     default:
         return 0.0;
     }
 }
 
 bool VariableDefinition::boolValue() const {
-    switch (m_storageType) {
+    ValueSample sample = m_cell->load();
+    switch (sample.storageType) {
     case ST_Bool:
-        return m_nativeValue.asBool;
+        return sample.value.asBool;
     case ST_Double:
-        return !qFuzzyIsNull(m_nativeValue.asDouble);
+        return !qFuzzyIsNull(sample.value.asDouble);
     case ST_Int:
-        return m_nativeValue.asInt != 0;
+        return sample.value.asInt != 0;
     case ST_Long:
-        return m_nativeValue.asLong != 0;
+        return sample.value.asLong != 0;
     case ST_String: {
-        QString lower = m_stringValue.toLower();
+        QString lower = stringCopy().toLower();
         return lower == "true" || lower == "1" || lower == "on" || lower == "yes";
     }
     default:
@@ -438,56 +619,84 @@ bool VariableDefinition::boolValue() const {
 }
 
 int VariableDefinition::intValue() const {
-    switch (m_storageType) {
+    ValueSample sample = m_cell->load();
+    switch (sample.storageType) {
     case ST_Int:
-        return m_nativeValue.asInt;
+        return sample.value.asInt;
     case ST_Double:
-        return static_cast<int>(m_nativeValue.asDouble);
+        return static_cast<int>(sample.value.asDouble);
     case ST_Bool:
-        return m_nativeValue.asBool ? 1 : 0;
+        return sample.value.asBool ? 1 : 0;
     case ST_Long:
-        return static_cast<int>(m_nativeValue.asLong);
+        return static_cast<int>(sample.value.asLong);
     case ST_String:
-        return m_stringValue.toInt();
+        return stringCopy().toInt();
     default:
         return 0;
     }
 }
 
 QString VariableDefinition::stringValue() const {
-    switch (m_storageType) {
+    ValueSample sample = m_cell->load();
+    switch (sample.storageType) {
     case ST_String:
-        return m_stringValue;
+        return stringCopy();
     case ST_Double:
-        if (!m_format.isEmpty()) {
-            return QString::asprintf(m_format.toUtf8().constData(), m_nativeValue.asDouble);
+        if (m_formatId != StringPool::EMPTY_ID) {
+            return QString::asprintf(formatString().toUtf8().constData(), sample.value.asDouble);
         }
-        return QString::number(m_nativeValue.asDouble, 'f', 6);
+        return QString::number(sample.value.asDouble, 'f', 6);
     case ST_Bool:
-        return m_nativeValue.asBool ? "TRUE" : "FALSE";
+        return sample.value.asBool ? "TRUE" : "FALSE";
     case ST_Int:
-        return QString::number(m_nativeValue.asInt);
+        return QString::number(sample.value.asInt);
     case ST_Long:
-        return QString::number(m_nativeValue.asLong);
+        return QString::number(sample.value.asLong);
     default:
         return QString();
     }
 }
 
 DataQuality VariableDefinition::quality() const {
-    QMutexLocker locker(&m_valueMutex);
-    return m_quality;
+    return static_cast<DataQuality>(m_cell->load().quality);
 }
 
 QDateTime VariableDefinition::timestamp() const {
+    return UaTime::toDateTime(m_cell->load().timestamp);
+}
+
+QString VariableDefinition::stringCopy() const {
     QMutexLocker locker(&m_valueMutex);
-    return m_timestamp;
+    return m_stringValue;
 }
 
 // ==================== 值设置方法 ====================
+// 值路径内部使用UA_DateTime整数时间戳，QDateTime版本只在入口转换一次
 void VariableDefinition::setValue(QVariant newValue,
                                   const QDateTime& timestamp,
                                   DataQuality quality) {
+    setValue(newValue, UaTime::fromDateTime(timestamp), quality);
+}
+
+void VariableDefinition::setDoubleValue(double value, const QDateTime& timestamp, DataQuality quality) {
+    setDoubleValue(value, UaTime::fromDateTime(timestamp), quality);
+}
+
+void VariableDefinition::setBoolValue(bool value, const QDateTime& timestamp, DataQuality quality) {
+    setBoolValue(value, UaTime::fromDateTime(timestamp), quality);
+}
+
+void VariableDefinition::setIntValue(int value, const QDateTime& timestamp, DataQuality quality) {
+    setIntValue(value, UaTime::fromDateTime(timestamp), quality);
+}
+
+void VariableDefinition::setStringValue(const QString& value, const QDateTime& timestamp, DataQuality quality) {
+    setStringValue(value, UaTime::fromDateTime(timestamp), quality);
+}
+
+void VariableDefinition::setValue(QVariant newValue,
+                                  UaTimestamp timestamp,
+                                  DataQuality quality) {
     // 根据QVariant类型调用对应的设置方法
     switch (newValue.type()) {
     case QVariant::Double:
@@ -510,14 +719,14 @@ void VariableDefinition::setValue(QVariant newValue,
         if (newValue.canConvert<double>()) {
             setDoubleValue(newValue.toDouble(), timestamp, quality);
         } else {
-            qWarning() << "Variable" << m_tagName << ": Unsupported value type:" << newValue.typeName();
+            qWarning() << "Variable" << tagName() << ": Unsupported value type:" << newValue.typeName();
         }
         break;
     }
 }
 
 void VariableDefinition::setDoubleValue(double value,
-                                        const QDateTime& timestamp,
+                                        UaTimestamp timestamp,
                                         DataQuality quality) {
     QMutexLocker locker(&m_valueMutex);
 
@@ -529,17 +738,20 @@ void VariableDefinition::setDoubleValue(double value,
         return;
     }
 
-    // 死区检查（仅对模拟量）
+    const VariableConfigPtr config = currentConfig();
+
+    // 死区检查（仅对模拟量；质量变化时不跳过，否则超时置为OLD的变量收到相同的值后恢复不了GOOD）
     if ((m_type == TYPE_AI || m_type == TYPE_AO || m_type == TYPE_CALC) &&
-        m_deadband > 0 && m_valueValid && m_storageType == ST_Double) {
-        if (checkDeadband(m_nativeValue.asDouble, value)) {
+        config->deadband > 0 && m_cell->sample.isValid() && m_cell->sample.storageType == ST_Double &&
+        m_cell->sample.quality == quality) {
+        if (qAbs(value - m_cell->sample.value.asDouble) <= config->deadband) {
             return;  // 变化小于死区，不更新
         }
     }
 
     // 范围检查（可选）
-    if (m_minValue != m_maxValue) {
-        if (value < m_minValue || value > m_maxValue) {
+    if (config->minValue != config->maxValue) {
+        if (value < config->minValue || value > config->maxValue) {
             quality = QUALITY_OUT_RANGE;
         }
     }
@@ -550,13 +762,13 @@ void VariableDefinition::setDoubleValue(double value,
 }
 
 void VariableDefinition::setBoolValue(bool value,
-                                      const QDateTime& timestamp,
+                                      UaTimestamp timestamp,
                                       DataQuality quality) {
     QMutexLocker locker(&m_valueMutex);
 
-    // 死区检查（对于bool，只有值变化才更新）
-    if (m_valueValid && m_storageType == ST_Bool) {
-        if (checkDeadband(m_nativeValue.asBool, value)) {
+    // 死区检查（对于bool，只有值或质量变化才更新）
+    if (m_cell->sample.isValid() && m_cell->sample.storageType == ST_Bool && m_cell->sample.quality == quality) {
+        if (checkDeadband(m_cell->sample.value.asBool, value)) {
             return;
         }
     }
@@ -567,13 +779,13 @@ void VariableDefinition::setBoolValue(bool value,
 }
 
 void VariableDefinition::setIntValue(int value,
-                                     const QDateTime& timestamp,
+                                     UaTimestamp timestamp,
                                      DataQuality quality) {
     QMutexLocker locker(&m_valueMutex);
 
-    // 死区检查
-    if (m_valueValid && m_storageType == ST_Int) {
-        if (checkDeadband(m_nativeValue.asInt, value)) {
+    // 死区检查（质量变化时总是更新）
+    if (m_cell->sample.isValid() && m_cell->sample.storageType == ST_Int && m_cell->sample.quality == quality) {
+        if (checkDeadband(m_cell->sample.value.asInt, value)) {
             return;
         }
     }
@@ -584,35 +796,110 @@ void VariableDefinition::setIntValue(int value,
 }
 
 void VariableDefinition::setStringValue(const QString& value,
-                                        const QDateTime& timestamp,
+                                        UaTimestamp timestamp,
                                         DataQuality quality) {
     QMutexLocker locker(&m_valueMutex);
 
-    // 对于字符串，只有值变化才更新（无死区）
-    if (m_valueValid && m_storageType == ST_String && m_stringValue == value) {
+    // 对于字符串，只有值或质量变化才更新（无死区）
+    if (m_cell->sample.isValid() && m_cell->sample.storageType == ST_String && m_stringValue == value &&
+        m_cell->sample.quality == quality) {
         return;
     }
 
     NativeValue dummy;
+    dummy.asLong = 0;
     setValueInternal(ST_String, dummy, value, timestamp, quality);
 }
 
+bool VariableDefinition::setQuality(DataQuality quality, qint64 expectedVersion) {
+    QMutexLocker locker(&m_valueMutex);
+
+    if (expectedVersion >= 0 && m_cell->version() != static_cast<quint32>(expectedVersion)) {
+        return false;
+    }
+    const ValueSample current = m_cell->sample;
+    if (current.isValid() && current.quality == quality) {
+        return false;
+    }
+
+    setValueInternal(static_cast<StorageType>(current.storageType), current.value, m_stringValue,
+                     current.timestamp, quality);
+    return true;
+}
+
 // ==================== 报警相关方法 ====================
 void VariableDefinition::setAlarmLimits(double lo, double hi, double lolo, double hihi) {
-    if (!qFuzzyCompare(m_alarmLo, lo) || !qFuzzyCompare(m_alarmHi, hi) ||
-        !qFuzzyCompare(m_alarmLoLo, lolo) || !qFuzzyCompare(m_alarmHiHi, hihi)) {
-        m_alarmLo = lo;
-        m_alarmHi = hi;
-        m_alarmLoLo = lolo;
-        m_alarmHiHi = hihi;
-        invalidateCache();
+    updateConfig([lo, hi, lolo, hihi](VariableConfig &config) {
+        if (qFuzzyCompare(config.alarmLo, lo) && qFuzzyCompare(config.alarmHi, hi) &&
+            qFuzzyCompare(config.alarmLoLo, lolo) && qFuzzyCompare(config.alarmHiHi, hihi)) {
+            return false;
+        }
+        config.alarmLo = lo;
+        config.alarmHi = hi;
+        config.alarmLoLo = lolo;
+        config.alarmHiHi = hihi;
+        return true;
+    });
+}
+
+void VariableDefinition::setAlarmLevel(AlarmLevel level) {
+    // 发布快照时touchConfig，批量报警计算的限值表随之重建
+    updateConfig([level](VariableConfig &config) {
+        if (config.alarmLevel == level) {
+            return false;
+        }
+        config.alarmLevel = level;
+        return true;
+    });
+}
+
+void VariableDefinition::setAlarmHysteresis(double hysteresis) {
+    hysteresis = qMax(0.0, hysteresis);
+    updateConfig([hysteresis](VariableConfig &config) {
+        if (qFuzzyCompare(config.alarmHysteresis + 1.0, hysteresis + 1.0)) {
+            return false;
+        }
+        config.alarmHysteresis = hysteresis;
+        return true;
+    });
+}
+
+void VariableDefinition::setAlarmOnDelay(int msecs) {
+    msecs = qMax(0, msecs);
+    updateConfig([msecs](VariableConfig &config) {
+        if (config.alarmOnDelay == msecs) {
+            return false;
+        }
+        config.alarmOnDelay = msecs;
+        return true;
+    });
+}
+
+void VariableDefinition::setAlarmOffDelay(int msecs) {
+    msecs = qMax(0, msecs);
+    updateConfig([msecs](VariableConfig &config) {
+        if (config.alarmOffDelay == msecs) {
+            return false;
+        }
+        config.alarmOffDelay = msecs;
+        return true;
+    });
+}
+
+void VariableDefinition::setServerAlarmEnabled(bool enabled) {
+    // 事件回调在管理器线程中设置，值写入线程和批量报警评估并发读取
+    if (m_serverAlarmEnabled.exchange(enabled, std::memory_order_acq_rel) != enabled) {
+        m_serverAlarmState.store(ALARM_NONE, std::memory_order_release);
+        if (m_cellStore) {
+            m_cellStore->touchConfig();
+        }
         emit alarmLimitsChanged();
     }
 }
 
-void VariableDefinition::setAlarmLevel(AlarmLevel level) {
-    if (m_alarmLevel != level) {
-        m_alarmLevel = level;
+void VariableDefinition::setServerAlarmState(AlarmLevel level) {
+    if (m_serverAlarmState.exchange(level, std::memory_order_acq_rel) != level) {
+        emit alarmLimitsChanged();
     }
 }
 
@@ -629,7 +916,7 @@ void VariableDefinition::setWritable(bool writable) {
 }
 
 void VariableDefinition::setAccessGroup(const QString &group) {
-    m_accessGroup = group;
+    m_accessGroupId = StringPool::global()->intern(group);
 }
 
 void VariableDefinition::setAddress(const QString &address) {
@@ -637,20 +924,17 @@ void VariableDefinition::setAddress(const QString &address) {
 }
 
 void VariableDefinition::setDataType(const QString &type) {
-    m_dataType = type;
+    m_dataTypeId = StringPool::global()->intern(type);
 }
 
 void VariableDefinition::setFormatString(const QString &format) {
-    if (m_format != format) {
-        m_format = format;
-        invalidateVariantCache();
-    }
+    m_formatId = StringPool::global()->intern(format);
 }
 
 void VariableDefinition::setUnitSuffix(const QString &suffix) {
-    if (m_unitSuffix != suffix) {
-        m_unitSuffix = suffix;
-        invalidateVariantCache();
+    StringPool::Id id = StringPool::global()->intern(suffix);
+    if (m_unitSuffixId != id) {
+        m_unitSuffixId = id;
         emit unitSuffixChanged(suffix);
     }
 }
@@ -661,6 +945,13 @@ void VariableDefinition::addRelatedVariable(const QString &tagName) {
     }
 }
 
+void VariableDefinition::setExpression(const QString &expression) {
+    if (m_expression != expression) {
+        m_expression = expression;
+        emit expressionChanged(expression);
+    }
+}
+
 // ==================== 转换功能 ====================
 QVariant VariableDefinition::rawToEngineering(QVariant rawValue) const {
     if (m_conversionFunc) {
@@ -695,14 +986,8 @@ double VariableDefinition::rawToEngineering(double rawValue) const {
         return m_conversionFunc->rawToEngineering(rawValue);
     }
 
-    QMutexLocker locker(&m_cacheMutex);
-    if (!m_conversionCache.valid) {
-        locker.unlock();
-        updateConversionCache();
-        locker.relock();
-    }
-
-    return rawValue * m_conversionCache.scaleFactor + m_conversionCache.offset;
+    const VariableConfigPtr config = currentConfig();
+    return rawValue * config->conversionScale + config->conversionOffset;
 }
 
 double VariableDefinition::engineeringToRaw(double engValue) const {
@@ -710,14 +995,8 @@ double VariableDefinition::engineeringToRaw(double engValue) const {
         return m_conversionFunc->engineeringToRaw(engValue);
     }
 
-  QMutexLocker locker(&m_cacheMutex);
-    if (!m_conversionCache.valid) {
-        locker.unlock();
-        updateConversionCache();
-        locker.relock();
-    }
-
-    return (engValue - m_conversionCache.offset) / m_conversionCache.scaleFactor;
+    const VariableConfigPtr config = currentConfig();
+    return (engValue - config->conversionOffset) / config->conversionScale;
 }
 
 void VariableDefinition::setConversionFunction(ConversionFunction* func) {
@@ -725,19 +1004,18 @@ void VariableDefinition::setConversionFunction(ConversionFunction* func) {
     invalidateCache();
 }
 
-double VariableDefinition::convertToUnit(double value, const QString& targetUnit) const {
-    // 简化的单位转换，实际项目中应该使用完整的单位转换管理器
-    QString sourceUnit = engineeringUnitToString(m_unit);
-    if (sourceUnit == "°C" && targetUnit == "°F") {
-        return celsiusToFahrenheit(value);
-    } else if (sourceUnit == "°F" && targetUnit == "°C") {
-        return fahrenheitToCelsius(value);
-    } else if (sourceUnit == "MPa" && targetUnit == "Bar") {
-        return mpaToBar(value);
-    } else if (sourceUnit == "Bar" && targetUnit == "MPa") {
-        return barToMpa(value);
+bool VariableDefinition::linearCoefficients(double &scaleFactor, double &offset) const {
+    if (m_conversionFunc) {
+        return m_conversionFunc->linearCoefficients(scaleFactor, offset);
     }
-    return value;
+    const VariableConfigPtr config = currentConfig();
+    scaleFactor = config->conversionScale;
+    offset = config->conversionOffset;
+    return true;
+}
+
+double VariableDefinition::convertToUnit(double value, const QString& targetUnit) const {
+    return UnitConversionManager::instance()->convert(value, m_unit, targetUnit);
 }
 
 QStringList VariableDefinition::supportedUnits() const {
@@ -778,7 +1056,7 @@ QStringList VariableDefinition::getValidationErrors() const {
         errors << "Invalid alarm limits";
     }
 
-    if (m_tagName.isEmpty()) {
+    if (m_tagPath.isEmpty()) {
         errors << "Tag name is empty";
     }
 
@@ -786,64 +1064,178 @@ QStringList VariableDefinition::getValidationErrors() const {
 }
 
 bool VariableDefinition::validateRange() const {
-    return m_minValue < m_maxValue && m_rawMinValue < m_rawMaxValue;
+    const VariableConfigPtr config = currentConfig();
+    return config->minValue < config->maxValue && config->rawMinValue < config->rawMaxValue;
 }
 
 bool VariableDefinition::validateAlarmLimits() const {
-    return m_alarmLoLo <= m_alarmLo && m_alarmLo <= m_alarmHi && m_alarmHi <= m_alarmHiHi;
+    const VariableConfigPtr config = currentConfig();
+    return config->alarmLoLo <= config->alarmLo && config->alarmLo <= config->alarmHi &&
+           config->alarmHi <= config->alarmHiHi;
 }
 
 // ==================== 克隆功能 ====================
 VariableDefinition* VariableDefinition::clone(const QString& newTagName) const {
-    VariableDefinition* clone = new VariableDefinition(newTagName.isEmpty() ? m_tagName : newTagName,
+    VariableDefinition* clone = new VariableDefinition(newTagName.isEmpty() ? tagName() : newTagName,
                                                        m_type, parent());
     *clone = *this;
     return clone;
 }
 
+// ==================== 配置快照 ====================
+VariableConfigPtr VariableDefinition::configSnapshot() const {
+    return currentConfig();
+}
+
+bool VariableDefinition::applyConfig(const VariableConfig &config) {
+    QStringList errors;
+    if (!config.validate(&errors)) {
+        qWarning() << "VariableDefinition::applyConfig" << tagName() << errors;
+        return false;
+    }
+
+    std::shared_ptr<VariableConfig> next = std::make_shared<VariableConfig>(config);
+    updateScalingParameters(*next);
+    next->finalize();
+
+    VariableConfig before;
+    {
+        QMutexLocker locker(&m_configMutex);
+        if (m_configOwner->sameParameters(*next)) {
+            return true;
+        }
+        before = *m_configOwner;
+        next->version = nextConfigVersion();
+        publishConfig(next);
+    }
+    emitConfigSignals(before, *next);
+    return true;
+}
+
+bool VariableDefinition::rollbackConfig() {
+    VariableConfig before;
+    VariableConfig after;
+    {
+        QMutexLocker locker(&m_configMutex);
+        if (!m_previousConfig) {
+            return false;
+        }
+        before = *m_configOwner;
+        after = *m_previousConfig;
+        publishConfig(m_previousConfig);    // 当前快照成为上一个，可以再换回来
+    }
+    emitConfigSignals(before, after);
+    return true;
+}
+
+bool VariableDefinition::hasPreviousConfig() const {
+    QMutexLocker locker(&m_configMutex);
+    return m_previousConfig != nullptr;
+}
+
+bool VariableDefinition::updateConfig(const std::function<bool(VariableConfig&)> &edit) {
+    VariableConfig before;
+    VariableConfig after;
+    {
+        QMutexLocker locker(&m_configMutex);
+        std::shared_ptr<VariableConfig> next = std::make_shared<VariableConfig>(*m_configOwner);
+        if (!edit(*next)) {
+            return false;
+        }
+        next->finalize();
+        next->version = nextConfigVersion();
+        before = *m_configOwner;
+        after = *next;
+        publishConfig(next);
+    }
+    emitConfigSignals(before, after);
+    return true;
+}
+
+void VariableDefinition::publishConfig(const VariableConfigPtr &config) {
+    // 写者之间由m_configMutex互斥，这里可以直接读m_configOwner；替换必须原子，与无锁读者并发。
+    // 被替换的快照由引用计数回收，最后一个持有它的读者释放时析构
+    VariableConfigPtr replaced = m_configOwner;
+    std::atomic_store_explicit(&m_configOwner, config, std::memory_order_release);
+    m_previousConfig = std::move(replaced);
+    if (m_cellStore) {
+        m_cellStore->touchConfig();  // 批量转换计划和报警限值表按存储的配置版本重建
+    }
+}
+
+void VariableDefinition::emitConfigSignals(const VariableConfig &before, const VariableConfig &after) {
+    if (before.minValue != after.minValue || before.maxValue != after.maxValue) {
+        emit rangeChanged(after.minValue, after.maxValue);
+    }
+    if (before.rawMinValue != after.rawMinValue || before.rawMaxValue != after.rawMaxValue) {
+        emit rawRangeChanged(after.rawMinValue, after.rawMaxValue);
+    }
+    if (before.scaleFactor != after.scaleFactor || before.offset != after.offset) {
+        emit scalingChanged(after.scaleFactor, after.offset);
+    }
+    if (before.deadband != after.deadband) {
+        emit deadbandChanged(after.deadband);
+    }
+    if (before.alarmLo != after.alarmLo || before.alarmHi != after.alarmHi ||
+        before.alarmLoLo != after.alarmLoLo || before.alarmHiHi != after.alarmHiHi ||
+        before.alarmHysteresis != after.alarmHysteresis ||
+        before.alarmOnDelay != after.alarmOnDelay || before.alarmOffDelay != after.alarmOffDelay) {
+        emit alarmLimitsChanged();
+    }
+}
+
 // ==================== 缓存管理 ====================
 void VariableDefinition::invalidateCache() {
-    QMutexLocker locker(&m_cacheMutex);
-    m_conversionCache.clear();
-    m_alarmCache.clear();
-    m_cacheValid = false;
+    if (m_cellStore) {
+        m_cellStore->touchConfig();  // 批量转换计划按存储的配置版本重建
+    }
 }
 
 bool VariableDefinition::isCacheValid() const {
-    QMutexLocker locker(&m_cacheMutex);
-    return m_cacheValid;
+    return true;    // 派生参数随快照一起发布
 }
 
 // ==================== 报警检查 ====================
 AlarmLevel VariableDefinition::checkAlarmFast(double value) const {
-    QMutexLocker locker(&m_cacheMutex);
-    if (!m_alarmCache.valid) {
-        locker.unlock();
-        updateAlarmCache();
-        locker.relock();
+    const VariableConfigPtr config = currentConfig();
+    if (!config->alarmValid) {
+        return ALARM_NONE;
     }
 
-    if (!m_alarmCache.valid) {
+    return alarmLevelFor(*config, value, 0.0);
+}
+
+AlarmLevel VariableDefinition::checkAlarmFast(double value, AlarmLevel current) const {
+    const VariableConfigPtr config = currentConfig();
+    if (!config->alarmValid) {
         return ALARM_NONE;
     }
 
+    // 升级立即生效；降级时按收窄滞环后的复位限值判断，回到限值内侧足够远才降级
+    AlarmLevel raise = alarmLevelFor(*config, value, 0.0);
+    if (raise >= current || config->alarmHysteresis <= 0.0) {
+        return raise;
+    }
+    AlarmLevel hold = alarmLevelFor(*config, value, config->alarmHysteresis);
+    return qMax(raise, qMin(hold, current));
+}
+
+AlarmLevel VariableDefinition::alarmLevelFor(const VariableConfig &config, double value, double hysteresis) {
     // 检查报警等级
-    if (m_alarmCache.hasCriticalAlarm) {
-        if (value <= m_alarmCache.criticalLoLo || value >= m_alarmCache.criticalHiHi) {
+    if (config.hasCriticalAlarm) {
+        if (value <= config.alarmLoLo + hysteresis || value >= config.alarmHiHi - hysteresis) {
             return ALARM_CRITICAL;
         }
     }
 
-    if (m_alarmCache.hasMajorAlarm) {
-        if (value <= m_alarmCache.majorLo || value >= m_alarmCache.majorHi) {
+    if (config.hasMajorAlarm) {
+        if (value <= config.alarmLo + hysteresis || value >= config.alarmHi - hysteresis) {
             return ALARM_MAJOR;
         }
     }
 
-    if (m_alarmCache.hasMinorAlarm) {
-        if (value <= m_alarmLo || value >= m_alarmHi) {
-            return ALARM_MINOR;
-        }
+    if (value <= config.alarmLo + hysteresis || value >= config.alarmHi - hysteresis) {
+        return ALARM_MINOR;
     }
 
     return ALARM_NONE;
@@ -853,14 +1245,56 @@ bool VariableDefinition::isInAlarmFast(double value) const {
     return checkAlarmFast(value) != ALARM_NONE;
 }
 
+AlarmThresholds VariableDefinition::alarmThresholds() const {
+    const double unused = std::numeric_limits<double>::quiet_NaN();
+    AlarmThresholds thresholds;
+    thresholds.loLo = unused;
+    thresholds.lo = unused;
+    thresholds.hi = unused;
+    thresholds.hiHi = unused;
+
+    const VariableConfigPtr config = currentConfig();
+    if (config->alarmLevel == ALARM_NONE || serverAlarmEnabled() || !config->alarmValid) {
+        return thresholds;
+    }
+
+    if (config->hasCriticalAlarm) {
+        thresholds.loLo = config->alarmLoLo;
+        thresholds.hiHi = config->alarmHiHi;
+    }
+    // 限值有序时Lo/Hi总参与判断：越限按是否有Major报警区分级别
+    thresholds.lo = config->alarmLo;
+    thresholds.hi = config->alarmHi;
+    thresholds.bandLevel = config->hasMajorAlarm ? ALARM_MAJOR : ALARM_MINOR;
+    thresholds.hysteresis = config->alarmHysteresis;
+    thresholds.enabled = true;
+    return thresholds;
+}
+
 AlarmLevel VariableDefinition::checkAlarm() const {
-    if (!m_valueValid || m_quality != QUALITY_GOOD) {
+    return checkAlarm(ALARM_NONE);
+}
+
+AlarmLevel VariableDefinition::checkAlarm(AlarmLevel current) const {
+    if (serverAlarmEnabled()) {
+        return serverAlarmState();
+    }
+
+    ValueSample sample = m_cell->load();
+    if (!sample.isValid() || sample.quality != QUALITY_GOOD) {
         return ALARM_NONE;
     }
 
     // 只有数值类型才进行报警检查
-    if (m_storageType == ST_Double || m_storageType == ST_Int || m_storageType == ST_Long) {
-        return checkAlarmFast(doubleValue());
+    switch (sample.storageType) {
+    case ST_Double:
+        return checkAlarmFast(sample.value.asDouble, current);
+    case ST_Int:
+        return checkAlarmFast(static_cast<double>(sample.value.asInt), current);
+    case ST_Long:
+        return checkAlarmFast(static_cast<double>(sample.value.asLong), current);
+    default:
+        break;
     }
 
     return ALARM_NONE;
@@ -875,159 +1309,286 @@ AlarmLevel VariableDefinition::checkCurrentAlarm() const {
 }
 
 // ==================== 私有方法 ====================
-void VariableDefinition::updateScalingParameters() {
+void VariableDefinition::updateScalingParameters(VariableConfig &config) {
     // 如果用户没有手动设置缩放参数，则自动计算
-    if (qFuzzyCompare(m_scaleFactor, 1.0) && qFuzzyIsNull(m_offset)) {
-        if (!qFuzzyCompare(m_rawMaxValue - m_rawMinValue, 0.0)) {
-            m_scaleFactor = (m_maxValue - m_minValue) / (m_rawMaxValue - m_rawMinValue);
-            m_offset = m_minValue - m_scaleFactor * m_rawMinValue;
-            invalidateCache();
+    if (qFuzzyCompare(config.scaleFactor, 1.0) && qFuzzyIsNull(config.offset)) {
+        if (!qFuzzyCompare(config.rawMaxValue - config.rawMinValue, 0.0)) {
+            config.scaleFactor = (config.maxValue - config.minValue) / (config.rawMaxValue - config.rawMinValue);
+            config.offset = config.minValue - config.scaleFactor * config.rawMinValue;
         }
     }
 }
 
-void VariableDefinition::updateConversionCache() const {
-    QMutexLocker locker(&m_cacheMutex);
+void VariableDefinition::setValueInternal(StorageType type,
+                                          const NativeValue& nativeValue,
+                                          const QString& stringValue,
+                                          UaTimestamp timestamp,
+                                          DataQuality quality) {
+    // 调用者持有m_valueMutex，是唯一的写者，可以直接读单元
+    const ValueSample oldSample = m_cell->sample;
+
+    // 更新值单元（原生值、类型、质量、时间戳集中在同一缓存行，读者通过顺序锁得到一致快照）
+    ValueSample newSample;
+    newSample.value = nativeValue;
+    newSample.storageType = static_cast<quint8>(type);
+    newSample.quality = static_cast<quint8>(quality);
+    newSample.timestamp = timestamp != UaTime::NOW ? timestamp : UaTime::now();
+    newSample.flags = oldSample.flags | ValueSample::FLAG_VALID;
+
+    // 按原生值比较，不构造QVariant
+    bool valueChanged = !oldSample.isValid() || oldSample.storageType != newSample.storageType;
+    if (!valueChanged) {
+        switch (type) {
+        case ST_Double:
+            valueChanged = oldSample.value.asDouble != newSample.value.asDouble;
+            break;
+        case ST_Bool:
+            valueChanged = oldSample.value.asBool != newSample.value.asBool;
+            break;
+        case ST_Int:
+            valueChanged = oldSample.value.asInt != newSample.value.asInt;
+            break;
+        case ST_Long:
+            valueChanged = oldSample.value.asLong != newSample.value.asLong;
+            break;
+        case ST_String:
+            valueChanged = m_stringValue != stringValue;
+            break;
+        default:
+            break;
+        }
+    }
+    bool qualityDiffers = !oldSample.isValid() || oldSample.quality != newSample.quality;
 
-    if (m_conversionFunc) {
-        // 如果有转换函数，缓存无效
-        m_conversionCache.valid = false;
-    } else {
-        m_conversionCache.scaleFactor = calculateScaleFactor();
-        m_conversionCache.offset = calculateOffset();
-        m_conversionCache.valid = true;
+    if (type == ST_String && valueChanged) {
+        m_stringValue = stringValue;
     }
+    m_cell->store(newSample);
 
-    m_cacheValid = true;
-}
+    // 只有时间戳变化时不算变化
+    if (!valueChanged && !qualityDiffers) {
+        emitTimestampChanged(newSample.timestamp);
+        return;
+    }
 
-void VariableDefinition::updateAlarmCache() const {
-    QMutexLocker locker(&m_cacheMutex);
+    // 批量消费者从所属存储的变化位图取走
+    m_cellStore->markChanged(m_cellId);
 
-    m_alarmCache.clear();
+    if (!m_changeSignalsEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
 
-    // 设置报警缓存
-    if (m_alarmLoLo < m_alarmLo && m_alarmLo < m_alarmHi && m_alarmHi < m_alarmHiHi) {
-        m_alarmCache.hasCriticalAlarm = (m_alarmLoLo > m_minValue || m_alarmHiHi < m_maxValue);
-        m_alarmCache.hasMajorAlarm = (m_alarmLo > m_minValue || m_alarmHi < m_maxValue);
-        m_alarmCache.hasMinorAlarm = true;
+    // 发出信号
+    if (valueChanged) {
+        QVariant newValue = variantFromSample(newSample);
+        emit this->valueChanged(newValue);
 
-        if (m_alarmCache.hasCriticalAlarm) {
-            m_alarmCache.criticalLoLo = m_alarmLoLo;
-            m_alarmCache.criticalHiHi = m_alarmHiHi;
+        // 信号参数是QDateTime，只在有接收者时转换
+        static const QMetaMethod infoSignal = QMetaMethod::fromSignal(&VariableDefinition::valueChangedWithInfo);
+        if (isSignalConnected(infoSignal)) {
+            emit this->valueChangedWithInfo(newValue, UaTime::toDateTime(newSample.timestamp), quality);
         }
 
-        if (m_alarmCache.hasMajorAlarm) {
-            m_alarmCache.majorLo = m_alarmLo;
-            m_alarmCache.majorHi = m_alarmHi;
+        // 检查越限（服务器报警时由事件驱动，不做限值判断）；带复位滞环，
+        // 停在限值附近抖动的值不会每个采样都发出信号
+        if (type == ST_Double && !serverAlarmEnabled()) {
+            AlarmLevel newAlarm = checkAlarmFast(newSample.value.asDouble, m_limitAlarmLevel);
+            if (newAlarm != m_limitAlarmLevel) {
+                m_limitAlarmLevel = newAlarm;
+                emit alarmLimitCrossed(newAlarm);
+            }
         }
-
-        m_alarmCache.valid = true;
     }
 
-    m_cacheValid = true;
+    if (qualityDiffers) {
+        emit qualityChanged(quality);
+    }
+    emitTimestampChanged(newSample.timestamp);
 }
 
-double VariableDefinition::calculateScaleFactor() const {
-    if (qFuzzyCompare(m_rawMaxValue - m_rawMinValue, 0.0)) {
-        return 1.0;
+void VariableDefinition::emitTimestampChanged(UaTimestamp timestamp) {
+    if (!m_changeSignalsEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    static const QMetaMethod timestampSignal = QMetaMethod::fromSignal(&VariableDefinition::timestampChanged);
+    if (isSignalConnected(timestampSignal)) {
+        emit timestampChanged(UaTime::toDateTime(timestamp));
     }
-    return (m_maxValue - m_minValue) / (m_rawMaxValue - m_rawMinValue);
 }
 
-double VariableDefinition::calculateOffset() const {
-    return m_minValue - calculateScaleFactor() * m_rawMinValue;
+double VariableDefinition::sampleToDouble(const ValueSample &sample) {
+    switch (sample.storageType) {
+    case ST_Double:
+        return sample.value.asDouble;
+    case ST_Bool:
+        return sample.value.asBool ? 1.0 : 0.0;
+    case ST_Int:
+        return static_cast<double>(sample.value.asInt);
+    case ST_Long:
+        return static_cast<double>(sample.value.asLong);
+    default:
+        return 0.0;
+    }
 }
 
-void VariableDefinition::setValueInternal(StorageType type,
-                                          const NativeValue& nativeValue,
-                                          const QString& stringValue,
-                                          const QDateTime& timestamp,
-                                          DataQuality quality) {
-    // 保存旧值用于比较
-    QVariant oldValue = getCachedVariant();
+bool VariableDefinition::isNumericSample(const ValueSample &sample) {
+    return sample.isValid() && sample.storageType != ST_Invalid && sample.storageType != ST_String;
+}
 
-    // 更新存储
-    m_storageType = type;
-    m_nativeValue = nativeValue;
-    if (type == ST_String) {
-        m_stringValue = stringValue;
+QVariant VariableDefinition::variantFromSample(const ValueSample &sample) const {
+    // 标量QVariant不分配堆内存，按需生成比维护缓存更便宜；字符串分支要求调用者持有m_valueMutex
+    switch (sample.storageType) {
+    case ST_Double:
+        return QVariant(sample.value.asDouble);
+    case ST_Bool:
+        return QVariant(sample.value.asBool);
+    case ST_Int:
+        return QVariant(sample.value.asInt);
+    case ST_Long:
+        return QVariant(sample.value.asLong);
+    case ST_String:
+        return QVariant(m_stringValue);
+    default:
+        return QVariant();
     }
+}
 
-    // 更新元数据
-    m_timestamp = timestamp;
-    m_quality = quality;
-    m_valueValid = true;
+bool VariableDefinition::checkDeadband(double oldValue, double newValue) const {
+    return qAbs(newValue - oldValue) <= currentConfig()->deadband;
+}
 
-    // 使QVariant缓存失效
-    invalidateVariantCache();
+bool VariableDefinition::checkDeadband(bool oldValue, bool newValue) const {
+    return oldValue == newValue;  // bool类型只有相等才不更新
+}
 
-    // 获取新值
-    QVariant newValue = getCachedVariant();
+bool VariableDefinition::checkDeadband(int oldValue, int newValue) const {
+    return qAbs(newValue - oldValue) <= static_cast<int>(currentConfig()->deadband);
+}
 
-    // 检查是否真的发生了变化
-    bool valueChanged = (oldValue != newValue);
+// ==================== VariableConfigBatch 实现 ====================
+bool VariableConfigBatch::stage(VariableDefinition *var, const VariableConfig &config) {
+    if (!var) {
+        m_errors << "Null variable";
+        return false;
+    }
+    if (m_committed) {
+        qWarning() << "VariableConfigBatch::stage: batch already committed, clear() first";
+        return false;
+    }
 
-    // 发出信号
-    if (valueChanged) {
-        emit this->valueChanged(newValue);
-        emit this->valueChangedWithInfo(newValue, timestamp, quality);
-
-        // 检查报警状态变化
-        if (m_storageType == ST_Double) {
-            AlarmLevel oldAlarm = checkAlarmFast(oldValue.toDouble());
-            AlarmLevel newAlarm = checkAlarmFast(newValue.toDouble());
-            if (oldAlarm != newAlarm) {
-                emit alarmLimitsChanged();
-            }
+    QStringList errors;
+    if (!config.validate(&errors)) {
+        for (const QString &error : errors) {
+            m_errors << var->tagName() + ": " + error;
         }
+        return false;
     }
 
-    emit qualityChanged(quality);
-    emit timestampChanged(timestamp);
-}
+    Item item;
+    item.var = var;
+    item.config = config;
+    VariableDefinition::updateScalingParameters(item.config);
+    item.config.finalize();
 
-QVariant VariableDefinition::getCachedVariant() const {
-    if (!m_variantCacheValid) {
-        switch (m_storageType) {
-        case ST_Double:
-            m_cachedVariant = QVariant(m_nativeValue.asDouble);
-            break;
-        case ST_Bool:
-            m_cachedVariant = QVariant(m_nativeValue.asBool);
-            break;
-        case ST_Int:
-            m_cachedVariant = QVariant(m_nativeValue.asInt);
-            break;
-        case ST_Long:
-            m_cachedVariant = QVariant(m_nativeValue.asLong);
-            break;
-        case ST_String:
-            m_cachedVariant = QVariant(m_stringValue);
-            break;
-        default:
-            m_cachedVariant = QVariant();
-            break;
-        }
-        m_variantCacheValid = true;
+    auto it = m_index.constFind(var);
+    if (it != m_index.constEnd()) {
+        m_items[it.value()] = item;
+    } else {
+        m_index.insert(var, m_items.size());
+        m_items.append(item);
     }
-    return m_cachedVariant;
+    return true;
 }
 
-void VariableDefinition::invalidateVariantCache() {
-    m_variantCacheValid = false;
+void VariableConfigBatch::clear() {
+    m_items.clear();
+    m_index.clear();
+    m_errors.clear();
+    m_version = 0;
+    m_committed = false;
 }
 
-bool VariableDefinition::checkDeadband(double oldValue, double newValue) const {
-    return qAbs(newValue - oldValue) <= m_deadband;
+bool VariableConfigBatch::commit() {
+    if (m_committed) {
+        qWarning() << "VariableConfigBatch::commit: batch already committed";
+        return false;
+    }
+    if (!m_errors.isEmpty()) {
+        qWarning() << "VariableConfigBatch::commit: rejected," << m_errors.size() << "validation errors";
+        return false;
+    }
+    for (const Item &item : m_items) {
+        if (!item.var) {
+            qWarning() << "VariableConfigBatch::commit: rejected, a staged variable has been deleted";
+            return false;
+        }
+    }
+
+    {
+        QMutexLocker batchLocker(&s_batchMutex);
+        m_version = nextConfigVersion();
+        s_configGeneration.fetch_add(1, std::memory_order_acq_rel);
+        for (Item &item : m_items) {
+            std::shared_ptr<VariableConfig> next = std::make_shared<VariableConfig>(item.config);
+            next->version = m_version;
+            item.published = next;
+
+            VariableDefinition *var = item.var;
+            QMutexLocker locker(&var->m_configMutex);
+            item.before = var->m_configOwner;
+            var->publishConfig(item.published);
+        }
+        s_configGeneration.fetch_add(1, std::memory_order_release);
+    }
+    m_committed = true;
+
+    for (const Item &item : m_items) {
+        item.var->emitConfigSignals(*item.before, *item.published);
+    }
+    return true;
 }
 
-bool VariableDefinition::checkDeadband(bool oldValue, bool newValue) const {
-    return oldValue == newValue;  // bool类型只有相等才不更新
+bool VariableConfigBatch::rollback() {
+    if (!m_committed) {
+        return false;
+    }
+
+    // 提交后又被单独修改过的变量保留其当前配置
+    bool complete = true;
+    QVector<int> restored;
+    {
+        QMutexLocker batchLocker(&s_batchMutex);
+        s_configGeneration.fetch_add(1, std::memory_order_acq_rel);
+        for (int i = 0; i < m_items.size(); i++) {
+            const Item &item = m_items[i];
+            if (!item.var) {
+                continue;
+            }
+            VariableDefinition *var = item.var;
+            QMutexLocker locker(&var->m_configMutex);
+            if (var->m_configOwner != item.published) {
+                qWarning() << "VariableConfigBatch::rollback:" << var->tagName() << "changed since commit, kept";
+                complete = false;
+                continue;
+            }
+            var->publishConfig(item.before);
+            restored.append(i);
+        }
+        s_configGeneration.fetch_add(1, std::memory_order_release);
+    }
+    m_committed = false;
+
+    for (int i : restored) {
+        const Item &item = m_items[i];
+        if (item.var) {
+            item.var->emitConfigSignals(*item.published, *item.before);
+        }
+    }
+    return complete;
 }
 
-bool VariableDefinition::checkDeadband(int oldValue, int newValue) const {
-    return qAbs(newValue - oldValue) <= static_cast<int>(m_deadband);
+quint64 VariableConfigBatch::generation() {
+    return s_configGeneration.load(std::memory_order_acquire);
 }
 
 // ==================== LinearConversion 实现 ====================
@@ -1052,18 +1613,84 @@ double LinearConversion::engineeringToRaw(double engValue) const {
 ConversionFunction* LinearConversion::clone() const {
     return new LinearConversion(m_scaleFactor, m_offset);
 }
+
+bool LinearConversion::linearCoefficients(double &scaleFactor, double &offset) const {
+    scaleFactor = m_scaleFactor;
+    offset = m_offset;
+    return true;
+}
+
+void LinearConversion::rawToEngineeringBatch(const double *raw, double *eng, int count) const {
+    const double scale = m_scaleFactor;
+    const double offset = m_offset;
+    for (int i = 0; i < count; i++) {
+        eng[i] = raw[i] * scale + offset;
+    }
+}
+
+QJsonObject LinearConversion::parameters() const {
+    QJsonObject params;
+    params["scaleFactor"] = m_scaleFactor;
+    params["offset"] = m_offset;
+    return params;
+}
+
+// ==================== AlarmFilter 实现 ====================
+bool AlarmFilter::update(AlarmLevel candidate, UaTimestamp now, qint64 onDelay, qint64 offDelay) {
+    if (candidate == confirmed) {
+        if (pending != confirmed) {  // 延时内回到原级别，等待的变化作废
+            suppressed++;
+            pending = confirmed;
+        }
+        return false;
+    }
+
+    if (pending != candidate) {
+        if (pending != confirmed) {  // 等待中的变化被另一个级别替换
+            suppressed++;
+        }
+        pending = candidate;
+        pendingSince = now;
+    }
+
+    qint64 delay = candidate > confirmed ? onDelay : offDelay;
+    if (delay > 0 && now - pendingSince < delay) {
+        return false;
+    }
+
+    confirmed = candidate;
+    return true;
+}
 }
 // ==================== UnitConversionManager 实现 ====================
 namespace Industrial {
 UnitConversionManager* UnitConversionManager::m_instance = nullptr;
 
+void UnitConversion::apply(const double *values, double *out, int count) const {
+    if (function) {
+        for (int i = 0; i < count; i++) {
+            out[i] = function(values[i]);
+        }
+        return;
+    }
+    const double a = scale;
+    const double b = offset;
+    for (int i = 0; i < count; i++) {
+        out[i] = values[i] * a + b;
+    }
+}
+
 UnitConversionManager::UnitConversionManager(QObject* parent)
     : QObject(parent) {
     // 注册默认的单位转换
-    registerConversion(UNIT_TEMPERATURE, "°F", celsiusToFahrenheit);
-    registerConversion(UNIT_TEMPERATURE, "K", celsiusToKelvin);
-    registerConversion(UNIT_PRESSURE, "Bar", mpaToBar);
-    registerConversion(UNIT_FLOW, "L/min", m3hToLmin);
+    registerAffineConversion(UNIT_TEMPERATURE, "°F", 9.0 / 5.0, 32.0);
+    registerAffineConversion(UNIT_TEMPERATURE, "K", 1.0, 273.15);
+    registerAffineConversion(UNIT_PRESSURE, "Bar", 10.0);
+    registerAffineConversion(UNIT_PRESSURE, "kPa", 1000.0);
+    registerAffineConversion(UNIT_PRESSURE, "psi", 145.0377377);
+    registerAffineConversion(UNIT_FLOW, "L/min", 1000.0 / 60.0);
+    registerAffineConversion(UNIT_FLOW, "L/s", 1000.0 / 3600.0);
+    registerAffineConversion(UNIT_FLOW, "GPM", 4.402867539);
 }
 
 UnitConversionManager::~UnitConversionManager() {
@@ -1079,26 +1706,113 @@ UnitConversionManager* UnitConversionManager::instance() {
     return m_instance;
 }
 
+int UnitConversionManager::ensureUnitId(const QString& unitName) {
+    auto it = m_unitIds.constFind(unitName);
+    if (it != m_unitIds.constEnd()) {
+        return it.value();
+    }
+    int id = m_unitNames.size();
+    m_unitIds.insert(unitName, id);
+    m_unitNames.append(unitName);
+    m_table.resize(m_table.size() + ENGINEERING_UNIT_COUNT);  // 新单位追加一列
+    return id;
+}
+
+const UnitConversion* UnitConversionManager::lookup(EngineeringUnit fromUnit, int toUnitId) const {
+    if (toUnitId < 0 || toUnitId >= m_unitNames.size() ||
+        fromUnit < 0 || fromUnit >= ENGINEERING_UNIT_COUNT) {
+        return nullptr;
+    }
+    const UnitConversion &entry = m_table.at(toUnitId * ENGINEERING_UNIT_COUNT + fromUnit);
+    return entry.valid ? &entry : nullptr;
+}
+
 void UnitConversionManager::registerConversion(EngineeringUnit fromUnit,
                                                const QString& toUnit,
                                                std::function<double(double)> converter) {
-    m_conversions.insert(qMakePair(fromUnit, toUnit), converter);
+    if (fromUnit < 0 || fromUnit >= ENGINEERING_UNIT_COUNT || !converter) {
+        return;
+    }
+    QWriteLocker locker(&m_lock);
+    UnitConversion &entry = m_table[ensureUnitId(toUnit) * ENGINEERING_UNIT_COUNT + fromUnit];
+    entry.scale = 1.0;
+    entry.offset = 0.0;
+    entry.function = converter;
+    entry.valid = true;
+}
+
+void UnitConversionManager::registerAffineConversion(EngineeringUnit fromUnit, const QString& toUnit,
+                                                     double scale, double offset) {
+    if (fromUnit < 0 || fromUnit >= ENGINEERING_UNIT_COUNT) {
+        return;
+    }
+    QWriteLocker locker(&m_lock);
+    UnitConversion &entry = m_table[ensureUnitId(toUnit) * ENGINEERING_UNIT_COUNT + fromUnit];
+    entry.scale = scale;
+    entry.offset = offset;
+    entry.function = nullptr;
+    entry.valid = true;
+}
+
+UnitConversion UnitConversionManager::conversion(EngineeringUnit fromUnit, const QString& toUnit) const {
+    {
+        QReadLocker locker(&m_lock);
+        const UnitConversion *entry = lookup(fromUnit, m_unitIds.value(toUnit, -1));
+        if (entry) {
+            return *entry;
+        }
+    }
+
+    UnitConversion identity;  // 同单位为恒等换算，其余无换算（原样输出）
+    identity.valid = (toUnit == engineeringUnitToString(fromUnit));
+    return identity;
+}
+
+int UnitConversionManager::unitId(const QString& unitName) const {
+    QReadLocker locker(&m_lock);
+    return m_unitIds.value(unitName, -1);
 }
 
 double UnitConversionManager::convert(double value, EngineeringUnit fromUnit,
                                       const QString& toUnit) const {
-    auto key = qMakePair(fromUnit, toUnit);
-    if (m_conversions.contains(key)) {
-        return m_conversions.value(key)(value);
+    QReadLocker locker(&m_lock);
+    const UnitConversion *entry = lookup(fromUnit, m_unitIds.value(toUnit, -1));
+    return entry ? entry->apply(value) : value;
+}
+
+double UnitConversionManager::convert(double value, EngineeringUnit fromUnit, int toUnitId) const {
+    QReadLocker locker(&m_lock);
+    const UnitConversion *entry = lookup(fromUnit, toUnitId);
+    return entry ? entry->apply(value) : value;
+}
+
+bool UnitConversionManager::convert(const double *values, double *out, int count,
+                                    EngineeringUnit fromUnit, const QString& toUnit) const {
+    if (count <= 0) {
+        return true;
     }
-    return value;
+    UnitConversion conv = conversion(fromUnit, toUnit);  // 只在这里查一次表
+    if (!conv.valid) {
+        std::copy(values, values + count, out);
+        return false;
+    }
+    conv.apply(values, out, count);
+    return true;
+}
+
+QVector<double> UnitConversionManager::convert(const QVector<double>& values, EngineeringUnit fromUnit,
+                                               const QString& toUnit) const {
+    QVector<double> out(values.size());
+    convert(values.constData(), out.data(), values.size(), fromUnit, toUnit);
+    return out;
 }
 
 QStringList UnitConversionManager::getSupportedUnits(EngineeringUnit unit) const {
     QStringList units;
-    for (auto it = m_conversions.constBegin(); it != m_conversions.constEnd(); ++it) {
-        if (it.key().first == unit) {
-            units << it.key().second;
+    QReadLocker locker(&m_lock);
+    for (int id = 0; id < m_unitNames.size(); id++) {
+        if (lookup(unit, id)) {
+            units << m_unitNames.at(id);
         }
     }
     return units;
@@ -1114,6 +1828,50 @@ void UnitConversionManager::addCustomUnit(const QString& unitName,
                                           double conversionFactor) {
     m_unitDisplayNames.insert(unitName, displayName);
     m_customUnits.insert(unitName, qMakePair(baseUnit, conversionFactor));
+    registerAffineConversion(baseUnit, unitName, conversionFactor);
+}
+}
+
+// ==================== AlarmRollup 实现 ====================
+namespace Industrial {
+
+int AlarmRollup::count(AlarmLevel level) const {
+    if (level < ALARM_NONE || level >= LEVEL_COUNT) {
+        return 0;
+    }
+    return levelCounts[level];
+}
+
+AlarmLevel AlarmRollup::highestLevel() const {
+    for (int level = LEVEL_COUNT - 1; level > ALARM_NONE; level--) {
+        if (levelCounts[level] > 0) {
+            return static_cast<AlarmLevel>(level);
+        }
+    }
+    return ALARM_NONE;
+}
+
+void AlarmRollup::add(const AlarmRollup &other, int sign) {
+    variableCount += sign * other.variableCount;
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        levelCounts[level] += sign * other.levelCounts[level];
+    }
+    activeCount += sign * other.activeCount;
+    unacknowledgedCount += sign * other.unacknowledgedCount;
+    badQualityCount += sign * other.badQualityCount;
+}
+
+bool AlarmRollup::operator==(const AlarmRollup &other) const {
+    if (variableCount != other.variableCount || activeCount != other.activeCount ||
+        unacknowledgedCount != other.unacknowledgedCount || badQualityCount != other.badQualityCount) {
+        return false;
+    }
+    for (int level = 0; level < LEVEL_COUNT; level++) {
+        if (levelCounts[level] != other.levelCounts[level]) {
+            return false;
+        }
+    }
+    return true;
 }
 }
 
@@ -1133,15 +1891,62 @@ void VariableGroup::setDescription(const QString &desc) {
 
 void VariableGroup::addVariable(VariableDefinition *var) {
     if (!m_variables.contains(var->tagName())) {
-        m_variables.insert(var->tagName(), var);
+        const QString tagName = var->tagName();
+        m_variables.insert(tagName, var);
+
+        // 成员越限、报警参数或质量变化时只重新计数这一个变量；在报警或等待确认的成员
+        // 每个新值都要重新判断（确认延时由本组的过滤器处理）
+        connect(var, &VariableDefinition::alarmLimitCrossed, this, [this, tagName]() {
+            refreshVariable(tagName);
+        });
+        connect(var, &VariableDefinition::alarmLimitsChanged, this, [this, tagName]() {
+            refreshVariable(tagName);
+        });
+        connect(var, &VariableDefinition::valueChanged, this, [this, tagName]() {
+            auto it = m_memberStates.constFind(tagName);
+            if (it != m_memberStates.constEnd() &&
+                (it.value().candidate != ALARM_NONE || it.value().filter.hasPending())) {
+                refreshVariable(tagName);
+            }
+        });
+        connect(var, &VariableDefinition::qualityChanged, this, [this, tagName]() {
+            refreshVariable(tagName);
+        });
+        connect(var, &QObject::destroyed, this, [this, tagName]() {
+            removeVariable(tagName);
+        });
+
+        // 加入时已在报警的变量直接按当前级别计入，不再等待确认延时
+        AlarmRollup previous = m_rollup;
+        MemberState state;
+        state.candidate = var->checkAlarm();
+        state.filter.confirmed = state.candidate;
+        state.filter.pending = state.candidate;
+        state.level = state.candidate;
+        state.acknowledged = (state.level == ALARM_NONE);
+        state.quality = var->quality();
+        m_memberStates.insert(tagName, state);
+        applyMember(state, 1);
+
         emit variableAdded(var);
+        publishRollup(previous);
     }
 }
 
 void VariableGroup::removeVariable(const QString &tagName) {
     if (m_variables.contains(tagName)) {
-        m_variables.remove(tagName);
+        VariableDefinition *var = m_variables.take(tagName);
+        disconnect(var, nullptr, this, nullptr);
+
+        AlarmRollup previous = m_rollup;
+        auto it = m_memberStates.find(tagName);
+        if (it != m_memberStates.end()) {
+            applyMember(it.value(), -1);
+            m_memberStates.erase(it);
+        }
+
         emit variableRemoved(tagName);
+        publishRollup(previous);
     }
 }
 
@@ -1153,28 +1958,285 @@ QList<VariableDefinition*> VariableGroup::variables() const {
     return m_variables.values();
 }
 
-void VariableGroup::addSubGroup(VariableGroup *group) {
-    if (!m_subGroups.contains(group)) {
-        m_subGroups.append(group);
+bool VariableGroup::addSubGroup(VariableGroup *group) {
+    if (!group || m_subGroups.contains(group)) {
+        return false;
     }
+    // group的下级中有本组时，加入后本组成为自己的下级，汇总会沿环无限传递
+    if (group->containsGroup(this)) {
+        qWarning() << "Sub group" << group->groupName() << "already contains" << m_groupName
+                   << ", rejected to avoid a cycle";
+        return false;
+    }
+
+    m_subGroups.append(group);
+
+    // 子组汇总变化时送来新汇总，这里扣除上次的再加上新的
+    connect(group, &VariableGroup::alarmRollupChanged, this,
+            [this, group](const AlarmRollup &rollup) {
+        onSubGroupRollupChanged(group, rollup);
+    });
+    connect(group, &QObject::destroyed, this, [this, group]() {
+        m_subGroups.removeAll(group);
+        removeSubGroupRollup(group);
+    });
+    onSubGroupRollupChanged(group, group->alarmRollup());
+    return true;
 }
 
 QList<VariableGroup*> VariableGroup::subGroups() const {
     return m_subGroups;
 }
 
+bool VariableGroup::containsGroup(const VariableGroup *group) const {
+    // 子组结构保证无环，仍按已访问集合遍历，共享的下级只走一次
+    QSet<const VariableGroup*> visited;
+    QList<const VariableGroup*> pending;
+    pending.append(this);
+    while (!pending.isEmpty()) {
+        const VariableGroup *current = pending.takeLast();
+        if (current == group) {
+            return true;
+        }
+        if (visited.contains(current)) {
+            continue;
+        }
+        visited.insert(current);
+        for (VariableGroup *sub : current->m_subGroups) {
+            pending.append(sub);
+        }
+    }
+    return false;
+}
+
 int VariableGroup::variableCount() const {
     return m_variables.size();
 }
 
 int VariableGroup::alarmCount() const {
-    int count = 0;
-    for (auto var : m_variables) {
-        if (var->isInAlarm()) {
-            count++;
+    return m_localRollup.activeCount;
+}
+
+int VariableGroup::rolledUpAlarmCount() const {
+    // 汇总计数按组相加，同一变量在多个组中会重复；这里按变量对象去重
+    QSet<const VariableDefinition*> alarmed;
+    QSet<const VariableGroup*> visited;
+    QList<const VariableGroup*> pending;
+    pending.append(this);
+    while (!pending.isEmpty()) {
+        const VariableGroup *current = pending.takeLast();
+        if (visited.contains(current)) {
+            continue;
+        }
+        visited.insert(current);
+        for (auto it = current->m_memberStates.constBegin(); it != current->m_memberStates.constEnd(); ++it) {
+            if (it.value().level != ALARM_NONE) {
+                alarmed.insert(current->m_variables.value(it.key(), nullptr));
+            }
+        }
+        for (VariableGroup *sub : current->m_subGroups) {
+            pending.append(sub);
+        }
+    }
+    alarmed.remove(nullptr);
+    return alarmed.size();
+}
+
+void VariableGroup::updateAlarmState(const QString &tagName, AlarmLevel level, bool acknowledged) {
+    auto it = m_memberStates.constFind(tagName);
+    if (it == m_memberStates.constEnd()) {
+        return;
+    }
+    MemberState state = it.value();
+    state.level = level;
+    state.candidate = level;
+    state.filter.confirmed = level;
+    state.filter.pending = level;
+    state.acknowledged = acknowledged || level == ALARM_NONE;
+    state.externalAlarm = true;
+    setMemberState(tagName, state);
+}
+
+void VariableGroup::refreshVariable(const QString &tagName) {
+    VariableDefinition *var = m_variables.value(tagName, nullptr);
+    auto it = m_memberStates.constFind(tagName);
+    if (!var || it == m_memberStates.constEnd()) {
+        return;
+    }
+    MemberState state = it.value();
+    state.quality = var->quality();
+    if (!state.externalAlarm) {
+        const UaTimestamp now = UaTime::now();
+        scheduleAlarmDelay(evaluateAlarm(var, state, now), now);
+    }
+    setMemberState(tagName, state);
+}
+
+void VariableGroup::acknowledgeAlarm(const QString &tagName) {
+    auto it = m_memberStates.constFind(tagName);
+    if (it == m_memberStates.constEnd() || it.value().acknowledged) {
+        return;
+    }
+    MemberState state = it.value();
+    state.acknowledged = true;
+    setMemberState(tagName, state);
+}
+
+void VariableGroup::acknowledgeAllAlarms() {
+    if (m_localRollup.unacknowledgedCount == 0) {
+        return;
+    }
+    AlarmRollup previous = m_rollup;
+    for (auto it = m_memberStates.begin(); it != m_memberStates.end(); ++it) {
+        if (!it.value().acknowledged) {
+            applyMember(it.value(), -1);
+            it.value().acknowledged = true;
+            applyMember(it.value(), 1);
+        }
+    }
+    publishRollup(previous);
+}
+
+void VariableGroup::applyMember(const MemberState &state, int sign) {
+    AlarmRollup member;
+    member.variableCount = 1;
+    member.levelCounts[qBound(0, static_cast<int>(state.level), AlarmRollup::LEVEL_COUNT - 1)] = 1;
+    if (state.level != ALARM_NONE) {
+        member.activeCount = 1;
+        if (!state.acknowledged) {
+            member.unacknowledgedCount = 1;
+        }
+    }
+    if (state.quality != QUALITY_GOOD) {
+        member.badQualityCount = 1;
+    }
+    m_localRollup.add(member, sign);
+    m_rollup.add(member, sign);
+}
+
+qint64 VariableGroup::evaluateAlarm(VariableDefinition *var, MemberState &state, UaTimestamp now) {
+    qint64 remaining = -1;
+    if (var->serverAlarmEnabled()) {
+        // 服务器报警不做滞环和延时，切回客户端判断时从服务器级别开始
+        state.candidate = var->serverAlarmState();
+        state.filter.confirmed = state.candidate;
+        state.filter.pending = state.candidate;
+    } else {
+        const qint64 onDelay = static_cast<qint64>(var->alarmOnDelay()) * UaTime::TICKS_PER_MSEC;
+        const qint64 offDelay = static_cast<qint64>(var->alarmOffDelay()) * UaTime::TICKS_PER_MSEC;
+        state.candidate = var->checkAlarm(state.candidate);
+        state.filter.update(state.candidate, now, onDelay, offDelay);
+        if (state.filter.hasPending()) {
+            const qint64 delay = state.filter.pending > state.filter.confirmed ? onDelay : offDelay;
+            remaining = qMax<qint64>(0, state.filter.pendingSince + delay - now);
+        }
+    }
+
+    const AlarmLevel level = state.filter.confirmed;
+    if (level != state.level) {
+        // 与RealTimeVariable一致：级别变化后需要重新确认
+        state.level = level;
+        state.acknowledged = (level == ALARM_NONE);
+    }
+    return remaining;
+}
+
+void VariableGroup::scheduleAlarmDelay(qint64 remaining, UaTimestamp now) {
+    if (remaining < 0) {
+        return;
+    }
+    // 只保留最早的一个到期时间；更早的成员再挂一个，先到的定时器会重新安排其余成员
+    const UaTimestamp due = now + remaining;
+    if (m_alarmTimerDue != 0 && m_alarmTimerDue <= due) {
+        return;
+    }
+    m_alarmTimerDue = due;
+    const int msecs = static_cast<int>(remaining / UaTime::TICKS_PER_MSEC) + 1;
+    QTimer::singleShot(msecs, Qt::PreciseTimer, this, &VariableGroup::onAlarmDelayTimeout);
+}
+
+void VariableGroup::onAlarmDelayTimeout() {
+    const UaTimestamp now = UaTime::now();
+    if (m_alarmTimerDue == 0) {
+        return;     // 已被更早的定时器处理
+    }
+    if (now < m_alarmTimerDue) {
+        // 之前挂的较晚定时器，或定时器提前触发：按剩余时间重新安排
+        const qint64 remaining = m_alarmTimerDue - now;
+        m_alarmTimerDue = 0;
+        scheduleAlarmDelay(remaining, now);
+        return;
+    }
+    m_alarmTimerDue = 0;
+
+    AlarmRollup previous = m_rollup;
+    qint64 nextRemaining = -1;
+    for (auto it = m_memberStates.begin(); it != m_memberStates.end(); ++it) {
+        MemberState &state = it.value();
+        if (state.externalAlarm || !state.filter.hasPending()) {
+            continue;
+        }
+        VariableDefinition *var = m_variables.value(it.key(), nullptr);
+        if (!var) {
+            continue;
+        }
+        applyMember(state, -1);
+        const qint64 remaining = evaluateAlarm(var, state, now);
+        applyMember(state, 1);
+        if (remaining >= 0 && (nextRemaining < 0 || remaining < nextRemaining)) {
+            nextRemaining = remaining;
         }
     }
-    return count;
+    scheduleAlarmDelay(nextRemaining, now);
+    publishRollup(previous);
+}
+
+void VariableGroup::setMemberState(const QString &tagName, const MemberState &state) {
+    auto it = m_memberStates.find(tagName);
+    if (it == m_memberStates.end()) {
+        return;
+    }
+    AlarmRollup previous = m_rollup;
+    applyMember(it.value(), -1);
+    it.value() = state;
+    applyMember(state, 1);
+    publishRollup(previous);
+}
+
+void VariableGroup::onSubGroupRollupChanged(VariableGroup *group, const AlarmRollup &rollup) {
+    AlarmRollup previous = m_rollup;
+    auto it = m_subGroupRollups.find(group);
+    if (it != m_subGroupRollups.end()) {
+        m_rollup.add(it.value(), -1);
+        it.value() = rollup;
+    } else {
+        m_subGroupRollups.insert(group, rollup);
+    }
+    m_rollup.add(rollup, 1);
+    publishRollup(previous);
+}
+
+void VariableGroup::removeSubGroupRollup(VariableGroup *group) {
+    auto it = m_subGroupRollups.find(group);
+    if (it == m_subGroupRollups.end()) {
+        return;
+    }
+    AlarmRollup previous = m_rollup;
+    m_rollup.add(it.value(), -1);
+    m_subGroupRollups.erase(it);
+    publishRollup(previous);
+}
+
+void VariableGroup::publishRollup(const AlarmRollup &previous) {
+    if (m_rollup == previous) {
+        return;
+    }
+    if (m_rollup.activeCount != previous.activeCount ||
+        m_rollup.highestLevel() != previous.highestLevel() ||
+        m_rollup.unacknowledgedCount != previous.unacknowledgedCount) {
+        emit alarmStatusChanged();
+    }
+    emit alarmRollupChanged(m_rollup);
 }
 }
 
@@ -1204,6 +2266,17 @@ void PlantArea::removeDevice(const QString &deviceName) {
 void PlantArea::addVariableGroup(VariableGroup *group) {
     if (!m_groups.contains(group->groupName())) {
         m_groups.insert(group->groupName(), group);
+
+        const QString groupName = group->groupName();
+        connect(group, &VariableGroup::alarmRollupChanged, this,
+                [this, group](const AlarmRollup &rollup) {
+            onGroupRollupChanged(group, rollup);
+        });
+        connect(group, &QObject::destroyed, this, [this, group, groupName]() {
+            m_groups.remove(groupName);
+            removeGroupRollup(group);
+        });
+        onGroupRollupChanged(group, group->alarmRollup());
     }
 }
 
@@ -1223,6 +2296,31 @@ QList<QString> PlantArea::getDeviceNames() const {
     return m_devices.keys();
 }
 
+void PlantArea::onGroupRollupChanged(VariableGroup *group, const AlarmRollup &rollup) {
+    AlarmRollup previous = m_rollup;
+    auto it = m_groupRollups.find(group);
+    if (it != m_groupRollups.end()) {
+        m_rollup.add(it.value(), -1);
+        it.value() = rollup;
+    } else {
+        m_groupRollups.insert(group, rollup);
+    }
+    m_rollup.add(rollup, 1);
+    if (m_rollup != previous) {
+        emit alarmRollupChanged(m_rollup);
+    }
+}
+
+void PlantArea::removeGroupRollup(VariableGroup *group) {
+    auto it = m_groupRollups.find(group);
+    if (it == m_groupRollups.end()) {
+        return;
+    }
+    m_rollup.add(it.value(), -1);
+    m_groupRollups.erase(it);
+    emit alarmRollupChanged(m_rollup);
+}
+
 
 
 
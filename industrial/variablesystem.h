@@ -4,14 +4,19 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
 #include <QVector>
 #include <QDateTime>
 #include <QVariant>
 #include <QStringList>
+#include <QJsonObject>
 #include <QReadWriteLock>
 #include <QMutex>
 #include <QScopedPointer>
+#include <QPointer>
 #include <functional>
+#include "valuecellstore.h"
+#include "stringpool.h"
 
 namespace Industrial {
 
@@ -108,6 +113,11 @@ public:
                                 const QString &variable, const QString &suffix = "PV") {
         return QString("%1.%2.%3.%4").arg(area).arg(device).arg(variable).arg(suffix);
     }
+    // 与generateName相同的分段，直接得到各段的字符串池编号
+    static TagName generateTagName(const QString &area, const QString &device,
+                                   const QString &variable, const QString &suffix = "PV") {
+        return TagName::fromSegments(QStringList() << area << device << variable << suffix);
+    }
 
     static const QString SUFFIX_PV;
     static const QString SUFFIX_SP;
@@ -121,6 +131,10 @@ public:
     static const QString SUFFIX_AVG;
     static const QString SUFFIX_SUM;
     static const QString SUFFIX_RATE;
+    static const QString SUFFIX_MIN;
+    static const QString SUFFIX_MAX;
+    static const QString SUFFIX_STD;
+    static const QString SUFFIX_CNT;
 };
 
 // ==================== 转换函数基类 ====================
@@ -148,7 +162,105 @@ public:
     }
 
     virtual ConversionFunction* clone() const = 0;
+
+    // 批量转换：默认逐个调用，内置转换在一个循环内完成，不再逐值虚调用
+    virtual void rawToEngineeringBatch(const double *raw, double *eng, int count) const {
+        for (int i = 0; i < count; i++) {
+            eng[i] = rawToEngineering(raw[i]);
+        }
+    }
+
+    // 不可逆（非单调）时engineeringToRaw返回NaN
+    virtual bool isInvertible() const { return true; }
+
+    // 序列化：VariableDatabase按类型名和参数重建（见conversionfunctions.h），类型名为空的自定义转换不保存
+    virtual QString typeName() const { return QString(); }
+    virtual QJsonObject parameters() const { return QJsonObject(); }
+
+    // 线性转换返回系数，批量转换据此走向量化路径；其他转换返回false，逐个调用rawToEngineering
+    virtual bool linearCoefficients(double &scaleFactor, double &offset) const {
+        Q_UNUSED(scaleFactor);
+        Q_UNUSED(offset);
+        return false;
+    }
+};
+
+// ==================== 变量值快照 ====================
+struct VariableSnapshot {
+    QVariant value;
+    DataQuality quality = QUALITY_BAD;
+    QDateTime timestamp;
+    bool valid = false;     // 是否写入过有效值
+};
+
+// ==================== 报警限值 ====================
+// 客户端限值判断的展开形式（批量报警计算用）：未启用的限值为NaN（任何比较都不成立），
+// 越LoLo/HiHi为ALARM_CRITICAL，越Lo/Hi为bandLevel
+struct AlarmThresholds {
+    double loLo;
+    double lo;
+    double hi;
+    double hiHi;
+    double hysteresis = 0.0;    // 复位滞环：越限后需回到限值内侧hysteresis以外才复位
+    AlarmLevel bandLevel = ALARM_NONE;
+    bool enabled = false;   // 报警关闭、服务器报警或限值无效时为false
+};
+
+// ==================== 报警延时过滤 ====================
+// 候选级别（限值+滞环的判断结果）需持续onDelay（升级）或offDelay（降级/复位）才确认。
+// 延时内候选级别回到确认级别或换成别的级别，原来等待的变化计为被抑制
+struct AlarmFilter {
+    AlarmLevel confirmed = ALARM_NONE;
+    AlarmLevel pending = ALARM_NONE;    // 等待确认的级别，等于confirmed表示没有等待
+    UaTimestamp pendingSince = 0;
+    quint32 suppressed = 0;             // 被延时抑制的变化次数
+
+    // 返回true表示确认级别变化；延时单位为UaTimestamp刻度
+    bool update(AlarmLevel candidate, UaTimestamp now, qint64 onDelay, qint64 offDelay);
+    bool hasPending() const { return pending != confirmed; }
+    void reset() { confirmed = ALARM_NONE; pending = ALARM_NONE; pendingSince = 0; }
+};
+
+// ==================== 变量配置快照 ====================
+// 采集线程在值路径上读取的工程参数（范围、缩放、死区、报警限值）打包成不可变快照，连同由它们推导出的
+// 换算系数和报警区段一起发布。修改时复制当前快照、改好后原子替换shared_ptr，读者用std::atomic_load取得
+// 自己的引用，不加m_configMutex，也不会读到改了一半的参数。被替换的快照在最后一个读者释放引用后析构
+struct VariableConfig {
+    // 工程范围与原始值范围
+    double minValue = 0.0;
+    double maxValue = 100.0;
+    double rawMinValue = 0.0;
+    double rawMaxValue = 100.0;
+
+    // 转换参数
+    double scaleFactor = 1.0;
+    double offset = 0.0;
+    double deadband = 0.1;
+
+    // 报警参数
+    double alarmLo = 10.0;
+    double alarmHi = 90.0;
+    double alarmLoLo = 5.0;
+    double alarmHiHi = 95.0;
+    AlarmLevel alarmLevel = ALARM_WARNING;
+    double alarmHysteresis = 0.0;
+    int alarmOnDelay = 0;
+    int alarmOffDelay = 0;
+
+    quint64 version = 0;                // 发布时分配，全局递增；0为缺省快照
+
+    // 派生参数，发布前由finalize()计算
+    double conversionScale = 1.0;       // rawToEngineering = raw * conversionScale + conversionOffset
+    double conversionOffset = 0.0;
+    bool alarmValid = false;            // 限值有序时才做报警判断
+    bool hasCriticalAlarm = false;
+    bool hasMajorAlarm = false;
+
+    void finalize();
+    bool validate(QStringList *errors = nullptr) const;
+    bool sameParameters(const VariableConfig &other) const;    // 不比较版本号和派生参数
 };
+typedef std::shared_ptr<const VariableConfig> VariableConfigPtr;
 
 // ==================== 变量定义类 ====================
 class VariableDefinition : public QObject {
@@ -181,6 +293,11 @@ public:
     explicit VariableDefinition(const QString &tagName,
                                 VariableType type,
                                 QObject *parent = nullptr);
+    // 实时值单元直接分配在给定存储中（批量注册时省去先占用进程级存储再迁移）
+    VariableDefinition(const QString &tagName,
+                       VariableType type,
+                       const std::shared_ptr<ValueCellStore> &store,
+                       QObject *parent);
     ~VariableDefinition();
 
     // 复制构造函数
@@ -188,7 +305,8 @@ public:
     VariableDefinition& operator=(const VariableDefinition& other);
 
     // ==================== 基本信息 ====================
-    QString tagName() const { return m_tagName; }
+    QString tagName() const;//由分段编号拼出，频繁使用时调用者保存一份
+    const TagName& tagPath() const { return m_tagPath; }//按'.'分段的池编号，按编号比较和按区域/设备前缀匹配
     QString description() const { return m_description; }
     void setDescription(const QString &desc);
 
@@ -197,23 +315,23 @@ public:
     void setUnit(EngineeringUnit unit);
 
     // ==================== 工程参数 ====================
-    double minValue() const { return m_minValue; }
+    double minValue() const { return currentConfig()->minValue; }
     void setMinValue(double minValue);
-    double maxValue() const { return m_maxValue; }
+    double maxValue() const { return currentConfig()->maxValue; }
     void setMaxValue(double maxValue);
     void setRange(double min, double max);
 
-    double rawMinValue() const { return m_rawMinValue; }
+    double rawMinValue() const { return currentConfig()->rawMinValue; }
     void setRawMinValue(double rawMin);
-    double rawMaxValue() const { return m_rawMaxValue; }
+    double rawMaxValue() const { return currentConfig()->rawMaxValue; }
     void setRawMaxValue(double rawMax);
     void setRawRange(double rawMin, double rawMax);
 
-    double scaleFactor() const { return m_scaleFactor; }
-    double offset() const { return m_offset; }
+    double scaleFactor() const { return currentConfig()->scaleFactor; }
+    double offset() const { return currentConfig()->offset; }
     void setScaling(double scaleFactor, double offset);
 
-    double deadband() const { return m_deadband; }
+    double deadband() const { return currentConfig()->deadband; }
     void setDeadband(double deadband);
 
     double initialValue() const { return m_initialValue; }
@@ -237,46 +355,95 @@ public:
     QString stringValue() const;
 
     // ✅ 新增：直接原生值访问（最高性能）
-    double directDoubleValue() const { return m_nativeValue.asDouble; }
-    bool directBoolValue() const { return m_nativeValue.asBool; }
-    int directIntValue() const { return m_nativeValue.asInt; }
+    double directDoubleValue() const { return m_cell->load().value.asDouble; }
+    bool directBoolValue() const { return m_cell->load().value.asBool; }
+    int directIntValue() const { return m_cell->load().value.asInt; }
 
     DataQuality quality() const;
     QDateTime timestamp() const;
+    UaTimestamp uaTimestamp() const { return m_cell->load().timestamp; }//原始时间戳，不构造QDateTime
+
+    // 值、质量、时间戳的一致快照（无锁读取，不阻塞写入）
+    VariableSnapshot snapshot() const;
+    ValueSample sample() const { return m_cell->load(); }//原生快照，不构造QVariant/QDateTime
+    static double sampleToDouble(const ValueSample &sample);//原生值按double读取（字符串为0）
+    static bool isNumericSample(const ValueSample &sample);//已写入且不是字符串
 
     // ==================== 值设置接口 ====================
     // ✅ 原有接口（保持兼容）
     Q_INVOKABLE void setValue(QVariant newValue,
-                              const QDateTime& timestamp = QDateTime::currentDateTime(),
+                              const QDateTime& timestamp,
+                              DataQuality quality = QUALITY_GOOD);
+
+    // 整数时间戳（UA_DateTime）：可直接传入服务器的sourceTimestamp，缺省UaTime::NOW在写入时取当前时间
+    Q_INVOKABLE void setValue(QVariant newValue,
+                              UaTimestamp timestamp = UaTime::NOW,
                               DataQuality quality = QUALITY_GOOD);
 
     // ✅ 新增：高效类型特定设置
     void setDoubleValue(double value,
-                        const QDateTime& timestamp = QDateTime::currentDateTime(),
+                        UaTimestamp timestamp = UaTime::NOW,
                         DataQuality quality = QUALITY_GOOD);
 
     void setBoolValue(bool value,
-                      const QDateTime& timestamp = QDateTime::currentDateTime(),
+                      UaTimestamp timestamp = UaTime::NOW,
                       DataQuality quality = QUALITY_GOOD);
 
     void setIntValue(int value,
-                     const QDateTime& timestamp = QDateTime::currentDateTime(),
+                     UaTimestamp timestamp = UaTime::NOW,
                      DataQuality quality = QUALITY_GOOD);
 
     void setStringValue(const QString& value,
-                        const QDateTime& timestamp = QDateTime::currentDateTime(),
+                        UaTimestamp timestamp = UaTime::NOW,
                         DataQuality quality = QUALITY_GOOD);
 
+    // QDateTime版本，转换后调用整数时间戳版本
+    void setDoubleValue(double value, const QDateTime& timestamp, DataQuality quality = QUALITY_GOOD);
+    void setBoolValue(bool value, const QDateTime& timestamp, DataQuality quality = QUALITY_GOOD);
+    void setIntValue(int value, const QDateTime& timestamp, DataQuality quality = QUALITY_GOOD);
+    void setStringValue(const QString& value, const QDateTime& timestamp, DataQuality quality = QUALITY_GOOD);
+
+    // 只改质量，值和时间戳不变（陈旧检测标记QUALITY_OLD/QUALITY_COMM_FAIL）。
+    // expectedVersion不为-1时，值单元写入次数仍等于它才修改，避免覆盖刚到的新值
+    bool setQuality(DataQuality quality, qint64 expectedVersion = -1);
+
+    // ==================== 值单元 ====================
+    // 实时值存放在所属管理器的连续单元数组中，变量对象只保存配置元数据
+    ValueCell* valueCell() const { return m_cell; }
+    quint32 valueCellId() const { return m_cellId; }
+    ValueCellStore* valueCellStore() const { return m_cellStore.get(); }
+    void bindValueCell(const std::shared_ptr<ValueCellStore> &store);//把实时值迁移到指定存储（管理器注册变量时调用）
+
+    // ==================== 变化通知 ====================
+    // 值或质量变化时总会在所属存储的变化位图中置位；关闭信号后不再逐个变量发出
+    // valueChanged/qualityChanged/timestampChanged，由管理器批量取走变化
+    void setChangeSignalsEnabled(bool enabled);
+    bool changeSignalsEnabled() const;
+
     // ==================== 报警参数 ====================
     void setAlarmLimits(double lo, double hi, double lolo = 0, double hihi = 0);
-    double alarmLo() const { return m_alarmLo; }
-    double alarmHi() const { return m_alarmHi; }
-    double alarmLoLo() const { return m_alarmLoLo; }
-    double alarmHiHi() const { return m_alarmHiHi; }
+    double alarmLo() const { return currentConfig()->alarmLo; }
+    double alarmHi() const { return currentConfig()->alarmHi; }
+    double alarmLoLo() const { return currentConfig()->alarmLoLo; }
+    double alarmHiHi() const { return currentConfig()->alarmHiHi; }
 
-    AlarmLevel alarmLevel() const { return m_alarmLevel; }
+    AlarmLevel alarmLevel() const { return currentConfig()->alarmLevel; }
     void setAlarmLevel(AlarmLevel level);
 
+    // 报警防抖：复位滞环（工程单位）和确认延时（毫秒），0为不启用
+    double alarmHysteresis() const { return currentConfig()->alarmHysteresis; }
+    void setAlarmHysteresis(double hysteresis);
+    int alarmOnDelay() const { return currentConfig()->alarmOnDelay; }     // 升级需持续的时间
+    void setAlarmOnDelay(int msecs);
+    int alarmOffDelay() const { return currentConfig()->alarmOffDelay; }   // 降级/复位需持续的时间
+    void setAlarmOffDelay(int msecs);
+
+    // 服务器报警（由OPC UA报警/条件事件给出，启用后跳过客户端限值判断）
+    bool serverAlarmEnabled() const { return m_serverAlarmEnabled.load(std::memory_order_acquire); }
+    void setServerAlarmEnabled(bool enabled);
+    AlarmLevel serverAlarmState() const { return m_serverAlarmState.load(std::memory_order_acquire); }
+    void setServerAlarmState(AlarmLevel level);
+
     // ==================== 历史记录 ====================
     bool historyEnabled() const { return m_historyEnabled; }
     void setHistoryEnabled(bool enabled);
@@ -288,27 +455,42 @@ public:
     bool writable() const { return m_writable; }
     void setWritable(bool writable);
 
-    QString accessGroup() const { return m_accessGroup; }
+    QString accessGroup() const { return StringPool::global()->string(m_accessGroupId); }
+    StringPool::Id accessGroupId() const { return m_accessGroupId; }
     void setAccessGroup(const QString &group);
 
     // ==================== 地址映射 ====================
     QString address() const { return m_address; }
     void setAddress(const QString &address);
 
-    QString dataType() const { return m_dataType; }
+    QString dataType() const { return StringPool::global()->string(m_dataTypeId); }
+    StringPool::Id dataTypeId() const { return m_dataTypeId; }
     void setDataType(const QString &type);
 
     // ==================== 显示格式 ====================
-    QString formatString() const { return m_format; }
+    QString formatString() const { return StringPool::global()->string(m_formatId); }
     void setFormatString(const QString &format);
 
-    QString unitSuffix() const { return m_unitSuffix; }
+    QString unitSuffix() const { return StringPool::global()->string(m_unitSuffixId); }
     void setUnitSuffix(const QString &suffix);
 
     // ==================== 关联变量 ====================
     void addRelatedVariable(const QString &tagName);
     QStringList relatedVariables() const { return m_relatedVariables; }
 
+    // ==================== 计算公式 ====================
+    // TYPE_CALC/TYPE_DERIVED变量的公式（引用其他标签），由CalculationEngine编译求值
+    QString expression() const { return m_expression; }
+    void setExpression(const QString &expression);
+
+    // ==================== 配置快照 ====================
+    // 各setter都是复制当前快照、修改、发布；整组参数一次替换用applyConfig，多个变量一次替换用VariableConfigBatch
+    VariableConfigPtr configSnapshot() const;
+    quint64 configVersion() const { return currentConfig()->version; }
+    bool applyConfig(const VariableConfig &config);    // 校验不通过时不修改
+    bool rollbackConfig();                              // 换回上一个快照，再次调用恢复
+    bool hasPreviousConfig() const;
+
     // ==================== 转换功能 ====================
     // QVariant版本（兼容性）
     QVariant rawToEngineering(QVariant rawValue) const;
@@ -320,6 +502,7 @@ public:
 
     void setConversionFunction(ConversionFunction* func);
     ConversionFunction* conversionFunction() const { return m_conversionFunc.data(); }
+    bool linearCoefficients(double &scaleFactor, double &offset) const;//转换为线性时返回与rawToEngineering一致的系数
 
     double convertToUnit(double value, const QString& targetUnit) const;
     QStringList supportedUnits() const;
@@ -334,14 +517,18 @@ public:
     VariableDefinition* clone(const QString& newTagName = "") const;
 
     // ==================== 缓存管理 ====================
+    // 换算系数和报警区段随快照发布时算好，这里只通知批量计算重建计划
     void invalidateCache();
     bool isCacheValid() const;
 
     // ==================== 报警检查 ====================
     AlarmLevel checkAlarmFast(double value) const;
+    AlarmLevel checkAlarmFast(double value, AlarmLevel current) const;//带复位滞环，current为上次结果
     bool isInAlarmFast(double value) const;
+    AlarmThresholds alarmThresholds() const;//与checkAlarmFast规则一致的限值展开
 
     AlarmLevel checkAlarm() const;
+    AlarmLevel checkAlarm(AlarmLevel current) const;//按当前值判断，带复位滞环，current为上次结果
     bool isInAlarm() const;
 
     // ✅ 新增：根据当前值的报警检查
@@ -359,72 +546,32 @@ private:
     };
 
     // ==================== 原生值存储 ====================
-    union NativeValue {
-        double asDouble;
-        bool asBool;
-        int asInt;
-        qint64 asLong;
-
-        NativeValue() : asDouble(0.0) {}
-    };
+    typedef ValueSample::NativeValue NativeValue;
 
-    // ==================== 缓存结构 ====================
-    struct ConversionCache {
-        double scaleFactor = 1.0;
-        double offset = 0.0;
-        bool valid = false;
-
-        void clear() {
-            scaleFactor = 1.0;
-            offset = 0.0;
-            valid = false;
-        }
-    };
+    // ==================== 私有方法 ====================
+    friend class VariableConfigBatch;
 
-    struct AlarmCache {
-        bool hasCriticalAlarm : 1;
-        bool hasMajorAlarm : 1;
-        bool hasMinorAlarm : 1;
-        double criticalLoLo;
-        double criticalHiHi;
-        double majorLo;
-        double majorHi;
-        bool valid : 1;
-
-        AlarmCache() :
-            hasCriticalAlarm(false),
-            hasMajorAlarm(false),
-            hasMinorAlarm(false),
-            criticalLoLo(0.0),
-            criticalHiHi(0.0),
-            majorLo(0.0),
-            majorHi(0.0),
-            valid(false) {}
-
-        void clear() {
-            hasCriticalAlarm = false;
-            hasMajorAlarm = false;
-            hasMinorAlarm = false;
-            valid = false;
-        }
-    };
+    static void updateScalingParameters(VariableConfig &config);
+    static AlarmLevel alarmLevelFor(const VariableConfig &config, double value, double hysteresis);//config.alarmValid为true
 
-    // ==================== 私有方法 ====================
-    void updateScalingParameters();
-    void updateConversionCache() const;
-    void updateAlarmCache() const;
-    double calculateScaleFactor() const;
-    double calculateOffset() const;
+    // 配置快照：读者原子加载得到自己的引用；写者持有m_configMutex复制修改后原子替换。
+    // 多次读取参数时先取一次快照存在局部变量中，保证用的是同一组参数
+    VariableConfigPtr currentConfig() const { return std::atomic_load_explicit(&m_configOwner, std::memory_order_acquire); }
+    bool updateConfig(const std::function<bool(VariableConfig&)> &edit);//edit返回false表示没有变化
+    void publishConfig(const VariableConfigPtr &config);//调用者持有m_configMutex
+    void emitConfigSignals(const VariableConfig &before, const VariableConfig &after);
 
     // ✅ 新增：内部值设置帮助方法
     void setValueInternal(StorageType type, const NativeValue& nativeValue,
                           const QString& stringValue,
-                          const QDateTime& timestamp,
+                          UaTimestamp timestamp,
                           DataQuality quality);
 
-    // ✅ 新增：QVariant缓存管理
-    QVariant getCachedVariant() const;
-    void invalidateVariantCache();
+    // 从值采样生成QVariant
+    QVariant variantFromSample(const ValueSample &sample) const;
+    QString stringCopy() const;//加锁读取字符串值
+    void emitTimestampChanged(UaTimestamp timestamp);
+    void initValueCell(const std::shared_ptr<ValueCellStore> &store);
 
     // ✅ 新增：死区检查
     bool checkDeadband(double oldValue, double newValue) const;
@@ -438,9 +585,13 @@ signals:
     void rawRangeChanged(double rawMin, double rawMax);
     void deadbandChanged(double deadband);
     void updateRateChanged(int rate);
-    void alarmLimitsChanged();
+    void alarmLimitsChanged();      // 报警参数或服务器报警状态变化
+    // 新值越过限值：按限值和复位滞环判断（与checkAlarmFast(value, current)一致），不含确认延时，
+    // 不计抑制次数；确认延时和计数由RealTimeVariable、AlarmEvaluator、VariableGroup各自的AlarmFilter处理
+    void alarmLimitCrossed(AlarmLevel level);
     void scalingChanged(double scaleFactor, double offset);
     void unitSuffixChanged(const QString& suffix);
+    void expressionChanged(const QString &expression);
 
     void valueChanged(QVariant newValue);
     void valueChangedWithInfo(QVariant newValue,
@@ -451,56 +602,42 @@ signals:
 
 private:
     // 基本信息
-    QString m_tagName;
+    // 标签名只保存分段编号，各段字符串在池中共享；
+    // 单位后缀、访问组、数据类型、显示格式重复度高，只保存字符串池编号
+    TagName m_tagPath;
     QString m_description;
     VariableType m_type;
     EngineeringUnit m_unit;
-    QString m_unitSuffix;
-
-    // 工程范围
-    double m_minValue;
-    double m_maxValue;
-
-    // 原始值范围
-    double m_rawMinValue;
-    double m_rawMaxValue;
+    StringPool::Id m_unitSuffixId;
 
-    // 转换参数
-    double m_scaleFactor;
-    double m_offset;
+    // 工程参数快照（范围、缩放、死区、报警限值）
+    VariableConfigPtr m_configOwner;        // 当前快照，只经std::atomic_load/atomic_store访问（写者持锁时可直接读）
+    VariableConfigPtr m_previousConfig;     // 回滚用
+    mutable QMutex m_configMutex;
 
     // 转换函数
     QScopedPointer<ConversionFunction> m_conversionFunc;
 
-    double m_deadband;
     double m_initialValue;
 
     // 更新参数
     int m_updateRate;
     int m_priority;
 
-    // ==================== 值存储（混合方案） ====================
-    // 1. 原生值存储（高性能）
-    NativeValue m_nativeValue;
-    QString m_stringValue;          // 字符串单独存储
-    StorageType m_storageType;      // 当前存储类型
+    // ==================== 值存储 ====================
+    // 原生值、质量、时间戳在值单元中，字符串单独存储
+    std::shared_ptr<ValueCellStore> m_cellStore;
+    quint32 m_cellId;
+    ValueCell *m_cell;
+    QString m_stringValue;
 
-    // 2. QVariant缓存（按需生成）
-    mutable QVariant m_cachedVariant;
-    mutable bool m_variantCacheValid;
+    mutable QMutex m_valueMutex;   // 写者之间互斥、保护字符串值；数值读取走值单元顺序锁，不加锁
+    std::atomic<bool> m_changeSignalsEnabled{true};
+    AlarmLevel m_limitAlarmLevel = ALARM_NONE;  // 上次发出的越限级别（带复位滞环），m_valueMutex保护
 
-    // 3. 值元数据
-    mutable QMutex m_valueMutex;
-    QDateTime m_timestamp;
-    DataQuality m_quality;
-    bool m_valueValid;
-
-    // 报警参数
-    double m_alarmLo;
-    double m_alarmHi;
-    double m_alarmLoLo;
-    double m_alarmHiHi;
-    AlarmLevel m_alarmLevel;
+    // 报警参数（限值在配置快照中）
+    std::atomic<bool> m_serverAlarmEnabled{false};          // 事件线程写入，值路径和报警评估无锁读取
+    std::atomic<AlarmLevel> m_serverAlarmState{ALARM_NONE};
 
     // 历史记录
     bool m_historyEnabled;
@@ -508,25 +645,57 @@ private:
 
     // 安全性
     bool m_writable;
-    QString m_accessGroup;
+    StringPool::Id m_accessGroupId;
 
     // 地址映射
     QString m_address;
-    QString m_dataType;
+    StringPool::Id m_dataTypeId;
 
     // 显示
-    QString m_format;
+    StringPool::Id m_formatId;
 
     // 关联
     QStringList m_relatedVariables;
+    QString m_expression;
+
+};
+
+// ==================== 配置批量发布 ====================
+// 组态下发时成千上万个变量的参数要么全部换新、要么一个不换：先逐个stage()校验，全部通过后commit()
+// 用同一个版本号依次发布。发布期间generation()为奇数，需要跨变量一致的读者（例如比较两个变量的限值）
+// 读前读后各取一次，两次相同且为偶数时读到的是同一批配置。rollback()把本批变量换回提交前的快照
+class VariableConfigBatch {
+public:
+    VariableConfigBatch() = default;
+
+    bool stage(VariableDefinition *var, const VariableConfig &config);  // 校验不通过时记入errors()并返回false
+    int size() const { return m_items.size(); }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    const QStringList& errors() const { return m_errors; }
+    void clear();
+
+    bool commit();                      // 有校验错误或变量已删除时不发布任何变量
+    bool rollback();                    // 仅在commit成功后有效
+    bool isCommitted() const { return m_committed; }
+    quint64 version() const { return m_version; }
+
+    static quint64 generation();
+
+private:
+    struct Item {
+        QPointer<VariableDefinition> var;
+        VariableConfig config;          // 已校验
+        VariableConfigPtr published;    // 本批发布的快照
+        VariableConfigPtr before;       // 提交前的快照
+    };
 
-    // 缓存
-    mutable ConversionCache m_conversionCache;
-    mutable AlarmCache m_alarmCache;
-    mutable bool m_cacheValid;
-    mutable QMutex m_cacheMutex;
-    //mutable QReadWriteLock m_cacheLock;
+    QVector<Item> m_items;
+    QHash<VariableDefinition*, int> m_index;    // 同一变量重复stage时后者覆盖
+    QStringList m_errors;
+    quint64 m_version = 0;
+    bool m_committed = false;
 };
+
 // ==================== 线性转换函数 ====================
 class LinearConversion : public ConversionFunction {
 public:
@@ -536,6 +705,10 @@ public:
     double rawToEngineering(double rawValue) const override;
     double engineeringToRaw(double engValue) const override;
     ConversionFunction* clone() const override;
+    bool linearCoefficients(double &scaleFactor, double &offset) const override;
+    void rawToEngineeringBatch(const double *raw, double *eng, int count) const override;
+    QString typeName() const override { return "linear"; }
+    QJsonObject parameters() const override;
 
     double scaleFactor() const { return m_scaleFactor; }
     double offset() const { return m_offset; }
@@ -545,7 +718,22 @@ private:
     double m_offset;
 };
 
+// ==================== 单位换算 ====================
+// 能表示为仿射的换算保存y = x * scale + offset，其余保存换算函数。
+// 显示管线先取一次换算，再对整条曲线调用apply()，不再逐点查表
+struct UnitConversion {
+    double scale = 1.0;
+    double offset = 0.0;
+    std::function<double(double)> function;     // 非空时按函数换算
+    bool valid = false;                         // 有对应的换算（包括同单位）
+
+    bool isAffine() const { return !function; }
+    double apply(double value) const { return function ? function(value) : value * scale + offset; }
+    void apply(const double *values, double *out, int count) const;
+};
+
 // ==================== 单位转换管理器 ====================
+// 目标单位名称注册时分配编号，换算按[目标单位编号][工程单位]存放在二维表中
 class UnitConversionManager : public QObject {
     Q_OBJECT
 public:
@@ -553,9 +741,21 @@ public:
 
     void registerConversion(EngineeringUnit fromUnit, const QString& toUnit,
                             std::function<double(double)> converter);
+    void registerAffineConversion(EngineeringUnit fromUnit, const QString& toUnit,
+                                  double scale, double offset = 0.0);
 
     double convert(double value, EngineeringUnit fromUnit,
                    const QString& toUnit) const;
+    double convert(double value, EngineeringUnit fromUnit, int toUnitId) const;
+
+    // 批量换算：一次查表后整批计算；没有对应换算时原样拷贝并返回false
+    bool convert(const double *values, double *out, int count,
+                 EngineeringUnit fromUnit, const QString& toUnit) const;
+    QVector<double> convert(const QVector<double>& values, EngineeringUnit fromUnit,
+                            const QString& toUnit) const;
+
+    UnitConversion conversion(EngineeringUnit fromUnit, const QString& toUnit) const;
+    int unitId(const QString& unitName) const;  // 未注册的单位返回-1
 
     QStringList getSupportedUnits(EngineeringUnit unit) const;
     QString getUnitString(EngineeringUnit unit) const;
@@ -567,13 +767,49 @@ private:
     UnitConversionManager(QObject* parent = nullptr);
     ~UnitConversionManager();
 
+    static const int ENGINEERING_UNIT_COUNT = UNIT_LENGTH + 1;  // 二维表的行数
+
+    int ensureUnitId(const QString& unitName);  // 调用者持有写锁
+    const UnitConversion* lookup(EngineeringUnit fromUnit, int toUnitId) const;//调用者持有读锁
+
     static UnitConversionManager* m_instance;
-    QMap<QPair<EngineeringUnit, QString>, std::function<double(double)>> m_conversions;
+    //QMap<QPair<EngineeringUnit, QString>, std::function<double(double)>> m_conversions;
+    mutable QReadWriteLock m_lock;
+    QHash<QString, int> m_unitIds;              // 目标单位名称 -> 编号
+    QStringList m_unitNames;
+    QVector<UnitConversion> m_table;            // 下标 toUnitId * ENGINEERING_UNIT_COUNT + fromUnit
     QMap<QString, QString> m_unitDisplayNames;
     QMap<QString, QPair<EngineeringUnit, double>> m_customUnits;
 };
 
+// ==================== 报警汇总 ====================
+// 变量组/区域按报警级别、确认状态和质量的计数。由成员的报警和质量变化增量维护，
+// 总览画面直接读取，不随变量数量增加而变慢
+struct AlarmRollup {
+    static const int LEVEL_COUNT = ALARM_CRITICAL + 1;
+
+    int variableCount = 0;
+    int levelCounts[LEVEL_COUNT] = {};  // 下标为AlarmLevel，ALARM_NONE为不在报警的变量数
+    int activeCount = 0;                // 报警中的变量数
+    int unacknowledgedCount = 0;        // 报警未确认的变量数
+    int badQualityCount = 0;            // 质量不是GOOD的变量数
+
+    int count(AlarmLevel level) const;
+    AlarmLevel highestLevel() const;    // 报警中的最高级别，没有报警时为ALARM_NONE
+    void add(const AlarmRollup &other, int sign = 1);   // sign为-1时扣除
+    bool operator==(const AlarmRollup &other) const;
+    bool operator!=(const AlarmRollup &other) const { return !(*this == other); }
+};
+
 // ==================== 变量组 ====================
+// 报警汇总包含本组变量和子组：成员的值/质量变化触发单个变量的重新计数，
+// 子组通过alarmRollupChanged把新汇总交给上级，只有汇总发生变化时才发出信号。
+// 成员级别与RealTimeVariable一致：限值判断带复位滞环，再经升级/降级确认延时（AlarmFilter），
+// 等待确认的成员到期时由组内定时器确认，值不再刷新也不会停在旧级别。
+// 使用逐个信号之外的报警来源（批量计算器）时由updateAlarmState()送入，
+// 批量取走变化（setChangeSignalsEnabled(false)）的变量由消费者调用refreshVariable()。
+// 子组不能包含本组或本组的上级（不允许成环）；同一变量同时属于本组和子组时alarmRollup()计两次，
+// 按变量去重的报警数用rolledUpAlarmCount()
 class VariableGroup : public QObject {
     Q_OBJECT
     Q_PROPERTY(QString groupName READ groupName CONSTANT)
@@ -591,23 +827,63 @@ public:
     VariableDefinition* getVariable(const QString &tagName) const;
     QList<VariableDefinition*> variables() const;
 
-    void addSubGroup(VariableGroup *group);
+    bool addSubGroup(VariableGroup *group);     // group已包含本组（成环）时拒绝
     QList<VariableGroup*> subGroups() const;
+    bool containsGroup(const VariableGroup *group) const;  // group是否为本组或本组的下级
 
     int variableCount() const;
-    int alarmCount() const;
+    int alarmCount() const;                     // 只计本组变量
+    int rolledUpAlarmCount() const;             // 本组和所有下级中报警的变量数，同一变量只计一次
+
+    // ==================== 报警汇总 ====================
+    const AlarmRollup& localRollup() const { return m_localRollup; }   // 只含本组变量
+    const AlarmRollup& alarmRollup() const { return m_rollup; }   // 含子组
+    int alarmCount(AlarmLevel level) const { return m_rollup.count(level); }
+    int unacknowledgedCount() const { return m_rollup.unacknowledgedCount; }
+    int badQualityCount() const { return m_rollup.badQualityCount; }
+
+    // 外部报警来源送入的状态，之后该变量不再按自身限值重新判断
+    void updateAlarmState(const QString &tagName, AlarmLevel level, bool acknowledged);
+    void refreshVariable(const QString &tagName);   // 按变量当前值和质量重新计数
+    void acknowledgeAlarm(const QString &tagName);
+    void acknowledgeAllAlarms();                    // 只确认本组变量，子组各自确认
 
 signals:
     void descriptionChanged(const QString &description);
     void variableAdded(VariableDefinition *var);
     void variableRemoved(const QString &tagName);
     void alarmStatusChanged();
+    void alarmRollupChanged(const Industrial::AlarmRollup &rollup);
 
 private:
+    struct MemberState {
+        AlarmLevel level = ALARM_NONE;          // 经延时确认的级别
+        AlarmLevel candidate = ALARM_NONE;      // 带滞环的限值判断结果
+        AlarmFilter filter;
+        bool acknowledged = true;
+        DataQuality quality = QUALITY_GOOD;
+        bool externalAlarm = false;     // 由updateAlarmState()维护级别
+    };
+
+    void applyMember(const MemberState &state, int sign);
+    void setMemberState(const QString &tagName, const MemberState &state);
+    qint64 evaluateAlarm(VariableDefinition *var, MemberState &state, UaTimestamp now);//返回等待确认的剩余刻度，-1为没有等待
+    void scheduleAlarmDelay(qint64 remaining, UaTimestamp now);
+    void onAlarmDelayTimeout();
+    void onSubGroupRollupChanged(VariableGroup *group, const AlarmRollup &rollup);
+    void removeSubGroupRollup(VariableGroup *group);
+    void publishRollup(const AlarmRollup &previous);
+
     QString m_groupName;
     QString m_description;
     QMap<QString, VariableDefinition*> m_variables;
     QList<VariableGroup*> m_subGroups;
+
+    QHash<QString, MemberState> m_memberStates;
+    QHash<VariableGroup*, AlarmRollup> m_subGroupRollups;   // 子组上次送来的汇总，变化时先扣除
+    AlarmRollup m_localRollup;
+    AlarmRollup m_rollup;
+    UaTimestamp m_alarmTimerDue = 0;    // 已挂定时器的到期时间，0为没有
 };
 
 // ==================== 区域管理 ====================
@@ -636,11 +912,29 @@ public:
     QList<VariableDefinition*> getAllVariables() const;
     QList<QString> getDeviceNames() const;
 
+    // ==================== 报警汇总 ====================
+    // 各变量组汇总之和，组的汇总变化时增量更新
+    const AlarmRollup& alarmRollup() const { return m_rollup; }
+    int variableCount() const { return m_rollup.variableCount; }
+    int alarmCount() const { return m_rollup.activeCount; }
+    int alarmCount(AlarmLevel level) const { return m_rollup.count(level); }
+    int unacknowledgedCount() const { return m_rollup.unacknowledgedCount; }
+    int badQualityCount() const { return m_rollup.badQualityCount; }
+
+signals:
+    void alarmRollupChanged(const Industrial::AlarmRollup &rollup);
+
 private:
+    void onGroupRollupChanged(VariableGroup *group, const AlarmRollup &rollup);
+    void removeGroupRollup(VariableGroup *group);
+
     QString m_areaName;
     QString m_areaCode;
     QMap<QString, VariableGroup*> m_groups;
     QMap<QString, QString> m_devices;
+
+    QHash<VariableGroup*, AlarmRollup> m_groupRollups;     // 各组上次送来的汇总
+    AlarmRollup m_rollup;
 };
 
 